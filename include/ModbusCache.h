@@ -6,6 +6,13 @@
 #include <ModbusClientRTU.h>
 #include <ModbusClientTCPasync.h>
 #include "ModbusServerTCPasync.h"
+#include "rtu_tcp_server.h"
+#include "modbus_socket_server.h"
+#include "rtu_sniffer.h"
+#include "phase_tracker.h"
+#include "register_codec.h"
+#include "pdu_pool.h"
+#include "pdu_checks.h"
 #include "config.h"
 #include <WiFi.h>
 #include <map>
@@ -22,12 +29,49 @@
 
 #define MAX_REGISTERS 400
 
-enum class RegisterType {
-    UINT16,
-    INT16,
-    UINT32,
-    INT32,
-    FLOAT
+// Demand-driven polling: ranges clients stopped reading drop to a background
+// rate, ranges they read are polled at twice their read rate (never faster
+// than the polling interval), and reads outside the poll set add new ranges.
+#define DEMAND_COLD_MS 30000              // No client read for this long makes a range cold
+#define DEMAND_COLD_INTERVAL_MS 10000     // Background poll interval for cold ranges
+#define DEMAND_MAX_REGISTERS 64           // Raw registers the poll set may grow by
+#define DEMAND_MAX_RANGES 16              // Ranges the poll set may grow by, reserved up front
+#define DEMAND_MAX_PENDING 8              // Uncovered reads waiting to become ranges
+#define DEMAND_MAX_FAILURES 3             // Consecutive errors before a grown range is retired
+
+// Phase-aligned prefetch: once a range's client reads lock to a period, the
+// range is polled so the response lands just before the next expected read
+#define PREFETCH_GUARD_MS 20              // Margin on top of the range's upstream round trip
+#define PREFETCH_JITTER_LEAD 3            // Multiples of the client's phase jitter added to the lead
+#define SERVED_AGE_BUCKETS 9
+
+// Binary cache image served on /cache.bin (all fields little-endian):
+//   header  magic u32 "ETC1", version u8, flags u8 (bit0 operational), count u16,
+//           generation u32, primary millis u32
+//   entries address u16, type u8, reserved u8, raw value u32, age ms u32 (0xFFFFFFFF if never read)
+#define CACHE_IMAGE_MAGIC 0x31435445
+#define CACHE_IMAGE_VERSION 1
+#define CACHE_IMAGE_HEADER_SIZE 16
+#define CACHE_IMAGE_ENTRY_SIZE 12
+#define CACHE_IMAGE_FLAG_OPERATIONAL 0x01
+
+// ET112 baud-rate switch: polling pauses, the FC6 write goes out at the old
+// rate, the client reopens at the new rate and the meter must answer there
+// before the deadline, otherwise both sides go back to the old rate.
+#define CG_BAUD_REGISTER 0x2001           // 1..5 = 9.6, 19.2, 38.4, 57.6, 115.2 kbps
+#define CG_ID_REGISTER 11                 // Identification code, read to verify the meter answers
+#define BAUD_DRAIN_MS 2000                // Wait for in-flight polls before taking the bus
+#define BAUD_VERIFY_DEADLINE_MS 3000      // Meter must answer at the new rate within this
+#define BAUD_PROBE_TIMEOUT_MS 300         // Response timeout while probing or verifying
+#define RTU_CLIENT_TIMEOUT_MS 1000        // Response timeout for normal polling
+
+enum class BaudSwitchState : uint8_t {
+    IDLE,
+    PROBING,
+    DRAINING,
+    WRITING,
+    VERIFYING,
+    ROLLING_BACK
 };
 
 static String typeString(RegisterType type) {
@@ -37,15 +81,13 @@ static String typeString(RegisterType type) {
         case RegisterType::UINT32: return "UINT32";
         case RegisterType::INT32: return "INT32";
         case RegisterType::FLOAT: return "FLOAT";
+        case RegisterType::UINT32_HIGH_FIRST: return "UINT32_HIGH_FIRST";
+        case RegisterType::INT32_HIGH_FIRST: return "INT32_HIGH_FIRST";
+        case RegisterType::FLOAT_HIGH_FIRST: return "FLOAT_HIGH_FIRST";
         default: return "Unknown RegisterType";
     }
 };
 
-struct Uint16Pair {
-    uint16_t highWord;
-    uint16_t lowWord;
-};
-
 enum class UnitType {
     V,
     A,
@@ -84,12 +126,74 @@ struct ScaledWaterMarks {
     float lowWaterMark;
 };
 
+// One register of a range response, resolved once when the ranges are built
+struct DecodeStep {
+    uint16_t address;
+    uint8_t payloadOffset;               // Byte offset of the value in the response payload
+    bool is32Bit;
+    const RegisterCodecOps* codec;       // Wire decoding and watermark ordering
+    const ModbusRegister* definition;    // Type, scaling and unit for the sanity filter
+    uint32_t* slot32;                    // Cache slot written for 32-bit registers
+    uint16_t* slot16;                    // Cache slot written for 16-bit registers
+    uint64_t* timestamp;                 // registerTimestamps entry
+    std::unordered_set<uint16_t>* fetchedSet; // Static or dynamic fetched set
+};
+
 struct RegisterRange {
     uint16_t startAddress;
     uint16_t regCount;
     bool isStatic;
     unsigned long lastRequestTime;
     bool inFlight;
+    std::vector<DecodeStep> decodePlan;  // Built by buildDecodePlan()
+
+    // Client demand, recorded by respondFromCache
+    unsigned long lastReadTime = 0;      // millis() of the last client read, 0 if never read
+    uint32_t readIntervalMs = 0;         // Smoothed time between client reads
+    uint32_t reads = 0;
+
+    // Ranges added for reads outside the configured registers
+    bool isDemand = false;               // Values are raw words in demandRegisters
+    uint16_t demandSlot = 0;             // Index of startAddress in demandRegisters
+    uint8_t failures = 0;                // Consecutive failed polls
+    bool retired = false;                // Gave up polling after DEMAND_MAX_FAILURES
+
+    // Phase-aligned prefetch
+    PhaseTracker clientPhase;            // Period and phase of the client reads
+    unsigned long lastCommitTime = 0;    // millis() when a poll response was last committed
+    uint32_t roundTripMs = 0;            // Smoothed upstream request to response time
+    unsigned long prefetchTarget = 0;    // Client read the last prefetch was aimed at
+};
+
+// Raw register added to the poll set because a client read it
+struct DemandRegister {
+    uint16_t address;
+    uint16_t value;
+};
+
+// Poll state of one range for /metrics
+struct RangeDemandInfo {
+    uint16_t startAddress;
+    uint16_t regCount;
+    bool isDemand;
+    bool retired;
+    bool cold;
+    uint32_t reads;
+    uint32_t readIntervalMs;
+    unsigned long pollIntervalMs;
+    bool phaseLocked;
+    uint32_t clientPeriodMs;
+    uint32_t phaseJitterMs;
+    uint32_t roundTripMs;
+};
+
+// Age of the cached data served to clients, from the upstream response that
+// filled it to the client read; the oldest dynamic range a read touches counts
+struct ServedAgeSnapshot {
+    uint32_t count;
+    uint64_t sumMs;
+    uint32_t maxMs;
+    uint32_t buckets[SERVED_AGE_BUCKETS + 1];
 };
 
 class ModbusCache {
@@ -107,10 +211,13 @@ public:
     //uint16_t getRegisterValue(uint16_t address);
     uint16_t update_interval = 50;
     bool checkNewRegisterValue(uint16_t address, uint32_t proposedRawValue);
-    void setRegisterValue(uint16_t address, uint32_t value, bool is32Bit = false);
+    bool checkNewRegisterValue(const ModbusRegister& reg, uint32_t proposedRawValue, uint32_t currentRawValue);
+    bool setRegisterValue(uint16_t address, uint32_t value, bool is32Bit = false);
     static ModbusMessage respondFromCache(ModbusMessage request);
     // Getter methods
     ModbusServerRTU& getModbusRTUServer();
+    RtuOverTcpServer& getRtuOverTcpServer() { return rtuTcpServer; }
+    ModbusSocketServer& getSocketServer() { return socketServer; }
     ModbusClientRTU* getModbusRTUClient();
     ModbusClientTCPasync* getModbusTCPClient();
     bool getIsOperational() const {
@@ -145,21 +252,21 @@ public:
     String formatRegisterValue(uint16_t address, float value);
     String getFormattedRegisterValue(uint16_t address);
     String getCGBaudRate();
-    void setCGBaudRate(uint16_t baudRateValue);
+    bool setCGBaudRate(uint16_t baudRateValue);
     std::pair<String, String> getFormattedWaterMarks(uint16_t address);
     void createEmulatedServer(const std::vector<ModbusRegister>& registers);
-    // Getters for the metrics
-    unsigned long getMinLatency() const { return minLatency; }
-    unsigned long getMaxLatency() const { return maxLatency; }
-    float getAverageLatency() const { return averageLatency; }
+    // Getters for the metrics; latencies are tracked in µs and reported in ms
+    float getMinLatency() const { return latencies.empty() ? 0.0f : minLatency / 1000.0f; }
+    float getMaxLatency() const { return maxLatency / 1000.0f; }
+    float getAverageLatency() const { return averageLatency / 1000.0f; }
     float getStdDeviation() const {
         if (latencies.size() <= 1) return 0.0f;
         
-        float variance = sumLatencySquared / static_cast<float>(latencies.size()) - 
-                         averageLatency * averageLatency;
-        return sqrt(variance);
+        double variance = sumLatencySquared / static_cast<double>(latencies.size()) - 
+                          averageLatency * averageLatency;
+        return variance > 0.0 ? sqrt(variance) / 1000.0f : 0.0f;
     }
-    void updateLatencyStats(unsigned long latency);
+    void updateLatencyStats(uint32_t latencyUs);
 
     // New structs and methods for round-robin polling
     struct PollGroup {
@@ -174,7 +281,7 @@ public:
     void scheduleReconnect();
 
     // Add getter for lastSuccessfulUpdate timestamp
-    unsigned long getLastSuccessfulUpdate() const { return lastSuccessfulUpdate; }
+    uint64_t getLastSuccessfulUpdate() const { return lastSuccessfulUpdate; }
 
     // New method to fetch multiple register values in a single atomic operation
     struct RegisterSnapshot {
@@ -194,23 +301,65 @@ public:
     // Updated method to fetch all system data in a single atomic operation
     SystemSnapshot fetchSystemSnapshot(const std::set<uint16_t>& addresses);
 
-    // Mutex statistics getters
-    unsigned long getMutexWaitingTime() const { return mutexWaitingTime; }
-    unsigned long getMutexHoldingTime() const { return mutexHoldingTime; }
+    // Mutex statistics getters; times are tracked in µs and reported in ms
+    float getMutexWaitingTime() const { return mutexWaitingTime / 1000.0f; }
+    float getMutexHoldingTime() const { return mutexHoldingTime / 1000.0f; }
     unsigned long getMutexAcquisitionAttempts() const { return mutexAcquisitionAttempts; }
     unsigned long getMutexAcquisitionFailures() const { return mutexAcquisitionFailures; }
-    unsigned long getMaxMutexHoldTime() const { return maxMutexHoldTime; }
+    float getMaxMutexHoldTime() const { return maxMutexHoldTime / 1000.0f; }
     float getAverageMutexWaitTime() const { 
         return mutexAcquisitionAttempts > 0 ? 
-            static_cast<float>(mutexWaitingTime) / mutexAcquisitionAttempts : 0.0f; 
+            getMutexWaitingTime() / mutexAcquisitionAttempts : 0.0f; 
     }
     float getAverageMutexHoldTime() const { 
         return mutexAcquisitionAttempts - mutexAcquisitionFailures > 0 ? 
-            static_cast<float>(mutexHoldingTime) / (mutexAcquisitionAttempts - mutexAcquisitionFailures) : 0.0f; 
+            getMutexHoldingTime() / (mutexAcquisitionAttempts - mutexAcquisitionFailures) : 0.0f; 
     }
 
     String getRequestMapStatus();  // Add this line
 
+    // Whole-cache image for secondaries, see CACHE_IMAGE_* above
+    uint32_t getCacheGeneration() const { return cacheGeneration.load(); }
+    bool buildCacheImage(std::vector<uint8_t>& image, uint32_t& generation, bool& operational);
+    bool applyCacheImage(const uint8_t* image, size_t length);
+    bool isBulkSyncActive() const { return bulkSyncActive; }
+    uint32_t getBulkSyncRequests() const { return bulkSyncRequests.load(); }
+    uint32_t getBulkSyncNotModified() const { return bulkSyncNotModified.load(); }
+    uint32_t getBulkSyncErrors() const { return bulkSyncErrors.load(); }
+    uint64_t getInitialSyncTime() const { return initialSyncTime; }
+
+    // Demand-driven polling, see DEMAND_* above
+    void setDemandPolling(bool enabled);
+    bool getDemandPolling() const { return demandPolling.load(); }
+    std::vector<RangeDemandInfo> getRangeDemand();
+    uint16_t getDemandRegisterCount() const { return demandRegisterCount.load(); }
+    uint32_t getDemandRangesAdded() const { return demandRangesAdded.load(); }
+    uint32_t getDemandUncoveredReads() const { return demandUncoveredReads.load(); }
+    uint32_t getDemandRejected() const { return demandRejected.load(); }
+
+    // Phase-aligned prefetch, see PREFETCH_* above
+    static constexpr uint32_t SERVED_AGE_BUCKET_MS[SERVED_AGE_BUCKETS] = {
+        20, 50, 100, 200, 500, 1000, 2000, 5000, 10000
+    };
+    void setPrefetch(bool enabled) { prefetch = enabled; }
+    bool getPrefetch() const { return prefetch.load(); }
+    uint32_t getPrefetchPolls() const { return prefetchPolls.load(); }
+    ServedAgeSnapshot getServedAge();
+
+    // Coordinated baud-rate switch and boot probe, see CG_BAUD_REGISTER above
+    BaudSwitchState getBaudSwitchState() const { return baudSwitchState.load(); }
+    unsigned long getClientBaudRate() const { return clientBaudRate.load(); }
+    uint32_t getBaudSwitchAttempts() const { return baudSwitchAttempts.load(); }
+    uint32_t getBaudSwitchSuccesses() const { return baudSwitchSuccesses.load(); }
+    uint32_t getBaudSwitchRollbacks() const { return baudSwitchRollbacks.load(); }
+    uint32_t getLastBaudSwitchGapMs() const { return lastBaudSwitchGapMs.load(); }
+    uint32_t getBaudProbeCorrections() const { return baudProbeCorrections.load(); }
+
+    // Listen-only RTU client, see config.getSnifferMode()
+    bool isSnifferActive() const { return snifferActive; }
+    const RtuSniffer& getSniffer() const { return sniffer; }
+    uint32_t getSnifferCommits() const { return snifferCommits.load(); }
+
 private:
     std::vector<ModbusRegister> registers; // All registers
     std::map<uint16_t, uint16_t> register16BitValues; // Values for 16-bit registers
@@ -225,8 +374,47 @@ private:
     bool shouldThrottleRequests(); // Method to check if we should throttle requests
 
     std::map<uint16_t, const ModbusRegister> registerDefinitions;
-
-    void updateWaterMarks(uint16_t address, uint32_t value, bool is32Bit);
+    std::map<uint16_t, uint64_t> registerTimestamps;     // TimeService::micros64() of the last accepted sample
+    std::atomic<uint32_t> cacheGeneration{0};            // Bumped whenever a cached value changes
+    uint64_t initialSyncTime = 0;                        // TimeService::millis64() at which the cache was first complete
+
+    // Bulk image sync from a primary (secondary in TCP client mode)
+    bool bulkSyncActive = false;
+    std::atomic<uint32_t> bulkSyncRequests{0};
+    std::atomic<uint32_t> bulkSyncNotModified{0};
+    std::atomic<uint32_t> bulkSyncErrors{0};
+    static void bulkSyncTask(void* param);
+
+    // Baud-rate switch and probe, run on their own task so the web handler returns at once
+    std::atomic<bool> busPaused{false};                  // update() queues nothing on the RTU client while set
+    std::atomic<BaudSwitchState> baudSwitchState{BaudSwitchState::IDLE};
+    std::atomic<uint16_t> pendingBaudCode{0};            // Register value waiting for the baud task, 0 if none
+    std::atomic<unsigned long> clientBaudRate{0};
+    std::atomic<uint32_t> baudSwitchAttempts{0};
+    std::atomic<uint32_t> baudSwitchSuccesses{0};
+    std::atomic<uint32_t> baudSwitchRollbacks{0};
+    std::atomic<uint32_t> lastBaudSwitchGapMs{0};
+    std::atomic<uint32_t> baudProbeCorrections{0};
+    TaskHandle_t baudTaskHandle = nullptr;
+    static void baudTask(void* param);
+    bool drainBus();
+    void reopenClient(unsigned long baudRate);
+    Error readMeterRegister(uint16_t address, uint16_t& value);
+    bool meterAnswers(uint32_t deadlineMs);
+    unsigned long probeBaudRate();
+    void runBaudSwitch(uint16_t baudCode);
+
+    // Passive decoding of another master's traffic instead of polling
+    bool snifferActive = false;
+    RtuSniffer sniffer;
+    std::atomic<uint32_t> snifferCommits{0};             // Sniffed FC3/FC4 responses committed to the cache
+    uint32_t snifferFirstRead = 0;                       // Start address and quantity of the first committed read
+    bool snifferCycleSeen = false;                       // The master has repeated its first read, so its whole poll cycle is cached
+    static void snifferTask(void* param);
+    void handleSniffedTransaction(const SniffedTransaction& transaction);
+
+    void updateWaterMarks(uint16_t address, uint32_t value);
+    void updateWaterMarks(uint16_t address, uint32_t value, const RegisterCodecOps& codec);
     bool isStaticRegister(uint16_t registerNumber) {
         // Check if the register number is in the staticRegisterAddresses set
         return staticRegisterAddresses.find(registerNumber) != staticRegisterAddresses.end();
@@ -238,13 +426,11 @@ private:
     }
 
     bool is32BitRegisterType(const ModbusRegister& reg) {
-        // Check if the register type is UINT32, INT32, or FLOAT
-        return reg.type == RegisterType::UINT32 || reg.type == RegisterType::INT32 || reg.type == RegisterType::FLOAT;
+        return registerCodec(reg.type).words == 2;
     }
     bool is32BitRegister(uint16_t address) {
         auto it = registerDefinitions.find(address);
         if (it != registerDefinitions.end()) {
-            // Check if the register type is either UINT32 or INT32
             return is32BitRegisterType(it->second);
         }
         return false; // Address not found or not a 32-bit register
@@ -253,23 +439,20 @@ private:
     bool is16BitRegister(uint16_t address) {
         auto it = registerDefinitions.find(address);
         if (it != registerDefinitions.end()) {
-            // Check if the register type is either UINT16 or INT16
-            return it->second.type == RegisterType::UINT16 || it->second.type == RegisterType::INT16;
+            return registerCodec(it->second.type).words == 1;
         }
         return false; // Address not found or not a 16-bit register
     }
 
-    // This next function take two RegisterType arguments (source, and destination), and a 32-bit value
-    // It returns a pair of 16-bit values in the correct order for modbus (low word first, high word second)
-
-    Uint16Pair convertValue(const ModbusRegister& source, const ModbusRegister& destination, uint32_t value);
+    // Converts a raw source value to the destination's raw encoding, applying the
+    // source's scaling and the destination's transform
+    uint32_t convertValue(const ModbusRegister& source, const ModbusRegister& destination, uint32_t value);
     uint16_t read16BitRegister(uint16_t address);
     uint32_t read32BitRegister(uint16_t address);
     void initializeRegisters(const std::vector<ModbusRegister>& dynamicRegisters, 
                                       const std::vector<ModbusRegister>& staticRegisters);
     void write16BitRegister(uint16_t address, uint16_t value);
     void write32BitRegister(uint16_t address, uint32_t value);
-    Uint16Pair split32BitRegister(uint32_t value);
     String serverIPString;
     IPAddress currentIPAddress;
     unsigned long lastPollStart = 0;  // Time of the last poll start
@@ -279,6 +462,9 @@ private:
     ModbusServerRTU modbusRTUServer;
     ModbusServerRTU modbusRTUEmulator;
     ModbusServerTCPasync MBserver;
+    RtuOverTcpServer rtuTcpServer;
+    ModbusSocketServer socketServer; // Replaces MBserver when config.getTcpSocketServer() is set
+    void startSocketServer();
     ModbusClientRTU* modbusRTUClient;
     ModbusClientTCPasync* modbusTCPClient;
     void fetchFromRemote(const std::set<uint16_t>& regAddresses);
@@ -286,13 +472,15 @@ private:
     static ModbusCache* instance;
     WiFiClient wifiClient;
     static void handleData(ModbusMessage response, uint32_t token);
-    void processResponsePayload(ModbusMessage& response, uint16_t startAddress, uint16_t regCount);
+    bool processResponsePayload(ModbusMessage& response, uint16_t startAddress, uint16_t regCount,
+                                const RegisterRange* range = nullptr);
+    void buildDecodePlan(RegisterRange& range);
     static void handleError(Error error, uint32_t token);// Static instance pointer
     void purgeToken(uint32_t token, bool mutexAlreadyHeld = false);
     void purgeAgedTokens(); // New method to purge aged tokens periodically
-    std::map<uint32_t, std::tuple<uint16_t, uint16_t, unsigned long>> requestMap; // Map to store token -> (startAddress, regCount, timestamp)
+    std::map<uint32_t, std::tuple<uint16_t, uint16_t, uint64_t>> requestMap; // Map to store token -> (startAddress, regCount, sent time in µs)
     std::vector<uint32_t> insertionOrder; // Vector to store the order in which requests were made
-    unsigned long lastSuccessfulUpdate = 0; // Initialize to 0, will be set to current time in begin()
+    uint64_t lastSuccessfulUpdate = 0; // TimeService::millis64(), set to the current time in begin()
     std::atomic<bool> isOperational;
     void updateServerStatus();
     std::unordered_set<uint16_t> fetchedStaticRegisters;
@@ -302,18 +490,18 @@ private:
     SemaphoreHandle_t mutex;
     
     // Mutex statistics for debugging
-    unsigned long mutexWaitingTime = 0;   // Total time spent waiting for mutex
-    unsigned long mutexHoldingTime = 0;   // Total time the mutex was held 
+    uint64_t mutexWaitingTime = 0;        // Total time spent waiting for mutex (µs)
+    uint64_t mutexHoldingTime = 0;        // Total time the mutex was held (µs)
     unsigned long mutexAcquisitionAttempts = 0; // Number of attempts to acquire mutex
     unsigned long mutexAcquisitionFailures = 0; // Number of failures to acquire mutex
-    unsigned long maxMutexHoldTime = 0;   // Maximum time the mutex was held
+    uint32_t maxMutexHoldTime = 0;        // Maximum time the mutex was held (µs)
 
-    std::deque<unsigned long> latencies; // Sliding window to store recent latencies
+    std::deque<uint32_t> latencies;      // Sliding window to store recent latencies (µs)
     size_t maxLatencySamples = 100;     // Maximum number of latency samples to track
-    unsigned long minLatency = ULONG_MAX; // Initialize to max value so first real value will be smaller
-    unsigned long maxLatency = 0;         // Initialize to 0 so first real value will be larger
-    float averageLatency = 0.0f;         // Average latency (as a float for efficiency)
-    float sumLatencySquared = 0.0f;      // Sum of squared latencies (for variance and std dev)
+    uint32_t minLatency = UINT32_MAX;    // Initialize to max value so first real value will be smaller
+    uint32_t maxLatency = 0;             // Initialize to 0 so first real value will be larger
+    double averageLatency = 0.0;         // Average latency in µs
+    double sumLatencySquared = 0.0;      // Sum of squared latencies (for variance and std dev); µs² overflows float precision
 
     // Message tracking for log collapsing
     String lastLogMessage;
@@ -346,6 +534,27 @@ private:
     std::vector<RegisterRange> registerRanges;  // Stores the ranges of adjacent registers
     void initializeRegisterRanges();  // Creates the initial ranges from register definitions
     void processRegisterRange(RegisterRange& range);  // Process a single range
+
+    // Demand-driven polling state; ranges and pendingDemand are guarded by the cache mutex
+    std::atomic<bool> demandPolling{false};
+    unsigned long demandStartTime = 0;        // Ranges never read count as hot until DEMAND_COLD_MS after this
+    std::vector<std::pair<uint16_t, uint16_t>> pendingDemand;  // Uncovered client reads (start, count)
+    DemandRegister demandRegisters[DEMAND_MAX_REGISTERS];
+    std::atomic<uint16_t> demandRegisterCount{0};
+    std::atomic<uint32_t> demandRangesAdded{0};
+    std::atomic<uint32_t> demandUncoveredReads{0};
+    std::atomic<uint32_t> demandRejected{0};
+    void recordClientRead(uint16_t address, uint16_t count);
+    void growDemandRanges();
+    bool readDemandRegister(uint16_t address, uint16_t& value);
+    unsigned long demandPollInterval(const RegisterRange& range, unsigned long now) const;
+
+    // Phase-aligned prefetch state; servedAge is guarded by the cache mutex
+    std::atomic<bool> prefetch{false};
+    std::atomic<uint32_t> prefetchPolls{0};
+    ServedAgeSnapshot servedAge = {};
+    void prefetchRanges(unsigned long now);
+    bool prefetchOwns(const RegisterRange& range, unsigned long now) const;
     static const unsigned long RETRY_DELAY_MS = 50;  // Delay between retries
 };
 
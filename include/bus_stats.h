@@ -0,0 +1,103 @@
+#ifndef BUS_STATS_H
+#define BUS_STATS_H
+
+#include <Arduino.h>
+#include <vector>
+#include <freertos/FreeRTOS.h>
+
+#define BUS_STATS_WINDOW_MS 10000        // Utilisation is reported over this window
+#define BUS_STATS_MAX_RANGES 16          // Per-range airtime slots, extra ranges are only counted in totals
+#define BUS_STATS_TARGET_PERCENT 70      // Utilisation ceiling used for the headroom figures
+#define BUS_STATS_GAP_BUCKETS 10
+#define BUS_STATS_GATEWAY_RANGE 0xFFFF   // Range key for pass-through transactions
+
+// Airtime and occupancy of one polled register range (or the pass-through gateway)
+struct BusRangeStats {
+    uint16_t startAddress;
+    uint16_t regCount;
+    uint32_t transactions;
+    uint64_t airtimeUs;          // Wire time of request and response frames
+    uint64_t busyUs;             // Airtime plus slave turnaround, or the full timeout
+};
+
+struct BusStatsSnapshot {
+    bool enabled;
+    uint32_t charTimeUs;
+    uint32_t transactions;
+    uint32_t timeouts;
+    uint64_t airtimeUs;
+    uint64_t busyUs;
+    uint64_t turnaroundUs;
+    uint32_t maxTurnaroundUs;
+
+    // Last complete BUS_STATS_WINDOW_MS window
+    float busyPercent;
+    float airtimePercent;
+    float headroomPercent;              // BUS_STATS_TARGET_PERCENT minus busyPercent
+    float headroomRegistersPerSecond;   // Extra registers that fit by widening existing reads
+    float headroomSlaves;               // Extra slaves polled like the ET112 that still fit
+
+    // Bus idle time between the end of one transaction and the start of the next
+    uint32_t gapBuckets[BUS_STATS_GAP_BUCKETS + 1];
+    uint64_t gapSumUs;
+    uint32_t gapCount;
+
+    std::vector<BusRangeStats> ranges;
+};
+
+// RS485 bus utilisation model for the upstream RTU client. The client runs one
+// transaction at a time, so a transaction starts when it was queued or when the
+// previous one completed, whichever is later. Frame airtime follows from the
+// frame length and character time; whatever remains of the measured duration
+// is slave turnaround.
+class BusStats {
+public:
+    // Upper bounds of the idle-gap histogram buckets, in ms
+    static constexpr uint16_t GAP_BUCKET_MS[BUS_STATS_GAP_BUCKETS] = {1, 2, 5, 10, 20, 50, 100, 200, 500, 1000};
+
+    BusStats();
+    void begin(unsigned long baudRate, uint8_t bitsPerChar);
+    bool isEnabled() const { return charTimeUs > 0; }
+
+    // Frame sizes include the CRC; a responseBytes of 0 records a timeout
+    void recordTransaction(uint16_t startAddress, uint16_t regCount, size_t requestBytes, size_t responseBytes,
+                           uint64_t queuedUs, uint64_t completedUs);
+
+    // Frame airtime including the 3.5 character inter-frame silence
+    uint32_t frameAirtimeUs(size_t bytes) const { return bytes > 0 ? (bytes * 2 + 7) * charTimeUs / 2 : 0; }
+
+    BusStatsSnapshot getSnapshot();
+
+private:
+    void rollWindow(uint64_t nowUs);
+
+    mutable portMUX_TYPE lock;
+    uint32_t charTimeUs;
+    uint64_t lastCompletedUs;
+
+    uint32_t transactions;
+    uint32_t timeouts;
+    uint64_t airtimeUs;
+    uint64_t busyUs;
+    uint64_t turnaroundUs;
+    uint32_t maxTurnaroundUs;
+    uint32_t gapBuckets[BUS_STATS_GAP_BUCKETS + 1];
+    uint64_t gapSumUs;
+    uint32_t gapCount;
+    BusRangeStats ranges[BUS_STATS_MAX_RANGES];
+    uint8_t rangeCount;
+
+    // Current and last complete utilisation window
+    uint64_t windowStartUs;
+    uint64_t windowBusyUs;
+    uint64_t windowAirtimeUs;
+    uint64_t windowPollBusyUs;
+    float lastBusyPercent;
+    float lastAirtimePercent;
+    float lastPollBusyPercent;
+};
+
+// Global instance
+extern BusStats busStats;
+
+#endif // BUS_STATS_H
@@ -38,6 +38,8 @@
             int16_t _tcpPort;
             int16_t _tcpPort2;
             int16_t _tcpPort3;
+            uint16_t _tcpPort4;
+            bool _tcpSocketServer;
             String _targetIP;
             uint32_t _tcpTimeout;
             unsigned long _modbusBaudRate;
@@ -49,12 +51,27 @@
             unsigned long _serialBaudRate;
             uint32_t _serialConfig;
             bool _clientIsRTU;
+            bool _snifferMode;
             unsigned long _pollingInterval;
             String _hostname;
             String _staticIP;
             String _staticGateway;
             String _staticSubnet;
             bool _useStaticIP;
+            String _eventRules;
+            uint8_t _eventSinkType;
+            String _eventSinkTarget;
+            String _gatewayUnits;
+            uint8_t _gatewayShare;
+            bool _bulkSync;
+            String _ntpServer;
+            String _syslogTarget;
+            uint8_t _syslogTransport;
+            uint32_t _syslogRate;
+            uint16_t _responseBudget;
+            bool _demandPolling;
+            bool _prefetch;
+            bool _ouiOnline;
         public:
             Config();
             void begin(Preferences *prefs);
@@ -64,6 +81,10 @@
             void setTcpPort2(uint16_t value);
             uint16_t getTcpPort3();
             void setTcpPort3(uint16_t value);
+            uint16_t getTcpPort4();
+            void setTcpPort4(uint16_t value);
+            bool getTcpSocketServer() const;
+            void setTcpSocketServer(bool value);
             uint32_t getTcpTimeout();
             void setTcpTimeout(uint32_t value);
             String getTargetIP() const;
@@ -101,6 +122,8 @@
             void setSerialStopBits(uint8_t value);
             bool getClientIsRTU();
             void setClientIsRTU(bool value);
+            bool getSnifferMode() const;
+            void setSnifferMode(bool value);
             unsigned long getPollingInterval();
             void setPollingInterval(unsigned long value);
             String getHostname() const;
@@ -113,6 +136,34 @@
             String getStaticSubnet() const;
             void setUseStaticIP(bool useStatic);
             bool getUseStaticIP() const;
+            String getEventRules() const;
+            void setEventRules(const String& rules);
+            uint8_t getEventSinkType() const;
+            void setEventSinkType(uint8_t value);
+            String getEventSinkTarget() const;
+            void setEventSinkTarget(const String& target);
+            String getGatewayUnits() const;
+            void setGatewayUnits(const String& units);
+            uint8_t getGatewayShare() const;
+            void setGatewayShare(uint8_t value);
+            bool getBulkSync() const;
+            void setBulkSync(bool value);
+            String getNtpServer() const;
+            void setNtpServer(const String& server);
+            String getSyslogTarget() const;
+            void setSyslogTarget(const String& target);
+            uint8_t getSyslogTransport() const;
+            void setSyslogTransport(uint8_t value);
+            uint32_t getSyslogRate() const;
+            void setSyslogRate(uint32_t value);
+            uint16_t getResponseBudget() const;
+            void setResponseBudget(uint16_t value);
+            bool getDemandPolling() const;
+            void setDemandPolling(bool value);
+            bool getPrefetch() const;
+            void setPrefetch(bool value);
+            bool getOuiOnline() const;
+            void setOuiOnline(bool value);
     };
     
     // Forward declaration of DebugRingBuffer
@@ -150,11 +201,11 @@
         return String(data);
     }
     
-    #define logErr(x...) do { debugSerial.print(x); String _msg = String(x); debugBuffer.add(_msg); } while(0);
-    #define logErrln(x...) do { debugSerial.println(x); String _msg = String(x); debugBuffer.add(_msg); } while(0);
+    #define logErr(x...) do { debugSerial.print(x); String _msg = String(x); debugBuffer.add(_msg, 'E'); } while(0);
+    #define logErrln(x...) do { debugSerial.println(x); String _msg = String(x); debugBuffer.add(_msg, 'E'); } while(0);
     #ifdef DEBUG
-    #define dbg(x...) do { debugSerial.print(x); String _msg = String(x); debugBuffer.add(_msg); } while(0);
-    #define dbgln(x...) do { debugSerial.println(x); String _msg = String(x); debugBuffer.add(_msg); } while(0);
+    #define dbg(x...) do { debugSerial.print(x); String _msg = String(x); debugBuffer.add(_msg, 'D'); } while(0);
+    #define dbgln(x...) do { debugSerial.println(x); String _msg = String(x); debugBuffer.add(_msg, 'D'); } while(0);
     #else /* DEBUG */
     #define dbg(x...) ;
     #define dbgln(x...) ;
@@ -4,46 +4,110 @@
 #include <Arduino.h>
 #include <mutex>
 
-// Increased from 8KB to 32KB ring buffer
-// ESP32 has about 520KB of SRAM, so 32KB is a reasonable size (about 6% of available RAM)
-// This will hold approximately 400-800 log messages depending on their size
+// Static DRAM budget of the log ring, about 6% of the ESP32's SRAM. Lines are
+// gathered in an open block and compressed into an arena of sealed blocks as it
+// fills, so the budget holds several times the history of a plain text ring.
 #define DEBUG_BUFFER_SIZE 32768
+#define LOG_BLOCK_SIZE 2048              // Raw bytes per block, also the open block and decode buffer size
+#define LOG_MAX_BLOCKS 128               // Sealed blocks tracked; the arena usually fills first
+#define LOG_HASH_BITS 9                  // Match finder table of the block compressor
+
+// Each stored line is "[<uptime>s] <level> <message>\n", level being one of
+// LOG_LEVEL_MARKERS in increasing severity
+#define LOG_LEVEL_MARKERS "DIWE"
+
+// Server-side /logdata filter, evaluated per line while scanning the ring
+struct LogFilter {
+    char minLevel = 0;   // Lowest level marker to include, 0 for all
+    String category;     // Leading "[Category]" tag of the message, case-insensitive
+    String text;         // Substring anywhere in the line, case-insensitive
+
+    bool isEmpty() const { return minLevel == 0 && category.length() == 0 && text.length() == 0; }
+    bool matches(const char* line, size_t len) const;
+};
+
+// Sealed block in the compressed arena
+struct LogBlock {
+    uint16_t arenaPos;
+    uint16_t storedLen;      // Bytes in the arena
+    uint16_t rawLen;         // Bytes of log text it expands to
+    bool compressed;         // False when compression did not pay off and the text is stored as is
+};
 
 class DebugRingBuffer {
 private:
-    char buffer[DEBUG_BUFFER_SIZE];
-    size_t head = 0;
-    size_t tail = 0;
-    size_t size = 0;
+    static constexpr size_t ARENA_SIZE = DEBUG_BUFFER_SIZE - 2 * LOG_BLOCK_SIZE -
+                                         (sizeof(uint16_t) << LOG_HASH_BITS) - LOG_MAX_BLOCKS * sizeof(LogBlock);
+
+    uint8_t arena[ARENA_SIZE];
+    LogBlock blocks[LOG_MAX_BLOCKS];
+    size_t firstBlock = 0;          // Index of the oldest sealed block
+    size_t blockCount = 0;
+    size_t arenaHead = 0;           // Where the next sealed block goes
+    uint32_t firstBlockSeq = 0;     // Sequence number of the oldest sealed block
+
+    char openBlock[LOG_BLOCK_SIZE];
+    size_t openLen = 0;
+
+    // Decoded copy of one sealed block, kept for sequential readers
+    char decoded[LOG_BLOCK_SIZE];
+    uint32_t decodedSeq = UINT32_MAX;
+    uint16_t hashTable[1 << LOG_HASH_BITS];
+
     std::mutex bufferMutex;
     bool overflow = false;
+    uint64_t written = 0;   // Total bytes ever added; written - retained is the logical offset of the oldest byte
+    uint64_t retained = 0;  // Log text held in sealed blocks and the open block
+    uint32_t storedBytes = 0;
+    uint64_t compressUs = 0;
+    uint32_t compressMaxUs = 0;
+    uint32_t sealedBlocks = 0;
+
+    void append(const char* data, size_t len);
+    void seal();
+    size_t reserveArena(size_t len);
+    void evictOldest();
+    // Contiguous log text from offset to the end of its block, nullptr if not retained
+    const char* segmentAt(uint64_t offset, size_t& available);
 
 public:
     DebugRingBuffer();
     
-    // Add a message to the ring buffer
-    void add(const String& message);
+    // Add a message to the ring buffer with its level marker
+    void add(const String& message, char level = 'D');
     
     // Get all messages currently in the buffer
     String getAll();
     
-    // Get messages since the last position
-    String getNewMessages(size_t& lastPosition);
-    
-    // Get a specific chunk of the buffer
-    String getChunk(size_t startPos, size_t endPos);
-    
+    // Positions are logical offsets of the next byte to read. A position
+    // outside the retained history starts from the oldest line.
     // Get a small chunk of data safely (for AJAX endpoint)
-    String getSafeChunk(size_t startPos, size_t maxChars, size_t& newPosition);
+    String getSafeChunk(uint64_t startPos, size_t maxChars, uint64_t& newPosition);
     
-    // Get current position for tracking updates
-    size_t getCurrentPosition();
+    // Like getSafeChunk, but only returns lines matching the filter. Lines are
+    // scanned in a single pass; scanned reports the bytes examined.
+    String getFilteredChunk(uint64_t startPos, size_t maxChars, const LogFilter& filter,
+                            uint64_t& newPosition, size_t& scanned);
+
+    // Logical stream access for bulk downloads and the log shipper: copies bytes
+    // from cursor up to end, skipping anything already overwritten (added to
+    // *skipped when given), and advances the cursor
+    uint64_t getWrittenBytes();
+    uint64_t getOldestOffset();
+    size_t readFrom(uint64_t& cursor, uint64_t end, uint8_t* dest, size_t maxLen, uint64_t* skipped = nullptr);
     
     // Clear the buffer
     void clear();
     
     // Check if buffer has overflowed since last clear
     bool hasOverflowed();
+
+    // Compression figures for /metrics
+    uint64_t getRetainedBytes();
+    uint32_t getStoredBytes();
+    uint32_t getSealedBlocks();
+    uint64_t getCompressUs();
+    uint32_t getCompressMaxUs();
 };
 
 // Global instance
@@ -0,0 +1,117 @@
+#ifndef EVENT_ENGINE_H
+#define EVENT_ENGINE_H
+
+#include <Arduino.h>
+#include <WiFiClient.h>
+#include <vector>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+
+#include "event_rules.h"
+
+// Maximum number of pending (undelivered) events
+#define EVENT_QUEUE_LENGTH 16
+
+// Time the sink task waits for an event before servicing the MQTT keepalive
+#define EVENT_SINK_IDLE_MS 30000
+#define EVENT_SINK_TIMEOUT_MS 2000
+
+enum class EventSinkType : uint8_t {
+    NONE = 0,
+    WEBHOOK = 1,  // target: http://host[:port]/path
+    MQTT = 2,     // target: host[:port]/topic
+    UDP = 3       // target: host:port
+};
+
+struct ThresholdEvent {
+    uint16_t address;
+    bool raised;                // true when the rule raised, false when it cleared
+    float value;
+    float threshold;
+    uint64_t sampleTime;        // TimeService::millis64() at which the triggering sample was committed
+};
+
+class EventEngine {
+public:
+    EventEngine();
+
+    // Compile the stored rules and start the sink task
+    void begin(const String& rules, uint8_t sinkType, const String& sinkTarget);
+
+    // Rules as parsed by compileEventRules, separated by ';' or newlines, e.g.
+    // "4<-4000:200:5000;0<210:2:1000".
+    // Returns false if any entry was rejected; valid entries are still applied.
+    bool compileRules(const String& spec);
+    void setSink(uint8_t sinkType, const String& target);
+
+    // Evaluate every rule whose register lies in [startAddress, startAddress + regCount).
+    // Called from the Modbus response path with the cache mutex held, so it must not block.
+    template<typename ValueFn>
+    void evaluateRange(uint16_t startAddress, uint16_t regCount, uint64_t sampleTime, ValueFn valueOf) {
+        if (rulesMutex == nullptr || xSemaphoreTake(rulesMutex, 0) != pdTRUE) {
+            return; // Rules are being recompiled, skip this sample
+        }
+        forEachRuleInRange(rules, startAddress, regCount, [&](EventRule& rule) {
+            evaluate(rule, valueOf(rule.address), sampleTime);
+        });
+        xSemaphoreGive(rulesMutex);
+    }
+
+    size_t getRuleCount() const { return ruleCount.load(); }
+    uint32_t getEventsRaised() const { return eventsRaised.load(); }
+    uint32_t getEventsCleared() const { return eventsCleared.load(); }
+    uint32_t getEventsDropped() const { return eventsDropped.load(); }
+    uint32_t getEventsDelivered() const { return eventsDelivered.load(); }
+    uint32_t getDeliveryFailures() const { return deliveryFailures.load(); }
+    uint32_t getQueueDepth() const;
+    unsigned long getLastNotifyLatency() const { return lastNotifyLatency; }
+    unsigned long getMaxNotifyLatency() const { return maxNotifyLatency; }
+    float getAverageNotifyLatency() const {
+        uint32_t delivered = eventsDelivered.load();
+        return delivered > 0 ? static_cast<float>(totalNotifyLatency) / delivered : 0.0f;
+    }
+
+private:
+    void evaluate(EventRule& rule, float value, uint64_t sampleTime);
+    void post(const EventRule& rule, bool raised, float value, uint64_t sampleTime);
+
+    static void sinkTask(void* param);
+    bool deliver(const ThresholdEvent& event);
+    bool deliverWebhook(const String& target, const String& payload);
+    bool deliverUdp(const String& target, const String& payload);
+    bool deliverMqtt(const String& target, const String& payload);
+    bool mqttConnect(const String& host, uint16_t port);
+    void mqttKeepalive();
+
+    std::vector<EventRule> rules;
+    SemaphoreHandle_t rulesMutex;
+    SemaphoreHandle_t sinkMutex;
+    QueueHandle_t eventQueue;
+    TaskHandle_t sinkTaskHandle;
+
+    std::atomic<EventSinkType> sinkType;  // Also read by post() on the Modbus response path
+    String sinkTarget;
+    bool sinkChanged;
+
+    WiFiClient mqttClient;
+    unsigned long mqttLastActivity;
+
+    std::atomic<size_t> ruleCount;
+    std::atomic<uint32_t> eventsRaised;
+    std::atomic<uint32_t> eventsCleared;
+    std::atomic<uint32_t> eventsDropped;
+    std::atomic<uint32_t> eventsDelivered;
+    std::atomic<uint32_t> deliveryFailures;
+
+    // Sample-to-notification latency, only written by the sink task
+    unsigned long lastNotifyLatency;
+    unsigned long maxNotifyLatency;
+    unsigned long long totalNotifyLatency;
+};
+
+// Global instance
+extern EventEngine eventEngine;
+
+#endif // EVENT_ENGINE_H
@@ -0,0 +1,64 @@
+#ifndef EVENT_RULES_H
+#define EVENT_RULES_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include <algorithm>
+
+// Maximum number of compiled rules
+#define MAX_EVENT_RULES 32
+
+enum class RuleComparator : uint8_t {
+    ABOVE,  // '>' raises above threshold, clears below threshold - hysteresis
+    BELOW   // '<' raises below threshold, clears above threshold + hysteresis
+};
+
+// A compiled rule. Rules are stored in a flat array sorted by address so a
+// committed register range only touches the rules that fall inside it.
+struct EventRule {
+    uint16_t address;
+    RuleComparator comparator;
+    float threshold;
+    float hysteresis;
+    uint32_t minDurationMs;
+
+    // Evaluation state
+    bool active;                // Rule has raised and not yet cleared
+    bool pending;               // Condition holds but minimum duration not yet met
+    uint64_t pendingSince;      // Sample time at which the condition started holding
+};
+
+enum class RuleTransition : uint8_t {
+    NONE,
+    RAISED,
+    CLEARED
+};
+
+// Called for every entry compileEventRules skips; limit is true when the entry
+// was valid but MAX_EVENT_RULES had been reached
+using RuleRejectFn = void (*)(const char* entry, bool limit);
+
+// Rule syntax: "<address><'>'|'<'><threshold>[:<hysteresis>[:<minMs>]]",
+// e.g. "4<-4000:200:5000". Leading and trailing blanks are ignored.
+bool parseEventRule(const char* entry, EventRule& rule);
+
+// Compiles rules separated by ';' or newlines into compiled, sorted by address.
+// Returns false if any entry was rejected; valid entries are still compiled.
+bool compileEventRules(const char* spec, std::vector<EventRule>& compiled, RuleRejectFn rejected);
+
+// Feeds one sample to the rule's hysteresis and minimum-duration state
+RuleTransition evaluateEventRule(EventRule& rule, float value, uint64_t sampleTime);
+
+// Calls fn for every rule whose register lies in [startAddress, startAddress + regCount)
+template<typename Fn>
+void forEachRuleInRange(std::vector<EventRule>& rules, uint16_t startAddress, uint16_t regCount, Fn fn) {
+    uint32_t endAddress = static_cast<uint32_t>(startAddress) + regCount;
+    auto it = std::lower_bound(rules.begin(), rules.end(), startAddress,
+        [](const EventRule& rule, uint16_t address) { return rule.address < address; });
+    for (; it != rules.end() && it->address < endAddress; ++it) {
+        fn(*it);
+    }
+}
+
+#endif // EVENT_RULES_H
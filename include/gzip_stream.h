@@ -0,0 +1,64 @@
+#ifndef GZIP_STREAM_H
+#define GZIP_STREAM_H
+
+#include <Arduino.h>
+#include <functional>
+
+#define GZIP_WINDOW_SIZE 2048      // LZ77 history; a power of two up to 32768
+#define GZIP_HASH_BITS 10
+#define GZIP_MIN_MATCH 3
+#define GZIP_MAX_MATCH 258
+#define GZIP_MAX_CHAIN 16          // Candidates checked per position
+#define GZIP_OUT_BUFFER 1024
+
+// Streaming gzip encoder for HTTP chunked responses. Emits a single deflate
+// block with the fixed Huffman code, so no symbol statistics are needed and
+// memory stays at ~11 KB regardless of input size. Input is pulled from the
+// source callback; read() returns 0 once the trailer has been delivered.
+class GzipStream {
+public:
+    // Source copies up to maxLen bytes into dest and returns 0 at end of input
+    typedef std::function<size_t(uint8_t* dest, size_t maxLen)> Source;
+
+    explicit GzipStream(Source source);
+
+    size_t read(uint8_t* out, size_t maxLen);
+
+    uint32_t getInputBytes() const { return inputBytes; }
+    uint32_t getOutputBytes() const { return outputBytes; }
+
+private:
+    void fillWindow();
+    void slideWindow();
+    void compressAvailable();
+    void finish();
+    uint16_t longestMatch(uint16_t position, uint16_t& distance);
+    void insertHash(uint16_t position);
+
+    void putBits(uint32_t value, uint8_t count);
+    void putHuffman(uint16_t code, uint8_t length);
+    void putLiteral(uint8_t literal);
+    void putMatch(uint16_t length, uint16_t distance);
+    void putByte(uint8_t value);
+
+    Source source;
+    uint8_t window[2 * GZIP_WINDOW_SIZE];
+    uint16_t head[1 << GZIP_HASH_BITS];   // Position + 1 of the newest entry per hash, 0 if empty
+    uint16_t prev[GZIP_WINDOW_SIZE];      // Previous position + 1 with the same hash
+    uint16_t position;                    // Next byte to encode
+    uint16_t lookahead;                   // Bytes available from position
+    bool inputDone;
+    bool finished;
+
+    uint8_t out[GZIP_OUT_BUFFER];
+    uint16_t outHead;
+    uint16_t outTail;
+    uint32_t bitBuffer;
+    uint8_t bitCount;
+
+    uint32_t crc;
+    uint32_t inputBytes;
+    uint32_t outputBytes;
+};
+
+#endif // GZIP_STREAM_H
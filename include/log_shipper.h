@@ -0,0 +1,99 @@
+#ifndef LOG_SHIPPER_H
+#define LOG_SHIPPER_H
+
+#include <Arduino.h>
+#include <WiFiClient.h>
+#include <WiFiUdp.h>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+#define SYSLOG_DEFAULT_PORT 514
+#define SYSLOG_DEFAULT_RATE 2048       // Bytes per second, 0 = unlimited
+#define SYSLOG_FACILITY 16             // local0
+#define SYSLOG_APP_NAME "et112-proxy"
+#define SYSLOG_MAX_DATAGRAM 1400       // Stays below a typical path MTU
+#define SYSLOG_MAX_RECORD 480          // Longer log lines are truncated
+#define SYSLOG_FLUSH_MS 1000           // Ship a partial batch after this long
+#define SYSLOG_RECONNECT_MS 5000
+
+enum class SyslogTransport : uint8_t {
+    UDP = 0,    // Records of a batch newline-separated in one datagram
+    TCP = 1     // RFC 6587 octet-counted framing on a persistent connection
+};
+
+// Ships the debug ring to a remote syslog collector as RFC 5424 records.
+// The shipper is just another reader of the ring's logical byte stream, so
+// producers never wait on the network: if the collector is slow or down the
+// ring overwrites unread data and the shipper counts what it missed.
+class LogShipper {
+public:
+    LogShipper();
+
+    // Starts the shipper task; an empty target keeps it idle
+    void begin(const String& target, uint8_t transport, uint32_t rateBytesPerSecond);
+    // target is "host[:port]", safe to call while the task is running
+    void configure(const String& target, uint8_t transport, uint32_t rateBytesPerSecond);
+
+    bool isEnabled() const { return enabled.load(); }
+    uint32_t getRecordsSent() const { return recordsSent.load(); }
+    uint32_t getBatchesSent() const { return batchesSent.load(); }
+    uint32_t getBytesSent() const { return bytesSent.load(); }
+    uint32_t getRecordsDropped() const { return recordsDropped.load(); }
+    uint32_t getBytesOverwritten() const { return bytesOverwritten.load(); }
+    uint32_t getThrottled() const { return throttled.load(); }
+    uint32_t getSendFailures() const { return sendFailures.load(); }
+    uint32_t getBacklogBytes() const { return backlogBytes.load(); }
+
+private:
+    static void shipperTask(void* param);
+    void applySettings();
+    bool transportReady();
+    void consume(const uint8_t* data, size_t length);
+    void processLine();
+    void appendRecord(char level, unsigned long uptimeSeconds, const char* message, size_t length);
+    void flush();
+    void waitForTokens(size_t bytes);
+
+    SemaphoreHandle_t settingsMutex;
+    TaskHandle_t taskHandle;
+    String pendingTarget;
+    uint8_t pendingTransport;
+    uint32_t pendingRate;
+    bool settingsChanged;
+
+    // Shipper task state
+    String host;
+    uint16_t port;
+    SyslogTransport transport;
+    uint32_t rate;
+    WiFiUDP udp;
+    WiFiClient tcp;
+    unsigned long lastConnectAttempt;
+    uint64_t cursor;                   // Logical offset into the debug ring
+    char line[SYSLOG_MAX_RECORD];
+    size_t lineLength;
+    char lastLevel;                    // Continuation lines inherit the previous record's
+    unsigned long lastUptime;
+    char batch[SYSLOG_MAX_DATAGRAM];
+    size_t batchLength;
+    uint16_t batchRecords;
+    unsigned long batchStarted;
+    float tokens;
+    uint64_t lastRefillUs;
+
+    std::atomic<bool> enabled;
+    std::atomic<uint32_t> recordsSent;
+    std::atomic<uint32_t> batchesSent;
+    std::atomic<uint32_t> bytesSent;
+    std::atomic<uint32_t> recordsDropped;
+    std::atomic<uint32_t> bytesOverwritten;
+    std::atomic<uint32_t> throttled;
+    std::atomic<uint32_t> sendFailures;
+    std::atomic<uint32_t> backlogBytes;
+};
+
+// Global instance
+extern LogShipper logShipper;
+
+#endif // LOG_SHIPPER_H
@@ -0,0 +1,119 @@
+#ifndef MODBUS_SOCKET_SERVER_H
+#define MODBUS_SOCKET_SERVER_H
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <functional>
+
+#define MB_SOCKET_MAX_CLIENTS 8          // Connection table size; lwIP has 16 sockets in total
+#define MB_SOCKET_MBAP_SIZE 7            // Transaction ID, protocol ID, length, unit ID
+#define MB_SOCKET_MAX_ADU 260            // MBAP header + 253 byte PDU
+#define MB_SOCKET_PIPELINE_DEPTH 4       // Responses queued per connection before reads stop
+#define MB_SOCKET_POLL_MS 50             // select() timeout, sets the idle timeout resolution
+#define MB_SOCKET_TASK_PRIORITY 3        // Above loop() and the RTU server, below WiFi and lwIP
+#define MB_SOCKET_TASK_CORE 1            // Away from the AsyncTCP task on core 0
+#define MB_SOCKET_MAX_DEFERRED 4         // Requests answered later by complete(), across all connections
+#define MB_SOCKET_DEFERRED_POLL_MS 2     // select() timeout while a deferred answer is outstanding
+#define MB_SOCKET_DEFERRED 0xFFFF        // Handler return value: the answer follows through complete()
+
+// Answers one request. request is the unit ID followed by the PDU; the unit ID
+// and PDU of the response go to response. Returns the response length, 0 for
+// no response, or MB_SOCKET_DEFERRED to answer later by passing ticket to complete().
+using ModbusSocketHandler = std::function<uint16_t(const uint8_t* request, uint16_t length,
+                                                   uint8_t* response, uint16_t capacity,
+                                                   uint32_t ticket)>;
+
+// Modbus TCP server on plain BSD sockets, serviced by one select() loop on its
+// own task instead of the shared AsyncTCP task, so a slow web handler cannot
+// hold up Modbus replies. Connections and their buffers are allocated once in
+// begin(). Requests a client sends back-to-back are answered in order without
+// waiting for the previous response to be read. A handler that has to wait,
+// e.g. for another slave on the bus, defers its answer instead of blocking the
+// loop; deferred answers go out as they complete, matched by transaction ID.
+//
+// Builds on Linux as well, scripts/modbus_bench.cpp runs it with --serve-socket.
+class ModbusSocketServer {
+public:
+    ModbusSocketServer();
+    bool begin(uint16_t port, uint32_t idleTimeoutMs, ModbusSocketHandler handler);
+#ifdef ARDUINO
+    bool start(UBaseType_t priority = MB_SOCKET_TASK_PRIORITY, BaseType_t core = MB_SOCKET_TASK_CORE);
+#endif
+    // One select() round: accept, read, answer and send, waiting at most timeoutMs
+    void poll(uint32_t timeoutMs);
+    // Answers a request the handler deferred; callable from any task, once per ticket
+    void complete(uint32_t ticket, const uint8_t* response, uint16_t length);
+    bool isListening() const { return listenFd >= 0; }
+
+    uint32_t getClients() const { return clients.load(); }
+    uint32_t getAccepted() const { return accepted.load(); }
+    uint32_t getRejected() const { return rejected.load(); }
+    uint32_t getRequests() const { return requests.load(); }
+    uint32_t getPipelined() const { return pipelined.load(); }
+    uint32_t getMaxPipelineDepth() const { return maxPipelineDepth.load(); }
+    uint32_t getProtocolErrors() const { return protocolErrors.load(); }
+    uint32_t getIdleClosed() const { return idleClosed.load(); }
+    uint32_t getDeferred() const { return deferred.load(); }
+    // Deferred answers still owed or waiting to be sent
+    uint32_t getDeferredPending() const;
+
+private:
+    struct Connection {
+        int fd;
+        uint32_t generation;             // Bumped on close, so late answers for a reused slot are dropped
+        uint32_t lastActivityMs;
+        uint16_t rxLength;
+        uint16_t txLength;
+        uint8_t deferredCount;           // Answers still owed; their room in tx is kept free
+        uint8_t rx[MB_SOCKET_MAX_ADU];
+        uint8_t tx[MB_SOCKET_MAX_ADU * MB_SOCKET_PIPELINE_DEPTH];
+    };
+
+    void acceptClient(uint32_t now);
+    void readClient(Connection& connection, uint32_t now);
+    void serviceClient(Connection& connection);
+    bool answerFrames(Connection& connection);
+    void closeClient(Connection& connection);
+    void sendDeferred();
+    bool hasRoom(const Connection& connection) const;
+
+    enum DeferredState : uint8_t { DEFERRED_FREE, DEFERRED_WAITING, DEFERRED_READY };
+
+    // Written by complete() on the completing task, handed over through state
+    struct Deferred {
+        std::atomic<uint8_t> state;
+        uint8_t connection;
+        uint32_t generation;
+        uint8_t header[4];               // Transaction and protocol ID of the request
+        uint16_t length;
+        uint8_t data[MB_SOCKET_MAX_ADU - 6];
+    };
+    static uint32_t nowMs();
+#ifdef ARDUINO
+    static void task(void* param);
+    TaskHandle_t taskHandle = nullptr;
+#endif
+
+    int listenFd;
+    uint32_t idleTimeoutMs;
+    ModbusSocketHandler handler;
+    Connection* connections;
+    Deferred* deferredAnswers;
+    int heldBackStart;
+
+    std::atomic<uint32_t> clients;
+    std::atomic<uint32_t> accepted;
+    std::atomic<uint32_t> rejected;
+    std::atomic<uint32_t> requests;
+    std::atomic<uint32_t> pipelined;
+    std::atomic<uint32_t> maxPipelineDepth;
+    std::atomic<uint32_t> protocolErrors;
+    std::atomic<uint32_t> idleClosed;
+    std::atomic<uint32_t> deferred;
+};
+
+#endif // MODBUS_SOCKET_SERVER_H
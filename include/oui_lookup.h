@@ -0,0 +1,104 @@
+#ifndef OUI_LOOKUP_H
+#define OUI_LOOKUP_H
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <map>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/queue.h>
+
+// OUI table on LittleFS, built by scripts/build_oui_table.py (little-endian):
+//   header     magic "OUI1", version u8, reserved u8, page size u16, count u32,
+//              records offset u32, names offset u32, generated unix time u32
+//   page index first OUI of every page, 3 bytes big-endian each
+//   records    count x (OUI 3 bytes big-endian, name offset 3 bytes), sorted by OUI
+//   names      NUL-terminated vendor names, each stored once
+#define OUI_TABLE_PATH "/oui.bin"
+#define OUI_TABLE_MAGIC 0x3149554FUL      // "OUI1"
+#define OUI_TABLE_VERSION 1
+#define OUI_HEADER_SIZE 24
+#define OUI_RECORD_SIZE 6
+#define OUI_MAX_PAGE_SIZE 64
+#define OUI_MAX_NAME 64
+#define OUI_MAX_PAGES 2048                // Page index RAM is 3 bytes per page
+
+// Online lookups for OUIs missing from the table, run on a worker task
+#define OUI_ONLINE_URL "http://api.maclookup.app/v2/macs/"
+#define OUI_ONLINE_QUEUE 8
+#define OUI_ONLINE_CACHE 50
+#define OUI_ONLINE_RETRY_MS 300000        // A failed online lookup is not retried before this
+
+enum class OuiSource : uint8_t {
+    TABLE,          // Found in the on-flash table
+    ONLINE,         // Found by an earlier online lookup
+    PENDING,        // Queued for an online lookup, ask again later
+    PRIVATE,        // Locally administered address, no vendor exists
+    NOT_FOUND
+};
+
+// BSSID vendor lookup that never touches the network in the caller's path:
+// a binary search over a RAM page index picks one page of the table, which is
+// read and searched in a single file access.
+class OuiLookup {
+public:
+    OuiLookup();
+
+    // Opens the table; online lookups for misses run only when enabled
+    void begin(bool onlineRefresh);
+    void setOnlineRefresh(bool enabled);
+
+    // mac is "AA:BB:CC:DD:EE:FF" or any form with at least six hex digits
+    static bool parseOui(const String& mac, uint32_t& oui);
+    OuiSource lookup(const String& mac, uint32_t& oui, String& vendor);
+    static const char* sourceName(OuiSource source);
+
+    bool hasTable() const { return count > 0; }
+    uint32_t getTableEntries() const { return count; }
+    uint32_t getTableGenerated() const { return generated; }
+    uint32_t getLookups() const { return lookups.load(); }
+    uint32_t getTableHits() const { return tableHits.load(); }
+    uint32_t getOnlineHits() const { return onlineHits.load(); }
+    uint32_t getMisses() const { return misses.load(); }
+    uint32_t getOnlineRequests() const { return onlineRequests.load(); }
+    uint32_t getOnlineFailures() const { return onlineFailures.load(); }
+    uint32_t getLastLookupUs() const { return lastLookupUs.load(); }
+    uint32_t getMaxLookupUs() const { return maxLookupUs.load(); }
+
+private:
+    static void onlineTask(void* param);
+    bool findInTable(uint32_t oui, String& vendor);
+    bool fetchOnline(uint32_t oui, String& vendor);
+
+    SemaphoreHandle_t mutex;        // Table file and online cache
+    QueueHandle_t onlineQueue;
+    TaskHandle_t taskHandle;
+    File table;
+    uint32_t count;
+    uint16_t pageSize;
+    uint32_t pageCount;
+    uint32_t recordsOffset;
+    uint32_t namesOffset;
+    uint32_t generated;
+    uint8_t* pageIndex;
+
+    // Online results; an empty vendor marks a failed or unknown OUI, value second is millis()
+    std::map<uint32_t, std::pair<String, unsigned long>> onlineCache;
+    std::map<uint32_t, unsigned long> pending;
+
+    std::atomic<bool> online;
+    std::atomic<uint32_t> lookups;
+    std::atomic<uint32_t> tableHits;
+    std::atomic<uint32_t> onlineHits;
+    std::atomic<uint32_t> misses;
+    std::atomic<uint32_t> onlineRequests;
+    std::atomic<uint32_t> onlineFailures;
+    std::atomic<uint32_t> lastLookupUs;
+    std::atomic<uint32_t> maxLookupUs;
+};
+
+// Global instance
+extern OuiLookup ouiLookup;
+
+#endif // OUI_LOOKUP_H
@@ -7,6 +7,7 @@
     #include <ModbusClientRTU.h>
     #include <ModbusCache.h>
     #include <Update.h>
+    #include <ArduinoJson.h>
     #include "config.h"
     #include "debug.h"
     #include "debug_buffer.h"
@@ -22,6 +23,10 @@
     void sendLogPage(AsyncResponseStream *response, const String &hostname);
     const String ErrorName(Modbus::Error code);
     const String WiFiQuality(int rssiValue);
+    ModbusCache::SystemSnapshot fetchStatusSnapshot(ModbusCache *modbusCache);
+    void buildStatusJson(ModbusCache *modbusCache, const ModbusCache::SystemSnapshot& systemSnapshot, JsonDocument& doc);
+    void buildConfigJson(Config *config, JsonDocument& doc);
+    bool readVersionJson(String& json);
     
     // External flag to track config portal mode
     extern bool inConfigPortal;
@@ -0,0 +1,52 @@
+#ifndef PDU_CHECKS_H
+#define PDU_CHECKS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define MODBUS_MAX_READ_REGISTERS 125 // FC3/FC4 quantity limit from the Modbus spec
+
+// Results of checkCacheRequest besides the Modbus exception codes
+// (0x01 illegal function, 0x02 illegal data address, 0x03 illegal data value)
+#define CACHE_REQUEST_VALID 0x00
+#define CACHE_REQUEST_DROP 0xFF      // Too short to answer at all
+
+// Validates a request the cache answers (unit ID, FC3/4/6, address, quantity
+// or value) before it touches the cache. A valid read never asks for more
+// than MODBUS_MAX_READ_REGISTERS registers, so its response fits one frame.
+//
+// The checks are kept free of Arduino and eModbus types so the fuzz targets
+// in scripts/fuzz/ can build them on Linux.
+uint8_t checkCacheRequest(const uint8_t* request, size_t length);
+
+// True if an FC3/FC4 response's byte count matches regCount registers and
+// the message holds all of them
+bool registerPayloadComplete(const uint8_t* response, size_t length, uint16_t regCount);
+
+// Lays a read of regCount registers from startAddress over a register map.
+// wordsAt(address) returns the width defined at an address: 1, 2, or 0 if
+// nothing is defined there. visit(address, payloadOffset, words) is called in
+// address order for every register the read holds, where payloadOffset is the
+// byte offset of its first word. Words that cannot be decoded are visited with
+// words = 0: undefined addresses, a first word that is the second half of a
+// 32-bit register (reads from another master may start there), and a 32-bit
+// register cut off by the end of the read. Each word keeps its own offset, so
+// a hole never shifts the registers after it.
+template <typename WordsAt, typename Visit>
+void forEachReadRegister(uint16_t startAddress, uint16_t regCount, WordsAt wordsAt, Visit visit) {
+    for (uint16_t i = 0; i < regCount; ++i) {
+        uint16_t address = static_cast<uint16_t>(startAddress + i);
+        uint8_t words = wordsAt(address);
+        if (i == 0 && address > 0 && wordsAt(static_cast<uint16_t>(address - 1)) == 2) {
+            words = 0;
+        } else if (words == 2 && i + 1 >= regCount) {
+            words = 0;
+        }
+        visit(address, static_cast<uint16_t>(2 * i), words);
+        if (words == 2) {
+            i++;
+        }
+    }
+}
+
+#endif // PDU_CHECKS_H
@@ -0,0 +1,67 @@
+#ifndef PDU_POOL_H
+#define PDU_POOL_H
+
+#include <stdint.h>
+#include <atomic>
+
+#define PDU_BUFFER_SIZE 256          // Largest Modbus RTU frame
+#define PDU_POOL_BUFFERS 8           // Frames built at once: RTU server, TCP connections, cache polls
+
+// One frame buffer taken from the pool. It has a single owner: handing the
+// frame on is a move, and the buffer returns to the pool when its last owner
+// is destroyed or calls release().
+class PduBuffer {
+public:
+    PduBuffer();
+    PduBuffer(PduBuffer&& other) noexcept;
+    PduBuffer& operator=(PduBuffer&& other) noexcept;
+    PduBuffer(const PduBuffer&) = delete;
+    PduBuffer& operator=(const PduBuffer&) = delete;
+    ~PduBuffer() { release(); }
+
+    bool valid() const { return buffer != nullptr; }
+    uint8_t* data() { return buffer; }
+    const uint8_t* data() const { return buffer; }
+    uint16_t size() const { return length; }
+
+    // Append big-endian like ModbusMessage::add; false once the frame is full
+    bool add(uint8_t value);
+    bool add(uint16_t value);
+
+    void release();
+
+private:
+    friend class PduPool;
+
+    uint8_t* buffer;
+    uint16_t length;
+    int8_t slot;                     // Pool slot, -1 for a heap buffer taken when the pool was empty
+};
+
+class PduPool {
+public:
+    PduPool();
+
+    // Never fails: an exhausted pool hands out a heap buffer and counts it
+    PduBuffer acquire();
+
+    uint32_t getAcquired() const { return acquired.load(); }
+    uint32_t getExhausted() const { return exhausted.load(); }
+    uint8_t getInUse() const;
+    uint8_t getMaxInUse() const { return maxInUse.load(); }
+
+private:
+    friend class PduBuffer;
+    void release(int8_t slot);
+
+    alignas(4) uint8_t storage[PDU_POOL_BUFFERS][PDU_BUFFER_SIZE];
+    std::atomic<uint32_t> freeMask;  // Bit n set while slot n is free
+    std::atomic<uint32_t> acquired;
+    std::atomic<uint32_t> exhausted;
+    std::atomic<uint8_t> maxInUse;
+};
+
+// Global instance
+extern PduPool pduPool;
+
+#endif // PDU_POOL_H
@@ -0,0 +1,50 @@
+#ifndef PHASE_TRACKER_H
+#define PHASE_TRACKER_H
+
+#include <stdint.h>
+
+#define PHASE_MIN_PERIOD_MS 100          // Faster arrivals are bursts within one client cycle
+#define PHASE_MAX_PERIOD_MS 60000
+#define PHASE_LOCK_COUNT 4               // On-time arrivals needed before the phase is trusted
+#define PHASE_LOCK_JITTER_MS 20          // Lock needs the smoothed phase error below this ...
+#define PHASE_LOCK_JITTER_PERCENT 10     // ... or below this share of the period, whichever is larger
+#define PHASE_MAX_MISSED 3               // Missed cycles before the estimate starts over
+
+// Second-order phase-locked loop over the arrival times of a periodic client
+// read. Each arrival within a quarter period of the prediction corrects the
+// predicted phase by half the phase error and the period by an eighth of it.
+// Arrivals outside that window count against the lock, and once they are
+// as frequent as on-time ones the estimate starts over.
+//
+// Builds on Linux as well, scripts/phase_sim.cpp drives it with simulated clients.
+class PhaseTracker {
+public:
+    PhaseTracker();
+
+    void reset();
+    void observe(unsigned long nowMs);
+
+    // Locked and the client has not gone quiet
+    bool isLocked(unsigned long nowMs) const;
+    // Predicted time of the next client read at or after nowMs minus half a period
+    unsigned long nextExpected(unsigned long nowMs) const;
+
+    uint32_t getPeriodMs() const { return static_cast<uint32_t>(periodMs); }
+    uint32_t getJitterMs() const { return static_cast<uint32_t>(jitterMs); }
+    uint32_t getOutliers() const { return outliers; }
+
+private:
+    void acquire(unsigned long nowMs);
+
+    uint8_t arrivals;            // 0 and 1 while acquiring, 2 once a period estimate exists
+    uint8_t onTime;              // Consecutive arrivals inside the capture window
+    uint8_t wild;                // Up 2 per arrival outside the capture window, down 1 per consecutive on-time one
+    bool locked;
+    unsigned long lastArrival;
+    unsigned long predicted;     // Expected time of the next arrival
+    float periodMs;
+    float jitterMs;              // Smoothed absolute phase error
+    uint32_t outliers;
+};
+
+#endif // PHASE_TRACKER_H
@@ -0,0 +1,146 @@
+#ifndef REGISTER_CODEC_H
+#define REGISTER_CODEC_H
+
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
+enum class RegisterType {
+    UINT16,
+    INT16,
+    UINT32,
+    INT32,
+    FLOAT,
+    // The plain 32-bit types send the low word first (Carlo Gavazzi order),
+    // these send the high word first (e.g. Eastron meters)
+    UINT32_HIGH_FIRST,
+    INT32_HIGH_FIRST,
+    FLOAT_HIGH_FIRST
+};
+
+enum class WordOrder : uint8_t {
+    LOW_FIRST,
+    HIGH_FIRST
+};
+
+// Encoding of one register type. A raw value is what the cache stores: the
+// value's natural 32-bit pattern (the IEEE 754 bits for floats, the 16-bit
+// pattern zero-extended for 16-bit types), whatever the word order on the wire.
+//
+// Everything but fromFloat is constexpr, so the integer codecs fold at compile
+// time. The float codecs are a deliberate limit: their bit casts go through
+// memcpy, which C++17 does not allow in constant expressions, and the ESP32
+// toolchain (GCC 8) has neither std::bit_cast nor __builtin_bit_cast. Their
+// decode, encode, less and scale only run at run time, where the memcpy
+// compiles to a register move.
+template <typename T, WordOrder Order = WordOrder::LOW_FIRST>
+struct RegisterCodec {
+    static_assert(std::is_same<T, uint16_t>::value || std::is_same<T, int16_t>::value ||
+                  std::is_same<T, uint32_t>::value || std::is_same<T, int32_t>::value ||
+                  std::is_same<T, float>::value, "Unsupported register value type");
+    static_assert(sizeof(T) == 4 || Order == WordOrder::LOW_FIRST, "Word order only applies to 32-bit types");
+
+    static constexpr uint8_t words = sizeof(T) / 2;
+    static constexpr bool isSigned = std::is_signed<T>::value;
+    static constexpr bool isFloat = std::is_floating_point<T>::value;
+    static constexpr WordOrder order = Order;
+
+    static constexpr T decode(uint32_t raw) {
+        if constexpr (isFloat) {
+            T value = 0;
+            memcpy(&value, &raw, sizeof(value));
+            return value;
+        } else {
+            return static_cast<T>(raw);
+        }
+    }
+
+    static constexpr uint32_t encode(T value) {
+        if constexpr (isFloat) {
+            uint32_t raw = 0;
+            memcpy(&raw, &value, sizeof(raw));
+            return raw;
+        } else if constexpr (words == 1) {
+            return static_cast<uint16_t>(value);
+        } else {
+            return static_cast<uint32_t>(value);
+        }
+    }
+
+    // Nearest representable value; integers saturate and NaN becomes 0
+    static uint32_t fromFloat(float value) {
+        if constexpr (isFloat) {
+            return encode(value);
+        } else {
+            if (std::isnan(value)) {
+                return encode(0);
+            }
+            double rounded = std::round(static_cast<double>(value));
+            if (rounded <= static_cast<double>(std::numeric_limits<T>::lowest())) {
+                return encode(std::numeric_limits<T>::lowest());
+            }
+            if (rounded >= static_cast<double>(std::numeric_limits<T>::max())) {
+                return encode(std::numeric_limits<T>::max());
+            }
+            return encode(static_cast<T>(rounded));
+        }
+    }
+
+    // wire points at the value's first register, bytes big-endian within each word
+    static constexpr uint32_t fromWire(const uint8_t* wire) {
+        uint16_t first = static_cast<uint16_t>(wire[0] << 8 | wire[1]);
+        if constexpr (words == 1) {
+            return first;
+        } else {
+            uint16_t second = static_cast<uint16_t>(wire[2] << 8 | wire[3]);
+            return Order == WordOrder::LOW_FIRST ? static_cast<uint32_t>(second) << 16 | first
+                                                 : static_cast<uint32_t>(first) << 16 | second;
+        }
+    }
+
+    // Fills out[0..words) in the order the registers go on the wire
+    static constexpr void toWire(uint32_t raw, uint16_t* out) {
+        if constexpr (words == 1) {
+            out[0] = static_cast<uint16_t>(raw);
+        } else {
+            uint16_t high = static_cast<uint16_t>(raw >> 16);
+            uint16_t low = static_cast<uint16_t>(raw);
+            out[0] = Order == WordOrder::LOW_FIRST ? low : high;
+            out[1] = Order == WordOrder::LOW_FIRST ? high : low;
+        }
+    }
+
+    // Orders raw values by the values they encode
+    static constexpr bool less(uint32_t a, uint32_t b) {
+        return decode(a) < decode(b);
+    }
+
+    static constexpr float scale(uint32_t raw, float factor) {
+        return static_cast<float>(decode(raw)) * factor;
+    }
+};
+
+// Type-erased codec, looked up once per register or range rather than
+// switching on the type for every value
+struct RegisterCodecOps {
+    uint8_t words;
+    bool isSigned;
+    bool isFloat;
+    uint32_t (*fromWire)(const uint8_t* wire);
+    void (*toWire)(uint32_t raw, uint16_t* out);
+    bool (*less)(uint32_t a, uint32_t b);
+    float (*scale)(uint32_t raw, float factor);
+    uint32_t (*fromFloat)(float value);
+};
+
+template <typename Codec>
+constexpr RegisterCodecOps makeCodecOps() {
+    return {Codec::words, Codec::isSigned, Codec::isFloat, &Codec::fromWire, &Codec::toWire,
+            &Codec::less, &Codec::scale, &Codec::fromFloat};
+}
+
+const RegisterCodecOps& registerCodec(RegisterType type);
+
+#endif // REGISTER_CODEC_H
@@ -0,0 +1,91 @@
+#ifndef RTU_FRAME_PARSER_H
+#define RTU_FRAME_PARSER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <algorithm>
+
+// Largest Modbus RTU frame: address + PDU (253) + CRC
+#define RTU_MAX_FRAME 256
+
+// Reassembles RTU frames from a TCP byte stream. TCP has no inter-frame
+// silence, so frame boundaries are derived from the function code and the
+// CRC; on a CRC mismatch the parser slides forward one byte to resync.
+// A byte count that would make the frame longer than RTU_MAX_FRAME can't be
+// a valid request and is resynced over the same way.
+//
+// Builds on Linux as well, scripts/rtu_frame_test.cpp drives it with
+// fragmented streams.
+class RtuFrameParser {
+public:
+    RtuFrameParser() : length(0), resyncing(false) {}
+
+    // Feed received bytes; onFrame(frame, lengthWithoutCrc) is called for every valid frame
+    template<typename FrameFn>
+    void feed(const uint8_t* data, size_t len, FrameFn onFrame) {
+        while (len > 0) {
+            size_t chunk = std::min(len, RTU_MAX_FRAME - length);
+            if (chunk == 0) {
+                // drain() never leaves a full buffer behind, but don't spin if it ever does
+                discard(1, true);
+                continue;
+            }
+            memcpy(buffer + length, data, chunk);
+            length += chunk;
+            data += chunk;
+            len -= chunk;
+            drain(onFrame);
+        }
+    }
+
+    uint32_t getFrames() const { return frames; }
+    uint32_t getCrcErrors() const { return crcErrors; }
+    uint32_t getDiscardedBytes() const { return discardedBytes; }
+
+    // Expected request frame length including CRC, -1 if more bytes are needed, 0 if unframeable
+    static int expectedRequestLength(const uint8_t* frame, size_t len);
+    static bool validCrc(const uint8_t* frame, size_t len);
+
+private:
+    template<typename FrameFn>
+    void drain(FrameFn& onFrame) {
+        while (length >= 4) {
+            int expected = expectedRequestLength(buffer, length);
+            if (expected < 0) return;
+            if (expected == 0 || expected > RTU_MAX_FRAME) {
+                discard(1, true);
+                continue;
+            }
+            if (length < (size_t)expected) return;
+
+            if (validCrc(buffer, expected)) {
+                frames++;
+                resyncing = false;
+                onFrame(buffer, static_cast<size_t>(expected - 2));
+                discard(expected, false);
+            } else {
+                if (!resyncing) crcErrors++;
+                discard(1, true);
+            }
+        }
+    }
+
+    void discard(size_t count, bool garbage) {
+        if (garbage) {
+            discardedBytes += count;
+            resyncing = true;
+        }
+        length -= count;
+        memmove(buffer, buffer + count, length);
+    }
+
+    uint8_t buffer[RTU_MAX_FRAME];
+    size_t length;
+    bool resyncing;
+    uint32_t frames = 0;
+    uint32_t crcErrors = 0;
+    uint32_t discardedBytes = 0;
+};
+
+#endif // RTU_FRAME_PARSER_H
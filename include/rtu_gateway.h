@@ -0,0 +1,120 @@
+#ifndef RTU_GATEWAY_H
+#define RTU_GATEWAY_H
+
+#include <Arduino.h>
+#include <ModbusClientRTU.h>
+#include <vector>
+#include <atomic>
+#include <functional>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+// Pass-through tokens carry this flag so handleData/handleError can route them
+#define GATEWAY_TOKEN_FLAG 0x80000000UL
+
+#define GATEWAY_MAX_PENDING 4          // Requests waiting for or holding the bus
+#define GATEWAY_WAIT_MS 1500           // Longest a request waits in the queue for the bus
+#define GATEWAY_TURNAROUND_MS 30       // Slave processing and line turnaround allowance
+#define GATEWAY_BUDGET_WINDOW_MS 2000  // Bus time budget may accumulate over this window
+#define GATEWAY_STUCK_MS 5000          // Give up on a dispatched request after this long
+
+// Transparent TCP -> RTU pass-through for other slaves sharing the ET112 bus.
+// Requests are queued by the TCP server and dispatched onto the RTU client
+// only when the cache poller leaves enough slack before its next poll and the
+// configured bus-time share has budget left. Nothing waits for the answer: it
+// is handed to the submitter's callback when the slave answers or gives up.
+class RtuGateway {
+public:
+    using DoneFn = std::function<void(const ModbusMessage& response)>;
+
+    RtuGateway();
+    void begin(ModbusClientRTU* client, const String& unitList, uint8_t sharePercent,
+               unsigned long baudRate, uint8_t bitsPerChar);
+    void setBaudRate(unsigned long baudRate, uint8_t bitsPerChar);
+    bool isEnabled() const { return enabled; }
+    const std::vector<uint8_t>& getUnits() const { return units; }
+
+    // Queues a request and returns at once. done is called exactly once, with the
+    // slave's response or a gateway exception: straight away if the request
+    // cannot be queued, otherwise from the RTU client or poll loop task.
+    void submit(const ModbusMessage& request, DoneFn done);
+
+    // Called from the poll loop. busIdle is false while a cache poll is in flight,
+    // slackMs is the time left until the next cache poll is due. Also expires
+    // requests that waited too long, so call it while the bus is paused as well.
+    void schedule(bool busIdle, unsigned long slackMs);
+    bool isDispatched() const { return inFlightToken.load() != 0; }
+
+    static bool isGatewayToken(uint32_t token) { return (token & GATEWAY_TOKEN_FLAG) != 0; }
+    void onData(ModbusMessage response, uint32_t token);
+    void onError(Error error, uint32_t token);
+
+    uint32_t getRequests() const { return requests.load(); }
+    uint32_t getErrors() const { return errors.load(); }
+    uint32_t getRejected() const { return rejected.load(); }
+    uint32_t getTimeouts() const { return timeouts.load(); }
+    uint32_t getQueueDepth();
+    uint8_t getSharePercent() const { return sharePercent; }
+    unsigned long getBusTime() const { return busTime; }
+    unsigned long getMaxQueueTime() const { return maxQueueTime; }
+    unsigned long getMaxLatency() const { return maxLatency; }
+    float getAverageQueueTime() const {
+        uint32_t count = requests.load() + errors.load();
+        return count > 0 ? static_cast<float>(totalQueueTime) / count : 0.0f;
+    }
+    float getAverageLatency() const {
+        uint32_t count = requests.load() + errors.load();
+        return count > 0 ? static_cast<float>(totalLatency) / count : 0.0f;
+    }
+
+private:
+    enum class SlotState : uint8_t { FREE, QUEUED, IN_FLIGHT };
+
+    struct Slot {
+        SlotState state;
+        ModbusMessage request;
+        DoneFn done;
+        uint32_t token;
+        uint32_t sequence;
+        uint64_t enqueuedAt;           // TimeService::micros64()
+        uint64_t dispatchedAt;         // TimeService::micros64()
+    };
+
+    unsigned long estimateTransactionMs(const ModbusMessage& request) const;
+    // sent is false when the request never reached the bus, e.g. the RTU client refused it
+    void fail(Error error, uint32_t token, bool sent);
+    // wireBytes is the response frame length including CRC, 0 if the slave stayed silent.
+    // Only sent requests are booked as bus time.
+    void complete(uint32_t token, const ModbusMessage& response, bool success, bool sent, size_t wireBytes);
+
+    ModbusClientRTU* client;
+    bool enabled;
+    std::vector<uint8_t> units;
+    Slot slots[GATEWAY_MAX_PENDING];
+    SemaphoreHandle_t slotMutex;
+    uint32_t nextSequence;
+    uint32_t nextToken;
+    std::atomic<uint32_t> inFlightToken;
+
+    // Bus-time share accounting, under slotMutex
+    uint8_t sharePercent;
+    float budgetMs;
+    unsigned long lastRefill;
+    unsigned long charTimeUs;
+
+    // Statistics
+    std::atomic<uint32_t> requests;
+    std::atomic<uint32_t> errors;
+    std::atomic<uint32_t> rejected;
+    std::atomic<uint32_t> timeouts;
+    unsigned long busTime;
+    unsigned long totalQueueTime;
+    unsigned long maxQueueTime;
+    unsigned long totalLatency;
+    unsigned long maxLatency;
+};
+
+// Global instance
+extern RtuGateway rtuGateway;
+
+#endif // RTU_GATEWAY_H
@@ -0,0 +1,96 @@
+#ifndef RTU_SNIFFER_H
+#define RTU_SNIFFER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <functional>
+
+#define RTU_SNIFFER_BUFFER 512           // Two maximum-size frames: a request and its response
+#define RTU_SNIFFER_FAST_T35_US 1750     // Fixed T3.5 above 19200 baud, from the Modbus serial line spec
+
+// One request/response pair seen on the bus
+struct SniffedTransaction {
+    uint8_t unit;
+    uint8_t functionCode;            // Request function code, the exception bit is in exception
+    uint16_t startAddress;           // FC1-6 and FC15/16 only
+    uint16_t quantity;
+    bool exception;
+    const uint8_t* response;         // Unit ID onwards, without CRC
+    uint16_t responseLength;
+    uint16_t requestLength;          // Including CRC
+    uint64_t requestUs;              // When the request's bytes were read
+    uint64_t responseUs;
+};
+
+// Decodes request/response pairs from a Modbus RTU line it never writes to.
+// Bytes are fed in as they are read, stamped with their arrival time: a gap
+// of T3.5 or more ends a frame and drops any partial frame before it. Inside
+// a gap, frames are split by their expected length and CRC, so several frames
+// read in one go (or a capture without timing) still decode. A response is
+// only accepted if it matches the outstanding request's unit, function code
+// and length.
+//
+// Builds on Linux as well, scripts/sniff_replay.cpp drives it from a capture.
+class RtuSniffer {
+public:
+    using TransactionFn = std::function<void(const SniffedTransaction& transaction)>;
+
+    RtuSniffer();
+    void begin(unsigned long baudRate, uint8_t bitsPerChar, TransactionFn handler);
+
+    // arrivalUs of 0 disables gap detection for this chunk
+    void feed(const uint8_t* data, size_t len, uint64_t arrivalUs);
+    // Call while nothing arrives, so the last frame before a pause is not held back
+    void idle(uint64_t nowUs);
+
+    uint32_t getT35Us() const { return t35Us; }
+    uint32_t getFrames() const { return frames.load(); }
+    uint32_t getTransactions() const { return transactions.load(); }
+    uint32_t getExceptions() const { return exceptions.load(); }
+    uint32_t getUnanswered() const { return unanswered.load(); }
+    uint32_t getOrphanResponses() const { return orphanResponses.load(); }
+    uint32_t getCrcErrors() const { return crcErrors.load(); }
+    uint32_t getDiscardedBytes() const { return discardedBytes.load(); }
+
+    static uint16_t crc16(const uint8_t* data, size_t len);
+
+private:
+    struct PendingRequest {
+        bool active;
+        uint8_t unit;
+        uint8_t functionCode;
+        uint16_t startAddress;
+        uint16_t quantity;
+        uint16_t length;
+        uint64_t arrivalUs;
+    };
+
+    void decode(bool frameEnded);
+    int requestLength(size_t available) const;
+    int responseLength() const;
+    int orphanResponseLength() const;
+    bool validFrame(int length) const;
+    void acceptRequest(uint16_t length);
+    void acceptResponse(uint16_t length);
+    void discard(size_t count, bool garbage);
+
+    uint8_t buffer[RTU_SNIFFER_BUFFER];
+    size_t length;
+    bool resyncing;
+    uint64_t lastArrivalUs;
+    uint32_t charUs;
+    uint32_t t35Us;
+    PendingRequest pending;
+    TransactionFn handler;
+
+    std::atomic<uint32_t> frames;
+    std::atomic<uint32_t> transactions;
+    std::atomic<uint32_t> exceptions;
+    std::atomic<uint32_t> unanswered;
+    std::atomic<uint32_t> orphanResponses;
+    std::atomic<uint32_t> crcErrors;
+    std::atomic<uint32_t> discardedBytes;
+};
+
+#endif // RTU_SNIFFER_H
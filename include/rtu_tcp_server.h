@@ -0,0 +1,48 @@
+#ifndef RTU_TCP_SERVER_H
+#define RTU_TCP_SERVER_H
+
+#include <Arduino.h>
+#include <AsyncTCP.h>
+#include <ModbusMessage.h>
+#include <ModbusClientRTU.h>
+#include <atomic>
+#include "rtu_frame_parser.h"
+
+#define RTU_TCP_MAX_CLIENTS 8
+
+// Modbus RTU-over-TCP listener (raw RTU frames with CRC, no MBAP header),
+// answering through the same worker as the Modbus TCP server.
+class RtuOverTcpServer {
+public:
+    RtuOverTcpServer();
+    bool begin(uint16_t port, uint8_t serverID, uint32_t idleTimeoutMs, MBSworker worker);
+
+    uint32_t getClients() const { return clients.load(); }
+    uint32_t getFrames() const { return frames.load(); }
+    uint32_t getCrcErrors() const { return crcErrors.load(); }
+    uint32_t getDiscardedBytes() const { return discardedBytes.load(); }
+
+private:
+    struct Connection {
+        RtuOverTcpServer* server;
+        AsyncClient* client;
+        RtuFrameParser parser;
+    };
+
+    static void onClient(void* arg, AsyncClient* client);
+    static void onData(void* arg, AsyncClient* client, void* data, size_t len);
+    static void onDisconnect(void* arg, AsyncClient* client);
+    void handleFrame(Connection* connection, const uint8_t* frame, size_t len);
+
+    AsyncServer* server;
+    uint8_t serverID;
+    uint32_t idleTimeoutMs;
+    MBSworker worker;
+
+    std::atomic<uint32_t> clients;
+    std::atomic<uint32_t> frames;
+    std::atomic<uint32_t> crcErrors;
+    std::atomic<uint32_t> discardedBytes;
+};
+
+#endif // RTU_TCP_SERVER_H
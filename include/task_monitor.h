@@ -0,0 +1,77 @@
+#ifndef TASK_MONITOR_H
+#define TASK_MONITOR_H
+
+#include <Arduino.h>
+#include <vector>
+#include <functional>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+
+#define TASK_MONITOR_INTERVAL_MS 5000
+#define TASK_MONITOR_MAX_TASKS 32
+#define TASK_MONITOR_HISTORY 60       // Samples kept for the idle/CPU history (5 minutes)
+#define TASK_MONITOR_CORES 2
+
+// Per-task CPU time needs FreeRTOS run-time stats; stack high-water marks and
+// queue depths are available with the trace facility alone.
+#if defined(configUSE_TRACE_FACILITY) && configUSE_TRACE_FACILITY && \
+    defined(configGENERATE_RUN_TIME_STATS) && configGENERATE_RUN_TIME_STATS
+#define TASK_MONITOR_HAS_RUNTIME 1
+#else
+#define TASK_MONITOR_HAS_RUNTIME 0
+#endif
+
+struct TaskSample {
+    String name;
+    uint8_t priority;
+    int8_t core;                 // -1 when not pinned
+    uint32_t stackHighWater;     // Minimum free stack seen so far, in bytes
+    float cpuPercent;            // Share of one core over the last interval, -1 if unavailable
+    float peakCpuPercent;
+    uint32_t runTime;            // Raw run-time counter, used for the next delta
+};
+
+struct QueueSample {
+    String name;
+    uint32_t depth;
+    uint32_t peak;
+};
+
+// Periodically samples FreeRTOS task state and registered queue depths on a
+// low-priority task, so /metrics and /debug/tasks only copy the last snapshot.
+class TaskMonitor {
+public:
+    TaskMonitor();
+    void begin();
+
+    // Register a queue whose depth should be sampled alongside the tasks
+    void addQueue(const String& name, std::function<uint32_t()> depthFn);
+
+    bool hasRuntimeStats() const { return TASK_MONITOR_HAS_RUNTIME; }
+    std::vector<TaskSample> getTasks();
+    std::vector<QueueSample> getQueues();
+    float getIdlePercent(uint8_t core);
+    std::vector<float> getIdleHistory(uint8_t core);
+    uint32_t getSamples() const { return samples; }
+
+private:
+    static void samplerTask(void* param);
+    void sample();
+
+    SemaphoreHandle_t mutex;
+    std::vector<TaskSample> tasks;
+    std::vector<QueueSample> queues;
+    std::vector<std::function<uint32_t()>> queueDepthFns;
+    uint32_t lastTotalRunTime;
+    float idlePercent[TASK_MONITOR_CORES];
+    float idleHistory[TASK_MONITOR_CORES][TASK_MONITOR_HISTORY];
+    uint16_t historyHead;
+    uint16_t historyCount;
+    uint32_t samples;
+};
+
+// Global instance
+extern TaskMonitor taskMonitor;
+
+#endif // TASK_MONITOR_H
@@ -0,0 +1,59 @@
+#ifndef TIME_SERVICE_H
+#define TIME_SERVICE_H
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <esp_timer.h>
+#else
+#include <stdint.h>
+#include <mutex>
+// Host builds supply the clock, see scripts/time_wrap_test.cpp
+extern "C" int64_t esp_timer_get_time();
+#endif
+
+#define TIME_SERVICE_DEFAULT_NTP_SERVER "pool.ntp.org"
+
+// Single time base for the firmware. The monotonic clock is the 64-bit
+// microsecond esp_timer counter, which does not wrap for ~290,000 years, so
+// intervals are plain subtractions. SNTP only disciplines the mapping from
+// monotonic time to wall-clock time; it never moves monotonic timestamps.
+class TimeService {
+public:
+    TimeService();
+
+#ifdef ARDUINO
+    // Starts SNTP against the given server, empty keeps wall-clock time unsynced
+    void begin(const String& ntpServer);
+#endif
+
+    static uint64_t micros64() { return static_cast<uint64_t>(esp_timer_get_time()); }
+    static uint64_t millis64() { return micros64() / 1000; }
+
+    // Wall-clock mapping, all return 0 until the first SNTP sync
+    bool isSynced() const;
+    uint64_t toUnixMs(uint64_t monotonicUs) const;
+    uint64_t unixMs() const { return toUnixMs(micros64()); }
+
+    uint32_t getSyncCount() const { return syncCount; }
+    uint64_t getLastSyncUs() const;      // Monotonic time of the last sync, 0 if never
+    int64_t getLastStepUs() const;       // Wall-clock correction applied by the last sync
+
+    // SNTP time sync notification, updates the global instance
+    static void onSync(struct timeval* tv);
+
+private:
+#ifdef ARDUINO
+    mutable portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+#else
+    mutable std::mutex lock;
+#endif
+    int64_t offsetUs;                    // Unix time in µs minus monotonic µs
+    uint64_t lastSyncUs;
+    int64_t lastStepUs;
+    volatile uint32_t syncCount;
+};
+
+// Global instance
+extern TimeService timeService;
+
+#endif // TIME_SERVICE_H
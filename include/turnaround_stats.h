@@ -0,0 +1,77 @@
+#ifndef TURNAROUND_STATS_H
+#define TURNAROUND_STATS_H
+
+#include <Arduino.h>
+#include <ModbusMessage.h>
+#include <freertos/FreeRTOS.h>
+
+#define TURNAROUND_BUCKETS 11
+#define TURNAROUND_DEFAULT_BUDGET_MS 20
+
+// Downstream servers answering from the cache
+enum class ServerKind : uint8_t {
+    RTU = 0,        // modbusRTUServer towards the CerboGX
+    TCP = 1,        // Modbus TCP server, including pass-through units
+    RTU_TCP = 2,    // RTU-over-TCP server
+    EMULATOR = 3,   // Emulated SDM120 on the client serial port
+    COUNT
+};
+
+struct TurnaroundSnapshot {
+    uint32_t answered;
+    uint32_t late;               // Answered, but above the response budget
+    uint32_t dropped;            // Worker returned no response, the master times out
+    uint32_t maxUs;
+    uint64_t sumUs;              // Over answered requests
+    uint32_t buckets[TURNAROUND_BUCKETS + 1];
+};
+
+// Estimated time from the end of a request frame to the start of the
+// response, per server. Neither end is timestamped on the wire: the value is
+// the worker's own run time (mutex waits and response building) plus, for RTU
+// servers, the nominal 3.5 character silence the server waits for before it
+// can tell the request frame has ended. Time eModbus spends before calling
+// the worker and after it returns, e.g. its task being scheduled late or the
+// UART still draining, is not included.
+class TurnaroundStats {
+public:
+    // Upper bounds of the histogram buckets, in µs
+    static constexpr uint32_t BUCKET_US[TURNAROUND_BUCKETS] = {
+        100, 200, 500, 1000, 2000, 5000, 10000, 20000, 50000, 100000, 500000
+    };
+
+    TurnaroundStats();
+
+    void setBudgetMs(uint16_t budgetMs) { budgetUs = budgetMs * 1000UL; }
+    uint32_t getBudgetUs() const { return budgetUs; }
+
+    // RTU servers: baud rate and character format of their serial line
+    void setSerialFormat(ServerKind kind, unsigned long baudRate, uint8_t bitsPerChar);
+
+    // Returns a worker that times the given one and records the outcome
+    MBSworker wrap(ServerKind kind, MBSworker worker);
+    void record(ServerKind kind, uint32_t workerUs, bool answered);
+
+    TurnaroundSnapshot getSnapshot(ServerKind kind);
+    static const char* kindName(ServerKind kind);
+
+private:
+    struct Counters {
+        uint32_t frameGapUs;
+        uint32_t answered;
+        uint32_t late;
+        uint32_t dropped;
+        uint32_t maxUs;
+        uint64_t sumUs;
+        uint32_t buckets[TURNAROUND_BUCKETS + 1];
+    };
+
+    portMUX_TYPE lock;
+    uint32_t budgetUs;
+    Counters counters[static_cast<uint8_t>(ServerKind::COUNT)];
+};
+
+// Global instance
+extern TurnaroundStats turnaroundStats;
+
+#endif // TURNAROUND_STATS_H
@@ -1,6 +1,20 @@
 #ifndef WIFI_UTILS_H
 #define WIFI_UTILS_H
 
+#include <Arduino.h>
+#include <IPAddress.h>
+#include <Preferences.h>
+
+#define WIFI_FAST_CONNECT_TIMEOUT_MS 4000 // Directed connect budget before falling back to a scan
+
+#define WIFI_RSSI_THRESHOLD -80         // RSSI below which the roaming agent looks for a better AP (dBm)
+#define WIFI_CHECK_INTERVAL 300000      // Minimum time between roaming scans
+#define WIFI_ROAM_RSSI_CHECK_MS 10000   // How often the current RSSI is checked
+#define WIFI_ROAM_HYSTERESIS_DB 8       // A candidate must beat the current AP by this much
+#define WIFI_ROAM_CHANNEL_DWELL_MS 120  // Active scan time per channel, short enough to stay associated
+#define WIFI_ROAM_MAX_CHANNEL 13
+#define WIFI_ROAM_TIMEOUT_MS 10000      // Give up waiting for an IP after switching
+
 /**
  * Attempts to reset the WiFi connection by disconnecting and reconnecting
  * to the configured SSID.
@@ -24,4 +38,63 @@ bool isWiFiActuallyDisconnected();
  */
 bool connectToStrongestAP();
 
+/**
+ * Loads the last-good BSSID and channel, from RTC memory if it survived the
+ * reset, otherwise from NVS.
+ */
+void wifiFastConnectBegin(Preferences* prefs);
+
+/**
+ * Starts a directed connect to the cached BSSID and channel without waiting.
+ *
+ * @return true if a connect was started, false if there is no usable cache
+ */
+bool wifiBeginFastConnect();
+
+/**
+ * Connects directly to the cached BSSID on the cached channel using the
+ * stored credentials, skipping the scan. Applies the configured static IP.
+ *
+ * @return true if connected within timeoutMs, false if the caller should scan
+ */
+bool wifiFastConnect(unsigned long timeoutMs = WIFI_FAST_CONNECT_TIMEOUT_MS);
+
+/**
+ * Parses the static IP settings from Config.
+ *
+ * @return true if static IP is enabled and all addresses are valid
+ */
+bool wifiGetStaticIPConfig(IPAddress& ip, IPAddress& gateway, IPAddress& subnet);
+
+/**
+ * Connection timing hooks for the WiFi event handler: call when a
+ * (re)connect starts and when an IP has been obtained. The latter also
+ * remembers the current BSSID and channel for the next fast connect.
+ */
+void wifiConnectStarted();
+void wifiGotIP();
+
+/**
+ * Background roaming agent, called from loop() while connected. When RSSI
+ * drops below WIFI_RSSI_THRESHOLD it scans one channel at a time without
+ * leaving the current AP and switches BSSID only if the best candidate is
+ * WIFI_ROAM_HYSTERESIS_DB stronger.
+ */
+void wifiRoamingLoop();
+
+/**
+ * @return true while a roam is switching APs, so recovery logic should wait
+ */
+bool wifiIsRoaming();
+
+uint32_t wifiGetRoamScans();
+uint32_t wifiGetRoamCount();
+unsigned long wifiGetLastRoamInterruption();
+unsigned long wifiGetMaxRoamInterruption();
+
+unsigned long wifiGetBootTimeToIP();
+unsigned long wifiGetLastTimeToIP();
+uint32_t wifiGetFastConnectAttempts();
+uint32_t wifiGetFastConnectSuccesses();
+
 #endif // WIFI_UTILS_H 
\ No newline at end of file
@@ -0,0 +1,118 @@
+#!/usr/bin/env python3
+"""
+OUI Vendor Table Builder
+
+Converts the IEEE MA-L registry (oui.csv) into the compact table the firmware
+reads from LittleFS for /lookup. Vendor names are normalised (corporate
+suffixes dropped, whitespace collapsed, length capped) and stored once, so
+the table is a fraction of the CSV size. Records are grouped into pages whose
+first OUIs form the index the device keeps in RAM; see OUI_* in
+include/oui_lookup.h for the layout.
+
+Usage:
+    python3 scripts/build_oui_table.py [--csv oui.csv] [--output data/oui.bin]
+
+Without --csv the registry is downloaded from the IEEE. Upload the result with
+the rest of the filesystem image (pio run -t uploadfs).
+"""
+
+import argparse
+import csv
+import io
+import re
+import struct
+import sys
+import time
+import urllib.request
+
+IEEE_URL = "https://standards-oui.ieee.org/oui/oui.csv"
+MAGIC = b"OUI1"
+VERSION = 1
+HEADER_FORMAT = "<4sBBHIIII"    # 24 bytes
+MAX_PAGE_SIZE = 64               # OUI_MAX_PAGE_SIZE
+MAX_PAGES = 2048                 # OUI_MAX_PAGES
+MAX_NAME = 64                    # OUI_MAX_NAME
+
+SUFFIXES = re.compile(
+    r"[\s,.]+(inc|incorporated|corp|corporation|co|company|ltd|limited|llc|l\.l\.c|gmbh|ag|sa|s\.a|"
+    r"bv|b\.v|oy|ab|as|a/s|spa|s\.p\.a|srl|s\.r\.l|pty|plc|kg|co\.,? ?ltd)\.?$",
+    re.IGNORECASE,
+)
+
+
+def normalise(name, max_length):
+    name = " ".join(name.split())
+    # Repeatedly, so "Foo Co., Ltd." loses both parts
+    while True:
+        shorter = SUFFIXES.sub("", name).rstrip(" ,.")
+        if shorter == name or not shorter:
+            break
+        name = shorter
+    return name[:max_length].rstrip()
+
+
+def read_registry(path):
+    if path:
+        with open(path, newline="", encoding="utf-8", errors="replace") as f:
+            return f.read()
+    print(f"Downloading {IEEE_URL}")
+    request = urllib.request.Request(IEEE_URL, headers={"User-Agent": "build_oui_table.py"})
+    with urllib.request.urlopen(request, timeout=60) as response:
+        return response.read().decode("utf-8", "replace")
+
+
+def build(text, page_size, max_length):
+    vendors = {}
+    for row in csv.DictReader(io.StringIO(text)):
+        if row.get("Registry", "MA-L") != "MA-L":
+            continue
+        assignment = row.get("Assignment", "").strip()
+        name = normalise(row.get("Organization Name", ""), max_length)
+        if len(assignment) == 6 and name:
+            vendors[int(assignment, 16)] = name
+
+    ouis = sorted(vendors)
+    page_count = (len(ouis) + page_size - 1) // page_size
+    if page_count > MAX_PAGES:
+        sys.exit(f"{page_count} pages exceed the firmware limit of {MAX_PAGES}, raise --page-size")
+
+    names = bytearray()
+    name_offsets = {}
+    records = bytearray()
+    for oui in ouis:
+        name = vendors[oui]
+        if name not in name_offsets:
+            name_offsets[name] = len(names)
+            names += name.encode("utf-8")[:max_length] + b"\0"
+        records += oui.to_bytes(3, "big") + name_offsets[name].to_bytes(3, "little")
+
+    page_index = b"".join(ouis[i].to_bytes(3, "big") for i in range(0, len(ouis), page_size))
+    records_offset = struct.calcsize(HEADER_FORMAT) + len(page_index)
+    names_offset = records_offset + len(records)
+    header = struct.pack(HEADER_FORMAT, MAGIC, VERSION, 0, page_size, len(ouis),
+                         records_offset, names_offset, int(time.time()))
+    return header + page_index + records + names, len(ouis), len(name_offsets), page_count
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Build the OUI vendor table for LittleFS")
+    parser.add_argument("--csv", help="IEEE oui.csv to read instead of downloading it")
+    parser.add_argument("--output", default="data/oui.bin", help="table to write (default data/oui.bin)")
+    parser.add_argument("--page-size", type=int, default=64, help="records per page (default 64)")
+    parser.add_argument("--max-name", type=int, default=40, help="vendor name length cap (default 40)")
+    args = parser.parse_args()
+    if not 1 <= args.page_size <= MAX_PAGE_SIZE:
+        parser.error(f"--page-size must be between 1 and {MAX_PAGE_SIZE}")
+    if not 1 <= args.max_name <= MAX_NAME:
+        parser.error(f"--max-name must be between 1 and {MAX_NAME}")
+
+    text = read_registry(args.csv)
+    table, entries, unique, pages = build(text, args.page_size, args.max_name)
+    with open(args.output, "wb") as f:
+        f.write(table)
+    print(f"Wrote {args.output}: {entries} OUIs, {unique} vendor names, {pages} pages, "
+          f"{len(table)} bytes ({len(text.encode('utf-8'))} bytes of CSV)")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,330 @@
+// Compares the two decode paths of ModbusCache::processResponsePayload on
+// the ET112 dynamic range: the per-address path (definition, width and
+// sanity lookups for every register) and the decode plan built once per
+// range by buildDecodePlan.
+//
+// ModbusCache itself needs Arduino and FreeRTOS, so both paths are
+// restated here step for step over the same containers (std::map values,
+// timestamps and definitions, unordered_set fetched sets) and the
+// firmware's codec table (src/register_codec.cpp). Keep them in step with
+// ModbusCache.cpp. Logging and the uncontended cache mutex are left out of
+// both.
+//
+// Build (Linux):
+//   g++ -O2 -std=c++17 -Iinclude -o decode_bench scripts/decode_bench.cpp src/register_codec.cpp
+//
+// Examples:
+//   ./decode_bench
+//   ./decode_bench --responses 2000000
+//
+// Both paths decode the same responses into separate caches, which must
+// match at the end. Exits with 1 if they don't.
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "register_codec.h"
+
+enum class Unit { NONE, V, A, W, VA, VAR, PF, HZ, KWH, KVARH };
+
+struct Definition {
+    RegisterType type;
+    float scale;
+    Unit unit;
+};
+
+// src/main.cpp, ET112 dynamic registers
+static const struct { uint16_t address; Definition definition; } et112Dynamic[] = {
+    {0, {RegisterType::INT32, 0.1f, Unit::V}},
+    {2, {RegisterType::INT32, 0.001f, Unit::A}},
+    {4, {RegisterType::INT32, 0.1f, Unit::W}},
+    {6, {RegisterType::INT32, 0.1f, Unit::VA}},
+    {8, {RegisterType::INT32, 0.1f, Unit::VAR}},
+    {10, {RegisterType::INT32, 0.1f, Unit::W}},
+    {12, {RegisterType::INT32, 0.1f, Unit::W}},
+    {14, {RegisterType::INT16, 0.001f, Unit::PF}},
+    {15, {RegisterType::INT16, 0.1f, Unit::HZ}},
+    {16, {RegisterType::INT32, 0.1f, Unit::KWH}},
+    {18, {RegisterType::INT32, 0.1f, Unit::KVARH}},
+    {20, {RegisterType::INT32, 0.1f, Unit::KWH}},
+    {22, {RegisterType::INT32, 0.1f, Unit::KVARH}},
+};
+#define RANGE_START 0
+#define RANGE_COUNT 24
+
+struct DecodeStep {
+    uint16_t address;
+    uint8_t payloadOffset;
+    bool is32Bit;
+    const RegisterCodecOps* codec;
+    const Definition* definition;
+    uint32_t* slot32;
+    uint16_t* slot16;
+    uint64_t* timestamp;
+    std::unordered_set<uint16_t>* fetchedSet;
+};
+
+struct Cache {
+    std::map<uint16_t, Definition> definitions;
+    std::set<uint16_t> dynamicAddresses;
+    std::map<uint16_t, uint16_t> values16;
+    std::map<uint16_t, uint32_t> values32;
+    std::map<uint16_t, uint64_t> timestamps;
+    std::map<uint16_t, uint32_t> highWaterMarks;
+    std::map<uint16_t, uint32_t> lowWaterMarks;
+    std::unordered_set<uint16_t> fetchedStatic;
+    std::unordered_set<uint16_t> fetchedDynamic;
+    std::vector<DecodeStep> plan;
+    uint32_t generation = 0;
+    uint32_t insane = 0;
+
+    Cache() {
+        for (const auto& entry : et112Dynamic) {
+            definitions.emplace(entry.address, entry.definition);
+            dynamicAddresses.insert(entry.address);
+            if (registerCodec(entry.definition.type).words == 2) values32[entry.address] = 0;
+            else values16[entry.address] = 0;
+        }
+    }
+
+    bool is32Bit(uint16_t address) {
+        auto it = definitions.find(address);
+        return it != definitions.end() && registerCodec(it->second.type).words == 2;
+    }
+    bool is16Bit(uint16_t address) {
+        auto it = definitions.find(address);
+        return it != definitions.end() && registerCodec(it->second.type).words == 1;
+    }
+    uint32_t read32(uint16_t address) {
+        if (is32Bit(address)) {
+            auto it = values32.find(address);
+            if (it != values32.end()) return it->second;
+        }
+        return 0;
+    }
+    uint16_t read16(uint16_t address) {
+        if (is16Bit(address)) {
+            auto it = values16.find(address);
+            if (it != values16.end()) return it->second;
+        }
+        return 0;
+    }
+
+    static bool sane(const Definition& definition, uint32_t proposedRaw, uint32_t currentRaw) {
+        const RegisterCodecOps& codec = registerCodec(definition.type);
+        float proposed = codec.scale(proposedRaw, definition.scale);
+        float current = codec.scale(currentRaw, definition.scale);
+        if (current == 0.0f) return true;
+        switch (definition.unit) {
+            case Unit::KWH: case Unit::KVARH: return std::abs(proposed - current) <= 30;
+            case Unit::W: case Unit::VA: case Unit::VAR: return proposed >= -25000 && proposed <= 25000;
+            case Unit::HZ: return proposed >= 40 && proposed <= 65;
+            case Unit::A: return proposed >= -150 && proposed <= 150;
+            case Unit::V: return proposed >= 205 && proposed <= 265;
+            default: return true;
+        }
+    }
+
+    void updateWaterMarks(uint16_t address, uint32_t value, const RegisterCodecOps& codec) {
+        auto high = highWaterMarks.find(address);
+        if (high == highWaterMarks.end()) highWaterMarks[address] = value;
+        else if (codec.less(high->second, value)) high->second = value;
+        auto low = lowWaterMarks.find(address);
+        if (low == lowWaterMarks.end()) lowWaterMarks[address] = value;
+        else if (codec.less(value, low->second)) low->second = value;
+    }
+
+    // ModbusCache::checkNewRegisterValue(address, ...) and setRegisterValue
+    bool setRegisterValue(uint16_t address, uint32_t value, bool wide, uint64_t now) {
+        auto definition = definitions.find(address);
+        if (definition != definitions.end()) {
+            uint32_t current = is32Bit(address) ? read32(address) : read16(address);
+            if (!sane(definition->second, value, current)) {
+                insane++;
+                return false;
+            }
+        }
+        if (wide) {
+            if (!is32Bit(address)) return false;
+            timestamps[address] = now;
+            if (values32[address] != value) {
+                values32[address] = value;
+                updateWaterMarks(address, value, registerCodec(definitions.find(address)->second.type));
+                generation++;
+            }
+        } else {
+            if (!is16Bit(address)) return false;
+            timestamps[address] = now;
+            uint16_t narrow = static_cast<uint16_t>(value);
+            if (values16[address] != narrow) {
+                values16[address] = narrow;
+                updateWaterMarks(address, narrow, registerCodec(definitions.find(address)->second.type));
+                generation++;
+            }
+        }
+        return true;
+    }
+
+    void decodeGeneric(const uint8_t* payload, size_t payloadSize, uint64_t now) {
+        size_t payloadIndex = 0;
+        for (uint16_t i = 0; i < RANGE_COUNT; ++i) {
+            uint16_t address = RANGE_START + i;
+            bool wide = is32Bit(address);
+            bool narrow = !wide && is16Bit(address);
+            if (!wide && !narrow) continue;
+            if (payloadIndex + (wide ? 4 : 2) > payloadSize) break;
+            if (wide) {
+                uint32_t value = registerCodec(definitions.find(address)->second.type).fromWire(payload + payloadIndex);
+                setRegisterValue(address, value, true, now);
+                payloadIndex += 4;
+                i++;
+            } else {
+                uint16_t value = static_cast<uint16_t>(payload[payloadIndex] << 8 | payload[payloadIndex + 1]);
+                setRegisterValue(address, value, false, now);
+                payloadIndex += 2;
+            }
+            if (dynamicAddresses.find(address) != dynamicAddresses.end()) {
+                fetchedDynamic.insert(address);
+            }
+        }
+    }
+
+    void buildPlan() {
+        plan.clear();
+        uint16_t payloadOffset = 0;
+        for (uint16_t i = 0; i < RANGE_COUNT; ++i) {
+            uint16_t address = RANGE_START + i;
+            auto it = definitions.find(address);
+            if (it == definitions.end()) {
+                payloadOffset += 2;
+                continue;
+            }
+            DecodeStep step;
+            step.address = address;
+            step.payloadOffset = static_cast<uint8_t>(payloadOffset);
+            step.codec = &registerCodec(it->second.type);
+            step.is32Bit = step.codec->words == 2;
+            step.definition = &it->second;
+            step.slot32 = step.is32Bit ? &values32[address] : nullptr;
+            step.slot16 = step.is32Bit ? nullptr : &values16[address];
+            step.timestamp = &timestamps[address];
+            step.fetchedSet = &fetchedDynamic;
+            plan.push_back(step);
+            payloadOffset += step.is32Bit ? 4 : 2;
+            if (step.is32Bit) i++;
+        }
+    }
+
+    void decodePlan(const uint8_t* payload, size_t payloadSize, uint64_t now) {
+        for (const DecodeStep& step : plan) {
+            if (step.payloadOffset + (step.is32Bit ? 4u : 2u) > payloadSize) break;
+            uint32_t value = step.codec->fromWire(payload + step.payloadOffset);
+            uint32_t current = step.is32Bit ? *step.slot32 : *step.slot16;
+            if (!sane(*step.definition, value, current)) {
+                insane++;
+                continue;
+            }
+            *step.timestamp = now;
+            if (value != current) {
+                if (step.is32Bit) *step.slot32 = value;
+                else *step.slot16 = static_cast<uint16_t>(value);
+                updateWaterMarks(step.address, value, *step.codec);
+                generation++;
+            }
+            if (step.fetchedSet != nullptr) step.fetchedSet->insert(step.address);
+        }
+    }
+};
+
+// Plausible readings that drift a little between responses, with the odd
+// out-of-range voltage for the sanity filter to reject
+static std::vector<std::vector<uint8_t>> makeResponses(size_t count) {
+    std::mt19937 rng(1);
+    std::vector<std::vector<uint8_t>> responses;
+    for (size_t n = 0; n < count; n++) {
+        // Stays within the 30 unit step the filter allows, also when the responses repeat
+        int32_t energy = 123456 + (n * 7) % 25;
+        std::vector<uint8_t> payload(2 * RANGE_COUNT);
+        auto put32 = [&payload](uint16_t address, int32_t value) {
+            uint16_t words[2];
+            registerCodec(RegisterType::INT32).toWire(static_cast<uint32_t>(value), words);
+            for (int w = 0; w < 2; w++) {
+                payload[2 * (address + w)] = words[w] >> 8;
+                payload[2 * (address + w) + 1] = words[w] & 0xFF;
+            }
+        };
+        auto put16 = [&payload](uint16_t address, int16_t value) {
+            payload[2 * address] = static_cast<uint16_t>(value) >> 8;
+            payload[2 * address + 1] = value & 0xFF;
+        };
+        put32(0, rng() % 50 == 0 ? 1200 : 2300 + rng() % 40);
+        put32(2, 5000 + rng() % 500);
+        put32(4, 11500 + rng() % 1000);
+        put32(6, 11600 + rng() % 1000);
+        put32(8, -(int32_t)(rng() % 800));
+        put32(10, 11000);
+        put32(12, 30000);
+        put16(14, 990 - rng() % 20);
+        put16(15, 499 + rng() % 3);
+        put32(16, energy);
+        put32(18, 4567);
+        put32(20, energy / 2);
+        put32(22, 89);
+        responses.push_back(payload);
+    }
+    return responses;
+}
+
+int main(int argc, char** argv) {
+    long count = 1000000;
+    if (argc == 3 && std::string(argv[1]) == "--responses") {
+        count = atol(argv[2]);
+    } else if (argc != 1) {
+        fprintf(stderr, "usage: %s [--responses N]\n", argv[0]);
+        return 2;
+    }
+
+    auto responses = makeResponses(1024);
+    Cache generic;
+    Cache planned;
+    planned.buildPlan();
+
+    auto time = [&](Cache& cache, bool usePlan) {
+        auto start = std::chrono::steady_clock::now();
+        for (long n = 0; n < count; n++) {
+            const auto& payload = responses[n % responses.size()];
+            if (usePlan) planned.decodePlan(payload.data(), payload.size(), n);
+            else cache.decodeGeneric(payload.data(), payload.size(), n);
+        }
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / count;
+    };
+    double genericNs = time(generic, false);
+    double planNs = time(planned, true);
+
+    if (generic.values16 != planned.values16 || generic.values32 != planned.values32 ||
+        generic.timestamps != planned.timestamps || generic.highWaterMarks != planned.highWaterMarks ||
+        generic.lowWaterMarks != planned.lowWaterMarks || generic.generation != planned.generation ||
+        generic.insane != planned.insane || generic.fetchedDynamic != planned.fetchedDynamic) {
+        fprintf(stderr, "decode paths disagree\n");
+        return 1;
+    }
+
+    printf("{\n");
+    printf("  \"responses\": %ld,\n", count);
+    printf("  \"registers\": %d,\n", RANGE_COUNT);
+    printf("  \"generic_ns\": %.1f,\n", genericNs);
+    printf("  \"plan_ns\": %.1f,\n", planNs);
+    printf("  \"speedup\": %.2f,\n", genericNs / planNs);
+    printf("  \"rejected\": %u\n", planned.insane);
+    printf("}\n");
+    return 0;
+}
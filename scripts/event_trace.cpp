@@ -0,0 +1,183 @@
+// Drives the firmware's threshold rules (src/event_rules.cpp) with sample
+// traces and checks every raise and clear against the expected transitions.
+//
+// Build (Linux):
+//   g++ -O2 -std=c++17 -Iinclude -o event_trace scripts/event_trace.cpp src/event_rules.cpp
+//
+// Examples:
+//   ./event_trace scripts/testdata/event_rules.trace
+//   ./event_trace --synthetic 100000
+//
+// Trace lines:
+//   rules <spec>                     compile the rules, as saved from the config page
+//   reject <entry>                   the entry must not parse
+//   <ms> <address> <value> [expect]  one committed sample; expect is "raised",
+//                                    "cleared" or "-" (default) for no transition
+// Samples go through the same address lookup as EventEngine::evaluateRange.
+//
+// --synthetic N feeds N noisy samples around a threshold to random rules and
+// checks the invariants instead: raise and clear alternate, a raise only
+// comes after minDurationMs of continuous trips, and a clear only once the
+// value is past the hysteresis band.
+//
+// Exits with 1 on the first mismatch.
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "event_rules.h"
+
+static const char* transitionName(RuleTransition transition) {
+    switch (transition) {
+        case RuleTransition::RAISED: return "raised";
+        case RuleTransition::CLEARED: return "cleared";
+        default: return "-";
+    }
+}
+
+static int runTrace(const char* path) {
+    FILE* file = fopen(path, "r");
+    if (file == nullptr) {
+        fprintf(stderr, "cannot open %s\n", path);
+        return 2;
+    }
+
+    std::vector<EventRule> rules;
+    char line[1024];
+    int lineNumber = 0;
+    int samples = 0;
+    int transitions = 0;
+    while (fgets(line, sizeof(line), file) != nullptr) {
+        lineNumber++;
+        line[strcspn(line, "\r\n")] = '\0';
+        const char* text = line + strspn(line, " \t");
+        if (*text == '\0' || *text == '#') continue;
+
+        if (strncmp(text, "rules ", 6) == 0) {
+            if (!compileEventRules(text + 6, rules, nullptr)) {
+                fprintf(stderr, "%s:%d: rules did not compile\n", path, lineNumber);
+                return 1;
+            }
+            continue;
+        }
+        if (strncmp(text, "reject ", 7) == 0) {
+            EventRule rule;
+            if (parseEventRule(text + 7, rule)) {
+                fprintf(stderr, "%s:%d: '%s' parsed\n", path, lineNumber, text + 7);
+                return 1;
+            }
+            continue;
+        }
+
+        unsigned long long ms;
+        unsigned address;
+        float value;
+        char expect[16] = "-";
+        if (sscanf(text, "%llu %u %f %15s", &ms, &address, &value, expect) < 3) {
+            fprintf(stderr, "%s:%d: bad line\n", path, lineNumber);
+            return 2;
+        }
+        std::string seen;
+        forEachRuleInRange(rules, static_cast<uint16_t>(address), 1, [&](EventRule& rule) {
+            RuleTransition transition = evaluateEventRule(rule, value, ms);
+            if (transition != RuleTransition::NONE) {
+                seen += seen.empty() ? "" : ",";
+                seen += transitionName(transition);
+                transitions++;
+            }
+        });
+        if (seen.empty()) seen = "-";
+        if (seen != expect) {
+            fprintf(stderr, "%s:%d: expected %s, got %s\n", path, lineNumber, expect, seen.c_str());
+            return 1;
+        }
+        samples++;
+    }
+    fclose(file);
+    printf("%s: %d samples, %d transitions as expected\n", path, samples, transitions);
+    return 0;
+}
+
+static int runSynthetic(long count) {
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+    std::uniform_int_distribution<int> step(50, 1500);
+
+    EventRule rule;
+    uint64_t ms = 0;
+    uint64_t trippedSince = 0;
+    bool tripping = false;
+    long raised = 0;
+    long cleared = 0;
+    for (long i = 0; i < count; i++) {
+        // A fresh rule every 1000 samples
+        if (i % 1000 == 0) {
+            char spec[64];
+            snprintf(spec, sizeof(spec), "4%c%d:%d:%d", rng() % 2 ? '>' : '<',
+                     static_cast<int>(rng() % 8000) - 4000, static_cast<int>(rng() % 300),
+                     static_cast<int>(rng() % 5000));
+            if (!parseEventRule(spec, rule)) {
+                fprintf(stderr, "synthetic rule %s did not parse\n", spec);
+                return 1;
+            }
+            tripping = false;
+        }
+
+        // Slow swing across the threshold with noise of a few hysteresis widths
+        ms += step(rng);
+        float value = rule.threshold + 600.0f * sinf(i / 40.0f) + 150.0f * noise(rng);
+        bool above = rule.comparator == RuleComparator::ABOVE;
+        bool wasActive = rule.active;
+        bool trips = above ? value > rule.threshold : value < rule.threshold;
+        if (!trips) {
+            tripping = false;
+        } else if (!tripping) {
+            tripping = true;
+            trippedSince = ms;
+        }
+
+        RuleTransition transition = evaluateEventRule(rule, value, ms);
+        if (transition == RuleTransition::RAISED) {
+            raised++;
+            if (wasActive || !trips || ms - trippedSince < rule.minDurationMs) {
+                fprintf(stderr, "sample %ld: early or repeated raise at %.1f\n", i, value);
+                return 1;
+            }
+            tripping = false;
+        } else if (transition == RuleTransition::CLEARED) {
+            cleared++;
+            bool pastBand = above ? value < rule.threshold - rule.hysteresis
+                                  : value > rule.threshold + rule.hysteresis;
+            if (!wasActive || !pastBand) {
+                fprintf(stderr, "sample %ld: clear inside the hysteresis band at %.1f\n", i, value);
+                return 1;
+            }
+        } else if (wasActive != rule.active) {
+            fprintf(stderr, "sample %ld: state changed without a transition\n", i);
+            return 1;
+        } else if (!wasActive && tripping && ms - trippedSince >= rule.minDurationMs) {
+            fprintf(stderr, "sample %ld: missed raise at %.1f\n", i, value);
+            return 1;
+        }
+        if (wasActive) tripping = false;
+    }
+    printf("synthetic: %ld samples, %ld raised, %ld cleared, invariants held\n", count, raised, cleared);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc == 3 && strcmp(argv[1], "--synthetic") == 0) {
+        return runSynthetic(atol(argv[2]));
+    }
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s trace | --synthetic N\n", argv[0]);
+        return 2;
+    }
+    return runTrace(argv[1]);
+}
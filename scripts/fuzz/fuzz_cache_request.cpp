@@ -0,0 +1,39 @@
+// libFuzzer target for the request checks respondFromCache runs before it
+// touches the cache (src/pdu_checks.cpp).
+//
+// Build (Linux, clang):
+//   clang++ -g -O1 -std=c++17 -fsanitize=fuzzer,address,undefined -Iinclude -o fuzz_cache_request scripts/fuzz/fuzz_cache_request.cpp src/pdu_checks.cpp
+//   ./fuzz_cache_request scripts/testdata/fuzz/cache_request
+//
+// Without libFuzzer, link scripts/fuzz/standalone_main.cpp instead of
+// -fsanitize=fuzzer to replay and mutate the seed corpus.
+//
+// The input is the request as respondFromCache gets it: unit ID, function
+// code and data, no CRC. Aborts if a request is let through that the
+// response builder can't answer within one frame.
+
+#include <cstdint>
+#include <cstdlib>
+
+#include "pdu_checks.h"
+
+#define FRAME_MAX 256   // PDU_BUFFER_SIZE, the pool buffer the response is built in
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    uint8_t check = checkCacheRequest(data, size);
+
+    if ((check == CACHE_REQUEST_DROP) != (size < 2)) abort();
+    if (check != CACHE_REQUEST_VALID && check != CACHE_REQUEST_DROP && (check < 0x01 || check > 0x03)) abort();
+    if (check != CACHE_REQUEST_VALID) return 0;
+
+    uint8_t functionCode = data[1];
+    if (size != 6 || (functionCode != 3 && functionCode != 4 && functionCode != 6)) abort();
+    if (functionCode == 6) return 0;
+
+    uint32_t address = (data[2] << 8) | data[3];
+    uint32_t words = (data[4] << 8) | data[5];
+    if (words == 0 || address + words > 0x10000) abort();
+    // Unit ID, function code, byte count and two bytes per register
+    if (3 + 2 * words > FRAME_MAX) abort();
+    return 0;
+}
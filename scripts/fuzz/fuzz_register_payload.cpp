@@ -0,0 +1,37 @@
+// libFuzzer target for the byte count check processResponsePayload runs
+// on FC3/FC4 responses from the meter (src/pdu_checks.cpp).
+//
+// Build (Linux, clang):
+//   clang++ -g -O1 -std=c++17 -fsanitize=fuzzer,address,undefined -Iinclude -o fuzz_register_payload scripts/fuzz/fuzz_register_payload.cpp src/pdu_checks.cpp
+//   ./fuzz_register_payload scripts/testdata/fuzz/register_payload
+//
+// Without libFuzzer, link scripts/fuzz/standalone_main.cpp instead of
+// -fsanitize=fuzzer to replay and mutate the seed corpus.
+//
+// The first two input bytes are the requested register count (big endian),
+// the rest is the response from the unit ID on, without CRC. An accepted
+// response is walked the way processResponsePayload walks it, from an
+// exactly sized copy so AddressSanitizer catches any read past its end.
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "pdu_checks.h"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    if (size < 2) return 0;
+    uint16_t regCount = (data[0] << 8) | data[1];
+    std::vector<uint8_t> response(data + 2, data + size);
+
+    if (!registerPayloadComplete(response.data(), response.size(), regCount)) return 0;
+
+    if (response[2] != 2 * regCount || response.size() < 3u + 2 * regCount) abort();
+    const uint8_t* payload = response.data() + 3;
+    uint32_t sum = 0;
+    for (uint16_t i = 0; i < regCount; i++) {
+        sum += (payload[2 * i] << 8) | payload[2 * i + 1];
+    }
+    return sum == 0xFFFFFFFF;  // Keeps the loop from being optimised out
+}
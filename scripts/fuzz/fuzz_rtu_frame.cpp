@@ -0,0 +1,44 @@
+// libFuzzer target for the RTU-over-TCP frame parser
+// (include/rtu_frame_parser.h).
+//
+// Build (Linux, clang):
+//   clang++ -g -O1 -std=c++17 -fsanitize=fuzzer,address,undefined -Iinclude -o fuzz_rtu_frame scripts/fuzz/fuzz_rtu_frame.cpp src/rtu_frame_parser.cpp
+//   ./fuzz_rtu_frame -timeout=5 scripts/testdata/fuzz/rtu_frame
+//
+// Without libFuzzer, link scripts/fuzz/standalone_main.cpp instead of
+// -fsanitize=fuzzer to replay and mutate the seed corpus.
+//
+// The first input byte picks the TCP segment size (1-256), the rest is the
+// byte stream. Every frame handed out must be complete with a valid CRC,
+// and the parser must account for every byte but the last partial frame.
+// A parser that stops consuming input shows up as a libFuzzer timeout.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+
+#include "rtu_frame_parser.h"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    if (size < 1) return 0;
+    size_t segment = data[0] + 1;
+    data++;
+    size--;
+
+    RtuFrameParser parser;
+    size_t frameBytes = 0;
+    auto onFrame = [&frameBytes](const uint8_t* frame, size_t len) {
+        size_t withCrc = len + 2;
+        if (withCrc > RTU_MAX_FRAME) abort();
+        if (RtuFrameParser::expectedRequestLength(frame, withCrc) != static_cast<int>(withCrc)) abort();
+        if (!RtuFrameParser::validCrc(frame, withCrc)) abort();
+        frameBytes += withCrc;
+    };
+    for (size_t offset = 0; offset < size; offset += segment) {
+        parser.feed(data + offset, std::min(segment, size - offset), onFrame);
+    }
+
+    size_t consumed = frameBytes + parser.getDiscardedBytes();
+    if (consumed > size || size - consumed >= RTU_MAX_FRAME) abort();
+    return 0;
+}
@@ -0,0 +1,136 @@
+// Driver for the fuzz targets in this directory where libFuzzer isn't
+// available (e.g. g++): runs every seed file, then random mutations of the
+// seeds (bit flips, byte runs, truncation, splicing) through the target.
+//
+// Build (Linux), e.g. for the frame parser:
+//   g++ -g -O1 -std=c++17 -fsanitize=address,undefined -Iinclude -o fuzz_rtu_frame scripts/fuzz/fuzz_rtu_frame.cpp scripts/fuzz/standalone_main.cpp src/rtu_frame_parser.cpp
+//
+// Examples:
+//   ./fuzz_rtu_frame scripts/testdata/fuzz/rtu_frame
+//   ./fuzz_rtu_frame --runs 1000000 --seed 7 scripts/testdata/fuzz/rtu_frame
+//
+// A target failure aborts, as under libFuzzer; the input that did it is
+// written to crash-standalone first.
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+using Input = std::vector<uint8_t>;
+
+static bool readFile(const std::string& path, Input& out) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file == nullptr) return false;
+    uint8_t chunk[4096];
+    size_t read;
+    out.clear();
+    while ((read = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        out.insert(out.end(), chunk, chunk + read);
+    }
+    fclose(file);
+    return true;
+}
+
+static void loadSeeds(const std::string& path, std::vector<Input>& seeds) {
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0) {
+        fprintf(stderr, "cannot open %s\n", path.c_str());
+        exit(2);
+    }
+    if (!S_ISDIR(info.st_mode)) {
+        Input input;
+        if (readFile(path, input)) seeds.push_back(input);
+        return;
+    }
+    DIR* dir = opendir(path.c_str());
+    while (struct dirent* entry = readdir(dir)) {
+        if (entry->d_name[0] == '.') continue;
+        loadSeeds(path + "/" + entry->d_name, seeds);
+    }
+    closedir(dir);
+}
+
+static Input current;
+
+static void saveCurrent(int) {
+    FILE* file = fopen("crash-standalone", "wb");
+    if (file != nullptr) {
+        fwrite(current.data(), 1, current.size(), file);
+        fclose(file);
+    }
+}
+
+static void run(const Input& input) {
+    current = input;
+    LLVMFuzzerTestOneInput(current.data(), current.size());
+}
+
+static Input mutate(const std::vector<Input>& seeds, std::mt19937& rng) {
+    Input input = seeds[rng() % seeds.size()];
+    for (int n = 1 + rng() % 4; n > 0; n--) {
+        switch (rng() % 5) {
+            case 0: // Flip a bit
+                if (!input.empty()) input[rng() % input.size()] ^= 1 << (rng() % 8);
+                break;
+            case 1: // Random byte, often a byte count or function code
+                if (!input.empty()) input[rng() % input.size()] = rng();
+                break;
+            case 2: { // Insert a run of random bytes
+                size_t at = input.empty() ? 0 : rng() % (input.size() + 1);
+                Input run(1 + rng() % 300);
+                for (uint8_t& byte : run) byte = rng();
+                input.insert(input.begin() + at, run.begin(), run.end());
+                break;
+            }
+            case 3: // Truncate
+                if (!input.empty()) input.resize(rng() % input.size());
+                break;
+            default: { // Append another seed
+                const Input& other = seeds[rng() % seeds.size()];
+                input.insert(input.end(), other.begin(), other.end());
+                break;
+            }
+        }
+    }
+    return input;
+}
+
+int main(int argc, char** argv) {
+    long runs = 100000;
+    unsigned seed = 1;
+    std::vector<Input> seeds;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if ((arg == "--runs" || arg == "--seed") && i + 1 < argc) {
+            long value = atol(argv[++i]);
+            if (arg == "--runs") runs = value;
+            else seed = static_cast<unsigned>(value);
+        } else {
+            loadSeeds(arg, seeds);
+        }
+    }
+    if (seeds.empty()) {
+        fprintf(stderr, "usage: %s [--runs N] [--seed S] corpus...\n", argv[0]);
+        return 2;
+    }
+
+    signal(SIGABRT, saveCurrent);
+    for (const Input& input : seeds) {
+        run(input);
+    }
+    std::mt19937 rng(seed);
+    for (long i = 0; i < runs; i++) {
+        run(mutate(seeds, rng));
+    }
+    printf("%zu seeds, %ld mutated runs, no failures\n", seeds.size(), runs);
+    return 0;
+}
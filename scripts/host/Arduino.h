@@ -0,0 +1,48 @@
+// Host stand-in for the parts of the Arduino core that the log ring
+// (src/debug_buffer.cpp) uses, so scripts/log_bench.cpp can run it unchanged.
+// Only the String members the ring calls are provided.
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <ctype.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+
+#include <algorithm>
+#include <string>
+
+using std::max;
+using std::min;
+
+inline void yield() {}
+
+class String {
+public:
+    String() {}
+    String(const char* text) : value(text) {}
+    String(const std::string& text) : value(text) {}
+
+    String& operator=(const char* text) { value = text; return *this; }
+    bool reserve(size_t size) { value.reserve(size); return true; }
+    bool concat(const char* text, size_t length) { value.append(text, length); return true; }
+
+    size_t length() const { return value.length(); }
+    const char* c_str() const { return value.c_str(); }
+    bool endsWith(const char* suffix) const {
+        size_t n = strlen(suffix);
+        return value.length() >= n && value.compare(value.length() - n, n, suffix) == 0;
+    }
+    int lastIndexOf(char c) const {
+        size_t pos = value.rfind(c);
+        return pos == std::string::npos ? -1 : static_cast<int>(pos);
+    }
+    void remove(size_t index) { value.erase(std::min(index, value.length())); }
+
+private:
+    std::string value;
+};
+
+#endif // HOST_ARDUINO_H
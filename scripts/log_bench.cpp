@@ -0,0 +1,257 @@
+// Replays a debug log through the firmware's compressed log ring
+// (src/debug_buffer.cpp) and reports how much history the 32 KB budget holds
+// and what add() costs, then reads the retained history back through every
+// reader and checks it against the text that went in.
+//
+// Build (Linux):
+//   g++ -O2 -std=c++17 -Iscripts/host -Iinclude -o log_bench scripts/log_bench.cpp src/debug_buffer.cpp
+//
+// Examples:
+//   ./log_bench --synthetic 3000
+//   ./log_bench device.log
+//
+// Captured logs are the /logdata or gzip download text: "[<uptime>s] <level>
+// <message>" per line. The uptime drives the simulated clock so the ring
+// writes the same prefixes; lines without one are added as level D at the
+// current time.
+//
+// --synthetic N generates N seconds of the steady-state poll loop from the
+// firmware's own dbgln messages: a cache update per second over the ET112's
+// dynamic ranges, request map status every 10 s and occasional web requests.
+//
+// Exits with 1 if any reader returns text that differs from what was added.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "debug_buffer.h"
+
+static int64_t clockUs = 0;
+
+extern "C" int64_t esp_timer_get_time() {
+    return clockUs;
+}
+
+struct LogLine {
+    uint64_t uptimeS;
+    char level;
+    std::string message;
+};
+
+// Splits "[<uptime>s] <level> <message>"; other lines keep the last uptime
+static void parseCaptured(FILE* file, std::vector<LogLine>& lines) {
+    char buffer[8192];
+    uint64_t uptimeS = 0;
+    while (fgets(buffer, sizeof(buffer), file) != nullptr) {
+        buffer[strcspn(buffer, "\r\n")] = '\0';
+        unsigned long long seconds;
+        char level;
+        int consumed = 0;
+        if (sscanf(buffer, "[%llus] %c %n", &seconds, &level, &consumed) == 2 && consumed > 0 &&
+            strchr(LOG_LEVEL_MARKERS, level) != nullptr) {
+            uptimeS = seconds;
+            lines.push_back({uptimeS, level, buffer + consumed});
+        } else {
+            lines.push_back({uptimeS, 'D', buffer});
+        }
+    }
+}
+
+static void generateSynthetic(uint64_t seconds, std::vector<LogLine>& lines) {
+    // ET112 dynamic ranges as configured by default
+    static const uint16_t ranges[][2] = {{0, 34}, {40, 12}, {52, 20}};
+    static const char* pages[] = {"/", "/status", "/config", "/log", "/metrics"};
+    std::mt19937 rng(1);
+    uint32_t token = 1;
+    auto add = [&lines](uint64_t s, char level, const std::string& message) {
+        lines.push_back({s, level, message});
+    };
+
+    for (uint64_t s = 1; s <= seconds; s++) {
+        uint64_t nowMs = s * 1000 + rng() % 40;
+        add(s, 'D', "[update] Updating Modbus Cache");
+        for (int i = 0; i < 3; i++) {
+            add(s, 'D', "[update] Processing dynamic register range " + std::to_string(i) + " of 3");
+            if (rng() % 50 == 0) {
+                add(s, 'D', "[processRegisterRange] Request in flight for " + std::to_string(900 + rng() % 300) +
+                                "ms, skipping");
+                continue;
+            }
+            add(s, 'D', "[processRegisterRange] Sent request for range " + std::to_string(ranges[i][0]) + "-" +
+                            std::to_string(ranges[i][0] + ranges[i][1] - 1) + " with token " +
+                            std::to_string(token) + " at time " + std::to_string(nowMs + i * 60));
+            char responseTime[64];
+            snprintf(responseTime, sizeof(responseTime), "%.2f", 38.0 + (rng() % 2400) / 100.0);
+            add(s, 'D', "[handleData] Response time for token " + std::to_string(token) + ": " + responseTime + " ms");
+            add(s, 'D', "[processResponsePayload] Processing payload...");
+            add(s, 'D', "[processResponsePayload] Done processing payload");
+            token++;
+        }
+        add(s, 'D', "[update] Server status updated");
+        if (s % 10 == 0) {
+            add(s, 'D', "[RequestMap Status] Total: " + std::to_string(rng() % 3) + ", In-Flight: " +
+                            std::to_string(rng() % 2) + ", Age Range: " + std::to_string(rng() % 80) + "ms to " +
+                            std::to_string(80 + rng() % 400) + "ms");
+        }
+        if (rng() % 15 == 0) {
+            add(s, 'I', std::string("[webserver] GET ") + pages[rng() % 5] + " - Free heap: " +
+                            std::to_string(150000 + rng() % 20000) + " bytes");
+        }
+    }
+}
+
+// The text add() stores for the line
+static std::string storedText(const LogLine& line) {
+    char prefix[32];
+    snprintf(prefix, sizeof(prefix), "[%lus] %c ", static_cast<unsigned long>(line.uptimeS), line.level);
+    std::string text = prefix + line.message;
+    if (text.empty() || text.back() != '\n') text += '\n';
+    return text;
+}
+
+static bool expectEqual(const char* reader, const std::string& got, const std::string& expected) {
+    if (got == expected) return true;
+    size_t at = 0;
+    while (at < got.size() && at < expected.size() && got[at] == expected[at]) at++;
+    fprintf(stderr, "%s: %zu bytes differ from the %zu expected, first at byte %zu\n", reader, got.size(),
+            expected.size(), at);
+    return false;
+}
+
+// Reads the retained history back through readFrom, getSafeChunk and
+// getFilteredChunk; expected is the tail of everything added
+static bool checkReaders(DebugRingBuffer& ring, const std::string& all) {
+    uint64_t oldest = ring.getOldestOffset();
+    uint64_t written = ring.getWrittenBytes();
+    if (written != all.size()) {
+        fprintf(stderr, "written %llu, expected %zu\n", (unsigned long long)written, all.size());
+        return false;
+    }
+    std::string expected = all.substr(oldest);
+    bool ok = true;
+
+    std::string got;
+    uint64_t cursor = 0;
+    uint64_t skipped = 0;
+    uint8_t chunk[700];
+    size_t count;
+    while ((count = ring.readFrom(cursor, written, chunk, sizeof(chunk), &skipped)) > 0) {
+        got.append(reinterpret_cast<const char*>(chunk), count);
+    }
+    ok &= expectEqual("readFrom", got, expected);
+    if (skipped != oldest) {
+        fprintf(stderr, "readFrom skipped %llu, expected %llu\n", (unsigned long long)skipped,
+                (unsigned long long)oldest);
+        ok = false;
+    }
+
+    got.clear();
+    uint64_t position = 0;
+    for (;;) {
+        String part = ring.getSafeChunk(position, 1000, position);
+        if (part.length() == 0) break;
+        got.append(part.c_str(), part.length());
+    }
+    ok &= expectEqual("getSafeChunk", got, expected);
+
+    got.clear();
+    position = 0;
+    LogFilter filter;
+    for (;;) {
+        size_t scanned;
+        String part = ring.getFilteredChunk(position, 1000, filter, position, scanned);
+        if (part.length() == 0) break;
+        got.append(part.c_str(), part.length());
+    }
+    ok &= expectEqual("getFilteredChunk", got, expected);
+    return ok;
+}
+
+static double percentile(std::vector<uint32_t>& sorted, double p) {
+    return sorted[static_cast<size_t>(p * (sorted.size() - 1))];
+}
+
+int main(int argc, char** argv) {
+    std::vector<LogLine> lines;
+    if (argc == 3 && strcmp(argv[1], "--synthetic") == 0) {
+        generateSynthetic(strtoull(argv[2], nullptr, 10), lines);
+    } else if (argc == 2 && strncmp(argv[1], "--", 2) != 0) {
+        FILE* file = fopen(argv[1], "r");
+        if (file == nullptr) {
+            fprintf(stderr, "cannot open %s\n", argv[1]);
+            return 2;
+        }
+        parseCaptured(file, lines);
+        fclose(file);
+    } else {
+        fprintf(stderr, "usage: %s log | --synthetic SECONDS\n", argv[0]);
+        return 2;
+    }
+    if (lines.empty()) {
+        fprintf(stderr, "no log lines\n");
+        return 2;
+    }
+
+    // Static in the firmware, too large for the stack
+    static DebugRingBuffer ring;
+    std::string all;
+    std::vector<uint32_t> addNs;
+    addNs.reserve(lines.size());
+    uint64_t totalNs = 0;
+    for (const LogLine& line : lines) {
+        clockUs = static_cast<int64_t>(line.uptimeS * 1000000);
+        String message(line.message);
+        auto start = std::chrono::steady_clock::now();
+        ring.add(message, line.level);
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        uint32_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+        addNs.push_back(ns);
+        totalNs += ns;
+        all += storedText(line);
+    }
+
+    uint64_t retained = ring.getRetainedBytes();
+    uint32_t stored = ring.getStoredBytes();
+    uint64_t spanS = lines.back().uptimeS - lines.front().uptimeS;
+    double bytesPerS = spanS > 0 ? static_cast<double>(all.size()) / spanS : 0;
+    double mean = static_cast<double>(totalNs) / addNs.size();
+    std::sort(addNs.begin(), addNs.end());
+
+    printf("{\n");
+    printf("  \"lines\": %zu,\n", lines.size());
+    printf("  \"text_bytes\": %zu,\n", all.size());
+    printf("  \"text_bytes_per_s\": %.1f,\n", bytesPerS);
+    printf("  \"budget_bytes\": %d,\n", DEBUG_BUFFER_SIZE);
+    printf("  \"retained_bytes\": %llu,\n", (unsigned long long)retained);
+    printf("  \"stored_bytes\": %u,\n", stored);
+    printf("  \"history_multiplier\": %.2f,\n", static_cast<double>(retained) / DEBUG_BUFFER_SIZE);
+    printf("  \"retained_s\": %.1f,\n", bytesPerS > 0 ? retained / bytesPerS : 0);
+    printf("  \"in_block_ratio\": %.2f,\n", stored > 0 ? static_cast<double>(retained) / stored : 0);
+    printf("  \"blocks_sealed\": %u,\n", ring.getSealedBlocks());
+    printf("  \"add_ns_mean\": %.0f,\n", mean);
+    printf("  \"add_ns_p50\": %.0f,\n", percentile(addNs, 0.5));
+    printf("  \"add_ns_p99\": %.0f,\n", percentile(addNs, 0.99));
+    printf("  \"add_ns_max\": %u\n", addNs.back());
+    printf("}\n");
+
+    if (!checkReaders(ring, all)) return 1;
+
+    // A line longer than a block spans blocks and must still come back whole
+    LogLine longLine{lines.back().uptimeS, 'W', std::string(5000, 'x')};
+    for (size_t i = 0; i < longLine.message.size(); i += 97) longLine.message[i] = 'a' + i % 26;
+    ring.add(String(longLine.message), longLine.level);
+    ring.add(String("[update] Server status updated"), 'D');
+    all += storedText(longLine);
+    all += storedText({lines.back().uptimeS, 'D', "[update] Server status updated"});
+    if (!checkReaders(ring, all)) return 1;
+
+    printf("round trips of readFrom, getSafeChunk and getFilteredChunk matched\n");
+    return 0;
+}
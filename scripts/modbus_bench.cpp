@@ -0,0 +1,785 @@
+// Modbus load generator and latency benchmark for the proxy's servers.
+//
+// Drives a mix of FC3/FC4/FC6 requests over N Modbus TCP connections and/or
+// an RTU serial line (real adapter or pty) and prints a JSON report with
+// throughput, latency percentiles, exception codes and served-data
+// staleness, so runs can be compared between firmware versions.
+//
+// Build (Linux):
+//   g++ -O2 -std=c++17 -pthread -Iinclude -o modbus_bench scripts/modbus_bench.cpp src/modbus_socket_server.cpp
+//
+// Examples:
+//   ./modbus_bench --tcp 192.168.1.50:503 --connections 4 --duration 30
+//   ./modbus_bench --serial /dev/ttyUSB0 --baud 9600 --mix 3:90,4:10
+//   ./modbus_bench --tcp 192.168.1.50:503 --cache-url 192.168.1.50 --stale-reg 40
+//   ./modbus_bench --serve-socket 1502 --connections 8 --pipeline 4
+//   ./modbus_bench --serve-socket 1502 --connections 4 --pipeline 4 --defer-ms 20
+//
+// FC6 is only sent when --write-addr is given: writes are forwarded to the
+// meter, so pick a harmless register.
+//
+// Staleness is reported two ways: the interval between observed changes of
+// --stale-reg in served responses, and (with --cache-url) the age the proxy
+// itself reports for that register in /cache.bin.
+//
+// --pipeline N sends N requests back-to-back on each connection before
+// reading the responses. --serve-socket runs the firmware's socket server
+// engine (src/modbus_socket_server.cpp) in this process with a synthetic
+// register map, and points the TCP connections at it unless --tcp is given.
+// --defer-ms N makes that register map answer from another thread after N ms,
+// through the server's deferred path, like a pass-through request waiting for
+// another slave on the bus.
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "modbus_socket_server.h"
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    std::string tcpHost;
+    int tcpPort = 502;
+    int connections = 1;
+    std::string serialDevice;
+    int baud = 9600;
+    int unit = 1;
+    std::vector<std::pair<int, int>> mix = {{3, 100}};  // function code, weight
+    int readAddress = 0;
+    int readCount = 2;
+    int writeAddress = -1;
+    int writeValue = 0;
+    int durationSec = 10;
+    int rate = 0;            // Requests per second per connection, 0 = closed loop
+    int timeoutMs = 1000;
+    int staleRegister = -1;
+    std::string cacheHost;
+    std::string label;
+    int pipeline = 1;        // Requests in flight per connection
+    int servePort = 0;       // Run the socket server engine on this port, 0 = off
+    int deferMs = -1;        // Answer --serve-socket requests from another thread after this long
+};
+
+struct Stats {
+    uint64_t sent = 0;
+    uint64_t ok = 0;
+    uint64_t timeouts = 0;
+    uint64_t ioErrors = 0;
+    uint64_t badFrames = 0;
+    std::map<int, uint64_t> perFunction;
+    std::map<int, uint64_t> exceptions;
+    std::vector<uint32_t> latencyUs;
+
+    void merge(const Stats& other) {
+        sent += other.sent;
+        ok += other.ok;
+        timeouts += other.timeouts;
+        ioErrors += other.ioErrors;
+        badFrames += other.badFrames;
+        for (auto& e : other.perFunction) perFunction[e.first] += e.second;
+        for (auto& e : other.exceptions) exceptions[e.first] += e.second;
+        latencyUs.insert(latencyUs.end(), other.latencyUs.begin(), other.latencyUs.end());
+    }
+};
+
+// Tracks how often the value of the staleness register changes as seen by clients
+class StalenessTracker {
+public:
+    void observe(uint16_t value) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto now = Clock::now();
+        if (!seen) {
+            seen = true;
+        } else if (value != lastValue) {
+            intervalsMs.push_back(std::chrono::duration_cast<std::chrono::milliseconds>(now - lastChange).count());
+        } else {
+            return;
+        }
+        lastValue = value;
+        lastChange = now;
+    }
+    void addCacheAge(uint32_t ageMs) {
+        std::lock_guard<std::mutex> lock(mutex);
+        cacheAgesMs.push_back(ageMs);
+    }
+    std::vector<uint32_t> intervalsMs;
+    std::vector<uint32_t> cacheAgesMs;
+
+private:
+    std::mutex mutex;
+    bool seen = false;
+    uint16_t lastValue = 0;
+    Clock::time_point lastChange;
+};
+
+static std::atomic<bool> running{true};
+static StalenessTracker staleness;
+
+static uint16_t crc16(const uint8_t* data, size_t len) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 1) ? (crc >> 1) ^ 0xA001 : crc >> 1;
+        }
+    }
+    return crc;
+}
+
+// Reads exactly len bytes or fails on timeout/EOF; returns 1 ok, 0 timeout, -1 error
+static int readExact(int fd, uint8_t* buffer, size_t len, Clock::time_point deadline) {
+    size_t got = 0;
+    while (got < len) {
+        int remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+        if (remaining <= 0) return 0;
+        pollfd pfd = {fd, POLLIN, 0};
+        int ready = poll(&pfd, 1, remaining);
+        if (ready == 0) return 0;
+        if (ready < 0) return -1;
+        ssize_t n = read(fd, buffer + got, len - got);
+        if (n <= 0) return -1;
+        got += n;
+    }
+    return 1;
+}
+
+static bool writeAll(int fd, const uint8_t* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, data, len);
+        if (n <= 0) return false;
+        data += n;
+        len -= n;
+    }
+    return true;
+}
+
+// Builds the PDU (function code onwards) for one request
+static std::vector<uint8_t> buildPdu(const Options& opt, int functionCode) {
+    std::vector<uint8_t> pdu = {static_cast<uint8_t>(functionCode)};
+    uint16_t address = functionCode == 6 ? opt.writeAddress : opt.readAddress;
+    uint16_t second = functionCode == 6 ? opt.writeValue : opt.readCount;
+    pdu.push_back(address >> 8);
+    pdu.push_back(address & 0xFF);
+    pdu.push_back(second >> 8);
+    pdu.push_back(second & 0xFF);
+    return pdu;
+}
+
+// Classifies a response PDU and feeds the staleness tracker
+static void recordResponse(const Options& opt, Stats& stats, int functionCode, const uint8_t* pdu, size_t len) {
+    if (len >= 2 && (pdu[0] & 0x80)) {
+        stats.exceptions[pdu[1]]++;
+        return;
+    }
+    if (len < 1 || pdu[0] != functionCode) {
+        stats.badFrames++;
+        return;
+    }
+    stats.ok++;
+    if ((functionCode == 3 || functionCode == 4) && opt.staleRegister >= opt.readAddress &&
+        opt.staleRegister < opt.readAddress + opt.readCount && len >= 2) {
+        size_t offset = 2 + 2 * (opt.staleRegister - opt.readAddress);
+        if (offset + 1 < len) {
+            staleness.observe((pdu[offset] << 8) | pdu[offset + 1]);
+        }
+    }
+}
+
+class FunctionPicker {
+public:
+    explicit FunctionPicker(const Options& opt, unsigned seed) : rng(seed) {
+        for (auto& entry : opt.mix) {
+            total += entry.second;
+            cumulative.push_back({total, entry.first});
+        }
+    }
+    int next() {
+        int pick = std::uniform_int_distribution<int>(0, total - 1)(rng);
+        for (auto& entry : cumulative) {
+            if (pick < entry.first) return entry.second;
+        }
+        return cumulative.back().second;
+    }
+
+private:
+    std::mt19937 rng;
+    int total = 0;
+    std::vector<std::pair<int, int>> cumulative;
+};
+
+static int connectTcp(const Options& opt) {
+    addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* result = nullptr;
+    std::string port = std::to_string(opt.tcpPort);
+    if (getaddrinfo(opt.tcpHost.c_str(), port.c_str(), &hints, &result) != 0) return -1;
+    int fd = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
+    if (fd >= 0 && connect(fd, result->ai_addr, result->ai_addrlen) != 0) {
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(result);
+    if (fd >= 0) {
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+    return fd;
+}
+
+static void pace(const Options& opt, Clock::time_point& nextSend) {
+    if (opt.rate <= 0) return;
+    nextSend += std::chrono::microseconds(1000000 / opt.rate);
+    std::this_thread::sleep_until(nextSend);
+}
+
+static void tcpWorker(const Options& opt, int index, Stats& stats) {
+    int fd = connectTcp(opt);
+    if (fd < 0) {
+        fprintf(stderr, "connection %d: cannot connect to %s:%d\n", index, opt.tcpHost.c_str(), opt.tcpPort);
+        stats.ioErrors++;
+        return;
+    }
+    FunctionPicker picker(opt, index + 1);
+    uint16_t transactionId = 0;
+    Clock::time_point nextSend = Clock::now();
+
+    while (running) {
+        // The whole batch goes out in one write, before the first response is read
+        std::vector<uint8_t> batch;
+        std::map<uint16_t, int> outstanding;  // transaction ID -> function code
+        for (int i = 0; i < opt.pipeline; i++) {
+            int functionCode = picker.next();
+            std::vector<uint8_t> pdu = buildPdu(opt, functionCode);
+            transactionId++;
+            uint8_t header[7] = {
+                static_cast<uint8_t>(transactionId >> 8), static_cast<uint8_t>(transactionId & 0xFF),
+                0, 0,
+                static_cast<uint8_t>((pdu.size() + 1) >> 8), static_cast<uint8_t>((pdu.size() + 1) & 0xFF),
+                static_cast<uint8_t>(opt.unit)};
+            batch.insert(batch.end(), header, header + sizeof(header));
+            batch.insert(batch.end(), pdu.begin(), pdu.end());
+            outstanding[transactionId] = functionCode;
+            stats.sent++;
+            stats.perFunction[functionCode]++;
+        }
+
+        auto start = Clock::now();
+        if (!writeAll(fd, batch.data(), batch.size())) {
+            stats.ioErrors++;
+            break;
+        }
+
+        // Skip responses to earlier transactions that timed out
+        auto deadline = start + std::chrono::milliseconds(opt.timeoutMs);
+        int status = 1;
+        uint8_t header[7];
+        uint8_t body[260];
+        while (!outstanding.empty()) {
+            status = readExact(fd, header, sizeof(header), deadline);
+            if (status != 1) break;
+            size_t bodyLen = ((header[4] << 8) | header[5]) - 1;
+            if (bodyLen == 0 || bodyLen > sizeof(body)) {
+                status = -1;
+                break;
+            }
+            status = readExact(fd, body, bodyLen, deadline);
+            if (status != 1) break;
+            auto pending = outstanding.find((header[0] << 8) | header[1]);
+            if (pending == outstanding.end()) continue;
+            stats.latencyUs.push_back(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count());
+            recordResponse(opt, stats, pending->second, body, bodyLen);
+            outstanding.erase(pending);
+        }
+        if (status == 0) {
+            stats.timeouts += outstanding.size();
+        } else if (status < 0) {
+            stats.ioErrors++;
+            break;
+        }
+        pace(opt, nextSend);
+    }
+    close(fd);
+}
+
+// Register map for --serve-socket: every register reads as its own address,
+// writes are echoed like a real slave does
+static uint16_t syntheticRegisters(const uint8_t* request, uint16_t length, uint8_t* response, uint16_t capacity,
+                                   uint32_t) {
+    uint8_t functionCode = request[1];
+    uint16_t address = length >= 4 ? (request[2] << 8) | request[3] : 0;
+    uint16_t count = length >= 6 ? (request[4] << 8) | request[5] : 0;
+    response[0] = request[0];
+    if ((functionCode == 3 || functionCode == 4) && count >= 1 && count <= 125 && length == 6) {
+        response[1] = functionCode;
+        response[2] = count * 2;
+        for (uint16_t i = 0; i < count; i++) {
+            response[3 + 2 * i] = (address + i) >> 8;
+            response[4 + 2 * i] = (address + i) & 0xFF;
+        }
+        return 3 + count * 2;
+    }
+    if (functionCode == 6 && length == 6 && capacity >= length) {
+        memcpy(response, request, length);
+        return length;
+    }
+    response[1] = functionCode | 0x80;
+    response[2] = 0x01;  // Illegal function
+    return 3;
+}
+
+static std::atomic<bool> serving{true};
+
+// --defer-ms: a slow slave that answers through ModbusSocketServer::complete()
+class DeferredSlave {
+public:
+    DeferredSlave(ModbusSocketServer& server, int delayMs) : server(server), delay(std::chrono::milliseconds(delayMs)) {}
+
+    uint16_t handle(const uint8_t* request, uint16_t length, uint8_t*, uint16_t, uint32_t ticket) {
+        Pending pending;
+        pending.ticket = ticket;
+        pending.due = Clock::now() + delay;
+        pending.length = syntheticRegisters(request, length, pending.response, sizeof(pending.response), ticket);
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back(pending);
+        wake.notify_one();
+        return MB_SOCKET_DEFERRED;
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (serving) {
+            if (queue.empty()) {
+                wake.wait_for(lock, std::chrono::milliseconds(10));
+                continue;
+            }
+            Pending pending = queue.front();
+            if (Clock::now() < pending.due) {
+                wake.wait_until(lock, pending.due);
+                continue;
+            }
+            queue.pop_front();
+            lock.unlock();
+            server.complete(pending.ticket, pending.response, pending.length);
+            lock.lock();
+        }
+    }
+
+private:
+    struct Pending {
+        uint32_t ticket;
+        Clock::time_point due;
+        uint16_t length;
+        uint8_t response[MB_SOCKET_MAX_ADU - 6];
+    };
+
+    ModbusSocketServer& server;
+    Clock::duration delay;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<Pending> queue;
+};
+
+static void socketServerLoop(ModbusSocketServer& server) {
+    while (serving) {
+        server.poll(MB_SOCKET_POLL_MS);
+    }
+}
+
+static speed_t baudConstant(int baud) {
+    switch (baud) {
+        case 1200: return B1200;
+        case 2400: return B2400;
+        case 4800: return B4800;
+        case 9600: return B9600;
+        case 19200: return B19200;
+        case 38400: return B38400;
+        case 57600: return B57600;
+        case 115200: return B115200;
+        default: return 0;
+    }
+}
+
+static int openSerial(const Options& opt) {
+    int fd = open(opt.serialDevice.c_str(), O_RDWR | O_NOCTTY);
+    if (fd < 0) return -1;
+    termios tty = {};
+    if (tcgetattr(fd, &tty) == 0) {
+        cfmakeraw(&tty);
+        speed_t speed = baudConstant(opt.baud);
+        if (speed != 0) {
+            cfsetispeed(&tty, speed);
+            cfsetospeed(&tty, speed);
+        }
+        tty.c_cflag |= CLOCAL | CREAD;
+        tcsetattr(fd, TCSANOW, &tty);  // pty may ignore the speed, which is fine
+    }
+    return fd;
+}
+
+static void rtuWorker(const Options& opt, Stats& stats) {
+    int fd = openSerial(opt);
+    if (fd < 0) {
+        fprintf(stderr, "serial: cannot open %s\n", opt.serialDevice.c_str());
+        stats.ioErrors++;
+        return;
+    }
+    FunctionPicker picker(opt, 1000);
+    // 3.5 character times of silence between frames, 11 bits per character
+    auto interFrame = std::chrono::microseconds(std::max(1750, 38500000 / std::max(1, opt.baud)));
+    Clock::time_point nextSend = Clock::now();
+
+    while (running) {
+        int functionCode = picker.next();
+        std::vector<uint8_t> frame = {static_cast<uint8_t>(opt.unit)};
+        std::vector<uint8_t> pdu = buildPdu(opt, functionCode);
+        frame.insert(frame.end(), pdu.begin(), pdu.end());
+        uint16_t crc = crc16(frame.data(), frame.size());
+        frame.push_back(crc & 0xFF);
+        frame.push_back(crc >> 8);
+
+        std::this_thread::sleep_for(interFrame);
+        tcflush(fd, TCIFLUSH);
+        auto start = Clock::now();
+        stats.sent++;
+        stats.perFunction[functionCode]++;
+        if (!writeAll(fd, frame.data(), frame.size())) {
+            stats.ioErrors++;
+            break;
+        }
+
+        // Unit, function code and the first data byte decide the remaining length
+        auto deadline = start + std::chrono::milliseconds(opt.timeoutMs);
+        uint8_t response[260];
+        int status = readExact(fd, response, 3, deadline);
+        size_t total = 0;
+        if (status == 1) {
+            if (response[1] & 0x80) {
+                total = 5;
+            } else if (response[1] == 3 || response[1] == 4) {
+                total = 5 + response[2];
+            } else {
+                total = 8;
+            }
+            status = readExact(fd, response + 3, total - 3, deadline);
+        }
+        if (status == 0) {
+            stats.timeouts++;
+        } else if (status < 0) {
+            stats.ioErrors++;
+            break;
+        } else if (crc16(response, total - 2) != (response[total - 2] | (response[total - 1] << 8)) ||
+                   response[0] != opt.unit) {
+            stats.badFrames++;
+        } else {
+            stats.latencyUs.push_back(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count());
+            recordResponse(opt, stats, functionCode, response + 1, total - 3);
+        }
+        pace(opt, nextSend);
+    }
+    close(fd);
+}
+
+// Samples the proxy's own view of register age from /cache.bin once per second
+static void cacheAgeSampler(const Options& opt) {
+    Options httpOpt = opt;
+    std::string host = opt.cacheHost;
+    httpOpt.tcpPort = 80;
+    size_t colon = host.find(':');
+    if (colon != std::string::npos) {
+        httpOpt.tcpPort = atoi(host.c_str() + colon + 1);
+        host = host.substr(0, colon);
+    }
+    httpOpt.tcpHost = host;
+
+    while (running) {
+        int fd = connectTcp(httpOpt);
+        if (fd >= 0) {
+            std::string request = "GET /cache.bin HTTP/1.0\r\nHost: " + host + "\r\n\r\n";
+            writeAll(fd, reinterpret_cast<const uint8_t*>(request.data()), request.size());
+            std::vector<uint8_t> reply;
+            uint8_t chunk[1024];
+            auto deadline = Clock::now() + std::chrono::milliseconds(opt.timeoutMs);
+            for (;;) {
+                pollfd pfd = {fd, POLLIN, 0};
+                int remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+                if (remaining <= 0 || poll(&pfd, 1, remaining) <= 0) break;
+                ssize_t n = read(fd, chunk, sizeof(chunk));
+                if (n <= 0) break;
+                reply.insert(reply.end(), chunk, chunk + n);
+            }
+            close(fd);
+
+            // Image layout: 16-byte header, then 12-byte entries (see CACHE_IMAGE_* in ModbusCache.h)
+            static const uint8_t separator[] = {'\r', '\n', '\r', '\n'};
+            auto body = std::search(reply.begin(), reply.end(), separator, separator + 4);
+            if (body != reply.end()) {
+                const uint8_t* image = &*body + 4;
+                size_t length = reply.end() - (body + 4);
+                if (length >= 16) {
+                    uint16_t count = image[6] | (image[7] << 8);
+                    for (uint16_t i = 0; i < count && 16 + (i + 1) * 12u <= length; i++) {
+                        const uint8_t* entry = image + 16 + i * 12;
+                        uint16_t address = entry[0] | (entry[1] << 8);
+                        uint32_t age = entry[8] | (entry[9] << 8) | (entry[10] << 16) | (static_cast<uint32_t>(entry[11]) << 24);
+                        if (address == opt.staleRegister && age != 0xFFFFFFFF) {
+                            staleness.addCacheAge(age);
+                        }
+                    }
+                }
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+    }
+}
+
+static double percentile(std::vector<uint32_t>& values, double p) {
+    if (values.empty()) return 0.0;
+    size_t index = std::min(values.size() - 1, static_cast<size_t>(p / 100.0 * values.size()));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+static void printDistribution(const char* name, std::vector<uint32_t> values, double scale, bool last) {
+    printf("    \"%s\": {\"count\": %zu, \"p50\": %.3f, \"p90\": %.3f, \"p99\": %.3f, \"p999\": %.3f, \"max\": %.3f}%s\n",
+           name, values.size(),
+           percentile(values, 50) / scale, percentile(values, 90) / scale,
+           percentile(values, 99) / scale, percentile(values, 99.9) / scale,
+           values.empty() ? 0.0 : *std::max_element(values.begin(), values.end()) / scale,
+           last ? "" : ",");
+}
+
+static void printReport(const char* transport, Stats stats, double seconds, bool last) {
+    printf("  \"%s\": {\n", transport);
+    printf("    \"requests\": %llu,\n", (unsigned long long)stats.sent);
+    printf("    \"ok\": %llu,\n", (unsigned long long)stats.ok);
+    printf("    \"throughput_rps\": %.1f,\n", seconds > 0 ? stats.ok / seconds : 0.0);
+    printf("    \"timeouts\": %llu,\n", (unsigned long long)stats.timeouts);
+    printf("    \"io_errors\": %llu,\n", (unsigned long long)stats.ioErrors);
+    printf("    \"bad_frames\": %llu,\n", (unsigned long long)stats.badFrames);
+    printf("    \"functions\": {");
+    bool first = true;
+    for (auto& entry : stats.perFunction) {
+        printf("%s\"%d\": %llu", first ? "" : ", ", entry.first, (unsigned long long)entry.second);
+        first = false;
+    }
+    printf("},\n    \"exceptions\": {");
+    first = true;
+    for (auto& entry : stats.exceptions) {
+        printf("%s\"%d\": %llu", first ? "" : ", ", entry.first, (unsigned long long)entry.second);
+        first = false;
+    }
+    printf("},\n");
+    printDistribution("latency_ms", stats.latencyUs, 1000.0, true);
+    printf("  }%s\n", last ? "" : ",");
+}
+
+static bool parseMix(const std::string& text, std::vector<std::pair<int, int>>& mix) {
+    mix.clear();
+    size_t start = 0;
+    while (start < text.size()) {
+        size_t end = text.find(',', start);
+        std::string item = text.substr(start, end == std::string::npos ? std::string::npos : end - start);
+        int functionCode = 0, weight = 0;
+        if (sscanf(item.c_str(), "%d:%d", &functionCode, &weight) != 2 ||
+            (functionCode != 3 && functionCode != 4 && functionCode != 6) || weight <= 0) {
+            return false;
+        }
+        mix.push_back({functionCode, weight});
+        if (end == std::string::npos) break;
+        start = end + 1;
+    }
+    return !mix.empty();
+}
+
+static void usage(const char* name) {
+    fprintf(stderr,
+            "usage: %s [--tcp host:port] [--connections N] [--serial dev] [--baud B]\n"
+            "          [--unit id] [--mix 3:80,4:15,6:5] [--read-addr A] [--read-count N]\n"
+            "          [--write-addr A] [--write-value V] [--duration s] [--rate rps]\n"
+            "          [--timeout ms] [--stale-reg A] [--cache-url host[:port]] [--label text]\n"
+            "          [--pipeline N] [--serve-socket port] [--defer-ms ms]\n",
+            name);
+}
+
+int main(int argc, char** argv) {
+    Options opt;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (value == nullptr || arg.rfind("--", 0) != 0) {
+            usage(argv[0]);
+            return 2;
+        }
+        i++;
+        if (arg == "--tcp") {
+            std::string target = value;
+            size_t colon = target.rfind(':');
+            opt.tcpHost = target.substr(0, colon);
+            if (colon != std::string::npos) opt.tcpPort = atoi(target.c_str() + colon + 1);
+        } else if (arg == "--connections") {
+            opt.connections = std::max(1, atoi(value));
+        } else if (arg == "--serial") {
+            opt.serialDevice = value;
+        } else if (arg == "--baud") {
+            opt.baud = atoi(value);
+        } else if (arg == "--unit") {
+            opt.unit = atoi(value);
+        } else if (arg == "--mix") {
+            if (!parseMix(value, opt.mix)) {
+                fprintf(stderr, "invalid --mix, expected fc:weight pairs with fc 3, 4 or 6\n");
+                return 2;
+            }
+        } else if (arg == "--read-addr") {
+            opt.readAddress = atoi(value);
+        } else if (arg == "--read-count") {
+            opt.readCount = std::min(125, std::max(1, atoi(value)));
+        } else if (arg == "--write-addr") {
+            opt.writeAddress = atoi(value);
+        } else if (arg == "--write-value") {
+            opt.writeValue = atoi(value);
+        } else if (arg == "--duration") {
+            opt.durationSec = atoi(value);
+        } else if (arg == "--rate") {
+            opt.rate = atoi(value);
+        } else if (arg == "--timeout") {
+            opt.timeoutMs = atoi(value);
+        } else if (arg == "--stale-reg") {
+            opt.staleRegister = atoi(value);
+        } else if (arg == "--cache-url") {
+            opt.cacheHost = value;
+        } else if (arg == "--label") {
+            opt.label = value;
+        } else if (arg == "--pipeline") {
+            opt.pipeline = std::min(64, std::max(1, atoi(value)));
+        } else if (arg == "--serve-socket") {
+            opt.servePort = atoi(value);
+        } else if (arg == "--defer-ms") {
+            opt.deferMs = std::max(0, atoi(value));
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (opt.servePort > 0 && opt.tcpHost.empty()) {
+        opt.tcpHost = "127.0.0.1";
+        opt.tcpPort = opt.servePort;
+    }
+    if (opt.tcpHost.empty() && opt.serialDevice.empty()) {
+        usage(argv[0]);
+        return 2;
+    }
+    for (auto& entry : opt.mix) {
+        if (entry.first == 6 && opt.writeAddress < 0) {
+            fprintf(stderr, "FC6 in --mix requires --write-addr\n");
+            return 2;
+        }
+    }
+
+    ModbusSocketServer socketServer;
+    DeferredSlave slave(socketServer, std::max(0, opt.deferMs));
+    std::thread serverThread;
+    std::thread slaveThread;
+    if (opt.servePort > 0) {
+        ModbusSocketHandler handler = syntheticRegisters;
+        if (opt.deferMs >= 0) {
+            handler = [&slave](const uint8_t* request, uint16_t length, uint8_t* response, uint16_t capacity,
+                               uint32_t ticket) {
+                return slave.handle(request, length, response, capacity, ticket);
+            };
+            slaveThread = std::thread(&DeferredSlave::run, &slave);
+        }
+        if (!socketServer.begin(opt.servePort, 0, handler)) {
+            fprintf(stderr, "cannot listen on port %d\n", opt.servePort);
+            return 1;
+        }
+        serverThread = std::thread(socketServerLoop, std::ref(socketServer));
+    }
+
+    std::vector<Stats> tcpStats(opt.tcpHost.empty() ? 0 : opt.connections);
+    Stats rtuStats;
+    std::vector<std::thread> threads;
+    auto start = Clock::now();
+    for (size_t i = 0; i < tcpStats.size(); i++) {
+        threads.emplace_back(tcpWorker, std::cref(opt), static_cast<int>(i), std::ref(tcpStats[i]));
+    }
+    if (!opt.serialDevice.empty()) {
+        threads.emplace_back(rtuWorker, std::cref(opt), std::ref(rtuStats));
+    }
+    if (!opt.cacheHost.empty() && opt.staleRegister >= 0) {
+        threads.emplace_back(cacheAgeSampler, std::cref(opt));
+    }
+
+    std::this_thread::sleep_for(std::chrono::seconds(opt.durationSec));
+    running = false;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (serverThread.joinable()) {
+        serving = false;
+        serverThread.join();
+    }
+    if (slaveThread.joinable()) {
+        slaveThread.join();
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    Stats tcpTotal;
+    for (auto& stats : tcpStats) {
+        tcpTotal.merge(stats);
+    }
+
+    printf("{\n");
+    printf("  \"label\": \"%s\",\n", opt.label.c_str());
+    printf("  \"duration_s\": %.2f,\n", seconds);
+    printf("  \"connections\": %d,\n", static_cast<int>(tcpStats.size()));
+    printf("  \"baud\": %d,\n", opt.serialDevice.empty() ? 0 : opt.baud);
+    printf("  \"pipeline\": %d,\n", opt.pipeline);
+    if (opt.servePort > 0) {
+        printf("  \"socket_server\": {\n");
+        printf("    \"accepted\": %u,\n", socketServer.getAccepted());
+        printf("    \"rejected\": %u,\n", socketServer.getRejected());
+        printf("    \"requests\": %u,\n", socketServer.getRequests());
+        printf("    \"pipelined\": %u,\n", socketServer.getPipelined());
+        printf("    \"max_pipeline_depth\": %u,\n", socketServer.getMaxPipelineDepth());
+        printf("    \"deferred\": %u,\n", socketServer.getDeferred());
+        printf("    \"protocol_errors\": %u\n", socketServer.getProtocolErrors());
+        printf("  },\n");
+    }
+    if (!tcpStats.empty()) {
+        printReport("tcp", tcpTotal, seconds, false);
+    }
+    if (!opt.serialDevice.empty()) {
+        printReport("rtu", rtuStats, seconds, false);
+    }
+    printf("  \"staleness\": {\n");
+    printf("    \"register\": %d,\n", opt.staleRegister);
+    printDistribution("change_interval_ms", staleness.intervalsMs, 1.0, false);
+    printDistribution("cache_age_ms", staleness.cacheAgesMs, 1.0, true);
+    printf("  }\n");
+    printf("}\n");
+    return 0;
+}
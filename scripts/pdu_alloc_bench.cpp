@@ -0,0 +1,271 @@
+// Counts heap allocations per 1000 FC3/FC4 serve transactions for the two
+// ways respondFromCache has built its frames: gathering the words in a
+// std::vector and growing the message one add() at a time, and writing the
+// frame into a pool buffer (src/pdu_pool.cpp) that is copied into the
+// message once. Also checks the pool's exhaustion, move and release rules.
+//
+// respondFromCache needs Arduino, FreeRTOS and eModbus, so both serve paths
+// are restated here over a plain register map and the firmware's codec table
+// (src/register_codec.cpp), and Message stands in for eModbus's
+// ModbusMessage: a std::vector<uint8_t> grown by push_back, with a sized
+// constructor that reserves. Keep them in step with ModbusCache.cpp.
+//
+// Build (Linux):
+//   g++ -O2 -std=c++17 -Iinclude -o pdu_alloc_bench scripts/pdu_alloc_bench.cpp src/pdu_pool.cpp src/register_codec.cpp
+//
+// Examples:
+//   ./pdu_alloc_bench
+//   ./pdu_alloc_bench --transactions 10000
+//
+// Exits with 1 if the two paths build different frames, the pool path
+// allocates more than the one message copy per transaction, or a pool check
+// fails.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "pdu_pool.h"
+#include "register_codec.h"
+
+static bool counting = false;
+static long allocations = 0;
+
+// Out of line, so the compiler does not pair the inlined free() with new
+__attribute__((noinline)) static void release(void* block) {
+    free(block);
+}
+
+void* operator new(size_t size) {
+    if (counting) allocations++;
+    void* block = malloc(size == 0 ? 1 : size);
+    if (block == nullptr) throw std::bad_alloc();
+    return block;
+}
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+void operator delete(void* block) noexcept {
+    release(block);
+}
+void operator delete[](void* block) noexcept {
+    release(block);
+}
+void operator delete(void* block, size_t) noexcept {
+    release(block);
+}
+void operator delete[](void* block, size_t) noexcept {
+    release(block);
+}
+
+// eModbus ModbusMessage, as far as the serve path uses it
+class Message {
+public:
+    Message() {}
+    explicit Message(uint16_t dataLen) { data_.reserve(dataLen); }
+    void add(uint8_t value) { data_.push_back(value); }
+    void add(uint16_t value) {
+        data_.push_back(value >> 8);
+        data_.push_back(value & 0xFF);
+    }
+    void add(const uint8_t* bytes, uint16_t count) {
+        for (uint16_t i = 0; i < count; i++) data_.push_back(bytes[i]);
+    }
+    const std::vector<uint8_t>& bytes() const { return data_; }
+
+private:
+    std::vector<uint8_t> data_;
+};
+
+// A register map laid out like the ET112's: 32-bit values with 16-bit ones
+// between them, then a run of 16-bit registers
+struct Registers {
+    std::map<uint16_t, RegisterType> definitions;
+    std::map<uint16_t, uint32_t> values32;
+    std::map<uint16_t, uint16_t> values16;
+
+    Registers() {
+        for (uint16_t address = 0; address < 260;) {
+            if (address < 24 && address != 14 && address != 15) {
+                definitions[address] = RegisterType::INT32;
+                values32[address] = 0x10000u * address + 7 * address + 1;
+                address += 2;
+            } else {
+                definitions[address] = RegisterType::INT16;
+                values16[address] = 3 * address + 1;
+                address++;
+            }
+        }
+    }
+    bool is32Bit(uint16_t address) const {
+        auto def = definitions.find(address);
+        return def != definitions.end() && registerCodec(def->second).words == 2;
+    }
+    uint32_t read32(uint16_t address) const { return values32.at(address); }
+    uint16_t read16(uint16_t address) const {
+        auto it = values16.find(address);
+        return it != values16.end() ? it->second : 0;
+    }
+};
+
+// respondFromCache before the pool: gather, then grow the message
+static Message serveVector(const Registers& cache, uint8_t slaveID, uint8_t functionCode, uint16_t address,
+                           uint16_t valueOrWords) {
+    std::vector<uint16_t> values;
+    values.reserve(valueOrWords);
+    uint16_t i = 0;
+    uint16_t currentAddress = address;
+    while (i < valueOrWords) {
+        auto def = cache.definitions.find(currentAddress);
+        if (def != cache.definitions.end() && cache.is32Bit(currentAddress)) {
+            uint16_t words[2];
+            registerCodec(def->second).toWire(cache.read32(currentAddress), words);
+            values.push_back(words[0]);
+            if (i + 1 < valueOrWords) {
+                values.push_back(words[1]);
+                i++;
+            }
+            currentAddress += 2;
+        } else {
+            values.push_back(cache.read16(currentAddress));
+            currentAddress++;
+        }
+        i++;
+    }
+
+    Message response;
+    response.add(slaveID);
+    response.add(functionCode);
+    response.add(static_cast<uint8_t>(values.size() * 2));
+    for (uint16_t val : values) {
+        response.add(val);
+    }
+    return response;
+}
+
+static Message toModbusMessage(const PduBuffer& frame) {
+    Message message(frame.size());
+    message.add(frame.data(), frame.size());
+    return message;
+}
+
+// respondFromCache with the pool: build in place, copy once
+static Message servePool(const Registers& cache, uint8_t slaveID, uint8_t functionCode, uint16_t address,
+                         uint16_t valueOrWords) {
+    PduBuffer frame = pduPool.acquire();
+    frame.add(slaveID);
+    frame.add(functionCode);
+    frame.add(static_cast<uint8_t>(0));
+    uint16_t i = 0;
+    uint16_t currentAddress = address;
+    while (i < valueOrWords) {
+        auto def = cache.definitions.find(currentAddress);
+        if (def != cache.definitions.end() && cache.is32Bit(currentAddress)) {
+            uint16_t words[2];
+            registerCodec(def->second).toWire(cache.read32(currentAddress), words);
+            frame.add(words[0]);
+            if (i + 1 < valueOrWords) {
+                frame.add(words[1]);
+                i++;
+            }
+            currentAddress += 2;
+        } else {
+            frame.add(cache.read16(currentAddress));
+            currentAddress++;
+        }
+        i++;
+    }
+    frame.data()[2] = static_cast<uint8_t>(frame.size() - 3);
+    return toModbusMessage(frame);
+}
+
+static bool check(bool condition, const char* what) {
+    if (!condition) fprintf(stderr, "pool: %s\n", what);
+    return condition;
+}
+
+static bool checkPool() {
+    bool ok = true;
+    uint32_t exhaustedBefore = pduPool.getExhausted();
+    {
+        std::vector<PduBuffer> held;
+        for (int i = 0; i < PDU_POOL_BUFFERS; i++) held.push_back(pduPool.acquire());
+        ok &= check(pduPool.getInUse() == PDU_POOL_BUFFERS, "all slots in use");
+        ok &= check(pduPool.getExhausted() == exhaustedBefore, "exhausted before the pool was empty");
+
+        PduBuffer overflow = pduPool.acquire();
+        ok &= check(overflow.valid(), "exhausted pool returned no buffer");
+        ok &= check(pduPool.getExhausted() == exhaustedBefore + 1, "heap buffer not counted");
+
+        PduBuffer moved(std::move(held[0]));
+        ok &= check(!held[0].valid() && moved.valid(), "move construction");
+        ok &= check(pduPool.getInUse() == PDU_POOL_BUFFERS, "move changed the slots in use");
+        held[1] = std::move(moved);
+        ok &= check(!moved.valid() && pduPool.getInUse() == PDU_POOL_BUFFERS - 1, "move assignment releases");
+        held[1].release();
+        ok &= check(pduPool.getInUse() == PDU_POOL_BUFFERS - 2, "release");
+    }
+    ok &= check(pduPool.getInUse() == 0, "slots returned on destruction");
+    ok &= check(pduPool.getMaxInUse() == PDU_POOL_BUFFERS, "peak in use");
+
+    PduBuffer frame = pduPool.acquire();
+    int words = 0;
+    while (frame.add(static_cast<uint16_t>(words))) words++;
+    ok &= check(words == PDU_BUFFER_SIZE / 2, "buffer does not hold 128 words");
+    ok &= check(!frame.add(static_cast<uint8_t>(0)), "add past the end of a full buffer");
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    long transactions = 1000;
+    if (argc == 3 && strcmp(argv[1], "--transactions") == 0) {
+        transactions = atol(argv[2]);
+    } else if (argc != 1) {
+        fprintf(stderr, "usage: %s [--transactions N]\n", argv[0]);
+        return 2;
+    }
+    if (transactions <= 0) {
+        fprintf(stderr, "--transactions needs a positive count\n");
+        return 2;
+    }
+
+    Registers cache;
+    static const uint16_t counts[] = {2, 16, 36, 125};
+    bool ok = true;
+    printf("registers  vector_allocs  pool_allocs   (per %ld transactions)\n", transactions);
+    for (uint16_t count : counts) {
+        long perPath[2];
+        for (int path = 0; path < 2; path++) {
+            allocations = 0;
+            counting = true;
+            for (long n = 0; n < transactions; n++) {
+                uint16_t address = n % 2 == 0 ? 0 : 24;
+                Message built = path == 0 ? serveVector(cache, 1, 3, address, count)
+                                          : servePool(cache, 1, 3, address, count);
+                (void)built;
+            }
+            counting = false;
+            perPath[path] = allocations;
+        }
+        printf("%9u  %13ld  %11ld\n", count, perPath[0], perPath[1]);
+
+        for (uint16_t address : {0, 1, 12, 24}) {
+            if (serveVector(cache, 1, 4, address, count).bytes() != servePool(cache, 1, 4, address, count).bytes()) {
+                fprintf(stderr, "%u registers at %u: frames differ\n", count, address);
+                ok = false;
+            }
+        }
+        if (perPath[1] > transactions) {
+            fprintf(stderr, "%u registers: the pool path allocated more than once per transaction\n", count);
+            ok = false;
+        }
+    }
+    ok &= checkPool();
+    if (ok) printf("frames byte-identical, pool checks passed\n");
+    return ok ? 0 : 1;
+}
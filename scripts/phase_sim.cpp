@@ -0,0 +1,239 @@
+// Simulates a periodic Modbus client reading one cached range and replays
+// its reads through the firmware's phase tracker (src/phase_tracker.cpp),
+// with the demand-driven polling grid and the phase-aligned prefetch of
+// ModbusCache::update restated around it. Each scenario runs twice, once
+// with the grid alone and once with prefetch, and compares the age of the
+// data the client is served.
+//
+// Build (Linux):
+//   g++ -O2 -std=c++17 -Iinclude -o phase_sim scripts/phase_sim.cpp src/phase_tracker.cpp
+//
+// Examples:
+//   ./phase_sim
+//   ./phase_sim --seed 7 --verbose
+//
+// Scenarios: steady jittered reads, reads with missed and duplicate cycles,
+// and a client whose period steps from 1 s to 1.6 s halfway through. For each
+// one the tracker must lock (and relock after the step, on the new period)
+// within the cycle budget below, and once locked the mean served age with
+// prefetch must be under half of the grid's.
+//
+// A step to a whole multiple of the period (1 s to 3 s) is not in the set:
+// the tracker reads it as missed cycles and stays locked on the old period,
+// which serves the reads just as fresh but prefetches on every old cycle.
+//
+// Exits with 1 if any scenario misses its bounds.
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "phase_tracker.h"
+
+#define TICK_MS 5                 // update() loop granularity
+#define UPDATE_INTERVAL_MS 50     // Polling interval, the grid's floor
+#define PREFETCH_GUARD_MS 20      // include/ModbusCache.h
+#define PREFETCH_JITTER_LEAD 3
+#define LOCK_BUDGET_CYCLES 10     // Cycles allowed to lock from cold
+#define RELOCK_BUDGET_CYCLES 20   // Cycles allowed to relock after a period step
+#define AGE_RATIO_LIMIT 0.5       // Prefetch mean age over grid mean age, once locked
+
+struct Scenario {
+    const char* name;
+    uint32_t periodMs;
+    uint32_t stepPeriodMs;        // Period after the step, 0 for none
+    float jitterMs;               // Standard deviation of each read's offset
+    float missedShare;            // Cycles the client skips
+    float duplicateShare;         // Cycles read twice in a row
+    uint32_t roundTripMs;         // Upstream poll round trip
+    uint32_t cycles;
+};
+
+struct Outcome {
+    long lockMs = -1;             // From the first read
+    long relockMs = -1;           // From the period step
+    double lockedAgeMs = 0;       // Mean served age over reads while locked
+    uint32_t lockedReads = 0;
+    double ageMs = 0;             // Mean served age over all reads after the first poll
+    uint32_t reads = 0;
+    uint32_t polls = 0;
+    uint32_t outliers = 0;
+    uint32_t periodMs = 0;        // Tracker's period estimate at the end
+};
+
+// Read times of the client, in ms
+static std::vector<uint64_t> clientReads(const Scenario& s, unsigned seed, uint64_t& stepAtMs) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> jitter(0.0f, s.jitterMs);
+    std::uniform_real_distribution<float> chance(0.0f, 1.0f);
+    std::vector<uint64_t> reads;
+    uint64_t cycleStart = 1000;
+    stepAtMs = 0;
+    for (uint32_t cycle = 0; cycle < s.cycles; cycle++) {
+        uint32_t period = s.periodMs;
+        if (s.stepPeriodMs != 0 && cycle >= s.cycles / 2) {
+            if (stepAtMs == 0) stepAtMs = cycleStart;
+            period = s.stepPeriodMs;
+        }
+        if (cycle < 2 || chance(rng) >= s.missedShare) {
+            uint64_t at = cycleStart + static_cast<int64_t>(std::lround(jitter(rng)));
+            reads.push_back(at);
+            if (chance(rng) < s.duplicateShare) {
+                reads.push_back(at + 10 + rng() % 40);
+            }
+        }
+        cycleStart += period;
+    }
+    return reads;
+}
+
+static Outcome run(const Scenario& s, bool prefetch, unsigned seed, bool verbose) {
+    uint64_t stepAtMs;
+    std::vector<uint64_t> reads = clientReads(s, seed, stepAtMs);
+    std::mt19937 rng(seed + 1);
+
+    PhaseTracker phase;
+    Outcome out;
+    size_t next = 0;
+    uint64_t lastRequest = 0;
+    uint64_t landsAt = 0;         // In-flight poll's commit time, 0 if none
+    uint64_t lastCommit = 0;
+    uint64_t lastReadTime = 0;
+    uint32_t readIntervalMs = 0;
+    unsigned long prefetchTarget = 0;
+    bool wasLocked = false;
+    double ageSum = 0, lockedAgeSum = 0;
+
+    for (uint64_t now = reads.front(); next < reads.size(); now += TICK_MS) {
+        // Client reads due this tick: respondFromCache, then recordClientRead
+        while (next < reads.size() && reads[next] <= now) {
+            uint64_t at = reads[next++];
+            if (landsAt != 0 && landsAt <= at) {
+                lastCommit = landsAt;
+                landsAt = 0;
+            }
+            bool locked = phase.isLocked(at);
+            if (lastCommit != 0) {
+                double age = static_cast<double>(at - lastCommit);
+                ageSum += age;
+                out.reads++;
+                if (locked) {
+                    lockedAgeSum += age;
+                    out.lockedReads++;
+                }
+            }
+            if (lastReadTime != 0) {
+                uint32_t interval = at - lastReadTime;
+                readIntervalMs = readIntervalMs == 0 ? interval : (readIntervalMs * 3 + interval) / 4;
+            }
+            lastReadTime = at;
+            phase.observe(at);
+        }
+        if (landsAt != 0 && landsAt <= now) {
+            lastCommit = landsAt;
+            landsAt = 0;
+        }
+
+        bool locked = phase.isLocked(now);
+        if (locked && !wasLocked) {
+            if (out.lockMs < 0) out.lockMs = now - reads.front();
+            if (stepAtMs != 0 && now >= stepAtMs && out.relockMs < 0) out.relockMs = now - stepAtMs;
+            if (verbose) printf("  %8llu ms  locked, period %u ms\n", (unsigned long long)now, phase.getPeriodMs());
+        } else if (!locked && wasLocked && verbose) {
+            printf("  %8llu ms  unlocked\n", (unsigned long long)now);
+        }
+        wasLocked = locked;
+        if (landsAt != 0) continue;
+
+        // prefetchRanges
+        if (prefetch && locked) {
+            unsigned long expected = phase.nextExpected(now);
+            unsigned long lead = std::min<unsigned long>(s.roundTripMs + PREFETCH_GUARD_MS + PREFETCH_JITTER_LEAD * phase.getJitterMs(),
+                                                         phase.getPeriodMs() / 2);
+            if (expected != prefetchTarget && static_cast<long>(now - (expected - lead)) >= 0) {
+                prefetchTarget = expected;
+                lastRequest = now;
+                landsAt = now + s.roundTripMs + rng() % 10;
+                out.polls++;
+                continue;
+            }
+        }
+
+        // The grid, unless prefetchOwns the range
+        bool owned = prefetch && locked && now - lastRequest < 2UL * phase.getPeriodMs();
+        uint64_t interval = std::max<uint64_t>(UPDATE_INTERVAL_MS, readIntervalMs / 2);
+        if (!owned && now - lastRequest >= interval) {
+            lastRequest = now;
+            landsAt = now + s.roundTripMs + rng() % 10;
+            out.polls++;
+        }
+    }
+
+    out.ageMs = out.reads ? ageSum / out.reads : 0;
+    out.lockedAgeMs = out.lockedReads ? lockedAgeSum / out.lockedReads : 0;
+    out.outliers = phase.getOutliers();
+    out.periodMs = phase.getPeriodMs();
+    return out;
+}
+
+int main(int argc, char** argv) {
+    unsigned seed = 1;
+    bool verbose = false;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--seed" && i + 1 < argc) {
+            seed = atoi(argv[++i]);
+        } else if (arg == "--verbose") {
+            verbose = true;
+        } else {
+            fprintf(stderr, "usage: %s [--seed S] [--verbose]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    const Scenario scenarios[] = {
+        {"steady 1 s, 15 ms jitter", 1000, 0, 15.0f, 0.0f, 0.0f, 40, 300},
+        {"5 s, 40 ms jitter, 10% missed, 10% duplicated", 5000, 0, 40.0f, 0.10f, 0.10f, 40, 200},
+        {"1 s stepping to 1.6 s, 20 ms jitter", 1000, 1600, 20.0f, 0.02f, 0.02f, 60, 400},
+    };
+
+    bool ok = true;
+    for (const Scenario& s : scenarios) {
+        if (verbose) printf("%s, prefetch:\n", s.name);
+        Outcome grid = run(s, false, seed, false);
+        Outcome aligned = run(s, true, seed, verbose);
+
+        double ratio = grid.ageMs > 0 ? aligned.lockedAgeMs / grid.ageMs : 1.0;
+        printf("%s\n", s.name);
+        printf("  lock %ld ms, relock %ld ms, outliers %u, final period %u ms\n", aligned.lockMs,
+               aligned.relockMs, aligned.outliers, aligned.periodMs);
+        printf("  grid:     mean age %.1f ms, %u polls\n", grid.ageMs, grid.polls);
+        printf("  prefetch: mean age %.1f ms while locked (%u of %u reads), %.1f ms overall, %u polls\n",
+               aligned.lockedAgeMs, aligned.lockedReads, aligned.reads, aligned.ageMs, aligned.polls);
+
+        uint32_t lockPeriod = s.periodMs;
+        if (aligned.lockMs < 0 || aligned.lockMs > static_cast<long>(LOCK_BUDGET_CYCLES * lockPeriod)) {
+            printf("  FAIL: no lock within %d cycles\n", LOCK_BUDGET_CYCLES);
+            ok = false;
+        }
+        if (s.stepPeriodMs != 0 &&
+            (aligned.relockMs < 0 || aligned.relockMs > static_cast<long>(RELOCK_BUDGET_CYCLES * s.stepPeriodMs))) {
+            printf("  FAIL: no relock within %d cycles of the step\n", RELOCK_BUDGET_CYCLES);
+            ok = false;
+        }
+        uint32_t finalPeriod = s.stepPeriodMs != 0 ? s.stepPeriodMs : s.periodMs;
+        if (fabs(static_cast<double>(aligned.periodMs) - finalPeriod) > finalPeriod * 0.05) {
+            printf("  FAIL: period estimate %u ms, client reads every %u ms\n", aligned.periodMs, finalPeriod);
+            ok = false;
+        }
+        if (aligned.lockedReads == 0 || ratio > AGE_RATIO_LIMIT) {
+            printf("  FAIL: locked served age %.2f of the grid's, limit %.2f\n", ratio, AGE_RATIO_LIMIT);
+            ok = false;
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,439 @@
+// Checks the register codecs (include/register_codec.h) against the
+// RegisterType switches in ModbusCache.cpp that they replaced, then times
+// both on the ET112 dynamic frame.
+//
+// The switch paths are restated from ModbusCache.cpp as they were before the
+// codec: extract16BitValue/extract32BitValue, split32BitRegister, the
+// getScaledValueFromRegister switch and the updateWaterMarks comparisons.
+// Where those were wrong or missing (FLOAT scaling converted the integer
+// instead of reinterpreting the bits, FLOAT had no watermarks, and there was no
+// high-word-first order or saturating conversion), the codec is checked
+// against a plain reference instead.
+//
+// Build (Linux):
+//   g++ -O2 -std=c++17 -Iinclude -o register_codec_test scripts/register_codec_test.cpp src/register_codec.cpp
+//
+// Examples:
+//   ./register_codec_test
+//   ./register_codec_test --full
+//   ./register_codec_test --bench 2000000
+//
+// Every 16-bit value is checked, and each is ordered against its neighbours
+// and 64 random partners. 32-bit types are checked on 4M random patterns
+// plus the edge cases. --full checks every 32-bit pattern and every 16-bit
+// pair instead, which takes about 7 minutes on one x86 core. --bench N times
+// N frames through each path.
+//
+// Exits with 1 on the first mismatch.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "register_codec.h"
+
+// Compile-time checks: all but the float codecs' decode/encode are constexpr
+using U16 = RegisterCodec<uint16_t>;
+using I16 = RegisterCodec<int16_t>;
+using U32 = RegisterCodec<uint32_t>;
+using I32 = RegisterCodec<int32_t>;
+using I32High = RegisterCodec<int32_t, WordOrder::HIGH_FIRST>;
+static_assert(I16::decode(0xFFFF) == -1, "INT16 decode");
+static_assert(I16::encode(-1) == 0xFFFF, "INT16 encode zero-extends");
+static_assert(I32::decode(0xFFFFFFFE) == -2, "INT32 decode");
+static_assert(U16::encode(U16::decode(0x1234)) == 0x1234, "UINT16 round trip");
+static_assert(I16::less(0x8000, 0x7FFF) && !U16::less(0x8000, 0x7FFF), "16-bit ordering");
+static_assert(I32::less(0x80000000, 0) && U32::less(0, 0x80000000), "32-bit ordering");
+static_assert(I32::scale(I32::encode(-20), 0.5f) == -10.0f, "INT32 scaling");
+static constexpr uint8_t lowFirstWire[] = {0x56, 0x78, 0x12, 0x34};
+static constexpr uint8_t highFirstWire[] = {0x12, 0x34, 0x56, 0x78};
+static_assert(U32::fromWire(lowFirstWire) == 0x12345678, "low word first");
+static_assert(I32High::fromWire(highFirstWire) == 0x12345678, "high word first");
+
+static const RegisterType allTypes[] = {
+    RegisterType::UINT16, RegisterType::INT16, RegisterType::UINT32, RegisterType::INT32, RegisterType::FLOAT,
+    RegisterType::UINT32_HIGH_FIRST, RegisterType::INT32_HIGH_FIRST, RegisterType::FLOAT_HIGH_FIRST,
+};
+static const char* typeNames[] = {
+    "UINT16", "INT16", "UINT32", "INT32", "FLOAT", "UINT32_HIGH_FIRST", "INT32_HIGH_FIRST", "FLOAT_HIGH_FIRST",
+};
+
+static bool isFloatType(RegisterType type) {
+    return type == RegisterType::FLOAT || type == RegisterType::FLOAT_HIGH_FIRST;
+}
+static bool isHighFirst(RegisterType type) {
+    return type == RegisterType::UINT32_HIGH_FIRST || type == RegisterType::INT32_HIGH_FIRST ||
+           type == RegisterType::FLOAT_HIGH_FIRST;
+}
+// Word-order variants share the value semantics of their plain type
+static RegisterType valueType(RegisterType type) {
+    switch (type) {
+        case RegisterType::UINT32_HIGH_FIRST: return RegisterType::UINT32;
+        case RegisterType::INT32_HIGH_FIRST: return RegisterType::INT32;
+        case RegisterType::FLOAT_HIGH_FIRST: return RegisterType::FLOAT;
+        default: return type;
+    }
+}
+
+static float bitsToFloat(uint32_t raw) {
+    float value;
+    memcpy(&value, &raw, sizeof(value));
+    return value;
+}
+static uint32_t floatToBits(float value) {
+    uint32_t raw;
+    memcpy(&raw, &value, sizeof(raw));
+    return raw;
+}
+
+// --- Switch paths, as in ModbusCache.cpp before the codec ---
+
+static uint32_t extract16BitValue(const uint8_t* buffer, size_t index) {
+    return static_cast<uint32_t>(buffer[index]) << 8 | buffer[index + 1];
+}
+
+static uint32_t extract32BitValue(const uint8_t* buffer, size_t index) {
+    return static_cast<uint32_t>(buffer[index + 2]) << 24 |
+           static_cast<uint32_t>(buffer[index + 3]) << 16 |
+           static_cast<uint32_t>(buffer[index]) << 8 |
+           static_cast<uint32_t>(buffer[index + 1]);
+}
+
+struct Uint16Pair {
+    uint16_t highWord;
+    uint16_t lowWord;
+};
+
+static Uint16Pair split32BitRegister(uint32_t value) {
+    Uint16Pair result;
+    result.highWord = static_cast<uint16_t>(value >> 16);
+    result.lowWord = static_cast<uint16_t>(value & 0xFFFF);
+    return result;
+}
+
+// getScaledValueFromRegister; FLOAT is the reference bit reinterpretation
+static float switchScale(RegisterType type, uint32_t rawValue, float factor) {
+    float value = 0.0;
+    switch (type) {
+        case RegisterType::UINT32:
+            value = static_cast<float>(rawValue);
+            break;
+        case RegisterType::INT32:
+            value = static_cast<float>(static_cast<int32_t>(rawValue));
+            break;
+        case RegisterType::UINT16:
+            value = static_cast<float>(static_cast<uint16_t>(rawValue));
+            break;
+        case RegisterType::INT16:
+            value = static_cast<float>(static_cast<int16_t>(rawValue));
+            break;
+        case RegisterType::FLOAT:
+            value = bitsToFloat(rawValue);
+            break;
+        default:
+            break;
+    }
+    value *= factor;
+    return value;
+}
+
+// updateWaterMarks' comparisons; FLOAT is the reference float comparison
+static bool switchLess(RegisterType type, uint32_t a, uint32_t b) {
+    switch (type) {
+        case RegisterType::UINT32: return a < b;
+        case RegisterType::INT32: return static_cast<int32_t>(a) < static_cast<int32_t>(b);
+        case RegisterType::UINT16: return static_cast<uint16_t>(a) < static_cast<uint16_t>(b);
+        case RegisterType::INT16: return static_cast<int16_t>(a) < static_cast<int16_t>(b);
+        case RegisterType::FLOAT: return bitsToFloat(a) < bitsToFloat(b);
+        default: return false;
+    }
+}
+
+// Saturating reference for fromFloat
+template <typename T>
+static uint32_t referenceFromFloat(float value) {
+    if (std::isnan(value)) return RegisterCodec<T>::encode(0);
+    double rounded = std::round(static_cast<double>(value));
+    rounded = std::max(rounded, static_cast<double>(std::numeric_limits<T>::lowest()));
+    rounded = std::min(rounded, static_cast<double>(std::numeric_limits<T>::max()));
+    return RegisterCodec<T>::encode(static_cast<T>(rounded));
+}
+
+static uint32_t referenceFromFloat(RegisterType type, float value) {
+    switch (valueType(type)) {
+        case RegisterType::UINT16: return referenceFromFloat<uint16_t>(value);
+        case RegisterType::INT16: return referenceFromFloat<int16_t>(value);
+        case RegisterType::UINT32: return referenceFromFloat<uint32_t>(value);
+        case RegisterType::INT32: return referenceFromFloat<int32_t>(value);
+        default: return floatToBits(value);
+    }
+}
+
+// --- Checks ---
+
+static long checked = 0;
+
+static bool fail(RegisterType type, const char* what, uint32_t raw, uint32_t other = 0) {
+    fprintf(stderr, "%s %s: mismatch for 0x%08x (0x%08x)\n", typeNames[static_cast<int>(type)], what, raw, other);
+    return false;
+}
+
+// Wire round trip, scaling and fromFloat of one raw value. The full 32-bit
+// sweep checks one scale factor and leaves fromFloat to the sampled run.
+static bool checkValue(RegisterType type, const RegisterCodecOps& codec, uint32_t raw, bool sweep = false) {
+    uint8_t wire[4];
+    uint16_t words[2];
+    if (codec.words == 1) {
+        wire[0] = raw >> 8;
+        wire[1] = raw;
+        if (codec.fromWire(wire) != extract16BitValue(wire, 0)) return fail(type, "fromWire", raw);
+        codec.toWire(raw, words);
+        if (words[0] != raw) return fail(type, "toWire", raw);
+    } else if (isHighFirst(type)) {
+        wire[0] = raw >> 24;
+        wire[1] = raw >> 16;
+        wire[2] = raw >> 8;
+        wire[3] = raw;
+        if (codec.fromWire(wire) != raw) return fail(type, "fromWire", raw);
+        codec.toWire(raw, words);
+        if (words[0] != (raw >> 16) || words[1] != (raw & 0xFFFF)) return fail(type, "toWire", raw);
+    } else {
+        Uint16Pair pair = split32BitRegister(raw);
+        wire[0] = pair.lowWord >> 8;
+        wire[1] = pair.lowWord;
+        wire[2] = pair.highWord >> 8;
+        wire[3] = pair.highWord;
+        if (codec.fromWire(wire) != extract32BitValue(wire, 0)) return fail(type, "fromWire", raw);
+        codec.toWire(raw, words);
+        if (words[0] != pair.lowWord || words[1] != pair.highWord) return fail(type, "toWire", raw);
+    }
+
+    static const float factors[] = {0.1f, 1.0f, 0.001f, -2.5f};
+    for (float factor : factors) {
+        float expected = switchScale(valueType(type), raw, factor);
+        float got = codec.scale(raw, factor);
+        if (floatToBits(got) != floatToBits(expected) && !(std::isnan(got) && std::isnan(expected))) {
+            return fail(type, "scale", raw, floatToBits(factor));
+        }
+        if (sweep) {
+            checked++;
+            return true;
+        }
+    }
+
+    // Feeding the decoded value back; 16-bit values are exact in a float
+    float asFloat = switchScale(valueType(type), raw, 1.0f);
+    if (!std::isnan(asFloat) && codec.fromFloat(asFloat) != referenceFromFloat(type, asFloat)) {
+        return fail(type, "fromFloat", raw);
+    }
+    if (codec.words == 1 && codec.fromFloat(asFloat) != raw) return fail(type, "fromFloat round trip", raw);
+    checked++;
+    return true;
+}
+
+static bool checkOrder(RegisterType type, const RegisterCodecOps& codec, uint32_t a, uint32_t b) {
+    if (codec.less(a, b) != switchLess(valueType(type), a, b)) return fail(type, "less", a, b);
+    return true;
+}
+
+static bool checkFromFloatEdges(RegisterType type, const RegisterCodecOps& codec) {
+    static const float edges[] = {
+        0.0f, -0.0f, 0.49f, 0.5f, -0.5f, 1.5f, -1.5f, 32767.4f, 32767.6f, -32768.4f, -32768.6f, 65535.4f,
+        65535.6f, -1.0f, 2147483520.0f, 2147483648.0f, -2147483648.0f, -2147483904.0f, 4294967040.0f,
+        4294967296.0f, 1e30f, -1e30f, std::numeric_limits<float>::infinity(),
+        -std::numeric_limits<float>::infinity(), std::numeric_limits<float>::quiet_NaN(),
+    };
+    for (float value : edges) {
+        uint32_t expected = referenceFromFloat(type, value);
+        uint32_t got = codec.fromFloat(value);
+        if (got != expected && !(codec.isFloat && std::isnan(value) && std::isnan(bitsToFloat(got)))) {
+            return fail(type, "fromFloat edge", floatToBits(value), got);
+        }
+    }
+    return true;
+}
+
+static bool runChecks(bool full) {
+    std::mt19937 rng(1);
+    for (size_t t = 0; t < sizeof(allTypes) / sizeof(allTypes[0]); t++) {
+        RegisterType type = allTypes[t];
+        const RegisterCodecOps& codec = registerCodec(type);
+        if (codec.words != (type == RegisterType::UINT16 || type == RegisterType::INT16 ? 1 : 2) ||
+            codec.isFloat != isFloatType(type) ||
+            codec.isSigned != (valueType(type) == RegisterType::INT16 || valueType(type) == RegisterType::INT32 ||
+                               isFloatType(type))) {
+            return fail(type, "flags", 0);
+        }
+        if (!checkFromFloatEdges(type, codec)) return false;
+
+        if (codec.words == 1) {
+            for (uint32_t raw = 0; raw <= 0xFFFF; raw++) {
+                if (!checkValue(type, codec, raw)) return false;
+                if (full) {
+                    for (uint32_t other = 0; other <= 0xFFFF; other++) {
+                        if (!checkOrder(type, codec, raw, other)) return false;
+                    }
+                    continue;
+                }
+                static const uint32_t partners[] = {0, 1, 0x7FFF, 0x8000, 0xFFFF};
+                for (uint32_t other : partners) {
+                    if (!checkOrder(type, codec, raw, other) || !checkOrder(type, codec, other, raw)) return false;
+                }
+                if (!checkOrder(type, codec, raw, (raw + 1) & 0xFFFF)) return false;
+                for (int i = 0; i < 64; i++) {
+                    if (!checkOrder(type, codec, raw, rng() & 0xFFFF)) return false;
+                }
+            }
+            continue;
+        }
+
+        static const uint32_t edges[] = {
+            0, 1, 0xFFFF, 0x10000, 0x7FFFFFFF, 0x80000000, 0xFFFFFFFF, 0x7F800000, 0xFF800000, 0x7FC00000,
+            0x00000001, 0x80000001, 0x3F800000, 0xBF800000,
+        };
+        for (uint32_t a : edges) {
+            if (!checkValue(type, codec, a)) return false;
+            for (uint32_t b : edges) {
+                if (!checkOrder(type, codec, a, b)) return false;
+            }
+        }
+        if (full) {
+            uint32_t raw = 0;
+            do {
+                if (!checkValue(type, codec, raw, true) || !checkOrder(type, codec, raw, raw + 1) ||
+                    !checkOrder(type, codec, raw, ~raw)) {
+                    return false;
+                }
+            } while (++raw != 0);
+        } else {
+            for (int i = 0; i < 4000000; i++) {
+                uint32_t raw = rng();
+                if (!checkValue(type, codec, raw) || !checkOrder(type, codec, raw, rng()) ||
+                    !checkOrder(type, codec, raw, raw + 1)) {
+                    return false;
+                }
+            }
+        }
+    }
+    printf("%ld values and their orderings matched the switch paths\n", checked);
+    return true;
+}
+
+// --- Benchmark ---
+
+// src/main.cpp, ET112 dynamic registers
+static const struct { uint16_t address; RegisterType type; float scale; } et112Dynamic[] = {
+    {0, RegisterType::INT32, 0.1f}, {2, RegisterType::INT32, 0.001f}, {4, RegisterType::INT32, 0.1f},
+    {6, RegisterType::INT32, 0.1f}, {8, RegisterType::INT32, 0.1f}, {10, RegisterType::INT32, 0.1f},
+    {12, RegisterType::INT32, 0.1f}, {14, RegisterType::INT16, 0.001f}, {15, RegisterType::INT16, 0.1f},
+    {16, RegisterType::INT32, 0.1f}, {18, RegisterType::INT32, 0.1f}, {20, RegisterType::INT32, 0.1f},
+    {22, RegisterType::INT32, 0.1f},
+};
+#define ET112_VALUES (sizeof(et112Dynamic) / sizeof(et112Dynamic[0]))
+#define ET112_BYTES 48
+
+struct Marks {
+    uint32_t high[ET112_VALUES];
+    uint32_t low[ET112_VALUES];
+    float scaledSum;
+};
+
+// Per value: extract by width, scale and update the watermarks by type
+static void decodeSwitch(const uint8_t* frame, const RegisterType* types, Marks& marks) {
+    for (size_t i = 0; i < ET112_VALUES; i++) {
+        RegisterType type = types[i];
+        bool is32Bit = type == RegisterType::UINT32 || type == RegisterType::INT32 || type == RegisterType::FLOAT;
+        size_t offset = et112Dynamic[i].address * 2;
+        uint32_t value = is32Bit ? extract32BitValue(frame, offset) : extract16BitValue(frame, offset);
+        marks.scaledSum += switchScale(type, value, et112Dynamic[i].scale);
+        if (switchLess(type, marks.high[i], value)) marks.high[i] = value;
+        if (switchLess(type, value, marks.low[i])) marks.low[i] = value;
+    }
+}
+
+// The same through codecs resolved once, as the decode plan does
+static void decodeCodec(const uint8_t* frame, const RegisterCodecOps* const* codecs, Marks& marks) {
+    for (size_t i = 0; i < ET112_VALUES; i++) {
+        const RegisterCodecOps& codec = *codecs[i];
+        uint32_t value = codec.fromWire(frame + et112Dynamic[i].address * 2);
+        marks.scaledSum += codec.scale(value, et112Dynamic[i].scale);
+        if (codec.less(marks.high[i], value)) marks.high[i] = value;
+        if (codec.less(value, marks.low[i])) marks.low[i] = value;
+    }
+}
+
+static bool runBench(long frames) {
+    std::mt19937 rng(1);
+    std::vector<uint8_t> responses(64 * ET112_BYTES);
+    for (uint8_t& byte : responses) byte = rng();
+
+    // Runtime copies so neither path is specialised on constant types
+    RegisterType types[ET112_VALUES];
+    const RegisterCodecOps* codecs[ET112_VALUES];
+    for (size_t i = 0; i < ET112_VALUES; i++) {
+        types[i] = et112Dynamic[i].type;
+        codecs[i] = &registerCodec(types[i]);
+    }
+
+    Marks switchMarks{};
+    Marks codecMarks{};
+    for (size_t i = 0; i < ET112_VALUES; i++) {
+        switchMarks.low[i] = codecMarks.low[i] = types[i] == RegisterType::INT16 ? 0x7FFF : 0x7FFFFFFF;
+        switchMarks.high[i] = codecMarks.high[i] = types[i] == RegisterType::INT16 ? 0x8000 : 0x80000000;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (long n = 0; n < frames; n++) {
+        decodeSwitch(&responses[(n % 64) * ET112_BYTES], types, switchMarks);
+    }
+    auto middle = std::chrono::steady_clock::now();
+    for (long n = 0; n < frames; n++) {
+        decodeCodec(&responses[(n % 64) * ET112_BYTES], codecs, codecMarks);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    if (memcmp(switchMarks.high, codecMarks.high, sizeof(switchMarks.high)) != 0 ||
+        memcmp(switchMarks.low, codecMarks.low, sizeof(switchMarks.low)) != 0 ||
+        switchMarks.scaledSum != codecMarks.scaledSum) {
+        fprintf(stderr, "bench: the two paths disagree\n");
+        return false;
+    }
+    double switchNs = std::chrono::duration<double, std::nano>(middle - start).count() / frames;
+    double codecNs = std::chrono::duration<double, std::nano>(end - middle).count() / frames;
+    printf("{\n");
+    printf("  \"frames\": %ld,\n", frames);
+    printf("  \"values_per_frame\": %zu,\n", ET112_VALUES);
+    printf("  \"switch_ns_per_frame\": %.1f,\n", switchNs);
+    printf("  \"codec_ns_per_frame\": %.1f\n", codecNs);
+    printf("}\n");
+    return true;
+}
+
+int main(int argc, char** argv) {
+    bool full = false;
+    long frames = 1000000;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--full") == 0) {
+            full = true;
+        } else if (strcmp(argv[i], "--bench") == 0 && i + 1 < argc) {
+            frames = atol(argv[++i]);
+        } else {
+            fprintf(stderr, "usage: %s [--full] [--bench FRAMES]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (frames <= 0) {
+        fprintf(stderr, "--bench needs a positive frame count\n");
+        return 2;
+    }
+    if (!runChecks(full) || !runBench(frames)) return 1;
+    return 0;
+}
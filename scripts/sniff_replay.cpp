@@ -0,0 +1,288 @@
+// Replays a recorded RS485 byte stream through the firmware's passive RTU
+// decoder (src/rtu_sniffer.cpp) and prints every request/response pair it
+// correlates, followed by a JSON summary of the decoder's counters.
+//
+// Reads of unit 1 are also decoded into a cache the way
+// handleSniffedTransaction does it: the byte count check and register walk
+// from src/pdu_checks.cpp and the codecs from src/register_codec.cpp, over
+// the ET112 register map restated from src/main.cpp (keep it in step). The
+// line after each read lists what was cached, "address=value" with the raw
+// value in hex, or "address=-" for a word that was skipped.
+//
+// Build (Linux):
+//   g++ -O2 -std=c++17 -Iinclude -o sniff_replay scripts/sniff_replay.cpp src/rtu_sniffer.cpp src/pdu_checks.cpp src/register_codec.cpp
+//
+// Examples:
+//   ./sniff_replay capture.txt --baud 9600
+//   ./sniff_replay capture.bin --binary --quiet
+//   ./sniff_replay scripts/testdata/sniffer_capture.txt --expect scripts/testdata/sniffer_capture.expected
+//
+// Text captures have one read per line: an optional arrival time in
+// microseconds followed by a colon, then the bytes in hex, e.g.
+//   1532000: 01 03 00 00 00 22 c4 13
+//   1561250: 01 03 44 00 09 ...
+// Blank lines and lines starting with # are skipped. Without arrival times
+// (and for --binary captures) frames are split by length and CRC only, so the
+// T3.5 resync after line noise is not exercised.
+//
+// --expect compares the whole output, transactions and counters, with a file
+// saved from an earlier run and reports the first line that differs. The
+// transactions are compared under --quiet too.
+//
+// Exits with 1 if the capture held no complete transaction or the output does
+// not match --expect.
+
+#include <cctype>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "pdu_checks.h"
+#include "register_codec.h"
+#include "rtu_sniffer.h"
+
+// The ET112's dynamic and static registers from src/main.cpp. 24..31 are not
+// defined, and 11 is both the identification code and the second word of W Demand.
+static const struct {
+    uint16_t address;
+    RegisterType type;
+} et112Registers[] = {
+    {0, RegisterType::INT32},   {2, RegisterType::INT32},   {4, RegisterType::INT32},
+    {6, RegisterType::INT32},   {8, RegisterType::INT32},   {10, RegisterType::INT32},
+    {12, RegisterType::INT32},  {14, RegisterType::INT16},  {15, RegisterType::INT16},
+    {16, RegisterType::INT32},  {18, RegisterType::INT32},  {20, RegisterType::INT32},
+    {22, RegisterType::INT32},  {32, RegisterType::INT32},  {34, RegisterType::INT32},
+    {11, RegisterType::INT16},  {770, RegisterType::UINT16}, {771, RegisterType::UINT16},
+    {4112, RegisterType::UINT32}, {4355, RegisterType::INT16}, {8193, RegisterType::UINT16},
+    {20480, RegisterType::UINT16}, {20481, RegisterType::UINT16}, {20482, RegisterType::UINT16},
+    {20483, RegisterType::UINT16}, {20484, RegisterType::UINT16}, {20485, RegisterType::UINT16},
+    {20486, RegisterType::UINT16},
+};
+
+static std::map<uint16_t, RegisterType> definitions;
+static std::map<uint16_t, uint32_t> cache;
+
+struct Options {
+    std::string path;
+    unsigned long baud = 9600;
+    int bitsPerChar = 10;    // 8N1
+    bool binary = false;
+    bool quiet = false;
+    std::string expectPath;
+};
+
+// Everything emitted, kept for --expect; echo is off for transactions under --quiet
+static std::string output;
+static bool echo = true;
+
+static void emit(const char* format, ...) {
+    char line[2048];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    output += line;
+    if (echo) fputs(line, stdout);
+}
+
+// Returns false and reports the first differing line
+static bool matchesExpected(const std::string& path) {
+    FILE* file = fopen(path.c_str(), "r");
+    if (file == nullptr) {
+        fprintf(stderr, "cannot open %s\n", path.c_str());
+        return false;
+    }
+    std::string expected;
+    char chunk[4096];
+    size_t read;
+    while ((read = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        expected.append(chunk, read);
+    }
+    fclose(file);
+
+    size_t pos = 0;
+    int lineNumber = 1;
+    while (pos < output.size() || pos < expected.size()) {
+        size_t gotEnd = output.find('\n', pos);
+        size_t expectedEnd = expected.find('\n', pos);
+        std::string got = pos < output.size() ? output.substr(pos, gotEnd - pos) : "<end of output>";
+        std::string want = pos < expected.size() ? expected.substr(pos, expectedEnd - pos) : "<end of file>";
+        if (got != want || gotEnd != expectedEnd) {
+            fprintf(stderr, "%s:%d: expected\n  %s\ngot\n  %s\n", path.c_str(), lineNumber, want.c_str(), got.c_str());
+            return false;
+        }
+        if (gotEnd == std::string::npos) break;
+        pos = gotEnd + 1;
+        lineNumber++;
+    }
+    return true;
+}
+
+static void usage(const char* name) {
+    fprintf(stderr, "usage: %s capture [--baud B] [--bits N] [--binary] [--quiet] [--expect FILE]\n", name);
+}
+
+static void printTransaction(const SniffedTransaction& t) {
+    emit("%12llu us  unit %3u  fc %2u  addr %5u  qty %3u  %7.2f ms ",
+         (unsigned long long)t.responseUs, t.unit, t.functionCode, t.startAddress, t.quantity,
+         (t.responseUs - t.requestUs) / 1000.0);
+    if (t.exception) {
+        emit(" exception %u\n", t.response[2]);
+        return;
+    }
+    if (t.functionCode == 3 || t.functionCode == 4) {
+        for (uint16_t i = 3; i + 1 < t.responseLength; i += 2) {
+            emit(" %04x", (t.response[i] << 8) | t.response[i + 1]);
+        }
+    }
+    emit("\n");
+}
+
+// processResponsePayload's generic walk, as handleSniffedTransaction runs it
+static void cacheTransaction(const SniffedTransaction& t) {
+    if (t.unit != 1 || (t.functionCode != 3 && t.functionCode != 4) || t.exception) {
+        return;
+    }
+    emit("%30s cache", "");
+    if (!registerPayloadComplete(t.response, t.responseLength, t.quantity)) {
+        emit(" byte count mismatch\n");
+        return;
+    }
+    const uint8_t* payload = t.response + 3;
+    forEachReadRegister(t.startAddress, t.quantity,
+        [](uint16_t address) -> uint8_t {
+            auto it = definitions.find(address);
+            return it != definitions.end() ? registerCodec(it->second).words : 0;
+        },
+        [payload](uint16_t address, uint16_t payloadOffset, uint8_t words) {
+            if (words == 0) {
+                emit(" %u=-", address);
+                return;
+            }
+            uint32_t value = registerCodec(definitions[address]).fromWire(payload + payloadOffset);
+            cache[address] = value;
+            emit(words == 2 ? " %u=%08x" : " %u=%04x", address, value);
+        });
+    emit("\n");
+}
+
+// Parses "[time:] hex bytes"; false for lines without data
+static bool parseLine(const char* line, uint64_t& arrivalUs, std::vector<uint8_t>& bytes) {
+    bytes.clear();
+    arrivalUs = 0;
+    while (isspace((unsigned char)*line)) line++;
+    if (*line == '\0' || *line == '#') return false;
+
+    const char* colon = strchr(line, ':');
+    if (colon != nullptr) {
+        arrivalUs = strtoull(line, nullptr, 10);
+        line = colon + 1;
+    }
+    int nibbles = 0;
+    uint8_t value = 0;
+    for (; *line; line++) {
+        if (!isxdigit((unsigned char)*line)) {
+            continue;
+        }
+        value = (value << 4) | (isdigit((unsigned char)*line) ? *line - '0' : (tolower(*line) - 'a' + 10));
+        if (++nibbles == 2) {
+            bytes.push_back(value);
+            nibbles = 0;
+            value = 0;
+        }
+    }
+    return !bytes.empty();
+}
+
+int main(int argc, char** argv) {
+    Options opt;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--binary") {
+            opt.binary = true;
+        } else if (arg == "--quiet") {
+            opt.quiet = true;
+        } else if (arg == "--expect" && i + 1 < argc) {
+            opt.expectPath = argv[++i];
+        } else if ((arg == "--baud" || arg == "--bits") && i + 1 < argc) {
+            long value = atol(argv[++i]);
+            if (arg == "--baud") opt.baud = value;
+            else opt.bitsPerChar = value;
+        } else if (arg.rfind("--", 0) != 0 && opt.path.empty()) {
+            opt.path = arg;
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (opt.path.empty() || opt.baud == 0) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    FILE* file = fopen(opt.path.c_str(), opt.binary ? "rb" : "r");
+    if (file == nullptr) {
+        fprintf(stderr, "cannot open %s\n", opt.path.c_str());
+        return 2;
+    }
+
+    for (const auto& reg : et112Registers) {
+        definitions[reg.address] = reg.type;
+    }
+
+    RtuSniffer sniffer;
+    sniffer.begin(opt.baud, opt.bitsPerChar, [&opt](const SniffedTransaction& t) {
+        echo = !opt.quiet;
+        printTransaction(t);
+        cacheTransaction(t);
+        echo = true;
+    });
+
+    uint64_t lastArrivalUs = 0;
+    if (opt.binary) {
+        uint8_t chunk[256];
+        size_t read;
+        while ((read = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+            sniffer.feed(chunk, read, 0);
+        }
+    } else {
+        char line[4096];
+        std::vector<uint8_t> bytes;
+        uint64_t arrivalUs;
+        while (fgets(line, sizeof(line), file) != nullptr) {
+            if (!parseLine(line, arrivalUs, bytes)) continue;
+            // What the firmware's read loop would have seen between the two reads
+            if (arrivalUs != 0 && lastArrivalUs != 0) {
+                sniffer.idle(arrivalUs - bytes.size() * (1000000ULL * opt.bitsPerChar / opt.baud));
+            }
+            sniffer.feed(bytes.data(), bytes.size(), arrivalUs);
+            if (arrivalUs != 0) lastArrivalUs = arrivalUs;
+        }
+    }
+    fclose(file);
+    if (lastArrivalUs != 0) {
+        sniffer.idle(lastArrivalUs + 1000000);
+    }
+
+    emit("{\n");
+    emit("  \"baud\": %lu,\n", opt.baud);
+    emit("  \"t35_us\": %u,\n", sniffer.getT35Us());
+    emit("  \"frames\": %u,\n", sniffer.getFrames());
+    emit("  \"transactions\": %u,\n", sniffer.getTransactions());
+    emit("  \"exceptions\": %u,\n", sniffer.getExceptions());
+    emit("  \"unanswered\": %u,\n", sniffer.getUnanswered());
+    emit("  \"orphan_responses\": %u,\n", sniffer.getOrphanResponses());
+    emit("  \"crc_errors\": %u,\n", sniffer.getCrcErrors());
+    emit("  \"discarded_bytes\": %u,\n", sniffer.getDiscardedBytes());
+    emit("  \"cached_registers\": %zu\n", cache.size());
+    emit("}\n");
+    if (!opt.expectPath.empty() && !matchesExpected(opt.expectPath)) {
+        return 1;
+    }
+    return sniffer.getTransactions() > 0 ? 0 : 1;
+}
@@ -0,0 +1,100 @@
+#!/usr/bin/env python3
+"""
+Minimal Syslog Collector for the Remote Syslog Shipper
+
+Listens on UDP and TCP at the same port and prints every record the proxy
+ships. UDP datagrams carry several newline-separated records; TCP uses RFC 6587
+octet counting. Per-second record and byte counts are printed so the
+configured bandwidth cap can be checked.
+
+Usage:
+    python3 scripts/syslog_listener.py [--port 5514] [--quiet]
+"""
+
+import argparse
+import socket
+import threading
+import time
+
+stats_lock = threading.Lock()
+stats = {"records": 0, "bytes": 0, "datagrams": 0}
+
+
+def record(line, quiet):
+    with stats_lock:
+        stats["records"] += 1
+    if not quiet:
+        print(line)
+
+
+def serve_udp(port, quiet):
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.bind(("0.0.0.0", port))
+    while True:
+        data, _ = sock.recvfrom(65535)
+        with stats_lock:
+            stats["datagrams"] += 1
+            stats["bytes"] += len(data)
+        for line in data.decode("utf-8", "replace").split("\n"):
+            if line:
+                record(line, quiet)
+
+
+def serve_tcp_client(conn, quiet):
+    buffer = b""
+    with conn:
+        while True:
+            data = conn.recv(4096)
+            if not data:
+                return
+            with stats_lock:
+                stats["bytes"] += len(data)
+            buffer += data
+            # Octet counting: "<length> <message>"
+            while b" " in buffer:
+                length_text, rest = buffer.split(b" ", 1)
+                if not length_text.isdigit():
+                    print("!! framing error, dropping connection")
+                    return
+                length = int(length_text)
+                if len(rest) < length:
+                    break
+                record(rest[:length].decode("utf-8", "replace"), quiet)
+                buffer = rest[length:]
+
+
+def serve_tcp(port, quiet):
+    sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    sock.bind(("0.0.0.0", port))
+    sock.listen(4)
+    while True:
+        conn, address = sock.accept()
+        print(f"-- TCP connection from {address[0]}")
+        threading.Thread(target=serve_tcp_client, args=(conn, quiet), daemon=True).start()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Print syslog records shipped by the proxy")
+    parser.add_argument("--port", type=int, default=5514, help="UDP and TCP port (default 5514)")
+    parser.add_argument("--quiet", action="store_true", help="only print per-second totals")
+    args = parser.parse_args()
+
+    threading.Thread(target=serve_udp, args=(args.port, args.quiet), daemon=True).start()
+    threading.Thread(target=serve_tcp, args=(args.port, args.quiet), daemon=True).start()
+    print(f"Listening on UDP and TCP port {args.port}")
+
+    last = dict(stats)
+    while True:
+        time.sleep(1)
+        with stats_lock:
+            current = dict(stats)
+        if current != last:
+            print(f"-- {current['records'] - last['records']} records, "
+                  f"{current['bytes'] - last['bytes']} bytes/s, "
+                  f"{current['datagrams'] - last['datagrams']} datagrams")
+        last = current
+
+
+if __name__ == "__main__":
+    main()
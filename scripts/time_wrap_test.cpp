@@ -0,0 +1,136 @@
+// Runs the firmware's time service (src/time_service.cpp) on a simulated
+// esp_timer clock across the points where the old 32-bit counters wrapped:
+// micros() after 71.6 minutes and millis() after 49.7 days, and on to ten
+// years of uptime. Checks that intervals, register ages, the watchdog's
+// time-since-update and the wall-clock mapping stay exact across each of
+// them, and that an SNTP correction moves wall-clock time only.
+//
+// Build (Linux):
+//   g++ -O2 -std=c++17 -Iinclude -o time_wrap_test scripts/time_wrap_test.cpp src/time_service.cpp
+//
+// Examples:
+//   ./time_wrap_test
+//
+// Exits with 1 on the first mismatch.
+
+#include <sys/time.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+
+#include "time_service.h"
+
+static int64_t clockUs = 0;
+
+extern "C" int64_t esp_timer_get_time() {
+    return clockUs;
+}
+
+#define UNIX_START_MS 1760000000000ULL   // Wall-clock time at the first sync
+
+static void sync(uint64_t unixMs) {
+    struct timeval tv;
+    tv.tv_sec = unixMs / 1000;
+    tv.tv_usec = (unixMs % 1000) * 1000;
+    TimeService::onSync(&tv);
+}
+
+// Steps the clock from 60 s before boundaryUs to 60 s after it and checks every
+// interval the firmware derives from it. Counts how often the 32-bit clocks
+// would have gone backwards, which the old code had to special-case.
+static bool crossBoundary(const char* name, uint64_t boundaryUs, std::mt19937& rng) {
+    clockUs = boundaryUs - 60000000;
+    uint64_t syncUs = clockUs;
+    uint64_t syncUnixMs = UNIX_START_MS + boundaryUs / 1000 - 60000;
+    sync(syncUnixMs);
+
+    uint64_t lastMs = TimeService::millis64();
+    uint64_t lastUpdateMs = lastMs;           // lastSuccessfulUpdate
+    uint64_t registerStampUs = TimeService::micros64();
+    uint32_t last32Ms = static_cast<uint32_t>(lastMs);
+    uint32_t last32Us = static_cast<uint32_t>(clockUs);
+    int backwards32 = 0;
+
+    while (static_cast<uint64_t>(clockUs) < boundaryUs + 60000000) {
+        uint64_t stepUs = 1000 * (50 + rng() % 450) + rng() % 1000;
+        clockUs += stepUs;
+
+        uint64_t nowMs = TimeService::millis64();
+        uint64_t nowUs = TimeService::micros64();
+        if (nowUs != static_cast<uint64_t>(clockUs) || nowMs < lastMs || nowMs - lastMs > stepUs / 1000 + 1) {
+            fprintf(stderr, "%s: monotonic clock jumped at %llu us\n", name, (unsigned long long)nowUs);
+            return false;
+        }
+
+        // updateServerStatus: time since the last good poll, updated every ~2 s
+        uint64_t sinceUpdate = nowMs - lastUpdateMs;
+        if (sinceUpdate > 2500) {
+            fprintf(stderr, "%s: time since update %llu ms at %llu us\n", name,
+                    (unsigned long long)sinceUpdate, (unsigned long long)nowUs);
+            return false;
+        }
+        if (sinceUpdate >= 2000) lastUpdateMs = nowMs;
+
+        // buildCacheImage: register age in ms from its micros64() stamp
+        uint64_t ageMs = (nowUs - registerStampUs) / 1000;
+        if (ageMs > 1500) {
+            fprintf(stderr, "%s: register age %llu ms\n", name, (unsigned long long)ageMs);
+            return false;
+        }
+        if (ageMs >= 1000) registerStampUs = nowUs;
+
+        // Wall-clock time follows the monotonic clock exactly between syncs
+        uint64_t unixMs = timeService.unixMs();
+        uint64_t expectedUnixMs = (syncUnixMs * 1000 + (nowUs - syncUs)) / 1000;
+        if (unixMs != expectedUnixMs) {
+            fprintf(stderr, "%s: wall clock %llu ms, expected %llu ms\n", name,
+                    (unsigned long long)unixMs, (unsigned long long)expectedUnixMs);
+            return false;
+        }
+
+        uint32_t now32Ms = static_cast<uint32_t>(nowMs);
+        uint32_t now32Us = static_cast<uint32_t>(nowUs);
+        if (now32Ms < last32Ms || now32Us < last32Us) backwards32++;
+        last32Ms = now32Ms;
+        last32Us = now32Us;
+        lastMs = nowMs;
+    }
+    printf("%s: exact across the boundary, 32-bit clocks went backwards %d times\n", name, backwards32);
+    return true;
+}
+
+static bool resync() {
+    // A sync 20 ms ahead of the current mapping steps wall-clock time only
+    uint64_t unixMs = timeService.unixMs();
+    sync(unixMs);
+    clockUs += 1000000;
+    uint64_t beforeUs = TimeService::micros64();
+    uint64_t beforeUnixMs = timeService.unixMs();
+    uint32_t syncs = timeService.getSyncCount();
+    sync(beforeUnixMs + 20);
+    if (TimeService::micros64() != beforeUs || timeService.unixMs() != beforeUnixMs + 20 ||
+        timeService.getLastStepUs() != 20000 || timeService.getSyncCount() != syncs + 1 ||
+        timeService.getLastSyncUs() != beforeUs) {
+        fprintf(stderr, "resync: step %lld us, wall clock %lld ms\n", (long long)timeService.getLastStepUs(),
+                (long long)(timeService.unixMs() - beforeUnixMs));
+        return false;
+    }
+    printf("resync: wall clock stepped 20 ms, monotonic clock untouched\n");
+    return true;
+}
+
+int main() {
+    std::mt19937 rng(1);
+
+    if (timeService.isSynced() || timeService.unixMs() != 0) {
+        fprintf(stderr, "unsynced: wall clock reported before the first sync\n");
+        return 1;
+    }
+    if (!crossBoundary("micros() wrap (71.6 min)", 1ULL << 32, rng)) return 1;
+    if (!crossBoundary("millis() wrap (49.7 days)", (1ULL << 32) * 1000, rng)) return 1;
+    if (!crossBoundary("second millis() wrap (99.4 days)", (1ULL << 33) * 1000, rng)) return 1;
+    if (!crossBoundary("ten years", 10ULL * 365 * 86400 * 1000000, rng)) return 1;
+    if (!resync()) return 1;
+    return 0;
+}
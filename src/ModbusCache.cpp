@@ -1,6 +1,11 @@
 #include "ModbusCache.h"
 #include "debug.h"
 #include "wifi_utils.h"
+#include "bus_stats.h"
+#include "turnaround_stats.h"
+#include "event_engine.h"
+#include "rtu_gateway.h"
+#include "time_service.h"
 #include <unordered_set>
 #include <functional>
 #include <algorithm>
@@ -8,12 +13,15 @@
 #include <iomanip>
 #include <sstream>
 #include <esp_wifi.h>  // Add this at the top with other includes
+#include <HTTPClient.h>
 
 extern Config config;
 
 // Global variables for token and response handling
 uint32_t globalToken = 0;
 
+constexpr uint32_t ModbusCache::SERVED_AGE_BUCKET_MS[SERVED_AGE_BUCKETS];
+
 // Constants for request management 
 #define MAX_PENDING_REQUESTS 20  // Maximum number of pending requests allowed
 #define REQUEST_TIMEOUT_MS 5000  // Timeout for requests in milliseconds
@@ -50,6 +58,31 @@ void printHex(const uint8_t *buffer, size_t length) {
     dbgln(hexBuffer);
 }
 
+// Character length on the secondary (server side) serial line: start, data, parity and stop bits
+static uint8_t serverBitsPerChar() {
+    uint8_t stopBits = config.getModbusStopBits2() == 1 ? 1 : 2;
+    return 1 + config.getModbusDataBits2() + (config.getModbusParity2() ? 1 : 0) + stopBits;
+}
+
+// Character length on the primary (client side) serial line to the meter
+static uint8_t clientBitsPerChar() {
+    uint8_t stopBits = config.getModbusStopBits() == 1 ? 1 : 2;
+    return 1 + config.getModbusDataBits() + (config.getModbusParity() ? 1 : 0) + stopBits;
+}
+
+// Serial rate for each value of CG_BAUD_REGISTER, 1-based
+static const unsigned long cgBaudRates[] = {9600, 19200, 38400, 57600, 115200};
+
+// CG_BAUD_REGISTER value for a serial rate, 0 if the meter has no such setting
+static uint16_t cgBaudCode(unsigned long baudRate) {
+    for (uint16_t i = 0; i < sizeof(cgBaudRates) / sizeof(cgBaudRates[0]); i++) {
+        if (cgBaudRates[i] == baudRate) {
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
 // Initialize static instance pointer
 ModbusCache *ModbusCache::instance = nullptr;
 
@@ -80,8 +113,9 @@ ModbusCache::ModbusCache(const std::vector<ModbusRegister>& dynamicRegisters,
     initializeRegisters(dynamicRegisters, staticRegisters);
     // We must define the client, even if we don't use it, to avoid a null pointer exception
     modbusRTUClient = new ModbusClientRTU(config.getModbusRtsPin(), 10); // queuelimit 10
-    modbusRTUClient->setTimeout(1000);
+    modbusRTUClient->setTimeout(RTU_CLIENT_TIMEOUT_MS);
     if(config.getClientIsRTU()) {
+        clientBaudRate = config.getModbusBaudRate();
         RTUutils::prepareHardwareSerial(modbusClientSerial);
         #if defined(RX_PIN) && defined(TX_PIN)
             // use rx and tx-pins if defined in platformio.ini
@@ -92,9 +126,21 @@ ModbusCache::ModbusCache(const std::vector<ModbusRegister>& dynamicRegisters,
             modbusClientSerial.begin(config.getModbusBaudRate(), config.getModbusConfig());
         #endif
         
-        // Running the RTU client on Core 1 (separate from WiFi on Core 0)
-        // to reduce interference between UART and WiFi operations
-        modbusRTUClient->begin(modbusClientSerial, RTU_client_core);
+        snifferActive = config.getSnifferMode();
+        if (snifferActive) {
+            // Another master owns the bus: keep the transceiver in receive mode
+            // and leave the serial port to the sniffer task
+            if (config.getModbusRtsPin() >= 0) {
+                pinMode(config.getModbusRtsPin(), OUTPUT);
+                digitalWrite(config.getModbusRtsPin(), LOW);
+            }
+            // Hand bytes over after one quiet character instead of ten, arrival times feed the T3.5 check
+            modbusClientSerial.setRxTimeout(1);
+        } else {
+            // Running the RTU client on Core 1 (separate from WiFi on Core 0)
+            // to reduce interference between UART and WiFi operations
+            modbusRTUClient->begin(modbusClientSerial, RTU_client_core);
+        }
     }
     
     if (serverIPString == "127.0.0.1") {
@@ -138,9 +184,22 @@ void ModbusCache::begin() {
     // Modbus RTU server will run on Core 1 (separate from WiFi on Core 0)
     // This separation helps prevent WiFi disconnections caused by UART operations
     
-    // Register worker function
-    modbusRTUServer.registerWorker(1, ANY_FUNCTION_CODE, &ModbusCache::respondFromCache);
-    MBserver.registerWorker(1, ANY_FUNCTION_CODE, &ModbusCache::respondFromCache);
+    // Register worker function, timed per server for the turnaround histograms
+    turnaroundStats.setBudgetMs(config.getResponseBudget());
+    turnaroundStats.setSerialFormat(ServerKind::RTU, config.getModbusBaudRate2(), serverBitsPerChar());
+    modbusRTUServer.registerWorker(1, ANY_FUNCTION_CODE,
+                                   turnaroundStats.wrap(ServerKind::RTU, &ModbusCache::respondFromCache));
+    MBserver.registerWorker(1, ANY_FUNCTION_CODE,
+                            turnaroundStats.wrap(ServerKind::TCP, &ModbusCache::respondFromCache));
+
+    // Other unit IDs on the RS485 bus are passed through to the RTU client
+    if (config.getClientIsRTU()) {
+        busStats.begin(config.getModbusBaudRate(), clientBitsPerChar());
+    }
+    if (config.getClientIsRTU() && !snifferActive) {
+        rtuGateway.begin(modbusRTUClient, config.getGatewayUnits(), config.getGatewayShare(),
+                         config.getModbusBaudRate(), clientBitsPerChar());
+    }
 
     // Start the Modbus RTU server explicitly on Core 1
     modbusRTUServer.begin(modbusServerSerial, 1);  // Force Core 1
@@ -148,14 +207,43 @@ void ModbusCache::begin() {
     // Optimize TCP server for multiple clients with multiple in-flight requests
     // Increase max connections from default 20 to 30 for better handling of multiple clients
     // Keep the timeout from config for consistency
-    MBserver.start(config.getTcpPort3(), 30, config.getTcpTimeout());
+    // MBserver workers must answer before returning, which would hold up the shared
+    // AsyncTCP task for a whole pass-through round trip; the socket server can defer
+    if (config.getTcpSocketServer() || rtuGateway.isEnabled()) {
+        if (!config.getTcpSocketServer()) {
+            dbgln("[ModbusCache] Pass-through units configured, serving Modbus TCP from the socket task");
+        }
+        startSocketServer();
+    } else {
+        MBserver.start(config.getTcpPort3(), 30, config.getTcpTimeout());
+    }
+
+    // Raw RTU frames over TCP (serial-server style), answered from the same cache
+    rtuTcpServer.begin(config.getTcpPort4(), 1, config.getTcpTimeout(),
+                       turnaroundStats.wrap(ServerKind::RTU_TCP, &ModbusCache::respondFromCache));
 
     // Set update_interval from config
     update_interval = config.getPollingInterval();
-
-    if(config.getClientIsRTU()) {
+    pendingDemand.reserve(DEMAND_MAX_PENDING);
+    demandStartTime = millis();
+    demandPolling = config.getDemandPolling();
+    prefetch = config.getPrefetch();
+
+    if (snifferActive) {
+        // Nothing is sent: the cache fills from the responses to the other master's polls
+        sniffer.begin(config.getModbusBaudRate(), clientBitsPerChar(), [this](const SniffedTransaction& transaction) {
+            handleSniffedTransaction(transaction);
+        });
+        xTaskCreatePinnedToCore(snifferTask, "sniffer", 4096, this, 2, nullptr, RTU_client_core);
+        dbgln("Sniffer mode: listening on the RS485 bus, T3.5 = " + String(sniffer.getT35Us()) + "us");
+    } else if(config.getClientIsRTU()) {
         modbusRTUClient->onDataHandler(&ModbusCache::handleData);
         modbusRTUClient->onErrorHandler(&ModbusCache::handleError);
+
+        // Check the meter answers at the configured rate before the first poll, the
+        // same task later runs baud-rate switches requested from the web UI
+        busPaused = true;
+        xTaskCreatePinnedToCore(baudTask, "baud", 4096, this, 1, &baudTaskHandle, 0);
     } else {
         modbusTCPClient->setMaxInflightRequests(10);
         dbgln("Setting up TCP client to [" + serverIP.toString() + "]:[" + String(serverPort)+"]");
@@ -164,9 +252,16 @@ void ModbusCache::begin() {
         delay(500);
         modbusTCPClient->onDataHandler(&ModbusCache::handleData);
         modbusTCPClient->onErrorHandler(&ModbusCache::handleError);
+
+        // Pull the primary's whole cache image over HTTP instead of polling register ranges
+        if (config.getBulkSync()) {
+            bulkSyncActive = true;
+            xTaskCreatePinnedToCore(bulkSyncTask, "bulkSync", 6144, this, 1, nullptr, 0);
+            dbgln("Bulk cache sync from http://" + serverIP.toString() + "/cache.bin enabled");
+        }
     }
     // Initialize lastSuccessfulUpdate to current time
-    unsigned long currentTime = millis();
+    uint64_t currentTime = TimeService::millis64();
     instance->lastSuccessfulUpdate = currentTime;
     
     // Debug the current millis value and the value of lastSuccessfulUpdate
@@ -178,6 +273,45 @@ void ModbusCache::begin() {
     initializePollGroups();
 }
 
+void ModbusCache::startSocketServer() {
+    MBSworker cacheWorker = turnaroundStats.wrap(ServerKind::TCP, &ModbusCache::respondFromCache);
+
+    // Same unit IDs MBserver would have; pass-through requests are answered
+    // through complete() once the slave has, the socket task never waits for the bus
+    auto handler = [this, cacheWorker](const uint8_t* request, uint16_t length,
+                                       uint8_t* response, uint16_t capacity, uint32_t ticket) -> uint16_t {
+        uint8_t unit = request[0];
+        uint8_t functionCode = request[1];
+        ModbusMessage message;
+        message.add(request, length);
+
+        ModbusMessage reply;
+        const std::vector<uint8_t>& units = rtuGateway.getUnits();
+        if (unit == 1) {
+            reply = cacheWorker(message);
+        } else if (rtuGateway.isEnabled() && std::find(units.begin(), units.end(), unit) != units.end()) {
+            rtuGateway.submit(message, [this, ticket](const ModbusMessage& answer) {
+                socketServer.complete(ticket, answer.data(), answer.size());
+            });
+            return MB_SOCKET_DEFERRED;
+        } else {
+            reply.setError(unit, functionCode, GATEWAY_TARGET_NO_RESP);
+        }
+        if (reply.size() == 0) {
+            // Cache not ready or busy
+            reply.setError(unit, functionCode, SERVER_DEVICE_BUSY);
+        }
+
+        uint16_t size = min<uint16_t>(reply.size(), capacity);
+        memcpy(response, reply.data(), size);
+        return size;
+    };
+
+    if (!socketServer.begin(config.getTcpPort3(), config.getTcpTimeout(), handler) || !socketServer.start()) {
+        logErrln("[ModbusCache] Socket server failed to start on port " + String(config.getTcpPort3()));
+    }
+}
+
 void ModbusCache::resetConnection() {
     if (xSemaphoreTakeRecursive(mutex, pdMS_TO_TICKS(100))) {
         // Purge all tokens
@@ -202,8 +336,8 @@ void ModbusCache::resetConnection() {
     }
 
     // Reset relevant flags
-    instance->lastSuccessfulUpdate = millis();
-    dbgln("[resetConnection] Current millis: " + String(millis()));
+    instance->lastSuccessfulUpdate = TimeService::millis64();
+    dbgln("[resetConnection] Current millis: " + String(TimeService::millis64()));
     dbgln("[resetConnection] Last successful update: " + String(instance->lastSuccessfulUpdate));
     staticRegistersFetched = false;
     dynamicRegistersFetched = false;
@@ -218,7 +352,7 @@ void ModbusCache::initializeRegisters(const std::vector<ModbusRegister>& dynamic
         registers.push_back(reg);
         registerDefinitions.insert({reg.address, reg});
         
-        if (reg.type == RegisterType::UINT32 || reg.type == RegisterType::INT32 || reg.type == RegisterType::FLOAT) {
+        if (is32BitRegisterType(reg)) {
             register32BitValues[reg.address] = 0; // Initialize with default value
         } else {
             register16BitValues[reg.address] = 0; // Initialize with default value
@@ -232,7 +366,7 @@ void ModbusCache::initializeRegisters(const std::vector<ModbusRegister>& dynamic
         registers.push_back(reg);
         registerDefinitions.insert({reg.address, reg});
 
-        if (reg.type == RegisterType::UINT32 || reg.type == RegisterType::INT32) {
+        if (is32BitRegisterType(reg)) {
             if (register32BitValues.find(reg.address) == register32BitValues.end()) {
                 register32BitValues[reg.address] = 0; // Initialize if not already present
             }
@@ -278,15 +412,16 @@ std::vector<uint16_t> ModbusCache::getRegisterValues(uint16_t startAddress, uint
     uint16_t currentAddress = startAddress;
     
     while (i < count) {
-        if (is32BitRegister(currentAddress)) {
-            // Handle 32-bit register
-            uint32_t value32 = read32BitRegister(currentAddress);
-            Uint16Pair pair = split32BitRegister(value32);
+        auto def = registerDefinitions.find(currentAddress);
+        if (def != registerDefinitions.end() && is32BitRegisterType(def->second)) {
+            // Handle 32-bit register, words in the register's wire order
+            uint16_t words[2];
+            registerCodec(def->second.type).toWire(read32BitRegister(currentAddress), words);
             
-            values.push_back(pair.lowWord);
-            if (i + 1 < count) { // Only add high word if we haven't reached the requested count
-                values.push_back(pair.highWord);
-                i++; // Count the high word
+            values.push_back(words[0]);
+            if (i + 1 < count) { // Only add the second word if we haven't reached the requested count
+                values.push_back(words[1]);
+                i++; // Count the second word
             }
             
             currentAddress += 2; // Move to the next register after the 32-bit one
@@ -308,6 +443,11 @@ uint16_t ModbusCache::read16BitRegister(uint16_t address) {
         return it->second;
     }
     
+    uint16_t demandValue;
+    if (readDemandRegister(address, demandValue)) {
+        return demandValue;
+    }
+    
     // Add this address to the set of unexpected registers
     // Only in debug mode to avoid unnecessary operations in production
     #ifdef DEBUG_MODE
@@ -335,13 +475,6 @@ uint32_t ModbusCache::read32BitRegister(uint16_t address) {
     return 0; // Placeholder for non-existent register
 }
 
-Uint16Pair ModbusCache::split32BitRegister(uint32_t value) {
-    Uint16Pair result;
-    result.highWord = static_cast<uint16_t>(value >> 16); // Extract the high word
-    result.lowWord = static_cast<uint16_t>(value & 0xFFFF); // Extract the low word
-    return result;
-}
-
 void ModbusCache::logWithCollapsing(const String& message) {
     unsigned long currentTime = millis();
     
@@ -381,9 +514,44 @@ void ModbusCache::logWithCollapsing(const String& message) {
 void ModbusCache::update() {
     unsigned long currentMillis = millis();
 
+    // The bulk sync or sniffer task keeps the cache filled, only the status needs updating
+    if (bulkSyncActive || snifferActive) {
+        if (currentMillis - lastPollStart >= update_interval) {
+            lastPollStart = currentMillis;
+            updateServerStatus();
+        }
+        return;
+    }
+
+    // A baud-rate probe or switch owns the bus, nothing may be queued on the RTU client;
+    // pass-through requests waiting for it still time out
+    if (busPaused) {
+        rtuGateway.schedule(false, 0);
+        return;
+    }
+
     // First, purge any aged tokens to clean up timed-out requests
     purgeAgedTokens();
 
+    // Let pass-through requests use the bus between cache polls
+    if (rtuGateway.isEnabled()) {
+        bool pollInFlight = false;
+        for (const auto& range : registerRanges) {
+            if (range.inFlight) {
+                pollInFlight = true;
+                break;
+            }
+        }
+        unsigned long sinceLastPoll = currentMillis - lastPollStart;
+        unsigned long slack = sinceLastPoll < update_interval ? update_interval - sinceLastPoll : 0;
+        rtuGateway.schedule(!pollInFlight, slack);
+    }
+
+    // Aligned prefetches run between the polling grid's passes
+    if (prefetch && staticRegistersFetched) {
+        prefetchRanges(currentMillis);
+    }
+
     if (currentMillis - lastPollStart >= update_interval) {
         dbgln("[update] Updating Modbus Cache");
         lastPollStart = currentMillis;
@@ -420,10 +588,16 @@ void ModbusCache::update() {
                 dbgln("[update] All static registers fetched");
             }
         } else {
+            // Turn client reads outside the poll set into new ranges
+            if (demandPolling) {
+                growDemandRanges();
+            }
+
             // Process dynamic registers
             size_t dynamicRangeCount = 0;
             for (auto& range : registerRanges) {
-                if (!range.isStatic) {
+                if (!range.isStatic && !range.retired && !prefetchOwns(range, currentMillis) &&
+                    currentMillis - range.lastRequestTime >= demandPollInterval(range, currentMillis)) {
                     // Find the index of this range among dynamic ranges
                     size_t rangeIndex = 0;
                     size_t totalDynamicRanges = 0;
@@ -512,6 +686,49 @@ void ModbusCache::initializeRegisterRanges() {
         // Add the last range
         registerRanges.push_back({startAddress, regCount, false, 0, false});
     }
+
+    for (auto& range : registerRanges) {
+        buildDecodePlan(range);
+    }
+
+    // Grown ranges are appended while other tasks hold references into the
+    // vector under the mutex; reserving the maximum keeps them from reallocating it
+    registerRanges.reserve(registerRanges.size() + DEMAND_MAX_RANGES);
+}
+
+void ModbusCache::buildDecodePlan(RegisterRange& range) {
+    range.decodePlan.clear();
+    uint16_t payloadOffset = 0;
+
+    for (uint16_t i = 0; i < range.regCount; ++i) {
+        uint16_t address = range.startAddress + i;
+        auto it = registerDefinitions.find(address);
+        if (it == registerDefinitions.end()) {
+            payloadOffset += 2;
+            continue;
+        }
+
+        DecodeStep step;
+        step.address = address;
+        step.payloadOffset = static_cast<uint8_t>(payloadOffset);
+        step.codec = &registerCodec(it->second.type);
+        step.is32Bit = step.codec->words == 2;
+        step.definition = &it->second;
+        // Map nodes are never erased, so the slot pointers stay valid
+        step.slot32 = step.is32Bit ? &register32BitValues[address] : nullptr;
+        step.slot16 = step.is32Bit ? nullptr : &register16BitValues[address];
+        step.timestamp = &registerTimestamps[address];
+        step.fetchedSet = isStaticRegister(address) ? &fetchedStaticRegisters
+                        : isDynamicRegister(address) ? &fetchedDynamicRegisters : nullptr;
+        range.decodePlan.push_back(step);
+
+        if (step.is32Bit) {
+            payloadOffset += 4;
+            i++;
+        } else {
+            payloadOffset += 2;
+        }
+    }
 }
 
 void ModbusCache::processRegisterRange(RegisterRange& range) {
@@ -557,7 +774,7 @@ void ModbusCache::processRegisterRange(RegisterRange& range) {
     uint32_t currentToken = globalToken++;
     
     if (xSemaphoreTakeRecursive(mutex, pdMS_TO_TICKS(10))) { // Reduced timeout from 100ms to 10ms
-        requestMap[currentToken] = std::make_tuple(range.startAddress, range.regCount, currentTime);
+        requestMap[currentToken] = std::make_tuple(range.startAddress, range.regCount, TimeService::micros64());
         xSemaphoreGiveRecursive(mutex);
         yield(); // Give WiFi time after mutex operations
     } else {
@@ -582,65 +799,259 @@ void ModbusCache::processRegisterRange(RegisterRange& range) {
     delay(10);
 }
 
-void ModbusCache::updateWaterMarks(uint16_t address, uint32_t value, bool is32Bit) {
-    auto it = registerDefinitions.find(address);
-    if (it == registerDefinitions.end()) {
-        // Handle error or log: register definition not found
-        return;
+void ModbusCache::setDemandPolling(bool enabled) {
+    if (demandPolling.load() == enabled) return;
+    if (xSemaphoreTakeRecursive(mutex, pdMS_TO_TICKS(100))) {
+        // Start from a clean slate so stale read history does not mark ranges cold
+        for (auto& range : registerRanges) {
+            range.lastReadTime = 0;
+            range.readIntervalMs = 0;
+        }
+        pendingDemand.clear();
+        demandStartTime = millis();
+        demandPolling = enabled;
+        xSemaphoreGiveRecursive(mutex);
     }
-    const ModbusRegister& reg = it->second;
+    dbgln(String("[demand] Demand-driven polling ") + (enabled ? "enabled" : "disabled"));
+}
 
-    // Convert the value to signed or unsigned based on the register definition before comparison
-    if (is32Bit) {
-        if (reg.type == RegisterType::UINT32) {
-            // Directly compare and update without needing to read the current value
-            if (highWaterMarks.find(address) == highWaterMarks.end() || value > highWaterMarks[address]) {
-                highWaterMarks[address] = value;
-            }
-            if (lowWaterMarks.find(address) == lowWaterMarks.end() || value < lowWaterMarks[address]) {
-                lowWaterMarks[address] = value;
-            }
-        } else if (reg.type == RegisterType::INT32) {
-            int32_t signedValue = static_cast<int32_t>(value);
-            // Direct comparison without reading the current value again
-            if (highWaterMarks.find(address) == highWaterMarks.end() || signedValue > static_cast<int32_t>(highWaterMarks[address])) {
-                highWaterMarks[address] = static_cast<uint32_t>(signedValue);
-            }
-            if (lowWaterMarks.find(address) == lowWaterMarks.end() || signedValue < static_cast<int32_t>(lowWaterMarks[address])) {
-                lowWaterMarks[address] = static_cast<uint32_t>(signedValue);
-            }
+// Called from respondFromCache with the mutex held
+void ModbusCache::recordClientRead(uint16_t address, uint16_t count) {
+    unsigned long now = millis();
+    uint32_t end = static_cast<uint32_t>(address) + count;
+    uint32_t covered = 0;
+    uint32_t oldestMs = 0;
+    bool aged = false;
+
+    for (auto& range : registerRanges) {
+        uint32_t rangeEnd = static_cast<uint32_t>(range.startAddress) + range.regCount;
+        if (range.startAddress >= end || rangeEnd <= address) {
+            continue;
+        }
+        covered += min(rangeEnd, end) - max<uint32_t>(range.startAddress, address);
+        if (range.lastReadTime != 0) {
+            // Smooth over 4 reads; several clients reading the same range blend into one rate
+            uint32_t interval = now - range.lastReadTime;
+            range.readIntervalMs = range.readIntervalMs == 0 ? interval
+                                 : (range.readIntervalMs * 3 + interval) / 4;
         }
-    } else { // 16-bit logic
-        if (reg.type == RegisterType::UINT16) {
-            uint16_t newValue = static_cast<uint16_t>(value);
-            // Again, direct comparison without the need for current value
-            if (highWaterMarks.find(address) == highWaterMarks.end() || newValue > static_cast<uint16_t>(highWaterMarks[address])) {
-                highWaterMarks[address] = newValue;
+        range.lastReadTime = now;
+        range.reads++;
+        range.clientPhase.observe(now);
+
+        if (!range.isStatic && range.lastCommitTime != 0) {
+            oldestMs = max<uint32_t>(oldestMs, now - range.lastCommitTime);
+            aged = true;
+        }
+    }
+
+    if (aged) {
+        uint8_t bucket = 0;
+        while (bucket < SERVED_AGE_BUCKETS && oldestMs > SERVED_AGE_BUCKET_MS[bucket]) {
+            bucket++;
+        }
+        servedAge.buckets[bucket]++;
+        servedAge.count++;
+        servedAge.sumMs += oldestMs;
+        servedAge.maxMs = max(servedAge.maxMs, oldestMs);
+    }
+
+    // Ranges never overlap, so anything short of the full count reads unpolled registers
+    if (demandPolling && covered < count) {
+        demandUncoveredReads++;
+        auto request = std::make_pair(address, count);
+        if (std::find(pendingDemand.begin(), pendingDemand.end(), request) == pendingDemand.end()) {
+            if (pendingDemand.size() < DEMAND_MAX_PENDING) {
+                pendingDemand.push_back(request);
+            } else {
+                demandRejected++;
             }
-            if (lowWaterMarks.find(address) == lowWaterMarks.end() || newValue < static_cast<uint16_t>(lowWaterMarks[address])) {
-                lowWaterMarks[address] = newValue;
+        }
+    }
+}
+
+void ModbusCache::growDemandRanges() {
+    if (!xSemaphoreTakeRecursive(mutex, pdMS_TO_TICKS(10))) {
+        return;
+    }
+    for (const auto& request : pendingDemand) {
+        uint32_t end = static_cast<uint32_t>(request.first) + request.second;
+        uint32_t runStart = 0;
+        bool inRun = false;
+
+        for (uint32_t address = request.first; address <= end; address++) {
+            bool uncovered = address < end;
+            for (const auto& range : registerRanges) {
+                if (!uncovered) break;
+                uncovered = address < range.startAddress ||
+                            address >= static_cast<uint32_t>(range.startAddress) + range.regCount;
             }
-        } else if (reg.type == RegisterType::INT16) {
-            int16_t signedValue = static_cast<int16_t>(value);
-            // And no need for current value in signed 16-bit logic
-            if (highWaterMarks.find(address) == highWaterMarks.end() || signedValue > static_cast<int16_t>(highWaterMarks[address])) {
-                highWaterMarks[address] = static_cast<uint16_t>(signedValue);
+            if (uncovered && !inRun) {
+                runStart = address;
+                inRun = true;
+            } else if (!uncovered && inRun) {
+                inRun = false;
+                uint16_t count = address - runStart;
+                uint16_t slot = demandRegisterCount.load();
+                if (slot + count > DEMAND_MAX_REGISTERS || registers.size() + slot + count > MAX_REGISTERS ||
+                    demandRangesAdded.load() >= DEMAND_MAX_RANGES) {
+                    demandRejected++;
+                    logErrln("[demand] No room to poll " + String(runStart) + "+" + String(count));
+                    continue;
+                }
+                for (uint16_t i = 0; i < count; i++) {
+                    demandRegisters[slot + i] = {static_cast<uint16_t>(runStart + i), 0};
+                }
+                // Publish the slots only once they are filled; readers scan without the mutex
+                demandRegisterCount = slot + count;
+
+                RegisterRange range = {static_cast<uint16_t>(runStart), count, false, 0, false};
+                range.isDemand = true;
+                range.demandSlot = slot;
+                registerRanges.push_back(range);
+                demandRangesAdded++;
+                dbgln("[demand] Polling " + String(runStart) + "+" + String(count) + " for client reads");
             }
-            if (lowWaterMarks.find(address) == lowWaterMarks.end() || signedValue < static_cast<int16_t>(lowWaterMarks[address])) {
-                lowWaterMarks[address] = static_cast<uint16_t>(signedValue);
+        }
+    }
+    pendingDemand.clear();
+    xSemaphoreGiveRecursive(mutex);
+}
+
+bool ModbusCache::readDemandRegister(uint16_t address, uint16_t& value) {
+    uint16_t count = demandRegisterCount.load();
+    for (uint16_t i = 0; i < count; i++) {
+        if (demandRegisters[i].address == address) {
+            value = demandRegisters[i].value;
+            return true;
+        }
+    }
+    return false;
+}
+
+unsigned long ModbusCache::demandPollInterval(const RegisterRange& range, unsigned long now) const {
+    if (!demandPolling || range.isStatic) {
+        return update_interval;
+    }
+    unsigned long lastDemand = range.lastReadTime != 0 ? range.lastReadTime : demandStartTime;
+    if (now - lastDemand > DEMAND_COLD_MS) {
+        return max<unsigned long>(update_interval, DEMAND_COLD_INTERVAL_MS);
+    }
+    // Two polls per client read keep what the client sees within half its read interval
+    return max<unsigned long>(update_interval, range.readIntervalMs / 2);
+}
+
+std::vector<RangeDemandInfo> ModbusCache::getRangeDemand() {
+    std::vector<RangeDemandInfo> result;
+    if (!xSemaphoreTakeRecursive(mutex, pdMS_TO_TICKS(50))) {
+        return result;
+    }
+    unsigned long now = millis();
+    result.reserve(registerRanges.size());
+    for (const auto& range : registerRanges) {
+        RangeDemandInfo info;
+        info.startAddress = range.startAddress;
+        info.regCount = range.regCount;
+        info.isDemand = range.isDemand;
+        info.retired = range.retired;
+        info.reads = range.reads;
+        info.readIntervalMs = range.readIntervalMs;
+        info.pollIntervalMs = demandPollInterval(range, now);
+        info.cold = demandPolling && !range.isStatic && info.pollIntervalMs >= DEMAND_COLD_INTERVAL_MS;
+        info.phaseLocked = range.clientPhase.isLocked(now);
+        info.clientPeriodMs = range.clientPhase.getPeriodMs();
+        info.phaseJitterMs = range.clientPhase.getJitterMs();
+        info.roundTripMs = range.roundTripMs;
+        result.push_back(info);
+    }
+    xSemaphoreGiveRecursive(mutex);
+    return result;
+}
+
+bool ModbusCache::prefetchOwns(const RegisterRange& range, unsigned long now) const {
+    // The grid takes the range back if prefetches stop landing, e.g. behind a busy bus
+    return prefetch && range.clientPhase.isLocked(now) &&
+           now - range.lastRequestTime < 2UL * range.clientPhase.getPeriodMs();
+}
+
+void ModbusCache::prefetchRanges(unsigned long now) {
+    for (auto& range : registerRanges) {
+        if (range.isStatic || range.retired || range.inFlight) {
+            continue;
+        }
+        bool due = false;
+        if (xSemaphoreTakeRecursive(mutex, pdMS_TO_TICKS(2))) {
+            if (range.clientPhase.isLocked(now)) {
+                unsigned long expected = range.clientPhase.nextExpected(now);
+                // A read arriving before the prefetch lands gets the previous cycle's data, so
+                // jittery clients get a longer lead; leading by more than half a period would
+                // serve the read before instead
+                unsigned long lead = min<unsigned long>(range.roundTripMs + PREFETCH_GUARD_MS +
+                                                        PREFETCH_JITTER_LEAD * range.clientPhase.getJitterMs(),
+                                                        range.clientPhase.getPeriodMs() / 2);
+                due = expected != range.prefetchTarget && static_cast<long>(now - (expected - lead)) >= 0;
+                if (due) {
+                    range.prefetchTarget = expected;
+                }
             }
+            xSemaphoreGiveRecursive(mutex);
+        }
+        if (due) {
+            dbgln("[prefetch] Polling " + String(range.startAddress) + "+" + String(range.regCount) +
+                  " for the client read due at " + String(range.prefetchTarget));
+            prefetchPolls++;
+            processRegisterRange(range);
         }
     }
 }
 
+ServedAgeSnapshot ModbusCache::getServedAge() {
+    ServedAgeSnapshot snapshot = {};
+    if (xSemaphoreTakeRecursive(mutex, pdMS_TO_TICKS(50))) {
+        snapshot = servedAge;
+        xSemaphoreGiveRecursive(mutex);
+    }
+    return snapshot;
+}
+
+void ModbusCache::updateWaterMarks(uint16_t address, uint32_t value) {
+    auto it = registerDefinitions.find(address);
+    if (it == registerDefinitions.end()) {
+        // Handle error or log: register definition not found
+        return;
+    }
+    updateWaterMarks(address, value, registerCodec(it->second.type));
+}
+
+void ModbusCache::updateWaterMarks(uint16_t address, uint32_t value, const RegisterCodecOps& codec) {
+    // Marks are raw values, ordered by the values they encode
+    auto high = highWaterMarks.find(address);
+    if (high == highWaterMarks.end()) {
+        highWaterMarks[address] = value;
+    } else if (codec.less(high->second, value)) {
+        high->second = value;
+    }
+    auto low = lowWaterMarks.find(address);
+    if (low == lowWaterMarks.end()) {
+        lowWaterMarks[address] = value;
+    } else if (codec.less(value, low->second)) {
+        low->second = value;
+    }
+}
+
 bool ModbusCache::checkNewRegisterValue(uint16_t address, uint32_t proposedRawValue) {
     auto regIt = registerDefinitions.find(address);
     if (regIt == registerDefinitions.end()) {
         return true;
     }
-    const ModbusRegister& reg = regIt->second;
+    uint32_t currentRawValue = is32BitRegister(address) ? read32BitRegister(address)
+                                                        : static_cast<uint32_t>(read16BitRegister(address));
+    return checkNewRegisterValue(regIt->second, proposedRawValue, currentRawValue);
+}
+
+bool ModbusCache::checkNewRegisterValue(const ModbusRegister& reg, uint32_t proposedRawValue, uint32_t currentRawValue) {
     float proposedValue = getScaledValueFromRegister(reg, proposedRawValue);
-    float currentValue = getRegisterScaledValue(address);
+    float currentValue = getScaledValueFromRegister(reg, currentRawValue);
 
     // If the register is uninitialized (current value is 0), accept the new value
     if (currentValue == 0.0) {
@@ -679,59 +1090,77 @@ bool ModbusCache::checkNewRegisterValue(uint16_t address, uint32_t proposedRawVa
 }
 
 
-void ModbusCache::setRegisterValue(uint16_t address, uint32_t value, bool is32Bit) {
+bool ModbusCache::setRegisterValue(uint16_t address, uint32_t value, bool is32Bit) {
     bool sane_value = checkNewRegisterValue(address, value);
     if (!sane_value) {
         insaneCounter++;
         logErrln("New value for register " + String(address) + " is not sane. Rejecting...");
-        return;
+        return false;
     }
     if (is32Bit) {
-        if (is32BitRegister(address)) {
-            if (register32BitValues[address] != value) { // Check if value has changed
-                register32BitValues[address] = value;
-                updateWaterMarks(address, value, is32Bit);
-            }
-        } else {
+        if (!is32BitRegister(address)) {
             logErrln("Error: Attempt to write 32-bit value to non-32-bit register at address: " + String(address));
+            return false;
+        }
+        registerTimestamps[address] = TimeService::micros64();
+        if (register32BitValues[address] != value) { // Check if value has changed
+            register32BitValues[address] = value;
+            updateWaterMarks(address, value);
+            cacheGeneration++;
         }
     } else {
-        if (is16BitRegister(address)) {
-            uint16_t newValue = static_cast<uint16_t>(value);
-            if (register16BitValues[address] != newValue) { // Check if value has changed
-                register16BitValues[address] = newValue;
-                updateWaterMarks(address, newValue, is32Bit);
-            }
-        } else {
+        if (!is16BitRegister(address)) {
             logErrln("Error: Attempt to write 16-bit value to non-16-bit register or 32-bit register at address: " + String(address));
+            return false;
+        }
+        registerTimestamps[address] = TimeService::micros64();
+        uint16_t newValue = static_cast<uint16_t>(value);
+        if (register16BitValues[address] != newValue) { // Check if value has changed
+            register16BitValues[address] = newValue;
+            updateWaterMarks(address, newValue);
+            cacheGeneration++;
         }
     }
+    return true;
 }
 
 void ModbusCache::updateServerStatus() {
-    unsigned long currentTime = millis();
     bool shouldBeOperational = false;
     
     // Take mutex to safely check and update the operational state
     if (xSemaphoreTakeRecursive(instance->mutex, pdMS_TO_TICKS(100))) {
-        // Handle uint32_t overflow/underflow conditions safely
-        unsigned long timeSinceUpdate;
-        if (currentTime >= instance->lastSuccessfulUpdate) {
-            timeSinceUpdate = currentTime - instance->lastSuccessfulUpdate;
-        } else {
-            // This case handles millis() overflow or lastUpdate being incorrectly set
-            logErrln("[updateServerStatus] Time calculation error: current=" + String(currentTime) + 
-                    ", lastUpdate=" + String(instance->lastSuccessfulUpdate));
-            // Don't change operational status based on incorrect time calculation
-            timeSinceUpdate = 0;
+        // Read the clock under the mutex so no response can be committed after it;
+        // the 64-bit clock does not wrap, so the difference is always valid
+        uint64_t currentTime = TimeService::millis64();
+        uint64_t timeSinceUpdate = currentTime - instance->lastSuccessfulUpdate;
+        
+        // Use 2000ms instead of 1000ms to achieve the desired 2.5 second timeout. With
+        // demand polling the freshest range may legitimately be polled less often.
+        unsigned long expectedInterval = update_interval;
+        if (demandPolling) {
+            unsigned long now = millis();
+            expectedInterval = DEMAND_COLD_INTERVAL_MS;
+            for (const auto& range : registerRanges) {
+                if (!range.isStatic && !range.retired) {
+                    expectedInterval = min(expectedInterval, demandPollInterval(range, now));
+                }
+            }
+            expectedInterval = max<unsigned long>(expectedInterval, update_interval);
         }
-        
-        // Use 2000ms instead of 1000ms to achieve the desired 2.5 second timeout
-        bool timeout = (timeSinceUpdate > (update_interval + 2000));
-        bool completed = (staticRegistersFetched && dynamicRegistersFetched);
+        bool timeout = (timeSinceUpdate > (expectedInterval + 2000));
+        // A sniffed master may never read the static registers, nor every dynamic
+        // one. The cache is complete once the master comes back to its first
+        // read, as every read in its poll cycle has then been committed; the
+        // registers it never reads stay at 0.
+        bool completed = snifferActive ? (snifferCycleSeen || dynamicRegistersFetched)
+                                       : (staticRegistersFetched && dynamicRegistersFetched);
         
         // Determine if server should be operational
         shouldBeOperational = !timeout && completed;
+        if (completed && initialSyncTime == 0) {
+            initialSyncTime = currentTime;
+            logErrln("[updateServerStatus] Initial cache sync completed after " + String(initialSyncTime) + " ms");
+        }
         
         // Only log and update if there's a state change
         if (shouldBeOperational != instance->isOperational.load()) {
@@ -844,23 +1273,21 @@ void ModbusCache::sendModbusRequest(uint16_t startAddress, uint16_t regCount) {
     
     // Record mutex acquisition attempt
     mutexAcquisitionAttempts++;
-    unsigned long mutexWaitStartTime = millis();
+    uint64_t mutexWaitStartTime = TimeService::micros64();
     
     if (xSemaphoreTakeRecursive(mutex, xTicksToWait)) {
         mutexAcquired = true;
         
         // Record mutex acquisition time
-        unsigned long mutexAcquiredTime = millis();
+        uint64_t mutexAcquiredTime = TimeService::micros64();
         mutexWaitingTime += (mutexAcquiredTime - mutexWaitStartTime);
         
         // Record internal operations
-        unsigned long currentTime = millis();
-        requestMap[currentToken] = std::make_tuple(startAddress, regCount, currentTime);
+        requestMap[currentToken] = std::make_tuple(startAddress, regCount, mutexAcquiredTime);
         insertionOrder.push_back(currentToken);
         
         // Record mutex release time
-        unsigned long mutexReleaseTime = millis();
-        unsigned long holdTime = mutexReleaseTime - mutexAcquiredTime;
+        uint32_t holdTime = TimeService::micros64() - mutexAcquiredTime;
         mutexHoldingTime += holdTime;
         
         // Update max hold time
@@ -869,8 +1296,8 @@ void ModbusCache::sendModbusRequest(uint16_t startAddress, uint16_t regCount) {
         }
         
         // Log if the hold time is significant
-        if (holdTime > 50) {  // More than 50ms
-            logErrln("[sendModbusRequest] Mutex held for " + String(holdTime) + "ms");
+        if (holdTime > 50000) {  // More than 50ms
+            logErrln("[sendModbusRequest] Mutex held for " + String(holdTime / 1000) + "ms");
         }
         
         xSemaphoreGiveRecursive(mutex);
@@ -921,7 +1348,7 @@ void ModbusCache::sendModbusRequest(uint16_t startAddress, uint16_t regCount) {
     yield();
 }
 
-void ModbusCache::updateLatencyStats(unsigned long latency) {
+void ModbusCache::updateLatencyStats(uint32_t latency) {
     // For the first value, initialize all stats
     if (latencies.empty()) {
         minLatency = latency;
@@ -938,7 +1365,7 @@ void ModbusCache::updateLatencyStats(unsigned long latency) {
 
     // Handle rolling window when full
     if (latencies.size() == maxLatencySamples) {
-        unsigned long oldest = latencies.front();
+        uint32_t oldest = latencies.front();
         latencies.pop_front();
 
         // Update rolling average
@@ -961,6 +1388,12 @@ void ModbusCache::updateLatencyStats(unsigned long latency) {
 
 // This function handles responses from the Modbus TCP client
 void ModbusCache::handleData(ModbusMessage response, uint32_t token) {
+    // Pass-through responses belong to the gateway, not the cache
+    if (RtuGateway::isGatewayToken(token)) {
+        rtuGateway.onData(response, token);
+        return;
+    }
+    
     // Yield at the beginning of processing
     yield();
     
@@ -968,17 +1401,17 @@ void ModbusCache::handleData(ModbusMessage response, uint32_t token) {
     bool requestFound = false;
     uint16_t startAddress = 0;
     uint16_t regCount = 0;
-    unsigned long sentTimestamp = 0;
-    unsigned long responseTime = 0;
+    uint64_t sentTimestamp = 0;
+    uint32_t responseTime = 0;
     String statusReport;
     
     // Record mutex timing
-    unsigned long mutexWaitStartTime = millis();
+    uint64_t mutexWaitStartTime = TimeService::micros64();
     bool mutexAcquired = false;
     
     if (xSemaphoreTakeRecursive(instance->mutex, pdMS_TO_TICKS(50))) { // Reduced timeout
         mutexAcquired = true;
-        unsigned long mutexAcquiredTime = millis();
+        uint64_t mutexAcquiredTime = TimeService::micros64();
         instance->mutexWaitingTime += (mutexAcquiredTime - mutexWaitStartTime);
         instance->mutexAcquisitionAttempts++;
         
@@ -990,23 +1423,43 @@ void ModbusCache::handleData(ModbusMessage response, uint32_t token) {
             regCount = std::get<1>(it->second);
             sentTimestamp = std::get<2>(it->second);
             
-            // Calculate response time with fresh millis() call
-            responseTime = millis() - sentTimestamp;
+            // Calculate response time with a fresh clock read
+            responseTime = TimeService::micros64() - sentTimestamp;
             
             // Find and mark the range as not in flight
+            RegisterRange* matchedRange = nullptr;
             for (auto& range : instance->registerRanges) {
                 if (range.startAddress == startAddress && range.regCount == regCount) {
                     range.inFlight = false;
+                    matchedRange = &range;
                     break;
                 }
             }
             
             // Process the response payload (this is the heavy operation)
-            instance->processResponsePayload(response, startAddress, regCount);
-            instance->lastSuccessfulUpdate = millis();
+            bool committed = instance->processResponsePayload(response, startAddress, regCount, matchedRange);
+            if (matchedRange != nullptr) {
+                matchedRange->failures = committed ? 0 : matchedRange->failures + 1;
+                uint32_t roundTripMs = responseTime / 1000;
+                matchedRange->roundTripMs = matchedRange->roundTripMs == 0 ? roundTripMs
+                                          : (matchedRange->roundTripMs * 3 + roundTripMs) / 4;
+                if (committed) {
+                    matchedRange->lastCommitTime = millis();
+                }
+            }
+            if (committed) {
+                instance->lastSuccessfulUpdate = TimeService::millis64();
+                
+                // Evaluate threshold rules against the freshly committed values
+                eventEngine.evaluateRange(startAddress, regCount, instance->lastSuccessfulUpdate,
+                    [](uint16_t address) { return instance->getRegisterScaledValue(address); });
+            }
             
             // Update latency statistics  
             instance->updateLatencyStats(responseTime);
+            // FC3/FC4 read request: unit, function, address, count and CRC
+            busStats.recordTransaction(startAddress, regCount, 8, response.size() + 2,
+                                       sentTimestamp, sentTimestamp + responseTime);
             
             // Clean up the request from the map
             instance->requestMap.erase(token);
@@ -1016,10 +1469,9 @@ void ModbusCache::handleData(ModbusMessage response, uint32_t token) {
         }
         
         // Record mutex hold time
-        unsigned long mutexReleaseTime = millis();
-        instance->mutexHoldingTime += (mutexReleaseTime - mutexAcquiredTime);
-        instance->maxMutexHoldTime = max(instance->maxMutexHoldTime, 
-                                       mutexReleaseTime - mutexAcquiredTime);
+        uint32_t holdTime = TimeService::micros64() - mutexAcquiredTime;
+        instance->mutexHoldingTime += holdTime;
+        instance->maxMutexHoldTime = max(instance->maxMutexHoldTime, holdTime);
         
         xSemaphoreGiveRecursive(instance->mutex);
     } else {
@@ -1029,7 +1481,7 @@ void ModbusCache::handleData(ModbusMessage response, uint32_t token) {
     
     // Do all logging outside the mutex to avoid holding it during I/O
     if (requestFound) {
-        dbgln("[handleData] Response time for token " + String(token) + ": " + String(responseTime) + " ms");
+        dbgln("[handleData] Response time for token " + String(token) + ": " + String(responseTime / 1000.0f, 2) + " ms");
         dbgln(statusReport);
     }
     
@@ -1037,6 +1489,11 @@ void ModbusCache::handleData(ModbusMessage response, uint32_t token) {
 }
 
 void ModbusCache::handleError(Error error, uint32_t token) {
+    if (RtuGateway::isGatewayToken(token)) {
+        rtuGateway.onError(error, token);
+        return;
+    }
+    
     // ModbusError wraps the error code and provides a readable error message
     ModbusError me(error);
     
@@ -1059,25 +1516,37 @@ void ModbusCache::handleError(Error error, uint32_t token) {
         dbgln("[Modbus Error] " + errorContext);
     }
     
-    // Find and mark the range as not in flight
+    // Find and mark the range as not in flight; the map and the ranges are
+    // changed by the polling task, so both are only touched under the mutex
+    if (!xSemaphoreTakeRecursive(instance->mutex, pdMS_TO_TICKS(100))) {
+        logErrln("[handleError] Failed to acquire mutex, token " + String(token) + " left in flight");
+        return;
+    }
     auto it = instance->requestMap.find(token);
     if (it != instance->requestMap.end()) {
         uint16_t startAddress = std::get<0>(it->second);
         uint16_t regCount = std::get<1>(it->second);
+        if (error == Error::TIMEOUT) {
+            busStats.recordTransaction(startAddress, regCount, 8, 0, std::get<2>(it->second), TimeService::micros64());
+        }
         
         for (auto& range : instance->registerRanges) {
             if (range.startAddress == startAddress && range.regCount == regCount) {
                 range.inFlight = false;
+                // A grown range the meter keeps rejecting is not worth the bus time
+                if (range.isDemand && ++range.failures >= DEMAND_MAX_FAILURES && !range.retired) {
+                    range.retired = true;
+                    logErrln("[demand] Retiring range " + String(startAddress) + "+" + String(regCount) +
+                             " after " + String(range.failures) + " failed polls");
+                }
                 break;
             }
         }
         
         // Clean up the request from the map
-        if (xSemaphoreTakeRecursive(instance->mutex, pdMS_TO_TICKS(100))) {
-            instance->requestMap.erase(token);
-            xSemaphoreGiveRecursive(instance->mutex);
-        }
+        instance->requestMap.erase(it);
     }
+    xSemaphoreGiveRecursive(instance->mutex);
 }
 
 // Improved method to schedule reconnection
@@ -1186,8 +1655,8 @@ void ModbusCache::ensureTCPConnection() {
 void ModbusCache::purgeToken(uint32_t token, bool mutexAlreadyHeld) {
     // Variables to store information for deferred logging
     bool tokenFound = false;
-    unsigned long elapsed = 0;
-    unsigned long currentTime = millis(); // Get time once, outside the mutex
+    uint64_t elapsed = 0;
+    uint64_t currentTime = TimeService::micros64(); // Get time once, outside the mutex
     
     // Only take mutex if not already held
     bool mutexAcquired = mutexAlreadyHeld;
@@ -1202,14 +1671,12 @@ void ModbusCache::purgeToken(uint32_t token, bool mutexAlreadyHeld) {
             tokenFound = true;
             
             // Check elapsed time
-            unsigned long sentTime = std::get<2>(it->second);
+            uint64_t sentTime = std::get<2>(it->second);
             uint16_t startAddress = std::get<0>(it->second);
             uint16_t regCount = std::get<1>(it->second);
             
-            // Handle potential millis() overflow
-            elapsed = (currentTime >= sentTime) ? 
-                     (currentTime - sentTime) : 
-                     (ULONG_MAX - sentTime + currentTime + 1);
+            // A request sent after currentTime was read is simply not aged yet
+            elapsed = currentTime > sentTime ? (currentTime - sentTime) / 1000 : 0;
                                     
             if (elapsed > REQUEST_TIMEOUT_MS) {
                 logErrln("[purgeToken:" + String(token) + "] Request timed out after " + 
@@ -1261,6 +1728,7 @@ void ModbusCache::purgeToken(uint32_t token, bool mutexAlreadyHeld) {
 void ModbusCache::purgeAgedTokens() {
     std::vector<uint32_t> agedTokens;
     unsigned long currentTime = millis();
+    uint64_t currentTimeUs = TimeService::micros64();
     
     if (xSemaphoreTakeRecursive(mutex, pdMS_TO_TICKS(100))) {
         // Pre-allocate to avoid resizing inside the critical section
@@ -1269,14 +1737,9 @@ void ModbusCache::purgeAgedTokens() {
         // First, check for aged tokens in the request map
         for (const auto& entry : requestMap) {
             uint32_t token = entry.first;
-            unsigned long sentTime = std::get<2>(entry.second);
+            uint64_t sentTime = std::get<2>(entry.second);
             
-            // Handle potential millis() overflow
-            unsigned long elapsed = (currentTime >= sentTime) ? 
-                                  (currentTime - sentTime) : 
-                                  (ULONG_MAX - sentTime + currentTime + 1);
-                               
-            if (elapsed > REQUEST_TIMEOUT_MS) {
+            if (currentTimeUs > sentTime && currentTimeUs - sentTime > REQUEST_TIMEOUT_MS * 1000ULL) {
                 agedTokens.push_back(token);
             }
         }
@@ -1314,14 +1777,6 @@ void ModbusCache::purgeAgedTokens() {
     }
 }
 
-uint32_t extract32BitValue(const uint8_t* buffer, size_t index) {
-    // Combine bytes directly without string operations for debugging
-    return static_cast<uint32_t>(buffer[index + 2]) << 24 |
-           static_cast<uint32_t>(buffer[index + 3]) << 16 |
-           static_cast<uint32_t>(buffer[index]) << 8 |
-           static_cast<uint32_t>(buffer[index + 1]);
-}
-
 uint16_t extract16BitValue(const uint8_t* buffer, size_t index) {
     // Combine bytes directly without string operations for debugging
     return static_cast<uint16_t>(buffer[index]) << 8 |
@@ -1329,12 +1784,20 @@ uint16_t extract16BitValue(const uint8_t* buffer, size_t index) {
 }
 
 
-void ModbusCache::processResponsePayload(ModbusMessage& response, uint16_t startAddress, uint16_t regCount) {
+bool ModbusCache::processResponsePayload(ModbusMessage& response, uint16_t startAddress, uint16_t regCount,
+                                         const RegisterRange* range) {
     dbgln("[processResponsePayload] Processing payload...");
     
+    // The byte count must match the request and the message must hold all of it
+    if (!registerPayloadComplete(response.data(), response.size(), regCount)) {
+        logErrln("[processResponsePayload] Byte count mismatch for " + String(regCount) + " registers at " +
+                 String(startAddress) + ", response size " + String(response.size()));
+        return false;
+    }
+    const size_t payloadSize = response[2];
+
     // Get payload pointer once
     const uint8_t* payload = response.data() + 3;
-    size_t payloadIndex = 0;
     
     // Pre-check if we need to update the register sets
     bool needToCheckStaticCompletion = !staticRegistersFetched;
@@ -1343,43 +1806,87 @@ void ModbusCache::processResponsePayload(ModbusMessage& response, uint16_t start
     // Yield before processing to ensure we don't trigger watchdog
     yield();
     
-    // Process registers in a single pass
-    for (uint16_t i = 0; i < regCount; ++i) {
-        uint16_t currentAddress = startAddress + i;
-        
-        // Check register type only once
-        bool is32Bit = is32BitRegister(currentAddress);
-        bool is16Bit = !is32Bit && is16BitRegister(currentAddress);
-        
-        // Skip processing if register type is unknown
-        if (!is32Bit && !is16Bit) {
-            logWithCollapsing("[processResponsePayload] Address " + String(currentAddress) + " not defined as 16 or 32 bit. Skipping...");
-            continue;
-        }
-        
-        // Process based on register type
-        if (is32Bit) {
-            uint32_t value = extract32BitValue(payload, payloadIndex);
-            setRegisterValue(currentAddress, value, true); // true indicates 32-bit operation
-            payloadIndex += 4; // Move past the 32-bit value in the payload
-            i++; // Skip the next address, as it's part of the 32-bit value
-        } else { // is16Bit
-            uint16_t value = extract16BitValue(payload, payloadIndex);
-            setRegisterValue(currentAddress, value); // Default is 16-bit operation
-            payloadIndex += 2; // Move past the 16-bit value in the payload
-        }
-        
-        // Update processed registers sets - only if needed
-        if (needToCheckStaticCompletion && isStaticRegister(currentAddress)) {
-            fetchedStaticRegisters.insert(currentAddress);
-        } else if (needToCheckDynamicCompletion && isDynamicRegister(currentAddress)) {
-            fetchedDynamicRegisters.insert(currentAddress);
+    if (range != nullptr && range->isDemand) {
+        // Registers added for client demand have no definition, keep the raw words as read
+        for (uint16_t i = 0; i < regCount && 2u * i + 2 <= payloadSize; ++i) {
+            DemandRegister& slot = demandRegisters[range->demandSlot + i];
+            uint16_t value = extract16BitValue(payload, 2 * i);
+            if (slot.value != value) {
+                slot.value = value;
+                cacheGeneration++;
+            }
         }
-        
-        // Yield after processing every 5 registers to prevent watchdog timeout
-        if (i % 5 == 0) {
-            yield();
+        return true;
+    }
+
+    if (range != nullptr && !range->decodePlan.empty()) {
+        // Fast path: offsets, types and cache slots were resolved when the range was built
+        uint64_t now = TimeService::micros64();
+        for (const DecodeStep& step : range->decodePlan) {
+            if (step.payloadOffset + (step.is32Bit ? 4 : 2) > payloadSize) {
+                break;
+            }
+            uint32_t value = step.codec->fromWire(payload + step.payloadOffset);
+            uint32_t current = step.is32Bit ? *step.slot32 : *step.slot16;
+            if (!checkNewRegisterValue(*step.definition, value, current)) {
+                insaneCounter++;
+                logErrln("New value for register " + String(step.address) + " is not sane. Rejecting...");
+                continue;
+            }
+            *step.timestamp = now;
+            if (value != current) {
+                if (step.is32Bit) {
+                    *step.slot32 = value;
+                } else {
+                    *step.slot16 = static_cast<uint16_t>(value);
+                }
+                updateWaterMarks(step.address, value, *step.codec);
+                cacheGeneration++;
+            }
+            bool needToCheck = step.fetchedSet == &fetchedStaticRegisters ? needToCheckStaticCompletion
+                                                                          : needToCheckDynamicCompletion;
+            if (step.fetchedSet != nullptr && needToCheck) {
+                step.fetchedSet->insert(step.address);
+            }
         }
+    } else {
+        // Process registers in a single pass. Reads sniffed from another master can span
+        // undefined addresses or start inside a 32-bit register; those words are skipped
+        // in place so the registers after them still decode from their own offsets.
+        uint16_t visited = 0;
+        forEachReadRegister(startAddress, regCount,
+            [this](uint16_t address) -> uint8_t {
+                auto it = registerDefinitions.find(address);
+                return it != registerDefinitions.end() ? registerCodec(it->second.type).words : 0;
+            },
+            [&](uint16_t currentAddress, uint16_t payloadOffset, uint8_t words) {
+                // Yield after processing every 5 registers to prevent watchdog timeout
+                if (visited++ % 5 == 0) {
+                    yield();
+                }
+
+                // Skip processing if register type is unknown or only part of it was read
+                if (words == 0) {
+                    logWithCollapsing("[processResponsePayload] Address " + String(currentAddress) + " not defined as 16 or 32 bit or not read whole. Skipping...");
+                    return;
+                }
+
+                // Process based on register type
+                if (words == 2) {
+                    uint32_t value = registerCodec(registerDefinitions.find(currentAddress)->second.type).fromWire(payload + payloadOffset);
+                    setRegisterValue(currentAddress, value, true); // true indicates 32-bit operation
+                } else {
+                    uint16_t value = extract16BitValue(payload, payloadOffset);
+                    setRegisterValue(currentAddress, value); // Default is 16-bit operation
+                }
+
+                // Update processed registers sets - only if needed
+                if (needToCheckStaticCompletion && isStaticRegister(currentAddress)) {
+                    fetchedStaticRegisters.insert(currentAddress);
+                } else if (needToCheckDynamicCompletion && isDynamicRegister(currentAddress)) {
+                    fetchedDynamicRegisters.insert(currentAddress);
+                }
+            });
     }
     
     // Yield before completing the method
@@ -1415,37 +1922,18 @@ void ModbusCache::processResponsePayload(ModbusMessage& response, uint16_t start
     yield();
     
     dbgln("[processResponsePayload] Done processing payload");
+    return true;
 }
 
 #include <optional>
 #include <cstring> // For memcpy
 
-Uint16Pair ModbusCache::convertValue(const ModbusRegister& source, const ModbusRegister& destination, uint32_t value) {
+uint32_t ModbusCache::convertValue(const ModbusRegister& source, const ModbusRegister& destination, uint32_t value) {
     //dbgln("Converting value from " + typeString(source.type) + " to " + typeString(destination.type) + ": " + String(value));
     
-    // The combined scaling factor is the source's scaling factor,
-    // as the destination's scaling factor is effectively 1 in this scenario.
-    double combinedScalingFactor = 1.0;
-
-    if (source.scalingFactor.has_value()) {
-        combinedScalingFactor = source.scalingFactor.value();
-    }
-    // log the scaling factor
-    //dbgln("Combined scaling factor: " + String(combinedScalingFactor,4));
-    
-    float trueValue = 0;
-    uint32_t tempValue = 0;
-
-    if (source.type == RegisterType::FLOAT) {
-        // If source is FLOAT, interpret the input value directly as float
-        memcpy(&trueValue, &value, sizeof(float));
-        trueValue *= combinedScalingFactor; // Apply scaling factor
-    } else {
-        // If source is INT32, apply the scaling factor before conversion
-        int32_t intValue;
-        memcpy(&intValue, &value, sizeof(int32_t)); // Treat the value as int32_t for scaling
-        trueValue = static_cast<float>(intValue) * combinedScalingFactor;
-    }
+    // The source's scaling factor gives the true value; the destination's
+    // scaling factor is effectively 1 in this scenario.
+    float trueValue = registerCodec(source.type).scale(value, source.scalingFactor.value_or(1.0f));
 
     // if destination.transformFunction is present, apply it to the trueValue
     if (destination.transformFunction.has_value()) {
@@ -1455,15 +1943,7 @@ Uint16Pair ModbusCache::convertValue(const ModbusRegister& source, const ModbusR
         //dbgln("Transformed value: " + String(trueValue,3));
     }
 
-    // Convert trueValue to the destination type
-    if (destination.type == RegisterType::FLOAT) {
-        // If destination is FLOAT, no further conversion needed
-        memcpy(&tempValue, &trueValue, sizeof(float)); // Store the float value as uint32_t for return
-    } else {
-        // Handle conversion to other types if needed, though not required for this specific scenario
-    }
-
-    return split32BitRegister(tempValue);
+    return registerCodec(destination.type).fromFloat(trueValue);
 }
 
 
@@ -1575,16 +2055,17 @@ void ModbusCache::createEmulatedServer(const std::vector<ModbusRegister>& regist
                     } else {
                         sourceValue = static_cast<uint32_t>(this->read16BitRegister(backendAddress));
                     }
-                    Uint16Pair pair = this->convertValue(sourceReg, destReg, sourceValue);
+                    uint16_t words[2];
+                    registerCodec(destReg.type).toWire(this->convertValue(sourceReg, destReg, sourceValue), words);
                     if (this->is32BitRegisterType(destReg)) {
                         // dbgln("[emulator] 32-bit destination register: ");
                         // dbgln("[emulator] Source register: " + sourceReg.description + ", Scaling factor: " + String(scalingFactor,4) + ", Value: " + String(sourceValue));   
-                        response.add(pair.highWord);
+                        response.add(words[0]);
                         wordCount++;
                         if (wordCount == valueOrWords) { // We might want word one of a 2 word register
                               break;
                         }
-                        response.add(pair.lowWord);
+                        response.add(words[1]);
                         i++;
                         wordCount++;
                     } else {
@@ -1592,7 +2073,7 @@ void ModbusCache::createEmulatedServer(const std::vector<ModbusRegister>& regist
                         // dbgln("[emulator] 16-bit Source register: " + sourceReg.description + ", Value: " + String(sourceValue) + ", Scaling factor: " + String(scalingFactor,4) +
                         //     ", sourveValue: " + String(sourceValue));
 
-                        response.add(pair.lowWord);
+                        response.add(words[0]);
                         wordCount++;
                     }
                 } else {
@@ -1616,14 +2097,35 @@ void ModbusCache::createEmulatedServer(const std::vector<ModbusRegister>& regist
         return ModbusMessage();
     };
     dbgln("Registering worker function for emulated server");
-    modbusRTUEmulator.registerWorker(1, ANY_FUNCTION_CODE, onData);
+    turnaroundStats.setSerialFormat(ServerKind::EMULATOR, baudRate, serverBitsPerChar());
+    modbusRTUEmulator.registerWorker(1, ANY_FUNCTION_CODE, turnaroundStats.wrap(ServerKind::EMULATOR, onData));
 }
 
 
+// eModbus owns its messages, so a finished frame is copied once at the boundary
+static ModbusMessage toModbusMessage(const PduBuffer& frame) {
+    ModbusMessage message(frame.size());
+    message.add(frame.data(), frame.size());
+    return message;
+}
+
 ModbusMessage ModbusCache::respondFromCache(ModbusMessage request) {
-    // Extract request parameters once
+    // Validate the PDU before touching the cache, so a garbled frame never
+    // causes a large allocation or holds the mutex
+    uint8_t check = checkCacheRequest(request.data(), request.size());
+    if (check == CACHE_REQUEST_DROP) {
+        return ModbusMessage();
+    }
     const uint8_t slaveID = request[0];
     const uint8_t functionCode = request[1];
+    ModbusMessage response;
+
+    if (check != CACHE_REQUEST_VALID) {
+        response.setError(slaveID, functionCode, static_cast<Error>(check));
+        return response;
+    }
+
+    // Extract request parameters once
     const uint16_t address = extract16BitValue(request.data(), 2);
     const uint16_t valueOrWords = extract16BitValue(request.data(), 4);
 
@@ -1632,9 +2134,6 @@ ModbusMessage ModbusCache::respondFromCache(ModbusMessage request) {
         return ModbusMessage();
     }
 
-    // Pre-allocate response buffer
-    ModbusMessage response;
-    
     // Record start time for monitoring
     unsigned long startTime = millis();
     
@@ -1664,9 +2163,12 @@ ModbusMessage ModbusCache::respondFromCache(ModbusMessage request) {
 
         // Handle read holding registers or read input registers (function codes 3 or 4)
         if (functionCode == 3 || functionCode == 4) {
-            // Pre-allocate vector to collect values within critical section
-            std::vector<uint16_t> values;
-            values.reserve(valueOrWords * 2); // Reserve space for worst case
+            // Build the frame in a pool buffer within the critical section; the
+            // validated register count keeps it within PDU_BUFFER_SIZE
+            PduBuffer frame = pduPool.acquire();
+            frame.add(slaveID);
+            frame.add(functionCode);
+            frame.add(static_cast<uint8_t>(0)); // Byte count, filled in below
             
             uint16_t i = 0;
             uint16_t currentAddress = address;
@@ -1691,34 +2193,32 @@ ModbusMessage ModbusCache::respondFromCache(ModbusMessage request) {
                     startTime = millis(); // Reset timeout after yield
                 }
                 
-                if (instance->is32BitRegister(currentAddress)) {
-                    uint32_t value32 = instance->read32BitRegister(currentAddress);
-                    Uint16Pair pair = instance->split32BitRegister(value32);
+                auto def = instance->registerDefinitions.find(currentAddress);
+                if (def != instance->registerDefinitions.end() && instance->is32BitRegisterType(def->second)) {
+                    uint16_t words[2];
+                    registerCodec(def->second.type).toWire(instance->read32BitRegister(currentAddress), words);
                     
-                    values.push_back(pair.lowWord);
+                    frame.add(words[0]);
                     if (i + 1 < valueOrWords) {
-                        values.push_back(pair.highWord);
+                        frame.add(words[1]);
                         i++;
                     }
                     currentAddress += 2;
                 } else {
-                    values.push_back(instance->read16BitRegister(currentAddress));
+                    frame.add(instance->read16BitRegister(currentAddress));
                     currentAddress++;
                 }
                 i++;
             }
             
+            instance->recordClientRead(address, valueOrWords);
+            
             // Release mutex before building response
             xSemaphoreGiveRecursive(instance->mutex);
             
-            // Build response outside critical section
-            response.add(slaveID);
-            response.add(functionCode);
-            response.add(static_cast<uint8_t>(values.size() * 2));
-            
-            for (uint16_t val : values) {
-                response.add(val);
-            }
+            // Hand the frame to eModbus in one sized copy instead of growing the message
+            frame.data()[2] = static_cast<uint8_t>(frame.size() - 3);
+            response = toModbusMessage(frame);
             
             // Log if operation took unusually long
             unsigned long duration = millis() - startTime;
@@ -1753,36 +2253,8 @@ ModbusClientRTU* ModbusCache::getModbusRTUClient() {
 }
 
 float ModbusCache::getScaledValueFromRegister(const ModbusRegister& reg, uint32_t rawValue) {
-    float value = 0.0;
-
-    // Use RegisterType to determine the appropriate conversion
-    switch (reg.type) {
-        case RegisterType::UINT32:
-            value = static_cast<float>(rawValue);
-            break;
-        case RegisterType::INT32:
-            value = static_cast<float>(static_cast<int32_t>(rawValue));
-            break;
-        case RegisterType::UINT16:
-            value = static_cast<float>(static_cast<uint16_t>(rawValue));
-            break;
-        case RegisterType::INT16:
-            value = static_cast<float>(static_cast<int16_t>(rawValue));
-            break;
-        case RegisterType::FLOAT:
-            value = static_cast<float>(rawValue);
-        // Add cases for other RegisterType enums if necessary
-        default:
-            // Handle unexpected register type or log an error
-            break;
-    }
-
-    // Apply scaling factor if present
-    if (reg.scalingFactor.has_value()) {
-        value *= reg.scalingFactor.value();
-    }
-
-    return value;
+    // Applies the scaling factor if present
+    return registerCodec(reg.type).scale(rawValue, reg.scalingFactor.value_or(1.0f));
 }
 
 
@@ -1883,49 +2355,254 @@ String ModbusCache::getCGBaudRate() {
     return baudRate;
 }
 
-void ModbusCache::setCGBaudRate(uint16_t baudRateValue) {
+bool ModbusCache::setCGBaudRate(uint16_t baudRateValue) {
     // Validate that the value is between 1 and 5
     if (baudRateValue < 1 || baudRateValue > 5) {
         dbgln("Invalid baud rate value. Must be between 1 and 5.");
-        return;
+        return false;
     }
 
     // Only proceed if the client is RTU
-    if (!config.getClientIsRTU()) {
+    if (!config.getClientIsRTU() || baudTaskHandle == nullptr) {
         dbgln("Cannot set baud rate. Client is not configured for RTU.");
+        return false;
+    }
+
+    // One switch at a time; the baud task picks the value up and runs the whole procedure
+    uint16_t idle = 0;
+    if (baudSwitchState.load() != BaudSwitchState::IDLE || !pendingBaudCode.compare_exchange_strong(idle, baudRateValue)) {
+        dbgln("Cannot set baud rate. A baud rate probe or switch is already running.");
+        return false;
+    }
+    xTaskNotifyGive(baudTaskHandle);
+    dbgln("Baud rate switch to " + String(cgBaudRates[baudRateValue - 1]) + " queued.");
+    return true;
+}
+
+void ModbusCache::baudTask(void* param) {
+    ModbusCache* cache = static_cast<ModbusCache*>(param);
+
+    // Boot probe: a meter left at another rate (e.g. by an interrupted switch)
+    // is found and the configured rate follows it
+    cache->baudSwitchState = BaudSwitchState::PROBING;
+    cache->modbusRTUClient->setTimeout(BAUD_PROBE_TIMEOUT_MS);
+    unsigned long configured = cache->clientBaudRate.load();
+    unsigned long found = cache->probeBaudRate();
+    if (found == 0) {
+        logErrln("[baudTask] Meter did not answer at any rate, staying at " + String(configured));
+    } else if (found != configured) {
+        logErrln("[baudTask] Meter answers at " + String(found) + " instead of " + String(configured) + ", saving new rate");
+        config.setModbusBaudRate(found);
+        cache->baudProbeCorrections++;
+    }
+    cache->modbusRTUClient->setTimeout(RTU_CLIENT_TIMEOUT_MS);
+    cache->baudSwitchState = BaudSwitchState::IDLE;
+    cache->busPaused = false;
+
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        uint16_t baudCode = cache->pendingBaudCode.exchange(0);
+        if (baudCode != 0) {
+            cache->runBaudSwitch(baudCode);
+        }
+    }
+}
+
+bool ModbusCache::drainBus() {
+    unsigned long start = millis();
+    while (millis() - start < BAUD_DRAIN_MS) {
+        if (modbusRTUClient->pendingRequests() == 0 && !rtuGateway.isDispatched()) {
+            return true;
+        }
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    return false;
+}
+
+void ModbusCache::reopenClient(unsigned long baudRate) {
+    // The client derives its inter-frame gap from the serial rate in begin()
+    modbusRTUClient->end();
+    modbusClientSerial.flush();
+    modbusClientSerial.updateBaudRate(baudRate);
+    modbusRTUClient->begin(modbusClientSerial, RTU_client_core);
+    clientBaudRate = baudRate;
+    busStats.begin(baudRate, clientBitsPerChar());
+    rtuGateway.setBaudRate(baudRate, clientBitsPerChar());
+}
+
+Error ModbusCache::readMeterRegister(uint16_t address, uint16_t& value) {
+    // Synchronous requests are answered here, not through handleData
+    ModbusMessage response = modbusRTUClient->syncRequest(globalToken++, 1, READ_HOLD_REGISTER, address, 1);
+    Error err = response.getError();
+    if (err == SUCCESS && response.size() >= 5) {
+        response.get(3, value);
+    }
+    return err;
+}
+
+bool ModbusCache::meterAnswers(uint32_t deadlineMs) {
+    unsigned long start = millis();
+    do {
+        uint16_t id;
+        // An exception response still proves the meter decodes frames at this rate
+        if (readMeterRegister(CG_ID_REGISTER, id) < TIMEOUT) {
+            return true;
+        }
+        vTaskDelay(pdMS_TO_TICKS(20));
+    } while (millis() - start < deadlineMs);
+    return false;
+}
+
+unsigned long ModbusCache::probeBaudRate() {
+    unsigned long current = clientBaudRate.load();
+    if (meterAnswers(BAUD_PROBE_TIMEOUT_MS)) {
+        return current;
+    }
+    for (unsigned long rate : cgBaudRates) {
+        if (rate == current) {
+            continue;
+        }
+        reopenClient(rate);
+        if (meterAnswers(BAUD_PROBE_TIMEOUT_MS)) {
+            dbgln("[baudTask] Meter found at " + String(rate));
+            return rate;
+        }
+    }
+    reopenClient(current);
+    return 0;
+}
+
+void ModbusCache::runBaudSwitch(uint16_t baudCode) {
+    unsigned long oldRate = clientBaudRate.load();
+    unsigned long newRate = cgBaudRates[baudCode - 1];
+    if (newRate == oldRate) {
+        dbgln("[baudTask] Already at " + String(newRate) + ", nothing to do");
         return;
     }
 
-    // Create the Modbus request to write to the baud rate register (8193 / 0x2001)
-    uint16_t startAddress = 0x2001; // Physical address for baud rate
-    uint16_t regValue = baudRateValue;
+    baudSwitchAttempts++;
+    baudSwitchState = BaudSwitchState::DRAINING;
+    busPaused = true;
+    uint64_t pausedAt = TimeService::millis64();
+    bool switched = false;
 
-    ModbusMessage request = ModbusMessage(1, 6, startAddress, regValue); // Function code 6 = Write Single Register
-    uint32_t currentToken = globalToken++;
+    if (!drainBus()) {
+        logErrln("[baudTask] RTU client still busy after " + String(BAUD_DRAIN_MS) + "ms, baud rate switch abandoned");
+    } else {
+        modbusRTUClient->setTimeout(BAUD_PROBE_TIMEOUT_MS);
+
+        // The meter acknowledges at the old rate, then changes over
+        baudSwitchState = BaudSwitchState::WRITING;
+        ModbusMessage response = modbusRTUClient->syncRequest(globalToken++, 1, WRITE_HOLD_REGISTER,
+                                                              CG_BAUD_REGISTER, baudCode);
+        Error err = response.getError();
+        if (err != SUCCESS && err < TIMEOUT) {
+            // Rejected with an exception, the meter is still at the old rate
+            logErrln("[baudTask] Meter rejected baud rate " + String(newRate) + ": " + String((int)err));
+        } else {
+            // A lost acknowledgement does not mean the write failed, so verify either way
+            baudSwitchState = BaudSwitchState::VERIFYING;
+            reopenClient(newRate);
+            unsigned long start = millis();
+            while (!switched && millis() - start < BAUD_VERIFY_DEADLINE_MS) {
+                uint16_t code = 0;
+                uint16_t id;
+                switched = readMeterRegister(CG_BAUD_REGISTER, code) == SUCCESS && code == baudCode &&
+                           readMeterRegister(CG_ID_REGISTER, id) == SUCCESS;
+                if (!switched) {
+                    vTaskDelay(pdMS_TO_TICKS(20));
+                }
+            }
 
-    // Mutex protection for request map and queue
-    if (xSemaphoreTakeRecursive(mutex, pdMS_TO_TICKS(100))) {
-        unsigned long timestamp = millis();
-        requestMap[currentToken] = std::make_tuple(startAddress, 1, timestamp); // Register count is 1
-        insertionOrder.push_back(currentToken);
+            if (!switched) {
+                baudSwitchState = BaudSwitchState::ROLLING_BACK;
+                baudSwitchRollbacks++;
+                logErrln("[baudTask] Meter did not answer at " + String(newRate) + ", rolling back to " + String(oldRate));
+                reopenClient(oldRate);
+                if (!meterAnswers(BAUD_VERIFY_DEADLINE_MS)) {
+                    // The meter is somewhere else: put it back to the old rate if we can,
+                    // otherwise follow it so the cache keeps working
+                    unsigned long found = probeBaudRate();
+                    if (found != 0 && found != oldRate) {
+                        modbusRTUClient->syncRequest(globalToken++, 1, WRITE_HOLD_REGISTER, CG_BAUD_REGISTER, cgBaudCode(oldRate));
+                        reopenClient(oldRate);
+                        if (!meterAnswers(BAUD_VERIFY_DEADLINE_MS)) {
+                            reopenClient(found);
+                            config.setModbusBaudRate(found);
+                            logErrln("[baudTask] Meter stays at " + String(found) + ", saving new rate");
+                        }
+                    } else if (found == 0) {
+                        logErrln("[baudTask] Meter lost after baud rate switch, staying at " + String(oldRate));
+                    }
+                }
+            }
+        }
+        modbusRTUClient->setTimeout(RTU_CLIENT_TIMEOUT_MS);
+    }
 
-        // Check if the map is at its maximum size
-        if (requestMap.size() >= 200) {
-            uint32_t oldestToken = insertionOrder.front();
-            requestMap.erase(oldestToken);
-            insertionOrder.erase(insertionOrder.begin()); // Remove the first element
+    if (switched) {
+        config.setModbusBaudRate(newRate);
+        baudSwitchSuccesses++;
+        // Static registers are read once, keep the cached setting in step with the meter
+        if (is16BitRegister(CG_BAUD_REGISTER) && xSemaphoreTakeRecursive(mutex, pdMS_TO_TICKS(100))) {
+            setRegisterValue(CG_BAUD_REGISTER, baudCode, false);
+            xSemaphoreGiveRecursive(mutex);
         }
-        xSemaphoreGiveRecursive(mutex);
     }
 
-    // Send the request
-    Error err = modbusRTUClient->addRequest(request, currentToken);
+    lastBaudSwitchGapMs = static_cast<uint32_t>(TimeService::millis64() - pausedAt);
+    dbgln("[baudTask] Baud rate switch " + String(switched ? "to " + String(newRate) + " done" : "failed") +
+          ", polling paused for " + String(lastBaudSwitchGapMs.load()) + "ms");
+    baudSwitchState = BaudSwitchState::IDLE;
+    busPaused = false;
+}
+
+void ModbusCache::snifferTask(void* param) {
+    ModbusCache* cache = static_cast<ModbusCache*>(param);
+    uint8_t chunk[128];
+
+    for (;;) {
+        int available = modbusClientSerial.available();
+        if (available > 0) {
+            size_t read = modbusClientSerial.read(chunk, min<size_t>(available, sizeof(chunk)));
+            cache->sniffer.feed(chunk, read, TimeService::micros64());
+        } else {
+            cache->sniffer.idle(TimeService::micros64());
+            vTaskDelay(1);
+        }
+    }
+}
+
+void ModbusCache::handleSniffedTransaction(const SniffedTransaction& transaction) {
+    // Both directions are on the wire once, whatever the unit or function code
+    busStats.recordTransaction(transaction.startAddress, transaction.quantity, transaction.requestLength,
+                               transaction.responseLength + 2, transaction.requestUs, transaction.responseUs);
+
+    // Only the meter's register reads carry values the cache holds
+    bool isRead = transaction.functionCode == READ_HOLD_REGISTER || transaction.functionCode == READ_INPUT_REGISTER;
+    if (transaction.unit != 1 || !isRead || transaction.exception) {
+        return;
+    }
 
-    // Check for errors
-    if (err != SUCCESS) {
-        dbgln("Error adding baud rate set request: " + String((int)err));
+    ModbusMessage response;
+    response.add(transaction.response, transaction.responseLength);
+    if (xSemaphoreTakeRecursive(mutex, pdMS_TO_TICKS(50))) {
+        // The master's ranges are its own, no RegisterRange of ours matches them
+        if (processResponsePayload(response, transaction.startAddress, transaction.quantity, nullptr)) {
+            uint32_t read = static_cast<uint32_t>(transaction.startAddress) << 16 | transaction.quantity;
+            if (snifferCommits++ == 0) {
+                snifferFirstRead = read;
+            } else if (read == snifferFirstRead) {
+                snifferCycleSeen = true;
+            }
+            lastSuccessfulUpdate = TimeService::millis64();
+            eventEngine.evaluateRange(transaction.startAddress, transaction.quantity, lastSuccessfulUpdate,
+                [](uint16_t address) { return instance->getRegisterScaledValue(address); });
+        }
+        updateLatencyStats(transaction.responseUs - transaction.requestUs);
+        xSemaphoreGiveRecursive(mutex);
     } else {
-        dbgln("Baud rate set request sent successfully.");
+        mutexAcquisitionFailures++;
     }
 }
 
@@ -2390,9 +3067,9 @@ String ModbusCache::getRequestMapStatus() {
     
     // Count in-flight requests
     size_t inFlightCount = 0;
-    unsigned long currentTime = millis();
-    unsigned long minAge = ULONG_MAX;
-    unsigned long maxAge = 0;
+    uint64_t currentTime = TimeService::micros64();
+    uint64_t minAge = UINT64_MAX;
+    uint64_t maxAge = 0;
     
     for (const auto& range : registerRanges) {
         if (range.inFlight) {
@@ -2402,7 +3079,8 @@ String ModbusCache::getRequestMapStatus() {
     
     // Calculate ages of requests
     for (const auto& entry : requestMap) {
-        unsigned long age = currentTime - std::get<2>(entry.second);
+        uint64_t sentTime = std::get<2>(entry.second);
+        uint64_t age = currentTime > sentTime ? (currentTime - sentTime) / 1000 : 0;
         minAge = std::min(minAge, age);
         maxAge = std::max(maxAge, age);
     }
@@ -2417,4 +3095,186 @@ String ModbusCache::getRequestMapStatus() {
              ", Age Range: " + String(minAge) + "ms to " + String(maxAge) + "ms";
              
     return status;
-}
\ No newline at end of file
+}
+
+static inline void putLE16(std::vector<uint8_t>& out, uint16_t value) {
+    out.push_back(value & 0xFF);
+    out.push_back(value >> 8);
+}
+
+static inline void putLE32(std::vector<uint8_t>& out, uint32_t value) {
+    putLE16(out, value & 0xFFFF);
+    putLE16(out, value >> 16);
+}
+
+static inline uint16_t getLE16(const uint8_t* in) {
+    return in[0] | (in[1] << 8);
+}
+
+static inline uint32_t getLE32(const uint8_t* in) {
+    return getLE16(in) | (static_cast<uint32_t>(getLE16(in + 2)) << 16);
+}
+
+bool ModbusCache::buildCacheImage(std::vector<uint8_t>& image, uint32_t& generation, bool& operational) {
+    image.clear();
+    image.reserve(CACHE_IMAGE_HEADER_SIZE + registerDefinitions.size() * CACHE_IMAGE_ENTRY_SIZE);
+
+    if (!xSemaphoreTakeRecursive(mutex, pdMS_TO_TICKS(50))) {
+        logErrln("[buildCacheImage] Failed to acquire mutex");
+        return false;
+    }
+
+    uint64_t now = TimeService::micros64();
+    generation = cacheGeneration.load();
+    operational = isOperational.load();
+
+    putLE32(image, CACHE_IMAGE_MAGIC);
+    image.push_back(CACHE_IMAGE_VERSION);
+    image.push_back(operational ? CACHE_IMAGE_FLAG_OPERATIONAL : 0);
+    putLE16(image, registerDefinitions.size());
+    putLE32(image, generation);
+    putLE32(image, static_cast<uint32_t>(now / 1000));
+
+    for (const auto& entry : registerDefinitions) {
+        uint16_t address = entry.first;
+        bool is32Bit = is32BitRegisterType(entry.second);
+        auto ts = registerTimestamps.find(address);
+        if (ts != registerTimestamps.end() && ts->second == 0) {
+            ts = registerTimestamps.end(); // Slot reserved by a decode plan, never written
+        }
+
+        putLE16(image, address);
+        image.push_back(static_cast<uint8_t>(entry.second.type));
+        image.push_back(0);
+        putLE32(image, is32Bit ? read32BitRegister(address) : read16BitRegister(address));
+        putLE32(image, ts != registerTimestamps.end() ? static_cast<uint32_t>(min<uint64_t>((now - ts->second) / 1000, 0xFFFFFFFE)) : 0xFFFFFFFF);
+    }
+
+    xSemaphoreGiveRecursive(mutex);
+    return true;
+}
+
+bool ModbusCache::applyCacheImage(const uint8_t* image, size_t length) {
+    if (length < CACHE_IMAGE_HEADER_SIZE || getLE32(image) != CACHE_IMAGE_MAGIC ||
+        image[4] != CACHE_IMAGE_VERSION) {
+        logErrln("[applyCacheImage] Invalid cache image header");
+        return false;
+    }
+    bool primaryOperational = image[5] & CACHE_IMAGE_FLAG_OPERATIONAL;
+    uint16_t count = getLE16(image + 6);
+    if (length < CACHE_IMAGE_HEADER_SIZE + (size_t)count * CACHE_IMAGE_ENTRY_SIZE) {
+        logErrln("[applyCacheImage] Truncated cache image");
+        return false;
+    }
+
+    if (!xSemaphoreTakeRecursive(mutex, pdMS_TO_TICKS(100))) {
+        logErrln("[applyCacheImage] Failed to acquire mutex");
+        return false;
+    }
+
+    uint64_t now = TimeService::micros64();
+    uint16_t mismatched = 0;
+    const uint8_t* entry = image + CACHE_IMAGE_HEADER_SIZE;
+    for (uint16_t i = 0; i < count; i++, entry += CACHE_IMAGE_ENTRY_SIZE) {
+        uint16_t address = getLE16(entry);
+        uint32_t value = getLE32(entry + 4);
+        uint32_t age = getLE32(entry + 8);
+
+        // Skip registers the primary has never read or that we do not cache
+        auto definition = registerDefinitions.find(address);
+        if (age == 0xFFFFFFFF || definition == registerDefinitions.end()) {
+            continue;
+        }
+        // A primary with a different register map would have us misread the width
+        if (entry[2] != static_cast<uint8_t>(definition->second.type)) {
+            mismatched++;
+            continue;
+        }
+        if (!setRegisterValue(address, value, is32BitRegisterType(definition->second))) {
+            continue;
+        }
+        // Carry the primary's sample age over so staleness is measured end to end
+        uint64_t ageUs = static_cast<uint64_t>(age) * 1000;
+        registerTimestamps[address] = now > ageUs ? now - ageUs : 1;
+        if (isStaticRegister(address)) {
+            fetchedStaticRegisters.insert(address);
+        } else if (isDynamicRegister(address)) {
+            fetchedDynamicRegisters.insert(address);
+        }
+    }
+
+    if (mismatched > 0) {
+        logErrln("[applyCacheImage] Skipped " + String(mismatched) + " registers with a different type on the primary");
+    }
+
+    staticRegistersFetched = fetchedStaticRegisters.size() == staticRegisterAddresses.size();
+    dynamicRegistersFetched = fetchedDynamicRegisters.size() == dynamicRegisterAddresses.size();
+
+    // Only count as fresh data if the primary itself is still receiving from the meter
+    if (primaryOperational) {
+        lastSuccessfulUpdate = TimeService::millis64();
+    }
+
+    xSemaphoreGiveRecursive(mutex);
+    return true;
+}
+
+void ModbusCache::bulkSyncTask(void* param) {
+    ModbusCache* cache = static_cast<ModbusCache*>(param);
+    String url = "http://" + cache->serverIP.toString() + "/cache.bin";
+    String etag;
+    std::vector<uint8_t> image;
+    const char* headerKeys[] = {"ETag"};
+
+    for (;;) {
+        vTaskDelay(pdMS_TO_TICKS(cache->update_interval));
+        if (WiFi.status() != WL_CONNECTED) {
+            continue;
+        }
+
+        HTTPClient http;
+        http.setTimeout(2000);
+        if (!http.begin(url)) {
+            cache->bulkSyncErrors++;
+            continue;
+        }
+        http.collectHeaders(headerKeys, 1);
+        if (etag.length() > 0) {
+            http.addHeader("If-None-Match", etag);
+        }
+
+        cache->bulkSyncRequests++;
+        int httpCode = http.GET();
+        if (httpCode == 304) {
+            // Nothing changed; only fresh if the image we hold came from an operational primary
+            cache->bulkSyncNotModified++;
+            if (!etag.endsWith("-stale\"")) {
+                if (xSemaphoreTakeRecursive(cache->mutex, pdMS_TO_TICKS(50))) {
+                    cache->lastSuccessfulUpdate = TimeService::millis64();
+                    xSemaphoreGiveRecursive(cache->mutex);
+                } else {
+                    cache->mutexAcquisitionFailures++;
+                }
+            }
+        } else if (httpCode == 200) {
+            int size = http.getSize();
+            WiFiClient* stream = http.getStreamPtr();
+            if (size <= 0 || size > CACHE_IMAGE_HEADER_SIZE + MAX_REGISTERS * CACHE_IMAGE_ENTRY_SIZE || stream == nullptr) {
+                cache->bulkSyncErrors++;
+            } else {
+                image.resize(size);
+                size_t received = stream->readBytes(image.data(), size);
+                if (received == (size_t)size && cache->applyCacheImage(image.data(), received)) {
+                    etag = http.header("ETag");
+                } else {
+                    cache->bulkSyncErrors++;
+                    etag = "";
+                }
+            }
+        } else {
+            cache->bulkSyncErrors++;
+            dbgln("[bulkSyncTask] GET " + url + " returned " + String(httpCode));
+        }
+        http.end();
+    }
+}
@@ -0,0 +1,151 @@
+#include "bus_stats.h"
+#include "config.h"
+#include "time_service.h"
+
+// Global instance
+BusStats busStats;
+
+constexpr uint16_t BusStats::GAP_BUCKET_MS[BUS_STATS_GAP_BUCKETS];
+
+BusStats::BusStats()
+    : lock(portMUX_INITIALIZER_UNLOCKED)
+    , charTimeUs(0)
+    , lastCompletedUs(0)
+    , transactions(0)
+    , timeouts(0)
+    , airtimeUs(0)
+    , busyUs(0)
+    , turnaroundUs(0)
+    , maxTurnaroundUs(0)
+    , gapSumUs(0)
+    , gapCount(0)
+    , rangeCount(0)
+    , windowStartUs(0)
+    , windowBusyUs(0)
+    , windowAirtimeUs(0)
+    , windowPollBusyUs(0)
+    , lastBusyPercent(0)
+    , lastAirtimePercent(0)
+    , lastPollBusyPercent(0)
+{
+    memset(gapBuckets, 0, sizeof(gapBuckets));
+    memset(ranges, 0, sizeof(ranges));
+}
+
+void BusStats::begin(unsigned long baudRate, uint8_t bitsPerChar) {
+    charTimeUs = baudRate > 0 ? (1000000UL * bitsPerChar) / baudRate : 0;
+    windowStartUs = TimeService::micros64();
+    dbgln("[BusStats] Character time " + String(charTimeUs) + " us at " + String(baudRate) + " baud");
+}
+
+void BusStats::recordTransaction(uint16_t startAddress, uint16_t regCount, size_t requestBytes, size_t responseBytes,
+                                 uint64_t queuedUs, uint64_t completedUs) {
+    if (!isEnabled()) return;
+
+    uint32_t airtime = frameAirtimeUs(requestBytes) + frameAirtimeUs(responseBytes);
+
+    portENTER_CRITICAL(&lock);
+    rollWindow(completedUs);
+
+    // Queued behind the previous transaction, the bus was busy until it completed
+    uint64_t startUs = max(queuedUs, lastCompletedUs);
+    startUs = min(startUs, completedUs);
+    uint64_t duration = completedUs - startUs;
+
+    if (lastCompletedUs != 0) {
+        uint64_t gapUs = startUs - min(startUs, lastCompletedUs);
+        uint8_t bucket = 0;
+        while (bucket < BUS_STATS_GAP_BUCKETS && gapUs > GAP_BUCKET_MS[bucket] * 1000ULL) {
+            bucket++;
+        }
+        gapBuckets[bucket]++;
+        gapSumUs += gapUs;
+        gapCount++;
+    }
+    lastCompletedUs = max(lastCompletedUs, completedUs);
+
+    transactions++;
+    busyUs += duration;
+    windowBusyUs += duration;
+    if (startAddress != BUS_STATS_GATEWAY_RANGE) {
+        windowPollBusyUs += duration;
+    }
+    if (responseBytes == 0) {
+        // The whole timeout is lost bus time, none of it is airtime
+        timeouts++;
+        airtime = frameAirtimeUs(requestBytes);
+    } else {
+        uint32_t turnaround = duration > airtime ? duration - airtime : 0;
+        turnaroundUs += turnaround;
+        maxTurnaroundUs = max(maxTurnaroundUs, turnaround);
+    }
+    airtimeUs += airtime;
+    windowAirtimeUs += airtime;
+
+    BusRangeStats* range = nullptr;
+    for (uint8_t i = 0; i < rangeCount; i++) {
+        if (ranges[i].startAddress == startAddress && ranges[i].regCount == regCount) {
+            range = &ranges[i];
+            break;
+        }
+    }
+    if (range == nullptr && rangeCount < BUS_STATS_MAX_RANGES) {
+        range = &ranges[rangeCount++];
+        range->startAddress = startAddress;
+        range->regCount = regCount;
+    }
+    if (range != nullptr) {
+        range->transactions++;
+        range->airtimeUs += airtime;
+        range->busyUs += duration;
+    }
+    portEXIT_CRITICAL(&lock);
+}
+
+// Called with the lock held
+void BusStats::rollWindow(uint64_t nowUs) {
+    uint64_t elapsed = nowUs > windowStartUs ? nowUs - windowStartUs : 0;
+    if (elapsed < BUS_STATS_WINDOW_MS * 1000ULL) return;
+
+    lastBusyPercent = min(100.0f, windowBusyUs * 100.0f / elapsed);
+    lastAirtimePercent = min(100.0f, windowAirtimeUs * 100.0f / elapsed);
+    lastPollBusyPercent = min(100.0f, windowPollBusyUs * 100.0f / elapsed);
+    windowStartUs = nowUs;
+    windowBusyUs = 0;
+    windowAirtimeUs = 0;
+    windowPollBusyUs = 0;
+}
+
+BusStatsSnapshot BusStats::getSnapshot() {
+    BusStatsSnapshot snapshot;
+    snapshot.ranges.reserve(BUS_STATS_MAX_RANGES);
+
+    portENTER_CRITICAL(&lock);
+    rollWindow(TimeService::micros64());
+    snapshot.enabled = isEnabled();
+    snapshot.charTimeUs = charTimeUs;
+    snapshot.transactions = transactions;
+    snapshot.timeouts = timeouts;
+    snapshot.airtimeUs = airtimeUs;
+    snapshot.busyUs = busyUs;
+    snapshot.turnaroundUs = turnaroundUs;
+    snapshot.maxTurnaroundUs = maxTurnaroundUs;
+    snapshot.busyPercent = lastBusyPercent;
+    snapshot.airtimePercent = lastAirtimePercent;
+    memcpy(snapshot.gapBuckets, gapBuckets, sizeof(gapBuckets));
+    snapshot.gapSumUs = gapSumUs;
+    snapshot.gapCount = gapCount;
+    float pollBusyPercent = lastPollBusyPercent;
+    for (uint8_t i = 0; i < rangeCount; i++) {
+        snapshot.ranges.push_back(ranges[i]);
+    }
+    portEXIT_CRITICAL(&lock);
+
+    // Each extra register adds two characters to a read response; an extra
+    // slave polled like the ET112 costs what the cache poller uses today
+    snapshot.headroomPercent = max(0.0f, BUS_STATS_TARGET_PERCENT - snapshot.busyPercent);
+    float headroomUsPerSecond = snapshot.headroomPercent * 10000.0f;
+    snapshot.headroomRegistersPerSecond = charTimeUs > 0 ? headroomUsPerSecond / (2.0f * charTimeUs) : 0.0f;
+    snapshot.headroomSlaves = pollBusyPercent > 0.0f ? snapshot.headroomPercent / pollBusyPercent : 0.0f;
+    return snapshot;
+}
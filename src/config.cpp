@@ -1,11 +1,16 @@
 #include "config.h"
 #include <WiFi.h>
+#include "time_service.h"
+#include "log_shipper.h"
+#include "turnaround_stats.h"
 
 Config::Config()
     :_prefs(NULL)
     ,_tcpPort(502)
     ,_tcpPort2(502)
     ,_tcpPort3(10502)
+    ,_tcpPort4(8899)
+    ,_tcpSocketServer(false)
     ,_targetIP("127.0.0.1")
     ,_tcpTimeout(10000)
     ,_modbusBaudRate(9600)
@@ -17,11 +22,26 @@ Config::Config()
     ,_serialBaudRate(115200)
     ,_serialConfig(SERIAL_8N1)
     ,_clientIsRTU(true)
+    ,_snifferMode(false)
     ,_pollingInterval(500)
     ,_staticIP("0.0.0.0")
     ,_staticGateway("0.0.0.0")
     ,_staticSubnet("255.255.255.0")
     ,_useStaticIP(false)
+    ,_eventRules("")
+    ,_eventSinkType(0)
+    ,_eventSinkTarget("")
+    ,_gatewayUnits("")
+    ,_gatewayShare(20)
+    ,_bulkSync(false)
+    ,_ntpServer(TIME_SERVICE_DEFAULT_NTP_SERVER)
+    ,_syslogTarget("")
+    ,_syslogTransport(0)
+    ,_syslogRate(SYSLOG_DEFAULT_RATE)
+    ,_responseBudget(TURNAROUND_DEFAULT_BUDGET_MS)
+    ,_demandPolling(false)
+    ,_prefetch(false)
+    ,_ouiOnline(true)
 {}
 
 void Config::begin(Preferences *prefs)
@@ -30,6 +50,8 @@ void Config::begin(Preferences *prefs)
     _tcpPort = _prefs->getUShort("tcpPort", _tcpPort);
     _tcpPort2 = _prefs->getUShort("tcpPort2", _tcpPort2);
     _tcpPort3 = _prefs->getUShort("tcpPort3", _tcpPort3);
+    _tcpPort4 = _prefs->getUShort("tcpPort4", _tcpPort4);
+    _tcpSocketServer = _prefs->getBool("tcpSocket", _tcpSocketServer);
     _targetIP = _prefs->getString("targetIP", _targetIP);
     _tcpTimeout = _prefs->getULong("tcpTimeout", _tcpTimeout);
     _modbusBaudRate = _prefs->getULong("modbusBaudRate", _modbusBaudRate);
@@ -41,11 +63,26 @@ void Config::begin(Preferences *prefs)
     _serialBaudRate = _prefs->getULong("serialBaudRate", _serialBaudRate);
     _serialConfig = _prefs->getULong("serialConfig", _serialConfig);
     _clientIsRTU = _prefs->getBool("clientIsRTU", _clientIsRTU);
+    _snifferMode = _prefs->getBool("sniffer", _snifferMode);
     _pollingInterval = _prefs->getULong("pollingInterval", _pollingInterval);
     _staticIP = _prefs->getString("staticIP", _staticIP);
     _staticGateway = _prefs->getString("staticGateway", _staticGateway);
     _staticSubnet = _prefs->getString("staticSubnet", _staticSubnet);
     _useStaticIP = _prefs->getBool("useStaticIP", _useStaticIP);
+    _eventRules = _prefs->getString("eventRules", _eventRules);
+    _eventSinkType = _prefs->getUChar("eventSink", _eventSinkType);
+    _eventSinkTarget = _prefs->getString("eventTarget", _eventSinkTarget);
+    _gatewayUnits = _prefs->getString("gatewayUnits", _gatewayUnits);
+    _gatewayShare = _prefs->getUChar("gatewayShare", _gatewayShare);
+    _bulkSync = _prefs->getBool("bulkSync", _bulkSync);
+    _ntpServer = _prefs->getString("ntpServer", _ntpServer);
+    _syslogTarget = _prefs->getString("syslogTarget", _syslogTarget);
+    _syslogTransport = _prefs->getUChar("syslogProto", _syslogTransport);
+    _syslogRate = _prefs->getULong("syslogRate", _syslogRate);
+    _responseBudget = _prefs->getUShort("respBudget", _responseBudget);
+    _demandPolling = _prefs->getBool("demandPoll", _demandPolling);
+    _prefetch = _prefs->getBool("prefetch", _prefetch);
+    _ouiOnline = _prefs->getBool("ouiOnline", _ouiOnline);
     if (_prefs->isKey("hostname")) {
         _hostname = _prefs->getString("hostname", "");  // Use stored hostname if present
     } else {
@@ -67,6 +104,10 @@ uint16_t Config::getTcpPort3(){
     return _tcpPort3;
 }
 
+uint16_t Config::getTcpPort4(){
+    return _tcpPort4;
+}
+
 void Config::setTcpPort(uint16_t value){
     if (_tcpPort == value) return;
     _tcpPort = value;
@@ -85,6 +126,22 @@ void Config::setTcpPort3(uint16_t value){
     _prefs->putUShort("tcpPort3", _tcpPort3);
 }
 
+void Config::setTcpPort4(uint16_t value){
+    if (_tcpPort4 == value) return;
+    _tcpPort4 = value;
+    _prefs->putUShort("tcpPort4", _tcpPort4);
+}
+
+bool Config::getTcpSocketServer() const {
+    return _tcpSocketServer;
+}
+
+void Config::setTcpSocketServer(bool value) {
+    if (_tcpSocketServer == value) return;
+    _tcpSocketServer = value;
+    _prefs->putBool("tcpSocket", _tcpSocketServer);
+}
+
 String Config::getTargetIP() const {
     return _targetIP;
 }
@@ -289,6 +346,16 @@ bool Config::getClientIsRTU(){
     return _clientIsRTU;
 }
 
+bool Config::getSnifferMode() const {
+    return _snifferMode;
+}
+
+void Config::setSnifferMode(bool value) {
+    if (_snifferMode == value) return;
+    _snifferMode = value;
+    _prefs->putBool("sniffer", _snifferMode);
+}
+
 unsigned long Config::getPollingInterval(){
     return _pollingInterval;
 }
@@ -348,3 +415,143 @@ void Config::setUseStaticIP(bool useStatic) {
 bool Config::getUseStaticIP() const {
     return _useStaticIP;
 }
+
+String Config::getEventRules() const {
+    return _eventRules;
+}
+
+void Config::setEventRules(const String& rules) {
+    if (_eventRules == rules) return;
+    _eventRules = rules;
+    _prefs->putString("eventRules", _eventRules);
+}
+
+uint8_t Config::getEventSinkType() const {
+    return _eventSinkType;
+}
+
+void Config::setEventSinkType(uint8_t value) {
+    if (_eventSinkType == value) return;
+    _eventSinkType = value;
+    _prefs->putUChar("eventSink", _eventSinkType);
+}
+
+String Config::getEventSinkTarget() const {
+    return _eventSinkTarget;
+}
+
+void Config::setEventSinkTarget(const String& target) {
+    if (_eventSinkTarget == target) return;
+    _eventSinkTarget = target;
+    _prefs->putString("eventTarget", _eventSinkTarget);
+}
+
+String Config::getGatewayUnits() const {
+    return _gatewayUnits;
+}
+
+void Config::setGatewayUnits(const String& units) {
+    if (_gatewayUnits == units) return;
+    _gatewayUnits = units;
+    _prefs->putString("gatewayUnits", _gatewayUnits);
+}
+
+uint8_t Config::getGatewayShare() const {
+    return _gatewayShare;
+}
+
+void Config::setGatewayShare(uint8_t value) {
+    if (_gatewayShare == value) return;
+    _gatewayShare = value;
+    _prefs->putUChar("gatewayShare", _gatewayShare);
+}
+
+bool Config::getBulkSync() const {
+    return _bulkSync;
+}
+
+void Config::setBulkSync(bool value) {
+    if (_bulkSync == value) return;
+    _bulkSync = value;
+    _prefs->putBool("bulkSync", _bulkSync);
+}
+
+String Config::getNtpServer() const {
+    return _ntpServer;
+}
+
+void Config::setNtpServer(const String& server) {
+    if (_ntpServer == server) return;
+    _ntpServer = server;
+    _prefs->putString("ntpServer", _ntpServer);
+}
+
+String Config::getSyslogTarget() const {
+    return _syslogTarget;
+}
+
+void Config::setSyslogTarget(const String& target) {
+    if (_syslogTarget == target) return;
+    _syslogTarget = target;
+    _prefs->putString("syslogTarget", _syslogTarget);
+}
+
+uint8_t Config::getSyslogTransport() const {
+    return _syslogTransport;
+}
+
+void Config::setSyslogTransport(uint8_t value) {
+    if (_syslogTransport == value) return;
+    _syslogTransport = value;
+    _prefs->putUChar("syslogProto", _syslogTransport);
+}
+
+uint32_t Config::getSyslogRate() const {
+    return _syslogRate;
+}
+
+void Config::setSyslogRate(uint32_t value) {
+    if (_syslogRate == value) return;
+    _syslogRate = value;
+    _prefs->putULong("syslogRate", _syslogRate);
+}
+
+uint16_t Config::getResponseBudget() const {
+    return _responseBudget;
+}
+
+void Config::setResponseBudget(uint16_t value) {
+    if (_responseBudget == value) return;
+    _responseBudget = value;
+    _prefs->putUShort("respBudget", _responseBudget);
+}
+
+bool Config::getDemandPolling() const {
+    return _demandPolling;
+}
+
+void Config::setDemandPolling(bool value) {
+    if (_demandPolling == value) return;
+    _demandPolling = value;
+    _prefs->putBool("demandPoll", _demandPolling);
+}
+
+bool Config::getPrefetch() const {
+    return _prefetch;
+}
+
+void Config::setPrefetch(bool value) {
+    if (_prefetch == value) return;
+    _prefetch = value;
+    _prefs->putBool("prefetch", _prefetch);
+}
+
+bool Config::getOuiOnline() const {
+    return _ouiOnline;
+}
+
+void Config::setOuiOnline(bool value) {
+    if (_ouiOnline == value) return;
+    _ouiOnline = value;
+    _prefs->putBool("ouiOnline", _ouiOnline);
+}
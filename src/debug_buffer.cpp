@@ -1,183 +1,337 @@
 #include "debug_buffer.h"
+#include "time_service.h"
 
 // Global instance
 DebugRingBuffer debugBuffer;
 
-DebugRingBuffer::DebugRingBuffer() {
-    memset(buffer, 0, DEBUG_BUFFER_SIZE);
+// Text the compressor may reference from every block as if it preceded the
+// block: the prefixes of the lines the poll loop and web server log most
+static const char LOG_DICTIONARY[] =
+    "[webserver] GET /[webserver] POST /config[WiFi] [purgeAgedTokens] Purging "
+    "[updateServerStatus] Server is now operational[respondFromCache] Long operation: "
+    "[processResponsePayload] Processing payload...[processResponsePayload] Done processing payload"
+    "[processRegisterRange] Request in flight for ms, skipping"
+    "[RequestMap Status] Total: 0, In-Flight: 0, Age Range: 0ms to 0ms\n"
+    "[update] Updating Modbus Cache\n[update] Processing dynamic register range "
+    "[processRegisterRange] Sent request for range  with token  at time "
+    "[handleData] Response time for token : 0. ms\n[update] Server status updated\n";
+static const size_t LOG_DICTIONARY_LEN = sizeof(LOG_DICTIONARY) - 1;
+
+// Blocks use the LZ4 sequence layout: a token with the literal length in the
+// high nibble and the match length minus 4 in the low nibble, 255-run length
+// extensions, the literals, then a little-endian 16-bit match offset. Offsets
+// count back through the decoded block and on into the dictionary. The last
+// sequence carries literals only.
+#define LZ_MIN_MATCH 4
+
+static inline uint8_t historyAt(const uint8_t* text, size_t pos) {
+    return pos < LOG_DICTIONARY_LEN ? static_cast<uint8_t>(LOG_DICTIONARY[pos]) : text[pos - LOG_DICTIONARY_LEN];
 }
 
-void DebugRingBuffer::add(const String& message) {
-    std::lock_guard<std::mutex> lock(bufferMutex);
-    
-    // Ensure the message ends with a newline
-    String formattedMessage = message;
-    if (!formattedMessage.endsWith("\n")) {
-        formattedMessage += "\n";
+static inline uint32_t read32(const uint8_t* text, size_t pos) {
+    if (pos >= LOG_DICTIONARY_LEN) {
+        uint32_t value;
+        memcpy(&value, text + pos - LOG_DICTIONARY_LEN, sizeof(value));
+        return value;
     }
-    
-    // Add timestamp to the message
-    String timestampedMessage = "[" + String(millis() / 1000) + "s] " + formattedMessage;
-    
-    size_t msgLen = timestampedMessage.length();
-    
-    // Check if message is too large for the buffer
-    if (msgLen >= DEBUG_BUFFER_SIZE) {
-        // Just store the last part of the message that fits
-        const char* msgStr = timestampedMessage.c_str();
-        memcpy(buffer, msgStr + (msgLen - DEBUG_BUFFER_SIZE + 1), DEBUG_BUFFER_SIZE - 1);
-        buffer[DEBUG_BUFFER_SIZE - 1] = '\0';
-        head = 0;
-        tail = DEBUG_BUFFER_SIZE - 1;
-        size = DEBUG_BUFFER_SIZE - 1;
-        overflow = true;
-        return;
+    return historyAt(text, pos) | historyAt(text, pos + 1) << 8 | historyAt(text, pos + 2) << 16 |
+           static_cast<uint32_t>(historyAt(text, pos + 3)) << 24;
+}
+
+static inline uint16_t hash32(uint32_t value) {
+    return (value * 2654435761U) >> (32 - LOG_HASH_BITS);
+}
+
+static bool putLength(uint8_t* dest, size_t& out, size_t capacity, size_t length) {
+    while (length >= 255) {
+        if (out >= capacity) return false;
+        dest[out++] = 255;
+        length -= 255;
     }
-    
-    // Check if we need to overwrite old data
-    if (size + msgLen >= DEBUG_BUFFER_SIZE) {
-        // Mark that we've overflowed
-        overflow = true;
-        
-        // For larger buffers, we can be more efficient by removing larger chunks at once
-        // Calculate how much space we need to free up
-        size_t spaceNeeded = (size + msgLen) - DEBUG_BUFFER_SIZE + 1024; // Add some extra margin
-        
-        // Remove old data to make room
-        while (size > 0 && spaceNeeded > 0) {
-            // Find the next newline to remove a complete line
-            size_t i = tail;
-            size_t lineLength = 0;
-            
-            while (i != head && buffer[i] != '\n') {
-                i = (i + 1) % DEBUG_BUFFER_SIZE;
-                lineLength++;
-            }
-            
-            // Include the newline character
-            if (i != head) {
-                lineLength++; // Count the newline
-                i = (i + 1) % DEBUG_BUFFER_SIZE;
-            }
-            
-            // Update tail and size
-            tail = i;
-            size -= lineLength;
-            spaceNeeded -= lineLength;
+    if (out >= capacity) return false;
+    dest[out++] = length;
+    return true;
+}
+
+static bool putSequence(uint8_t* dest, size_t& out, size_t capacity, const uint8_t* literals,
+                        size_t literalLen, size_t offset, size_t matchLen) {
+    if (out >= capacity) return false;
+    size_t tokenPos = out++;
+    uint8_t token = min<size_t>(literalLen, 15) << 4;
+    if (literalLen >= 15 && !putLength(dest, out, capacity, literalLen - 15)) return false;
+    if (out + literalLen > capacity) return false;
+    memcpy(dest + out, literals, literalLen);
+    out += literalLen;
+    if (matchLen > 0) {
+        token |= min<size_t>(matchLen - LZ_MIN_MATCH, 15);
+        if (out + 2 > capacity) return false;
+        dest[out++] = offset & 0xFF;
+        dest[out++] = offset >> 8;
+        if (matchLen - LZ_MIN_MATCH >= 15 && !putLength(dest, out, capacity, matchLen - LZ_MIN_MATCH - 15)) return false;
+    }
+    dest[tokenPos] = token;
+    return true;
+}
+
+// Returns the compressed length, or 0 if it would not fit in capacity
+static size_t compressBlock(const uint8_t* src, size_t srcLen, uint8_t* dest, size_t capacity, uint16_t* table) {
+    // Positions count from the start of the dictionary; 0 marks an empty slot
+    memset(table, 0, sizeof(uint16_t) << LOG_HASH_BITS);
+    for (size_t pos = 0; pos + LZ_MIN_MATCH <= LOG_DICTIONARY_LEN; pos++) {
+        table[hash32(read32(src, pos))] = pos + 1;
+    }
+
+    size_t end = LOG_DICTIONARY_LEN + srcLen;
+    size_t anchor = LOG_DICTIONARY_LEN;
+    size_t pos = LOG_DICTIONARY_LEN;
+    size_t out = 0;
+    while (pos + LZ_MIN_MATCH <= end) {
+        uint32_t sequence = read32(src, pos);
+        uint16_t& slot = table[hash32(sequence)];
+        size_t candidate = slot;
+        slot = pos + 1;
+        if (candidate == 0 || read32(src, candidate - 1) != sequence) {
+            pos++;
+            continue;
+        }
+        candidate--;
+        size_t matchLen = LZ_MIN_MATCH;
+        while (pos + matchLen < end && historyAt(src, candidate + matchLen) == historyAt(src, pos + matchLen)) {
+            matchLen++;
+        }
+        if (!putSequence(dest, out, capacity, src + anchor - LOG_DICTIONARY_LEN, pos - anchor, pos - candidate, matchLen)) {
+            return 0;
         }
+        pos += matchLen;
+        anchor = pos;
     }
-    
-    // Add the new message - use memcpy for efficiency with larger messages
-    if (msgLen > 20) {
-        // If the message wraps around the buffer, we need to do it in two parts
-        const char* msgStr = timestampedMessage.c_str();
-        size_t firstPart = DEBUG_BUFFER_SIZE - head;
-        if (msgLen <= firstPart) {
-            // Message fits before the end of the buffer
-            memcpy(buffer + head, msgStr, msgLen);
-            head = (head + msgLen) % DEBUG_BUFFER_SIZE;
-            size += msgLen;
-        } else {
-            // Message wraps around the buffer
-            memcpy(buffer + head, msgStr, firstPart);
-            memcpy(buffer, msgStr + firstPart, msgLen - firstPart);
-            head = msgLen - firstPart;
-            size += msgLen;
+    if (!putSequence(dest, out, capacity, src + anchor - LOG_DICTIONARY_LEN, end - anchor, 0, 0)) {
+        return 0;
+    }
+    return out;
+}
+
+// Returns the decoded length, or 0 if the block is corrupt
+static size_t decompressBlock(const uint8_t* src, size_t srcLen, uint8_t* dest, size_t capacity) {
+    size_t in = 0;
+    size_t out = 0;
+    while (in < srcLen) {
+        uint8_t token = src[in++];
+        size_t literalLen = token >> 4;
+        if (literalLen == 15) {
+            uint8_t extra;
+            do {
+                if (in >= srcLen) return 0;
+                extra = src[in++];
+                literalLen += extra;
+            } while (extra == 255);
         }
-    } else {
-        // For small messages, use the original approach
-        for (size_t i = 0; i < msgLen; i++) {
-            buffer[head] = timestampedMessage[i];
-            head = (head + 1) % DEBUG_BUFFER_SIZE;
-            size++;
+        if (in + literalLen > srcLen || out + literalLen > capacity) return 0;
+        memcpy(dest + out, src + in, literalLen);
+        in += literalLen;
+        out += literalLen;
+        if (in >= srcLen) {
+            break;
+        }
+
+        if (in + 2 > srcLen) return 0;
+        size_t offset = src[in] | src[in + 1] << 8;
+        in += 2;
+        size_t matchLen = (token & 0x0F) + LZ_MIN_MATCH;
+        if ((token & 0x0F) == 15) {
+            uint8_t extra;
+            do {
+                if (in >= srcLen) return 0;
+                extra = src[in++];
+                matchLen += extra;
+            } while (extra == 255);
+        }
+        size_t from = LOG_DICTIONARY_LEN + out;
+        if (offset == 0 || offset > from || out + matchLen > capacity) return 0;
+        from -= offset;
+        // Byte by byte: matches may overlap their own output
+        for (size_t i = 0; i < matchLen; i++) {
+            dest[out] = historyAt(dest, from + i);
+            out++;
         }
     }
+    return out;
 }
 
-String DebugRingBuffer::getAll() {
+DebugRingBuffer::DebugRingBuffer() {
+    memset(arena, 0, sizeof(arena));
+    memset(openBlock, 0, sizeof(openBlock));
+}
+
+void DebugRingBuffer::add(const String& message, char level) {
+    // Add timestamp and level marker to the message
+    char prefix[32];
+    size_t prefixLen = snprintf(prefix, sizeof(prefix), "[%lus] %c ",
+                                static_cast<unsigned long>(TimeService::millis64() / 1000), level);
+    bool needsNewline = !message.endsWith("\n");
+
     std::lock_guard<std::mutex> lock(bufferMutex);
-    
-    // Allow other tasks to run
-    yield();
-    
-    String result;
-    result.reserve(size + 1);
-    
-    size_t current = tail;
-    for (size_t i = 0; i < size; i++) {
-        result += buffer[current];
-        current = (current + 1) % DEBUG_BUFFER_SIZE;
-        
-        // Allow other tasks to run periodically during large transfers
-        if (i > 0 && i % 500 == 0) {
-            yield();
+    size_t msgLen = prefixLen + message.length() + (needsNewline ? 1 : 0);
+    written += msgLen;
+    retained += msgLen;
+
+    // Keep lines within one block unless they are longer than a block
+    if (openLen + msgLen > LOG_BLOCK_SIZE && msgLen <= LOG_BLOCK_SIZE) {
+        seal();
+    }
+    append(prefix, prefixLen);
+    append(message.c_str(), message.length());
+    if (needsNewline) {
+        append("\n", 1);
+    }
+}
+
+// Called with the mutex held
+void DebugRingBuffer::append(const char* data, size_t len) {
+    while (len > 0) {
+        if (openLen == LOG_BLOCK_SIZE) {
+            seal();
         }
+        size_t count = min(len, LOG_BLOCK_SIZE - openLen);
+        memcpy(openBlock + openLen, data, count);
+        openLen += count;
+        data += count;
+        len -= count;
     }
-    
-    return result;
 }
 
-String DebugRingBuffer::getNewMessages(size_t& lastPosition) {
-    std::lock_guard<std::mutex> lock(bufferMutex);
-    
-    // Allow other tasks to run
-    yield();
-    
-    // If lastPosition is out of bounds or we've overflowed, return all messages
-    if (lastPosition >= DEBUG_BUFFER_SIZE || overflow) {
-        lastPosition = (head == 0) ? DEBUG_BUFFER_SIZE - 1 : head - 1;
-        overflow = false;
-        return getAll();
+// Called with the mutex held: compresses the open block into the arena
+void DebugRingBuffer::seal() {
+    if (openLen == 0) {
+        return;
     }
-    
-    // Calculate how many characters to read
-    size_t current = (lastPosition + 1) % DEBUG_BUFFER_SIZE;
-    size_t count = 0;
-    
-    if (current <= head) {
-        count = head - current;
-    } else {
-        count = (DEBUG_BUFFER_SIZE - current) + head;
+    uint64_t startUs = TimeService::micros64();
+
+    // The decode buffer doubles as compression output so only the compressed
+    // size needs arena space; a block that does not shrink is stored as is
+    decodedSeq = UINT32_MAX;
+    size_t storedLen = compressBlock(reinterpret_cast<const uint8_t*>(openBlock), openLen,
+                                     reinterpret_cast<uint8_t*>(decoded), openLen - 1, hashTable);
+    bool compressed = storedLen > 0;
+    if (!compressed) {
+        storedLen = openLen;
     }
-    
-    if (count == 0) {
-        return "";
+    if (blockCount == LOG_MAX_BLOCKS) {
+        evictOldest();
     }
-    
-    // Allow other tasks to run again if we have a lot of data
-    if (count > 1000) {
-        yield();
+    size_t pos = reserveArena(storedLen);
+    memcpy(arena + pos, compressed ? decoded : openBlock, storedLen);
+
+    LogBlock& block = blocks[(firstBlock + blockCount) % LOG_MAX_BLOCKS];
+    block.arenaPos = pos;
+    block.storedLen = storedLen;
+    block.rawLen = openLen;
+    block.compressed = compressed;
+    blockCount++;
+    arenaHead = pos + storedLen;
+    storedBytes += storedLen;
+    sealedBlocks++;
+    openLen = 0;
+
+    uint32_t elapsedUs = TimeService::micros64() - startUs;
+    compressUs += elapsedUs;
+    compressMaxUs = max(compressMaxUs, elapsedUs);
+}
+
+// Called with the mutex held: frees len contiguous arena bytes and returns where
+size_t DebugRingBuffer::reserveArena(size_t len) {
+    for (;;) {
+        if (blockCount == 0) {
+            arenaHead = 0;
+            return 0;
+        }
+        size_t oldestPos = blocks[firstBlock].arenaPos;
+        if (arenaHead > oldestPos) {
+            // Used space is one span; free space after it, then before it
+            if (ARENA_SIZE - arenaHead >= len) {
+                return arenaHead;
+            }
+            if (oldestPos >= len) {
+                return 0;
+            }
+        } else if (oldestPos - arenaHead >= len) {
+            // Used space wraps; the gap between the newest and oldest block is free
+            return arenaHead;
+        }
+        evictOldest();
     }
-    
-    String result;
-    result.reserve(count + 1);
-    
-    for (size_t i = 0; i < count; i++) {
-        result += buffer[current];
-        current = (current + 1) % DEBUG_BUFFER_SIZE;
-        
-        // Allow other tasks to run periodically during large transfers
-        if (i > 0 && i % 500 == 0) {
-            yield();
+}
+
+// Called with the mutex held
+void DebugRingBuffer::evictOldest() {
+    const LogBlock& block = blocks[firstBlock];
+    retained -= block.rawLen;
+    storedBytes -= block.storedLen;
+    firstBlock = (firstBlock + 1) % LOG_MAX_BLOCKS;
+    firstBlockSeq++;
+    blockCount--;
+    overflow = true;
+}
+
+// Called with the mutex held
+const char* DebugRingBuffer::segmentAt(uint64_t offset, size_t& available) {
+    uint64_t blockStart = written - retained;
+    if (offset < blockStart || offset >= written) {
+        available = 0;
+        return nullptr;
+    }
+    for (size_t i = 0; i < blockCount; i++) {
+        const LogBlock& block = blocks[(firstBlock + i) % LOG_MAX_BLOCKS];
+        if (offset < blockStart + block.rawLen) {
+            uint32_t seq = firstBlockSeq + i;
+            if (decodedSeq != seq) {
+                if (block.compressed) {
+                    size_t decodedLen = decompressBlock(arena + block.arenaPos, block.storedLen,
+                                                        reinterpret_cast<uint8_t*>(decoded), block.rawLen);
+                    if (decodedLen != block.rawLen) {
+                        // Never expected; keep readers going with a marker instead of garbage
+                        memset(decoded, '?', block.rawLen);
+                        decoded[block.rawLen - 1] = '\n';
+                    }
+                } else {
+                    memcpy(decoded, arena + block.arenaPos, block.rawLen);
+                }
+                decodedSeq = seq;
+            }
+            available = blockStart + block.rawLen - offset;
+            return decoded + (offset - blockStart);
         }
+        blockStart += block.rawLen;
     }
-    
-    lastPosition = (head == 0) ? DEBUG_BUFFER_SIZE - 1 : head - 1;
-    return result;
+    available = written - offset;
+    return openBlock + (offset - blockStart);
 }
 
-size_t DebugRingBuffer::getCurrentPosition() {
-    std::lock_guard<std::mutex> lock(bufferMutex);
-    return (head == 0) ? DEBUG_BUFFER_SIZE - 1 : head - 1;
+String DebugRingBuffer::getAll() {
+    String result;
+    uint64_t cursor = getOldestOffset();
+    uint64_t end = getWrittenBytes();
+    result.reserve(end - cursor + 1);
+    uint8_t chunk[256];
+    size_t count;
+    while ((count = readFrom(cursor, end, chunk, sizeof(chunk))) > 0) {
+        result.concat(reinterpret_cast<const char*>(chunk), count);
+        // Allow other tasks to run during large transfers
+        yield();
+    }
+    return result;
 }
 
 void DebugRingBuffer::clear() {
     std::lock_guard<std::mutex> lock(bufferMutex);
-    head = 0;
-    tail = 0;
-    size = 0;
+    firstBlock = 0;
+    blockCount = 0;
+    arenaHead = 0;
+    decodedSeq = UINT32_MAX;
+    openLen = 0;
+    retained = 0;
+    storedBytes = 0;
     overflow = false;
-    memset(buffer, 0, DEBUG_BUFFER_SIZE);
 }
 
 bool DebugRingBuffer::hasOverflowed() {
@@ -185,166 +339,200 @@ bool DebugRingBuffer::hasOverflowed() {
     return overflow;
 }
 
-String DebugRingBuffer::getChunk(size_t startPos, size_t endPos) {
+// Ultra lightweight method to get a small chunk of data safely
+String DebugRingBuffer::getSafeChunk(uint64_t startPos, size_t maxChars, uint64_t& newPosition) {
     std::lock_guard<std::mutex> lock(bufferMutex);
-    
-    // Allow other tasks to run
-    yield();
-    
-    // Validate positions
-    if (startPos >= DEBUG_BUFFER_SIZE || endPos >= DEBUG_BUFFER_SIZE || startPos >= endPos) {
-        return "";
-    }
-    
-    // Calculate how many characters to read
-    size_t count = endPos - startPos;
-    
-    // Limit to buffer size
-    if (count > size) {
-        count = size;
+    uint64_t current = startPos;
+    if (current < written - retained || current > written) {
+        current = written - retained;
     }
-    
-    // Allow other tasks to run again if we have a lot of data
-    if (count > 1000) {
-        yield();
-    }
-    
+
     String result;
-    result.reserve(count + 1);
-    
-    size_t current = startPos;
-    for (size_t i = 0; i < count; i++) {
-        result += buffer[current];
-        current = (current + 1) % DEBUG_BUFFER_SIZE;
-        
-        // Stop if we reach the head
-        if (current == head) {
+    result.reserve(min<uint64_t>(written - current, maxChars) + 1);
+    while (result.length() < maxChars) {
+        size_t available;
+        const char* data = segmentAt(current, available);
+        if (data == nullptr) {
             break;
         }
-        
-        // Allow other tasks to run periodically during large transfers
-        if (i > 0 && i % 500 == 0) {
-            yield();
-        }
+        size_t count = min(available, maxChars - result.length());
+        result.concat(data, count);
+        current += count;
+    }
+
+    // End on a complete line; the rest comes with the next request
+    int lastNewlinePos = result.lastIndexOf('\n');
+    if (lastNewlinePos >= 0 && lastNewlinePos < static_cast<int>(result.length()) - 1) {
+        current -= result.length() - (lastNewlinePos + 1);
+        result.remove(lastNewlinePos + 1);
     }
+
+    newPosition = current;
+    
+    // Reset overflow flag after reading
+    overflow = false;
     
     return result;
+} 
+
+static bool containsIgnoreCase(const char* haystack, size_t len, const String& needle) {
+    size_t needleLen = needle.length();
+    if (needleLen > len) return false;
+    const char* n = needle.c_str();
+    char first = tolower(n[0]);
+    for (size_t i = 0; i + needleLen <= len; i++) {
+        if (tolower(haystack[i]) == first && strncasecmp(haystack + i, n, needleLen) == 0) {
+            return true;
+        }
+    }
+    return false;
 }
 
-// Ultra lightweight method to get a small chunk of data safely
-String DebugRingBuffer::getSafeChunk(size_t startPos, size_t maxChars, size_t& newPosition) {
-    // Use a very short lock to minimize blocking
-    std::lock_guard<std::mutex> lock(bufferMutex);
-    
-    // Validate position
-    if (startPos >= DEBUG_BUFFER_SIZE || size == 0) {
-        newPosition = (head == 0) ? DEBUG_BUFFER_SIZE - 1 : head - 1;
-        return "";
+bool LogFilter::matches(const char* line, size_t len) const {
+    // Split "[<uptime>s] <level> <message>"; continuation lines of multi-line
+    // messages carry no prefix and only match text filters
+    char level = 0;
+    const char* message = line;
+    const char* close = static_cast<const char*>(memchr(line, ']', min<size_t>(len, 24)));
+    if (len > 0 && line[0] == '[' && close != nullptr && close + 4 <= line + len &&
+        close[1] == ' ' && close[3] == ' ') {
+        level = close[2];
+        message = close + 4;
     }
-    
-    // Calculate the current position
-    size_t current = (startPos + 1) % DEBUG_BUFFER_SIZE;
-    
-    // Check if we're already at the head
-    if (current == head) {
-        newPosition = (head == 0) ? DEBUG_BUFFER_SIZE - 1 : head - 1;
-        return "";
+    size_t messageLen = len - (message - line);
+
+    if (minLevel != 0) {
+        const char* rank = level != 0 ? strchr(LOG_LEVEL_MARKERS, level) : nullptr;
+        if (rank == nullptr || rank < strchr(LOG_LEVEL_MARKERS, minLevel)) {
+            return false;
+        }
     }
-    
-    // Calculate how many characters we can read
-    size_t availableChars = 0;
-    
-    if (current < head) {
-        availableChars = head - current;
-    } else {
-        availableChars = (DEBUG_BUFFER_SIZE - current) + head;
+    if (category.length() > 0) {
+        // "[WiFi]" and tagged forms such as "[sendRequest:42]" both match "WiFi"/"sendRequest"
+        size_t n = category.length();
+        if (messageLen < n + 2 || message[0] != '[' || strncasecmp(message + 1, category.c_str(), n) != 0 ||
+            (message[n + 1] != ']' && message[n + 1] != ':')) {
+            return false;
+        }
     }
-    
-    // Limit to maxChars
-    size_t charsToRead = (availableChars > maxChars) ? maxChars : availableChars;
-    
-    // Prepare result string with exact capacity
+    return text.length() == 0 || containsIgnoreCase(line, len, text);
+}
+
+String DebugRingBuffer::getFilteredChunk(uint64_t startPos, size_t maxChars, const LogFilter& filter,
+                                         uint64_t& newPosition, size_t& scanned) {
+    std::lock_guard<std::mutex> lock(bufferMutex);
+    scanned = 0;
+
+    uint64_t current = startPos;
+    if (current < written - retained || current > written) {
+        current = written - retained;
+    }
+
     String result;
-    result.reserve(charsToRead + 1);
-    
-    // Track the original starting position for position calculations
-    size_t originalCurrent = current;
-    size_t charsRead = 0;
-    
-    // For larger chunks, use a more efficient approach
-    if (charsToRead > 1000) {
-        // If the data doesn't wrap around the buffer, we can use a single memcpy
-        if (current + charsToRead <= DEBUG_BUFFER_SIZE) {
-            // Create a temporary buffer
-            char* tempBuffer = new char[charsToRead + 1];
-            memcpy(tempBuffer, buffer + current, charsToRead);
-            tempBuffer[charsToRead] = '\0';
-            
-            // Create the string from the buffer
-            result = String(tempBuffer);
-            delete[] tempBuffer;
+    result.reserve(min<uint64_t>(written - current, maxChars) + 1);
+    String spannedLine;
+
+    while (current < written) {
+        // Lines only cross a block boundary when they are longer than a block
+        size_t available;
+        const char* line = segmentAt(current, available);
+        const char* newline = static_cast<const char*>(memchr(line, '\n', available));
+        size_t lineLen;
+        if (newline != nullptr) {
+            lineLen = newline - line + 1;
         } else {
-            // Data wraps around the buffer, need two memcpy operations
-            size_t firstPartSize = DEBUG_BUFFER_SIZE - current;
-            size_t secondPartSize = charsToRead - firstPartSize;
-            
-            // Create a temporary buffer
-            char* tempBuffer = new char[charsToRead + 1];
-            memcpy(tempBuffer, buffer + current, firstPartSize);
-            memcpy(tempBuffer + firstPartSize, buffer, secondPartSize);
-            tempBuffer[charsToRead] = '\0';
-            
-            // Create the string from the buffer
-            result = String(tempBuffer);
-            delete[] tempBuffer;
-        }
-        
-        charsRead = result.length();
-        
-        // Find the last newline character to ensure we end on a complete line
-        int lastNewlinePos = result.lastIndexOf('\n');
-        if (lastNewlinePos >= 0 && lastNewlinePos < result.length() - 1) {
-            // Truncate to the last complete line
-            result = result.substring(0, lastNewlinePos + 1);
-            // Adjust chars read
-            charsRead = lastNewlinePos + 1;
-        }
-    } else {
-        // For smaller chunks, use the original approach
-        size_t i;
-        for (i = 0; i < charsToRead; i++) {
-            char c = buffer[current];
-            result += c;
-            current = (current + 1) % DEBUG_BUFFER_SIZE;
-            charsRead++;
-            
-            // Stop if we reach the head
-            if (current == head) {
-                break;
+            spannedLine = "";
+            uint64_t lineEnd = current;
+            while (newline == nullptr) {
+                spannedLine.concat(line, available);
+                lineEnd += available;
+                line = segmentAt(lineEnd, available);
+                if (line == nullptr) {
+                    break;
+                }
+                newline = static_cast<const char*>(memchr(line, '\n', available));
+                if (newline != nullptr) {
+                    spannedLine.concat(line, newline - line + 1);
+                }
             }
-        }
-        
-        // If we didn't read the full chunk and didn't end on a newline, find the last newline
-        if (i == charsToRead && result.length() > 0 && result[result.length() - 1] != '\n') {
-            int lastNewlinePos = result.lastIndexOf('\n');
-            if (lastNewlinePos >= 0) {
-                // Truncate to the last complete line
-                result = result.substring(0, lastNewlinePos + 1);
-                // Adjust chars read
-                charsRead = lastNewlinePos + 1;
+            if (newline == nullptr) {
+                break; // Partial line, never produced by add()
             }
+            line = spannedLine.c_str();
+            lineLen = spannedLine.length();
+        }
+
+        bool match = filter.matches(line, lineLen);
+        if (match && result.length() > 0 && result.length() + lineLen > maxChars) {
+            break; // Keep it for the next request
         }
+        if (match) {
+            result.concat(line, lineLen);
+        }
+        current += lineLen;
+        scanned += lineLen;
     }
-    
-    // Calculate the new position based on the original position and chars read
-    current = (originalCurrent + charsRead) % DEBUG_BUFFER_SIZE;
-    if (current == 0) current = DEBUG_BUFFER_SIZE - 1;
-    else current--;
-    
+
     newPosition = current;
-    
-    // Reset overflow flag after reading
     overflow = false;
-    
     return result;
-} 
\ No newline at end of file
+}
+
+uint64_t DebugRingBuffer::getWrittenBytes() {
+    std::lock_guard<std::mutex> lock(bufferMutex);
+    return written;
+}
+
+uint64_t DebugRingBuffer::getOldestOffset() {
+    std::lock_guard<std::mutex> lock(bufferMutex);
+    return written - retained;
+}
+
+size_t DebugRingBuffer::readFrom(uint64_t& cursor, uint64_t end, uint8_t* dest, size_t maxLen, uint64_t* skipped) {
+    std::lock_guard<std::mutex> lock(bufferMutex);
+    uint64_t oldest = written - retained;
+    if (cursor < oldest) {
+        // Overwritten while the reader was behind
+        if (skipped != nullptr) {
+            *skipped += oldest - cursor;
+        }
+        cursor = oldest;
+    }
+    end = min(end, written);
+
+    size_t count = 0;
+    while (cursor < end && count < maxLen) {
+        size_t available;
+        const char* data = segmentAt(cursor, available);
+        size_t part = min<uint64_t>(min(available, maxLen - count), end - cursor);
+        memcpy(dest + count, data, part);
+        count += part;
+        cursor += part;
+    }
+    return count;
+}
+
+uint64_t DebugRingBuffer::getRetainedBytes() {
+    std::lock_guard<std::mutex> lock(bufferMutex);
+    return retained;
+}
+
+uint32_t DebugRingBuffer::getStoredBytes() {
+    std::lock_guard<std::mutex> lock(bufferMutex);
+    return storedBytes + openLen;
+}
+
+uint32_t DebugRingBuffer::getSealedBlocks() {
+    std::lock_guard<std::mutex> lock(bufferMutex);
+    return sealedBlocks;
+}
+
+uint64_t DebugRingBuffer::getCompressUs() {
+    std::lock_guard<std::mutex> lock(bufferMutex);
+    return compressUs;
+}
+
+uint32_t DebugRingBuffer::getCompressMaxUs() {
+    std::lock_guard<std::mutex> lock(bufferMutex);
+    return compressMaxUs;
+}
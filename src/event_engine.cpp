@@ -0,0 +1,312 @@
+#include "event_engine.h"
+#include "config.h"
+#include "time_service.h"
+#include <WiFi.h>
+#include <WiFiUdp.h>
+#include <HTTPClient.h>
+
+// Global instance
+EventEngine eventEngine;
+
+// MQTT 3.1.1 keepalive advertised to the broker, must exceed EVENT_SINK_IDLE_MS
+#define MQTT_KEEPALIVE_SECONDS 60
+#define MQTT_DEFAULT_PORT 1883
+
+EventEngine::EventEngine()
+    : rulesMutex(nullptr)
+    , sinkMutex(nullptr)
+    , eventQueue(nullptr)
+    , sinkTaskHandle(nullptr)
+    , sinkType(EventSinkType::NONE)
+    , sinkChanged(false)
+    , mqttLastActivity(0)
+    , ruleCount(0)
+    , eventsRaised(0)
+    , eventsCleared(0)
+    , eventsDropped(0)
+    , eventsDelivered(0)
+    , deliveryFailures(0)
+    , lastNotifyLatency(0)
+    , maxNotifyLatency(0)
+    , totalNotifyLatency(0)
+{}
+
+void EventEngine::begin(const String& ruleSpec, uint8_t type, const String& target) {
+    rulesMutex = xSemaphoreCreateMutex();
+    sinkMutex = xSemaphoreCreateMutex();
+    eventQueue = xQueueCreate(EVENT_QUEUE_LENGTH, sizeof(ThresholdEvent));
+    if (rulesMutex == nullptr || sinkMutex == nullptr || eventQueue == nullptr) {
+        logErrln("[EventEngine] Failed to allocate rule mutex or event queue");
+        return;
+    }
+
+    setSink(type, target);
+    compileRules(ruleSpec);
+
+    // Deliveries do network I/O, keep them on the WiFi core and away from the RTU client
+    xTaskCreatePinnedToCore(sinkTask, "eventSink", 6144, this, 1, &sinkTaskHandle, 0);
+    dbgln("[EventEngine] Started with " + String(ruleCount.load()) + " rules");
+}
+
+// Invalid entries are logged, the rest of the rules still apply
+static void logRejectedRule(const char* entry, bool limit) {
+    logErrln(String(limit ? "[EventEngine] Rule limit reached, ignoring: " : "[EventEngine] Invalid rule: ") + entry);
+}
+
+bool EventEngine::compileRules(const String& spec) {
+    std::vector<EventRule> compiled;
+    bool allValid = compileEventRules(spec.c_str(), compiled, logRejectedRule);
+
+    if (rulesMutex == nullptr) return false;
+    xSemaphoreTake(rulesMutex, portMAX_DELAY);
+    rules.swap(compiled);
+    ruleCount = rules.size();
+    xSemaphoreGive(rulesMutex);
+    return allValid;
+}
+
+void EventEngine::setSink(uint8_t type, const String& target) {
+    if (sinkMutex == nullptr) return;
+    xSemaphoreTake(sinkMutex, portMAX_DELAY);
+    sinkType = type <= static_cast<uint8_t>(EventSinkType::UDP) ? static_cast<EventSinkType>(type) : EventSinkType::NONE;
+    sinkTarget = target;
+    sinkChanged = true;
+    xSemaphoreGive(sinkMutex);
+}
+
+uint32_t EventEngine::getQueueDepth() const {
+    return eventQueue != nullptr ? uxQueueMessagesWaiting(eventQueue) : 0;
+}
+
+void EventEngine::evaluate(EventRule& rule, float value, uint64_t sampleTime) {
+    switch (evaluateEventRule(rule, value, sampleTime)) {
+        case RuleTransition::RAISED:
+            eventsRaised++;
+            post(rule, true, value, sampleTime);
+            break;
+        case RuleTransition::CLEARED:
+            eventsCleared++;
+            post(rule, false, value, sampleTime);
+            break;
+        default:
+            break;
+    }
+}
+
+void EventEngine::post(const EventRule& rule, bool raised, float value, uint64_t sampleTime) {
+    if (eventQueue == nullptr || sinkType.load() == EventSinkType::NONE) return;
+
+    ThresholdEvent event;
+    event.address = rule.address;
+    event.raised = raised;
+    event.value = value;
+    event.threshold = rule.threshold;
+    event.sampleTime = sampleTime;
+
+    // Never block the Modbus response path; a full queue means the sink is behind
+    if (xQueueSend(eventQueue, &event, 0) != pdTRUE) {
+        eventsDropped++;
+    }
+}
+
+void EventEngine::sinkTask(void* param) {
+    EventEngine* engine = static_cast<EventEngine*>(param);
+    ThresholdEvent event;
+
+    for (;;) {
+        if (xQueueReceive(engine->eventQueue, &event, pdMS_TO_TICKS(EVENT_SINK_IDLE_MS)) != pdTRUE) {
+            engine->mqttKeepalive();
+            continue;
+        }
+
+        if (engine->deliver(event)) {
+            unsigned long latency = TimeService::millis64() - event.sampleTime;
+            engine->lastNotifyLatency = latency;
+            engine->maxNotifyLatency = max(engine->maxNotifyLatency, latency);
+            engine->totalNotifyLatency += latency;
+            engine->eventsDelivered++;
+        } else {
+            engine->deliveryFailures++;
+        }
+    }
+}
+
+bool EventEngine::deliver(const ThresholdEvent& event) {
+    xSemaphoreTake(sinkMutex, portMAX_DELAY);
+    EventSinkType type = sinkType.load();
+    String target = sinkTarget;
+    bool changed = sinkChanged;
+    sinkChanged = false;
+    xSemaphoreGive(sinkMutex);
+
+    if (changed && mqttClient.connected()) {
+        mqttClient.stop();
+    }
+    if (type == EventSinkType::NONE || target.length() == 0 || WiFi.status() != WL_CONNECTED) {
+        return false;
+    }
+
+    // Use static buffer to avoid String memory fragmentation. sample_time is the
+    // Unix time in ms of the triggering sample, or 0 until SNTP has synced.
+    static char payload[224];
+    snprintf(payload, sizeof(payload),
+             "{\"host\":\"%s\",\"register\":%u,\"state\":\"%s\",\"value\":%.3f,\"threshold\":%.3f,\"sample_age_ms\":%llu,\"sample_time\":%llu}",
+             WiFi.getHostname(), event.address, event.raised ? "raised" : "cleared",
+             event.value, event.threshold,
+             static_cast<unsigned long long>(TimeService::millis64() - event.sampleTime),
+             static_cast<unsigned long long>(timeService.toUnixMs(event.sampleTime * 1000)));
+
+    switch (type) {
+        case EventSinkType::WEBHOOK:
+            return deliverWebhook(target, payload);
+        case EventSinkType::MQTT:
+            return deliverMqtt(target, payload);
+        case EventSinkType::UDP:
+            return deliverUdp(target, payload);
+        default:
+            return false;
+    }
+}
+
+bool EventEngine::deliverWebhook(const String& target, const String& payload) {
+    HTTPClient http;
+    http.setTimeout(EVENT_SINK_TIMEOUT_MS);
+    if (!http.begin(target)) {
+        logErrln("[EventEngine] Invalid webhook URL: " + target);
+        return false;
+    }
+    http.addHeader("Content-Type", "application/json");
+    int httpCode = http.POST(payload);
+    http.end();
+    if (httpCode < 200 || httpCode >= 300) {
+        dbgln("[EventEngine] Webhook returned " + String(httpCode));
+        return false;
+    }
+    return true;
+}
+
+bool EventEngine::deliverUdp(const String& target, const String& payload) {
+    int colon = target.lastIndexOf(':');
+    if (colon <= 0) return false;
+    String host = target.substring(0, colon);
+    uint16_t port = target.substring(colon + 1).toInt();
+    if (port == 0) return false;
+
+    WiFiUDP udp;
+    if (!udp.beginPacket(host.c_str(), port)) return false;
+    udp.write(reinterpret_cast<const uint8_t*>(payload.c_str()), payload.length());
+    return udp.endPacket() == 1;
+}
+
+// Encode an MQTT remaining-length field, returns number of bytes written
+static size_t encodeRemainingLength(uint8_t* out, size_t length) {
+    size_t pos = 0;
+    do {
+        uint8_t digit = length % 128;
+        length /= 128;
+        if (length > 0) digit |= 0x80;
+        out[pos++] = digit;
+    } while (length > 0 && pos < 4);
+    return pos;
+}
+
+bool EventEngine::mqttConnect(const String& host, uint16_t port) {
+    mqttClient.stop();
+    mqttClient.setTimeout(EVENT_SINK_TIMEOUT_MS / 1000);
+    if (!mqttClient.connect(host.c_str(), port)) {
+        dbgln("[EventEngine] MQTT connect to " + host + " failed");
+        return false;
+    }
+
+    char clientId[24];
+    snprintf(clientId, sizeof(clientId), "et112-%06lx", (unsigned long)(ESP.getEfuseMac() & 0xFFFFFF));
+    size_t idLength = strlen(clientId);
+
+    // CONNECT: protocol "MQTT" level 4, clean session, no credentials
+    uint8_t packet[48];
+    size_t pos = 0;
+    packet[pos++] = 0x10;
+    pos += encodeRemainingLength(&packet[pos], 10 + 2 + idLength);
+    const uint8_t variableHeader[] = {0x00, 0x04, 'M', 'Q', 'T', 'T', 0x04, 0x02,
+                                      0x00, MQTT_KEEPALIVE_SECONDS};
+    memcpy(&packet[pos], variableHeader, sizeof(variableHeader));
+    pos += sizeof(variableHeader);
+    packet[pos++] = 0x00;
+    packet[pos++] = static_cast<uint8_t>(idLength);
+    memcpy(&packet[pos], clientId, idLength);
+    pos += idLength;
+    mqttClient.write(packet, pos);
+
+    // Wait for CONNACK (0x20 0x02 <flags> <return code>)
+    unsigned long start = millis();
+    while (mqttClient.available() < 4) {
+        if (millis() - start > EVENT_SINK_TIMEOUT_MS || !mqttClient.connected()) {
+            logErrln("[EventEngine] MQTT broker did not acknowledge connection");
+            mqttClient.stop();
+            return false;
+        }
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    uint8_t connack[4];
+    mqttClient.read(connack, sizeof(connack));
+    if (connack[0] != 0x20 || connack[3] != 0x00) {
+        logErrln("[EventEngine] MQTT broker refused connection, code " + String(connack[3]));
+        mqttClient.stop();
+        return false;
+    }
+    mqttLastActivity = millis();
+    return true;
+}
+
+bool EventEngine::deliverMqtt(const String& target, const String& payload) {
+    int slash = target.indexOf('/');
+    if (slash <= 0 || slash == (int)target.length() - 1) return false;
+    String hostPort = target.substring(0, slash);
+    String topic = target.substring(slash + 1);
+    String host = hostPort;
+    uint16_t port = MQTT_DEFAULT_PORT;
+    int colon = hostPort.indexOf(':');
+    if (colon > 0) {
+        host = hostPort.substring(0, colon);
+        port = hostPort.substring(colon + 1).toInt();
+    }
+
+    if (!mqttClient.connected() && !mqttConnect(host, port)) {
+        return false;
+    }
+
+    // PUBLISH, QoS 0, no retain
+    uint8_t header[5];
+    size_t pos = 0;
+    header[pos++] = 0x30;
+    pos += encodeRemainingLength(&header[pos], 2 + topic.length() + payload.length());
+    uint8_t topicLength[2] = {static_cast<uint8_t>(topic.length() >> 8), static_cast<uint8_t>(topic.length() & 0xFF)};
+
+    size_t written = mqttClient.write(header, pos);
+    written += mqttClient.write(topicLength, sizeof(topicLength));
+    written += mqttClient.write(reinterpret_cast<const uint8_t*>(topic.c_str()), topic.length());
+    written += mqttClient.write(reinterpret_cast<const uint8_t*>(payload.c_str()), payload.length());
+    if (written != pos + 2 + topic.length() + payload.length()) {
+        mqttClient.stop();
+        return false;
+    }
+    mqttLastActivity = millis();
+    return true;
+}
+
+void EventEngine::mqttKeepalive() {
+    if (!mqttClient.connected()) return;
+
+    // Discard PINGRESP and anything else the broker sent us
+    while (mqttClient.available()) {
+        mqttClient.read();
+    }
+    if (millis() - mqttLastActivity >= EVENT_SINK_IDLE_MS) {
+        const uint8_t pingreq[2] = {0xC0, 0x00};
+        if (mqttClient.write(pingreq, sizeof(pingreq)) != sizeof(pingreq)) {
+            mqttClient.stop();
+            return;
+        }
+        mqttLastActivity = millis();
+    }
+}
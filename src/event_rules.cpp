@@ -0,0 +1,124 @@
+#include "event_rules.h"
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+// Parses text[0, length) as a number, ignoring surrounding blanks
+static bool parseNumber(const char* text, size_t length, float& out) {
+    while (length > 0 && isspace(static_cast<unsigned char>(*text))) {
+        text++;
+        length--;
+    }
+    while (length > 0 && isspace(static_cast<unsigned char>(text[length - 1]))) {
+        length--;
+    }
+    char buffer[32];
+    if (length == 0 || length >= sizeof(buffer)) return false;
+    memcpy(buffer, text, length);
+    buffer[length] = '\0';
+
+    char* end = nullptr;
+    out = strtof(buffer, &end);
+    return end != nullptr && *end == '\0';
+}
+
+bool parseEventRule(const char* entry, EventRule& rule) {
+    const char* op = strchr(entry, '>');
+    const char* below = strchr(entry, '<');
+    if (op == nullptr || (below != nullptr && below < op)) {
+        op = below;
+    }
+    if (op == nullptr || op == entry) return false;
+
+    float address;
+    if (!parseNumber(entry, op - entry, address) || address < 0 || address > 65535) {
+        return false;
+    }
+
+    // threshold[:hysteresis[:minMs]]
+    const char* rest = op + 1;
+    float fields[3] = {0.0f, 0.0f, 0.0f};
+    int fieldCount = 0;
+    while (fieldCount < 3) {
+        const char* sep = strchr(rest, ':');
+        size_t fieldLength = sep == nullptr ? strlen(rest) : static_cast<size_t>(sep - rest);
+        if (!parseNumber(rest, fieldLength, fields[fieldCount])) return false;
+        fieldCount++;
+        if (sep == nullptr) break;
+        rest = sep + 1;
+    }
+    if (fields[1] < 0 || fields[2] < 0) return false;
+
+    rule.address = static_cast<uint16_t>(address);
+    rule.comparator = *op == '>' ? RuleComparator::ABOVE : RuleComparator::BELOW;
+    rule.threshold = fields[0];
+    rule.hysteresis = fields[1];
+    rule.minDurationMs = static_cast<uint32_t>(fields[2]);
+    rule.active = false;
+    rule.pending = false;
+    rule.pendingSince = 0;
+    return true;
+}
+
+bool compileEventRules(const char* spec, std::vector<EventRule>& compiled, RuleRejectFn rejected) {
+    compiled.clear();
+    bool allValid = true;
+
+    const char* start = spec;
+    for (;;) {
+        size_t length = strcspn(start, ";\r\n");
+        std::string entry(start, length);
+        size_t first = entry.find_first_not_of(" \t");
+        if (first != std::string::npos) {
+            entry = entry.substr(first, entry.find_last_not_of(" \t") - first + 1);
+            EventRule rule;
+            if (compiled.size() >= MAX_EVENT_RULES) {
+                if (rejected) rejected(entry.c_str(), true);
+                allValid = false;
+            } else if (parseEventRule(entry.c_str(), rule)) {
+                compiled.push_back(rule);
+            } else {
+                if (rejected) rejected(entry.c_str(), false);
+                allValid = false;
+            }
+        }
+        if (start[length] == '\0') break;
+        start += length + 1;
+    }
+
+    std::stable_sort(compiled.begin(), compiled.end(),
+        [](const EventRule& a, const EventRule& b) { return a.address < b.address; });
+    return allValid;
+}
+
+RuleTransition evaluateEventRule(EventRule& rule, float value, uint64_t sampleTime) {
+    bool above = rule.comparator == RuleComparator::ABOVE;
+
+    if (rule.active) {
+        bool cleared = above ? value < rule.threshold - rule.hysteresis
+                             : value > rule.threshold + rule.hysteresis;
+        if (cleared) {
+            rule.active = false;
+            return RuleTransition::CLEARED;
+        }
+        return RuleTransition::NONE;
+    }
+
+    bool tripped = above ? value > rule.threshold : value < rule.threshold;
+    if (!tripped) {
+        rule.pending = false;
+        return RuleTransition::NONE;
+    }
+    if (!rule.pending) {
+        rule.pending = true;
+        rule.pendingSince = sampleTime;
+    }
+    if (sampleTime - rule.pendingSince >= rule.minDurationMs) {
+        rule.pending = false;
+        rule.active = true;
+        return RuleTransition::RAISED;
+    }
+    return RuleTransition::NONE;
+}
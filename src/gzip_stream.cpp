@@ -0,0 +1,252 @@
+#include "gzip_stream.h"
+
+// Bytes that must be buffered ahead of the encoder so a full-length match can be found
+#define GZIP_MIN_LOOKAHEAD (GZIP_MAX_MATCH + GZIP_MIN_MATCH + 1)
+
+static const uint16_t lengthBase[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+static const uint8_t lengthExtra[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+static const uint16_t distanceBase[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+static const uint8_t distanceExtra[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+// Nibble-wise CRC-32 (IEEE), 64 bytes of table instead of 1 KB
+static uint32_t crc32Update(uint32_t crc, const uint8_t* data, size_t len) {
+    static const uint32_t table[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+    };
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        crc = (crc >> 4) ^ table[crc & 0x0F];
+        crc = (crc >> 4) ^ table[crc & 0x0F];
+    }
+    return ~crc;
+}
+
+static inline uint16_t hash3(const uint8_t* p) {
+    uint32_t value = (static_cast<uint32_t>(p[0]) << 16) | (p[1] << 8) | p[2];
+    return static_cast<uint32_t>(value * 2654435761U) >> (32 - GZIP_HASH_BITS);
+}
+
+GzipStream::GzipStream(Source source)
+    : source(source)
+    , position(0)
+    , lookahead(0)
+    , inputDone(false)
+    , finished(false)
+    , outHead(0)
+    , outTail(0)
+    , bitBuffer(0)
+    , bitCount(0)
+    , crc(0)
+    , inputBytes(0)
+    , outputBytes(0)
+{
+    memset(head, 0, sizeof(head));
+    memset(prev, 0, sizeof(prev));
+
+    // gzip member header: deflate, no flags, no mtime, unknown OS
+    static const uint8_t header[10] = {0x1F, 0x8B, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF};
+    for (uint8_t b : header) {
+        putByte(b);
+    }
+    // One final block using the fixed Huffman code
+    putBits(1, 1);
+    putBits(1, 2);
+}
+
+size_t GzipStream::read(uint8_t* dest, size_t maxLen) {
+    while (outHead == outTail && !finished) {
+        outHead = 0;
+        outTail = 0;
+        fillWindow();
+        compressAvailable();
+        if (inputDone && lookahead == 0 && outHead + 16 <= GZIP_OUT_BUFFER) {
+            finish();
+        }
+    }
+
+    size_t count = min<size_t>(maxLen, outHead - outTail);
+    memcpy(dest, out + outTail, count);
+    outTail += count;
+    outputBytes += count;
+    return count;
+}
+
+void GzipStream::fillWindow() {
+    while (!inputDone && lookahead < GZIP_MIN_LOOKAHEAD) {
+        uint16_t end = position + lookahead;
+        if (end == 2 * GZIP_WINDOW_SIZE) {
+            slideWindow();
+            end -= GZIP_WINDOW_SIZE;
+        }
+        size_t received = source(window + end, 2 * GZIP_WINDOW_SIZE - end);
+        if (received == 0) {
+            inputDone = true;
+            break;
+        }
+        crc = crc32Update(crc, window + end, received);
+        inputBytes += received;
+        lookahead += received;
+    }
+}
+
+void GzipStream::slideWindow() {
+    memmove(window, window + GZIP_WINDOW_SIZE, GZIP_WINDOW_SIZE);
+    position -= GZIP_WINDOW_SIZE;
+    // Entries hold position + 1; anything that fell out of the buffer becomes empty
+    for (uint16_t& entry : head) {
+        entry = entry > GZIP_WINDOW_SIZE ? entry - GZIP_WINDOW_SIZE : 0;
+    }
+    for (uint16_t& entry : prev) {
+        entry = entry > GZIP_WINDOW_SIZE ? entry - GZIP_WINDOW_SIZE : 0;
+    }
+}
+
+void GzipStream::insertHash(uint16_t p) {
+    uint16_t h = hash3(window + p);
+    prev[p & (GZIP_WINDOW_SIZE - 1)] = head[h];
+    head[h] = p + 1;
+}
+
+uint16_t GzipStream::longestMatch(uint16_t p, uint16_t& distance) {
+    uint16_t maxLength = min<uint16_t>(GZIP_MAX_MATCH, lookahead);
+    uint16_t best = 0;
+    uint16_t candidate = head[hash3(window + p)];
+
+    for (uint8_t chain = 0; candidate != 0 && chain < GZIP_MAX_CHAIN; chain++) {
+        uint16_t start = candidate - 1;
+        if (start >= p || p - start > GZIP_WINDOW_SIZE) {
+            break;
+        }
+        // Hash collisions and aliased chain slots are harmless: every candidate is verified
+        if (window[start + best] == window[p + best]) {
+            uint16_t length = 0;
+            while (length < maxLength && window[start + length] == window[p + length]) {
+                length++;
+            }
+            if (length > best) {
+                best = length;
+                distance = p - start;
+                if (length == maxLength) {
+                    break;
+                }
+            }
+        }
+        uint16_t next = prev[start & (GZIP_WINDOW_SIZE - 1)];
+        if (next == 0 || next - 1 >= start) {
+            break;
+        }
+        candidate = next;
+    }
+    return best;
+}
+
+void GzipStream::compressAvailable() {
+    while (lookahead >= GZIP_MIN_LOOKAHEAD || (inputDone && lookahead > 0)) {
+        // Worst case per symbol is 31 bits; stop while there is room for one more
+        if (outHead > GZIP_OUT_BUFFER - 8) {
+            return;
+        }
+
+        uint16_t length = 0;
+        uint16_t distance = 0;
+        if (lookahead >= GZIP_MIN_MATCH) {
+            length = longestMatch(position, distance);
+        }
+
+        if (length >= GZIP_MIN_MATCH) {
+            putMatch(length, distance);
+        } else {
+            length = 1;
+            putLiteral(window[position]);
+        }
+        for (uint16_t i = 0; i < length; i++) {
+            if (lookahead >= GZIP_MIN_MATCH) {
+                insertHash(position);
+            }
+            position++;
+            lookahead--;
+        }
+    }
+}
+
+void GzipStream::finish() {
+    putHuffman(0, 7); // End of block
+    if (bitCount > 0) {
+        putByte(bitBuffer & 0xFF);
+        bitBuffer = 0;
+        bitCount = 0;
+    }
+    for (uint8_t i = 0; i < 4; i++) {
+        putByte((crc >> (8 * i)) & 0xFF);
+    }
+    for (uint8_t i = 0; i < 4; i++) {
+        putByte((inputBytes >> (8 * i)) & 0xFF);
+    }
+    finished = true;
+}
+
+void GzipStream::putByte(uint8_t value) {
+    out[outHead++] = value;
+}
+
+void GzipStream::putBits(uint32_t value, uint8_t count) {
+    bitBuffer |= value << bitCount;
+    bitCount += count;
+    while (bitCount >= 8) {
+        putByte(bitBuffer & 0xFF);
+        bitBuffer >>= 8;
+        bitCount -= 8;
+    }
+}
+
+void GzipStream::putHuffman(uint16_t code, uint8_t length) {
+    // Huffman codes are packed starting from their most significant bit
+    uint16_t reversed = 0;
+    for (uint8_t i = 0; i < length; i++) {
+        reversed = (reversed << 1) | ((code >> i) & 1);
+    }
+    putBits(reversed, length);
+}
+
+void GzipStream::putLiteral(uint8_t literal) {
+    if (literal < 144) {
+        putHuffman(0x30 + literal, 8);
+    } else {
+        putHuffman(0x190 + literal - 144, 9);
+    }
+}
+
+void GzipStream::putMatch(uint16_t length, uint16_t distance) {
+    uint8_t code = 28;
+    while (lengthBase[code] > length) {
+        code--;
+    }
+    uint16_t symbol = 257 + code;
+    if (symbol < 280) {
+        putHuffman(symbol - 256, 7);
+    } else {
+        putHuffman(0xC0 + symbol - 280, 8);
+    }
+    putBits(length - lengthBase[code], lengthExtra[code]);
+
+    code = 29;
+    while (distanceBase[code] > distance) {
+        code--;
+    }
+    putHuffman(code, 5);
+    putBits(distance - distanceBase[code], distanceExtra[code]);
+}
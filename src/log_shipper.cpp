@@ -0,0 +1,339 @@
+#include "log_shipper.h"
+#include "config.h"
+#include "debug_buffer.h"
+#include "time_service.h"
+#include <WiFi.h>
+#include <time.h>
+
+// Global instance
+LogShipper logShipper;
+
+// Bytes read from the ring per lock acquisition
+#define SYSLOG_READ_CHUNK 256
+// Idle poll interval when the ring has nothing new
+#define SYSLOG_POLL_MS 100
+
+LogShipper::LogShipper()
+    : settingsMutex(nullptr)
+    , taskHandle(nullptr)
+    , pendingTransport(0)
+    , pendingRate(SYSLOG_DEFAULT_RATE)
+    , settingsChanged(false)
+    , port(SYSLOG_DEFAULT_PORT)
+    , transport(SyslogTransport::UDP)
+    , rate(SYSLOG_DEFAULT_RATE)
+    , lastConnectAttempt(0)
+    , cursor(0)
+    , lineLength(0)
+    , lastLevel('I')
+    , lastUptime(0)
+    , batchLength(0)
+    , batchRecords(0)
+    , batchStarted(0)
+    , tokens(0)
+    , lastRefillUs(0)
+    , enabled(false)
+    , recordsSent(0)
+    , batchesSent(0)
+    , bytesSent(0)
+    , recordsDropped(0)
+    , bytesOverwritten(0)
+    , throttled(0)
+    , sendFailures(0)
+    , backlogBytes(0)
+{}
+
+void LogShipper::begin(const String& target, uint8_t transportType, uint32_t rateBytesPerSecond) {
+    settingsMutex = xSemaphoreCreateMutex();
+    if (settingsMutex == nullptr) {
+        logErrln("[Syslog] Failed to allocate settings mutex");
+        return;
+    }
+    configure(target, transportType, rateBytesPerSecond);
+
+    // Start from the oldest retained line so the boot log reaches the collector too
+    cursor = debugBuffer.getOldestOffset();
+    xTaskCreatePinnedToCore(shipperTask, "syslog", 4096, this, 1, &taskHandle, 0);
+}
+
+void LogShipper::configure(const String& target, uint8_t transportType, uint32_t rateBytesPerSecond) {
+    if (settingsMutex == nullptr) return;
+    xSemaphoreTake(settingsMutex, portMAX_DELAY);
+    pendingTarget = target;
+    pendingTarget.trim();
+    pendingTransport = transportType;
+    pendingRate = rateBytesPerSecond;
+    settingsChanged = true;
+    xSemaphoreGive(settingsMutex);
+}
+
+void LogShipper::applySettings() {
+    xSemaphoreTake(settingsMutex, portMAX_DELAY);
+    bool changed = settingsChanged;
+    settingsChanged = false;
+    String target = pendingTarget;
+    uint8_t transportType = pendingTransport;
+    uint32_t newRate = pendingRate;
+    xSemaphoreGive(settingsMutex);
+    if (!changed) return;
+
+    // Whatever was batched for the old target is not re-addressed
+    if (batchRecords > 0) {
+        recordsDropped += batchRecords;
+    }
+    batchLength = 0;
+    batchRecords = 0;
+    tcp.stop();
+    lastConnectAttempt = 0;
+
+    int colon = target.lastIndexOf(':');
+    host = colon > 0 ? target.substring(0, colon) : target;
+    port = colon > 0 ? target.substring(colon + 1).toInt() : SYSLOG_DEFAULT_PORT;
+    transport = transportType == static_cast<uint8_t>(SyslogTransport::TCP) ? SyslogTransport::TCP : SyslogTransport::UDP;
+    rate = newRate;
+    tokens = max<float>(rate, SYSLOG_MAX_DATAGRAM);
+    lastRefillUs = TimeService::micros64();
+
+    if (host.length() == 0 || port == 0) {
+        host = "";
+        if (enabled) {
+            dbgln("[Syslog] Remote logging disabled");
+        }
+        enabled = false;
+        return;
+    }
+    enabled = true;
+    dbgln("[Syslog] Shipping to " + host + ":" + String(port) +
+          (transport == SyslogTransport::TCP ? " over TCP" : " over UDP"));
+}
+
+void LogShipper::shipperTask(void* param) {
+    LogShipper* shipper = static_cast<LogShipper*>(param);
+    uint8_t chunk[SYSLOG_READ_CHUNK];
+
+    for (;;) {
+        shipper->applySettings();
+
+        if (!shipper->enabled) {
+            // Follow the ring so enabling later does not replay stale history
+            shipper->cursor = debugBuffer.getWrittenBytes();
+            shipper->lineLength = 0;
+            shipper->backlogBytes = 0;
+            vTaskDelay(pdMS_TO_TICKS(SYSLOG_FLUSH_MS));
+            continue;
+        }
+
+        // While the collector is unreachable the ring is the buffer; anything
+        // it overwrites in the meantime shows up in bytesOverwritten
+        if (!shipper->transportReady()) {
+            vTaskDelay(pdMS_TO_TICKS(SYSLOG_FLUSH_MS));
+            continue;
+        }
+
+        uint64_t end = debugBuffer.getWrittenBytes();
+        uint64_t skipped = 0;
+        size_t count = debugBuffer.readFrom(shipper->cursor, end, chunk, sizeof(chunk), &skipped);
+        if (skipped > 0) {
+            // The ring trims whole lines, so the cursor is now at a line start
+            shipper->bytesOverwritten += skipped;
+            if (shipper->lineLength > 0) {
+                shipper->recordsDropped++;
+                shipper->lineLength = 0;
+            }
+        }
+        shipper->backlogBytes = static_cast<uint32_t>(end - shipper->cursor);
+
+        if (count > 0) {
+            shipper->consume(chunk, count);
+        }
+        if (shipper->batchRecords > 0 && millis() - shipper->batchStarted >= SYSLOG_FLUSH_MS) {
+            shipper->flush();
+        }
+        if (count == 0) {
+            vTaskDelay(pdMS_TO_TICKS(SYSLOG_POLL_MS));
+        }
+    }
+}
+
+bool LogShipper::transportReady() {
+    if (WiFi.status() != WL_CONNECTED) {
+        return false;
+    }
+    if (transport == SyslogTransport::UDP || tcp.connected()) {
+        return true;
+    }
+    if (lastConnectAttempt != 0 && millis() - lastConnectAttempt < SYSLOG_RECONNECT_MS) {
+        return false;
+    }
+    lastConnectAttempt = millis();
+    tcp.setTimeout(2);
+    if (!tcp.connect(host.c_str(), port)) {
+        sendFailures++;
+        return false;
+    }
+    tcp.setNoDelay(true);
+    return true;
+}
+
+void LogShipper::consume(const uint8_t* data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        if (data[i] == '\n') {
+            processLine();
+            lineLength = 0;
+        } else if (lineLength < sizeof(line)) {
+            line[lineLength++] = data[i];
+        }
+        // Bytes beyond SYSLOG_MAX_RECORD are truncated
+    }
+}
+
+void LogShipper::processLine() {
+    if (lineLength == 0) {
+        return;
+    }
+
+    // Ring lines look like "[123s] E message"; anything else continues the previous record
+    const char* message = line;
+    size_t length = lineLength;
+    if (length >= 6 && line[0] == '[') {
+        size_t i = 1;
+        unsigned long uptime = 0;
+        while (i < length && isdigit(static_cast<unsigned char>(line[i]))) {
+            uptime = uptime * 10 + (line[i] - '0');
+            i++;
+        }
+        if (i > 1 && i + 4 <= length && line[i] == 's' && line[i + 1] == ']' && line[i + 2] == ' ' &&
+            strchr(LOG_LEVEL_MARKERS, line[i + 3]) != nullptr && (i + 4 == length || line[i + 4] == ' ')) {
+            lastUptime = uptime;
+            lastLevel = line[i + 3];
+            size_t skip = min(length, i + 5);
+            message += skip;
+            length -= skip;
+        }
+    }
+    appendRecord(lastLevel, lastUptime, message, length);
+}
+
+static uint8_t syslogSeverity(char level) {
+    switch (level) {
+        case 'E': return 3;
+        case 'W': return 4;
+        case 'D': return 7;
+        default: return 6;
+    }
+}
+
+void LogShipper::appendRecord(char level, unsigned long uptimeSeconds, const char* message, size_t length) {
+    // RFC 5424: <PRI>1 TIMESTAMP HOSTNAME APP-NAME PROCID MSGID STRUCTURED-DATA MSG
+    char timestamp[24] = "-";
+    uint64_t unixMs = timeService.toUnixMs(static_cast<uint64_t>(uptimeSeconds) * 1000000ULL);
+    if (unixMs != 0) {
+        time_t seconds = unixMs / 1000;
+        struct tm utc;
+        gmtime_r(&seconds, &utc);
+        strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", &utc);
+    }
+
+    // A leading "[Component]" tag becomes the MSGID
+    char msgId[33] = "-";
+    if (length > 2 && message[0] == '[') {
+        size_t close = 1;
+        while (close < length && close <= sizeof(msgId) && message[close] != ']' && message[close] > ' ') {
+            close++;
+        }
+        if (close > 1 && close < length && close <= sizeof(msgId) && message[close] == ']') {
+            memcpy(msgId, message + 1, close - 1);
+            msgId[close - 1] = '\0';
+            size_t skip = min(length, close + 2);
+            message += skip;
+            length -= skip;
+        }
+    }
+
+    const char* hostname = WiFi.getHostname();
+    static char record[SYSLOG_MAX_RECORD + 160];
+    int header = snprintf(record, sizeof(record), "<%u>1 %s %s %s - %s - ",
+                          SYSLOG_FACILITY * 8 + syslogSeverity(level), timestamp,
+                          hostname != nullptr && hostname[0] != '\0' ? hostname : "-",
+                          SYSLOG_APP_NAME, msgId);
+    if (header < 0) {
+        return;
+    }
+    size_t recordLength = min<size_t>(header + length, sizeof(record));
+    memcpy(record + header, message, recordLength - header);
+
+    // UDP batches are newline-delimited, TCP uses octet counting ("LEN SP MSG")
+    char frame[8] = "";
+    size_t frameLength = 0;
+    if (transport == SyslogTransport::TCP) {
+        frameLength = snprintf(frame, sizeof(frame), "%u ", static_cast<unsigned>(recordLength));
+    } else if (batchRecords > 0) {
+        frame[0] = '\n';
+        frameLength = 1;
+    }
+
+    if (batchLength + frameLength + recordLength > sizeof(batch)) {
+        flush();
+        if (transport == SyslogTransport::UDP) {
+            frameLength = 0;
+        }
+    }
+    if (batchRecords == 0) {
+        batchStarted = millis();
+    }
+    memcpy(batch + batchLength, frame, frameLength);
+    batchLength += frameLength;
+    memcpy(batch + batchLength, record, recordLength);
+    batchLength += recordLength;
+    batchRecords++;
+}
+
+void LogShipper::waitForTokens(size_t bytes) {
+    if (rate == 0) {
+        return;
+    }
+    float burst = max<float>(rate, SYSLOG_MAX_DATAGRAM);
+    for (;;) {
+        uint64_t now = TimeService::micros64();
+        tokens = min(burst, tokens + (now - lastRefillUs) * rate / 1000000.0f);
+        lastRefillUs = now;
+        if (tokens >= bytes) {
+            tokens -= bytes;
+            return;
+        }
+        // Only this task waits; producers keep writing into the ring
+        throttled++;
+        uint32_t waitMs = static_cast<uint32_t>((bytes - tokens) * 1000.0f / rate) + 1;
+        vTaskDelay(pdMS_TO_TICKS(waitMs));
+    }
+}
+
+void LogShipper::flush() {
+    if (batchRecords == 0) {
+        return;
+    }
+    waitForTokens(batchLength);
+
+    bool sent = false;
+    if (transport == SyslogTransport::TCP) {
+        sent = tcp.connected() && tcp.write(reinterpret_cast<const uint8_t*>(batch), batchLength) == batchLength;
+        if (!sent) {
+            tcp.stop();
+        }
+    } else if (udp.beginPacket(host.c_str(), port)) {
+        udp.write(reinterpret_cast<const uint8_t*>(batch), batchLength);
+        sent = udp.endPacket() == 1;
+    }
+
+    if (sent) {
+        recordsSent += batchRecords;
+        batchesSent++;
+        bytesSent += batchLength;
+    } else {
+        // Deliberately not logged: the error line would itself be queued for shipping
+        recordsDropped += batchRecords;
+        sendFailures++;
+    }
+    batchLength = 0;
+    batchRecords = 0;
+}
@@ -20,6 +20,12 @@
 #include <ModbusClientTCPasync.h>
 #include "debug.h"
 #include "wifi_utils.h"
+#include "event_engine.h"
+#include "log_shipper.h"
+#include "oui_lookup.h"
+#include "rtu_gateway.h"
+#include "task_monitor.h"
+#include "time_service.h"
 #include "esp_task_wdt.h" // Include ESP task watchdog header
 
 #ifdef REROUTE_DEBUG
@@ -121,25 +127,25 @@ std::function<double(ModbusCache*, double)> invert_sign = [](ModbusCache* modbus
 };
 
 std::vector<ModbusRegister> sdm120Registers = {
-  {0, RegisterType::FLOAT, "Volts", 1, UnitType::V, 0},
-  {6, RegisterType::FLOAT, "Amps", 1, UnitType::A, 2},
-  {12, RegisterType::FLOAT, "Watts", 1, UnitType::W, 4},
-  {18, RegisterType::FLOAT, "VA", 1, UnitType::VA, 6},
-  {24, RegisterType::FLOAT, "Volt Amp Reactive", 1, UnitType::var, 8},
-  {30, RegisterType::FLOAT, "Power Factor", 1, UnitType::PF, 14},
-  {36, RegisterType::FLOAT, "Phase Angle", 1, UnitType::PF, 14, calc_angle},
-  {70, RegisterType::FLOAT, "Frequency", 1, UnitType::Hz, 15},
-  {72, RegisterType::FLOAT, "Energy kWh (+)", 1, UnitType::KWh, 16},
-  {74, RegisterType::FLOAT, "Energy kWh (-)", 1, UnitType::KWh, 32, invert_sign},
-  {76, RegisterType::FLOAT, "Reactive Power Kvarh (+)", 1, UnitType::KVarh, 18},
-  {78, RegisterType::FLOAT, "Reactive Power Kvarh (-)", 1, UnitType::KVarh, 34, invert_sign},
-  {84, RegisterType::FLOAT, "W Demand", 1, UnitType::W, 10},
-  {86, RegisterType::FLOAT, "W Demand Peak", 1, UnitType::W, 12},
-  {88, RegisterType::FLOAT, "kWh (+) PARTIAL", 1, UnitType::KWh, 20},
-  {90, RegisterType::FLOAT, "Kvarh (+) PARTIAL", 1, UnitType::KVarh, 22},
-  {92, RegisterType::FLOAT, "kWh (-) PARTIAL", 1, UnitType::KWh, 34, invert_sign},
-  {342, RegisterType::FLOAT, "kWh Energy Total", 1, UnitType::KWh, 16, calc_total_energy},
-  {344, RegisterType::FLOAT, "Reactive Power Total", 1, UnitType::KVarh, 18, calc_total_reactive},
+  {0, RegisterType::FLOAT_HIGH_FIRST, "Volts", 1, UnitType::V, 0},
+  {6, RegisterType::FLOAT_HIGH_FIRST, "Amps", 1, UnitType::A, 2},
+  {12, RegisterType::FLOAT_HIGH_FIRST, "Watts", 1, UnitType::W, 4},
+  {18, RegisterType::FLOAT_HIGH_FIRST, "VA", 1, UnitType::VA, 6},
+  {24, RegisterType::FLOAT_HIGH_FIRST, "Volt Amp Reactive", 1, UnitType::var, 8},
+  {30, RegisterType::FLOAT_HIGH_FIRST, "Power Factor", 1, UnitType::PF, 14},
+  {36, RegisterType::FLOAT_HIGH_FIRST, "Phase Angle", 1, UnitType::PF, 14, calc_angle},
+  {70, RegisterType::FLOAT_HIGH_FIRST, "Frequency", 1, UnitType::Hz, 15},
+  {72, RegisterType::FLOAT_HIGH_FIRST, "Energy kWh (+)", 1, UnitType::KWh, 16},
+  {74, RegisterType::FLOAT_HIGH_FIRST, "Energy kWh (-)", 1, UnitType::KWh, 32, invert_sign},
+  {76, RegisterType::FLOAT_HIGH_FIRST, "Reactive Power Kvarh (+)", 1, UnitType::KVarh, 18},
+  {78, RegisterType::FLOAT_HIGH_FIRST, "Reactive Power Kvarh (-)", 1, UnitType::KVarh, 34, invert_sign},
+  {84, RegisterType::FLOAT_HIGH_FIRST, "W Demand", 1, UnitType::W, 10},
+  {86, RegisterType::FLOAT_HIGH_FIRST, "W Demand Peak", 1, UnitType::W, 12},
+  {88, RegisterType::FLOAT_HIGH_FIRST, "kWh (+) PARTIAL", 1, UnitType::KWh, 20},
+  {90, RegisterType::FLOAT_HIGH_FIRST, "Kvarh (+) PARTIAL", 1, UnitType::KVarh, 22},
+  {92, RegisterType::FLOAT_HIGH_FIRST, "kWh (-) PARTIAL", 1, UnitType::KWh, 34, invert_sign},
+  {342, RegisterType::FLOAT_HIGH_FIRST, "kWh Energy Total", 1, UnitType::KWh, 16, calc_total_energy},
+  {344, RegisterType::FLOAT_HIGH_FIRST, "Reactive Power Total", 1, UnitType::KVarh, 18, calc_total_reactive},
 };
 
 #endif
@@ -165,8 +171,6 @@ int countdownSeconds = 0;
 int currentScreen = 0; // 0 = screen1 (default), 1 = screen2
 const int NUM_SCREENS = 2;
 
-#define WIFI_RSSI_THRESHOLD -80  // RSSI threshold to trigger reconnection (dBm)
-#define WIFI_CHECK_INTERVAL 300000 // Check WiFi signal strength every 5 minutes
 #define WIFI_CONNECTION_VERIFY_COUNT 3 // Number of times to verify WiFi is actually disconnected
 
 // Add WiFi event handler to track connection status
@@ -189,6 +193,9 @@ void WiFiEventHandler(WiFiEvent_t event, WiFiEventInfo_t info) {
             break;
         case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
             dbgln("[WiFi] Disconnected from AP");
+            if (wifiConnected) {
+                wifiConnectStarted(); // Time-to-IP is measured from the loss of the link
+            }
             wifiDisconnectDetected = true;
             wifiConnected = false;
             // Stop mDNS when WiFi disconnects to prevent UDP errors
@@ -199,6 +206,7 @@ void WiFiEventHandler(WiFiEvent_t event, WiFiEventInfo_t info) {
             snprintf(ipBuffer, sizeof(ipBuffer), "[WiFi] Got IP: %s", WiFi.localIP().toString().c_str());
             dbgln(ipBuffer);
             wifiConnected = true;
+            wifiGotIP();
             if (lastWiFiConnectionTime == 0) {
                 lastWiFiConnectionTime = millis();
             }
@@ -414,8 +422,15 @@ bool forceWiFiReset() {
         return false;
     }
     
+    // Directed connect to the last-good AP first
+    if (wifiFastConnect()) {
+        resetCount = 0;
+        return true;
+    }
+
     // Simple connection attempt without scanning
     dbgln("[WiFi] Attempting connection to " + ssid);
+    wifiConnectStarted();
     WiFi.begin(ssid.c_str(), password.c_str());
     
     // Wait for connection
@@ -488,6 +503,7 @@ bool connectToStrongestAP() {
     
     // Use the specific BSSID to avoid fixation on weaker APs
     uint8_t* bssid = WiFi.BSSID(bestNetworkIndex);
+    wifiConnectStarted();
     WiFi.begin(targetSSID.c_str(), password.c_str(), 0, bssid);
     
     // Wait for connection
@@ -562,8 +578,16 @@ void setup() {
     String hostname = config.getHostname();
     WiFi.setHostname(hostname.c_str());
     
-    // Let WiFiManager handle all WiFi configuration
-    // Don't interfere with WiFi settings here
+    // Try a directed connect to the last-good AP before WiFiManager scans
+    WiFi.mode(WIFI_STA);
+    wifiConnectStarted();
+    wifiFastConnectBegin(&prefs);
+    IPAddress staticIP, staticGateway, staticSubnet;
+    if (wifiGetStaticIPConfig(staticIP, staticGateway, staticSubnet)) {
+        wm.setSTAStaticIPConfig(staticIP, staticGateway, staticSubnet);
+        dbgln("[WiFi] Using static IP " + staticIP.toString());
+    }
+    bool fastConnected = wifiFastConnect();
     
     // Get MAC address for unique AP name
     uint8_t mac[6];
@@ -595,7 +619,7 @@ void setup() {
     wm.setConfigPortalTimeout(180);
     
     // This single call handles everything
-    bool connected = wm.autoConnect(apName);
+    bool connected = fastConnected || wm.autoConnect(apName);
     
     if (!connected) {
         // Portal timed out without connection
@@ -664,6 +688,13 @@ void setup() {
         }
     }
 
+    // SNTP keeps retrying in the background if the network is not up yet
+    timeService.begin(config.getNtpServer());
+    // Remote syslog drains the debug ring from its own task, including the boot log so far
+    logShipper.begin(config.getSyslogTarget(), config.getSyslogTransport(), config.getSyslogRate());
+    // BSSID vendors come from the table on LittleFS, misses optionally go online in the background
+    ouiLookup.begin(config.getOuiOnline());
+
     dbgln("[wifi] finished");
 
     MBUlogLvl = LOG_LEVEL_WARNING;
@@ -691,6 +722,21 @@ void setup() {
 
     dbgln("[modbusCache] finished");
 
+    // Threshold rules are evaluated as responses are committed to the cache
+    eventEngine.begin(config.getEventRules(), config.getEventSinkType(), config.getEventSinkTarget());
+
+    // Sample task CPU, stacks and queue depths for /metrics and /debug/tasks
+    taskMonitor.addQueue("modbus_rtu_client", []() { return modbusCache->getModbusRTUClient()->pendingRequests(); });
+    taskMonitor.addQueue("modbus_tcp_client", []() { return modbusCache->getModbusTCPClient()->pendingRequests(); });
+    taskMonitor.addQueue("event_sink", []() { return eventEngine.getQueueDepth(); });
+    taskMonitor.addQueue("rtu_gateway", []() { return rtuGateway.getQueueDepth(); });
+    // eModbus' servers answer inline and keep no request queue of their own; the
+    // server-side backlog is the bytes the RTU server task hasn't read yet and the
+    // socket server's deferred pass-through answers
+    taskMonitor.addQueue("modbus_rtu_server_rx", []() { return (uint32_t)modbusServerSerial.available(); });
+    taskMonitor.addQueue("modbus_socket_deferred", []() { return modbusCache->getSocketServer().getDeferredPending(); });
+    taskMonitor.begin();
+
     // Setup web server pages - AsyncWiFiManager shares the same server
     setupPages(&webServer, modbusCache, &config, &wm);
     
@@ -751,8 +797,11 @@ void loop() {
         yield(); // Give WiFi stack CPU time after heavy string operations and WiFi calls
     }
     
-    // Active WiFi recovery when disconnected
-    if (WiFi.status() != WL_CONNECTED) {
+    // Look for a stronger AP in the background while the signal is weak
+    wifiRoamingLoop();
+    
+    // Active WiFi recovery when disconnected, unless a roam is switching APs
+    if (WiFi.status() != WL_CONNECTED && !wifiIsRoaming()) {
         if (currentTime - lastWiFiReconnectAttempt >= 5000) { // Try every 5 seconds
             lastWiFiReconnectAttempt = currentTime;
             wifiReconnectAttempts++;
@@ -760,8 +809,10 @@ void loop() {
             dbgln("[WiFi] Connection lost, attempting recovery (attempt " + String(wifiReconnectAttempts) + ")");
             
             if (wifiReconnectAttempts <= 2) {
-                // First attempts: Simple reconnect
-                WiFi.reconnect();
+                // First attempts: directed connect to the last-good AP, else simple reconnect
+                if (!wifiBeginFastConnect()) {
+                    WiFi.reconnect();
+                }
                 yield();
             } else if (wifiReconnectAttempts <= 4) {
                 // Next attempts: Force WiFi reset
@@ -786,38 +837,27 @@ void loop() {
     
     // Check if we need to reboot due to no data for 60 seconds
     if (modbusCache) {
-        // Get current timestamp
-        currentTime = millis();
-        
-        // Get last update time safely
-        unsigned long lastUpdate = modbusCache->getLastSuccessfulUpdate();
+        // 64-bit monotonic time, so the intervals below need no wrap handling
+        uint64_t now = timeService.millis64();
+        uint64_t lastUpdate = modbusCache->getLastSuccessfulUpdate();
         
         // Track connection problems across multiple loop iterations
-        static unsigned long noUpdatesSince = 0;
-        static unsigned long lastStatusCheck = 0;
+        static uint64_t noUpdatesSince = 0;
+        static uint64_t lastStatusCheck = 0;
         static int connectionProblemCounter = 0;
         
-        // Handle uint32_t overflow/underflow conditions safely
-        unsigned long timeSinceLastUpdate;
-        if (currentTime >= lastUpdate) {
-            timeSinceLastUpdate = currentTime - lastUpdate;
-        } else {
-            // This case handles millis() overflow or lastUpdate being incorrectly set to a future time
-            static char timeBuffer[128];
-            snprintf(timeBuffer, sizeof(timeBuffer), "[main] Time calculation error: current=%lu, lastUpdate=%lu", currentTime, lastUpdate);
-            logErrln(timeBuffer);
-            // Use a more reasonable value instead of overflowing
-            timeSinceLastUpdate = 0;
-        }
+        // lastUpdate is taken under the cache mutex and may be a little newer than now
+        uint64_t timeSinceLastUpdate = now > lastUpdate ? now - lastUpdate : 0;
         
         // Debug log status every 10 seconds
-        if (currentTime - lastStatusCheck > 10000) {
-            lastStatusCheck = currentTime;
+        if (now - lastStatusCheck > 10000) {
+            lastStatusCheck = now;
             // This call is thread-safe as it uses proper getters
             bool isOp = modbusCache->getIsOperational();
             static char statusBuffer[256];
-            snprintf(statusBuffer, sizeof(statusBuffer), "[main] Server operational: %s, Time since last update: %lu seconds, current: %lu, lastUpdate: %lu, connection problem counter: %d", 
-                    isOp ? "YES" : "NO", timeSinceLastUpdate / 1000, currentTime, lastUpdate, connectionProblemCounter);
+            snprintf(statusBuffer, sizeof(statusBuffer), "[main] Server operational: %s, Time since last update: %llu seconds, current: %llu, lastUpdate: %llu, connection problem counter: %d", 
+                    isOp ? "YES" : "NO", static_cast<unsigned long long>(timeSinceLastUpdate / 1000),
+                    static_cast<unsigned long long>(now), static_cast<unsigned long long>(lastUpdate), connectionProblemCounter);
             dbgln(statusBuffer);
             yield(); // Give WiFi stack CPU time after heavy logging operations
             
@@ -827,20 +867,17 @@ void loop() {
                 
                 // If this is the first detection of a problem, note the time
                 if (connectionProblemCounter == 1) {
-                    noUpdatesSince = currentTime;
+                    noUpdatesSince = now;
                 }
                 
                 // Check if we've had sustained problems
-                unsigned long sustainedProblemTime = 0;
-                if (currentTime >= noUpdatesSince) {
-                    sustainedProblemTime = currentTime - noUpdatesSince;
-                }
+                uint64_t sustainedProblemTime = now - noUpdatesSince;
                 
                 // Log the sustained problem duration
                 if (connectionProblemCounter > 1) {
                     static char problemBuffer[128];
-                    snprintf(problemBuffer, sizeof(problemBuffer), "[main] Non-operational state for %lu seconds, counter: %d", 
-                            sustainedProblemTime / 1000, connectionProblemCounter);
+                    snprintf(problemBuffer, sizeof(problemBuffer), "[main] Non-operational state for %llu seconds, counter: %d", 
+                            static_cast<unsigned long long>(sustainedProblemTime / 1000), connectionProblemCounter);
                     logErrln(problemBuffer);
                     yield(); // Give WiFi stack CPU time after error logging
                 }
@@ -864,7 +901,8 @@ void loop() {
         // If it's been more than 60 seconds with no data, reboot the device
         if (timeSinceLastUpdate > 60000 && timeSinceLastUpdate < 3600000) { // Between 1 minute and 1 hour
             static char rebootBuffer[128];
-            snprintf(rebootBuffer, sizeof(rebootBuffer), "[main] No data received for %lu seconds. Rebooting device...", timeSinceLastUpdate / 1000);
+            snprintf(rebootBuffer, sizeof(rebootBuffer), "[main] No data received for %llu seconds. Rebooting device...",
+                     static_cast<unsigned long long>(timeSinceLastUpdate / 1000));
             logErrln(rebootBuffer);
             delay(200); // Short delay to allow log message to be sent
             ESP.restart();
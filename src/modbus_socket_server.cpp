@@ -0,0 +1,399 @@
+#include "modbus_socket_server.h"
+
+#include <string.h>
+#include <errno.h>
+
+#ifdef ARDUINO
+#include <lwip/sockets.h>
+#include "config.h"
+#define SOCKET_LOG(msg) dbgln(String("[ModbusSocketServer] ") + msg)
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <chrono>
+#define SOCKET_LOG(msg) ((void)0)
+#endif
+
+ModbusSocketServer::ModbusSocketServer()
+    : listenFd(-1)
+    , idleTimeoutMs(0)
+    , handler(nullptr)
+    , connections(nullptr)
+    , deferredAnswers(nullptr)
+    , heldBackStart(0)
+    , clients(0)
+    , accepted(0)
+    , rejected(0)
+    , requests(0)
+    , pipelined(0)
+    , maxPipelineDepth(0)
+    , protocolErrors(0)
+    , idleClosed(0)
+    , deferred(0)
+{}
+
+uint32_t ModbusSocketServer::nowMs() {
+#ifdef ARDUINO
+    return millis();
+#else
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+bool ModbusSocketServer::begin(uint16_t port, uint32_t timeoutMs, ModbusSocketHandler requestHandler) {
+    if (port == 0 || !requestHandler || listenFd >= 0) {
+        return false;
+    }
+
+    int fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (fd < 0) {
+        SOCKET_LOG("socket() failed: " + String(errno));
+        return false;
+    }
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) < 0 ||
+        listen(fd, MB_SOCKET_MAX_CLIENTS) < 0) {
+        SOCKET_LOG("Cannot listen on port " + String(port) + ": " + String(errno));
+        close(fd);
+        return false;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+
+    // The whole connection table up front, nothing is allocated per client or request
+    connections = new Connection[MB_SOCKET_MAX_CLIENTS];
+    for (int i = 0; i < MB_SOCKET_MAX_CLIENTS; i++) {
+        connections[i].fd = -1;
+        connections[i].generation = 0;
+        connections[i].deferredCount = 0;
+    }
+    deferredAnswers = new Deferred[MB_SOCKET_MAX_DEFERRED];
+    for (int i = 0; i < MB_SOCKET_MAX_DEFERRED; i++) {
+        deferredAnswers[i].state = DEFERRED_FREE;
+    }
+    handler = requestHandler;
+    idleTimeoutMs = timeoutMs;
+    listenFd = fd;
+    SOCKET_LOG("Listening on port " + String(port));
+    return true;
+}
+
+#ifdef ARDUINO
+bool ModbusSocketServer::start(UBaseType_t priority, BaseType_t core) {
+    if (listenFd < 0 || taskHandle != nullptr) {
+        return false;
+    }
+    return xTaskCreatePinnedToCore(task, "mbSocket", 6144, this, priority, &taskHandle, core) == pdPASS;
+}
+
+void ModbusSocketServer::task(void* param) {
+    ModbusSocketServer* self = static_cast<ModbusSocketServer*>(param);
+    for (;;) {
+        self->poll(MB_SOCKET_POLL_MS);
+    }
+}
+#endif
+
+void ModbusSocketServer::poll(uint32_t timeoutMs) {
+    if (listenFd < 0) {
+        return;
+    }
+
+    // Deferred answers arrive from other tasks, look for them often while any are owed
+    for (int i = 0; i < MB_SOCKET_MAX_DEFERRED; i++) {
+        if (deferredAnswers[i].state.load() != DEFERRED_FREE) {
+            timeoutMs = timeoutMs < MB_SOCKET_DEFERRED_POLL_MS ? timeoutMs : MB_SOCKET_DEFERRED_POLL_MS;
+            break;
+        }
+    }
+
+    fd_set readSet;
+    fd_set writeSet;
+    FD_ZERO(&readSet);
+    FD_ZERO(&writeSet);
+    FD_SET(listenFd, &readSet);
+    int maxFd = listenFd;
+    for (int i = 0; i < MB_SOCKET_MAX_CLIENTS; i++) {
+        Connection& connection = connections[i];
+        if (connection.fd < 0) {
+            continue;
+        }
+        // Stop reading while the queued and owed responses leave no room for another
+        // one, TCP flow control then holds the client back
+        if (connection.rxLength < sizeof(connection.rx) && hasRoom(connection)) {
+            FD_SET(connection.fd, &readSet);
+        }
+        if (connection.txLength > 0) {
+            FD_SET(connection.fd, &writeSet);
+        }
+        if (connection.fd > maxFd) {
+            maxFd = connection.fd;
+        }
+    }
+
+    struct timeval timeout;
+    timeout.tv_sec = timeoutMs / 1000;
+    timeout.tv_usec = (timeoutMs % 1000) * 1000;
+    int ready = select(maxFd + 1, &readSet, &writeSet, nullptr, &timeout);
+    uint32_t now = nowMs();
+    sendDeferred();
+
+    if (ready > 0) {
+        for (int i = 0; i < MB_SOCKET_MAX_CLIENTS; i++) {
+            Connection& connection = connections[i];
+            if (connection.fd >= 0 && FD_ISSET(connection.fd, &writeSet)) {
+                serviceClient(connection);
+            }
+            if (connection.fd >= 0 && FD_ISSET(connection.fd, &readSet)) {
+                readClient(connection, now);
+            }
+        }
+        // After the clients, so a slot freed this round is never confused with a new descriptor
+        if (FD_ISSET(listenFd, &readSet)) {
+            acceptClient(now);
+        }
+    }
+
+    if (idleTimeoutMs > 0) {
+        for (int i = 0; i < MB_SOCKET_MAX_CLIENTS; i++) {
+            Connection& connection = connections[i];
+            if (connection.fd >= 0 && now - connection.lastActivityMs >= idleTimeoutMs) {
+                idleClosed++;
+                closeClient(connection);
+            }
+        }
+    }
+}
+
+void ModbusSocketServer::acceptClient(uint32_t now) {
+    struct sockaddr_in address;
+    socklen_t addressLength = sizeof(address);
+    int fd = accept(listenFd, reinterpret_cast<struct sockaddr*>(&address), &addressLength);
+    if (fd < 0) {
+        return;
+    }
+
+    Connection* free = nullptr;
+    for (int i = 0; i < MB_SOCKET_MAX_CLIENTS; i++) {
+        if (connections[i].fd < 0) {
+            free = &connections[i];
+            break;
+        }
+    }
+    if (free == nullptr) {
+        rejected++;
+        SOCKET_LOG("Too many clients, rejecting connection");
+        close(fd);
+        return;
+    }
+
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    free->fd = fd;
+    free->lastActivityMs = now;
+    free->rxLength = 0;
+    free->txLength = 0;
+    free->deferredCount = 0;
+    clients++;
+    accepted++;
+}
+
+void ModbusSocketServer::readClient(Connection& connection, uint32_t now) {
+    int received = recv(connection.fd, connection.rx + connection.rxLength,
+                        sizeof(connection.rx) - connection.rxLength, 0);
+    if (received < 0 && (errno == EWOULDBLOCK || errno == EAGAIN)) {
+        return;
+    }
+    if (received <= 0) {
+        closeClient(connection);
+        return;
+    }
+    connection.rxLength += received;
+    connection.lastActivityMs = now;
+    serviceClient(connection);
+}
+
+void ModbusSocketServer::serviceClient(Connection& connection) {
+    // Answer what has arrived and send it; if everything went out, frames held
+    // back for lack of room get their turn
+    for (;;) {
+        uint16_t pending = connection.rxLength;
+        if (!answerFrames(connection)) {
+            protocolErrors++;
+            closeClient(connection);
+            return;
+        }
+        if (connection.txLength > 0) {
+            int sent = send(connection.fd, connection.tx, connection.txLength, MSG_NOSIGNAL);
+            if (sent < 0) {
+                if (errno != EWOULDBLOCK && errno != EAGAIN) {
+                    closeClient(connection);
+                }
+                return;
+            }
+            connection.txLength -= sent;
+            memmove(connection.tx, connection.tx + sent, connection.txLength);
+        }
+        if (connection.rxLength == pending || connection.txLength > 0) {
+            return;
+        }
+    }
+}
+
+bool ModbusSocketServer::answerFrames(Connection& connection) {
+    uint16_t offset = 0;
+    uint32_t answered = 0;
+    while (connection.rxLength - offset >= MB_SOCKET_MBAP_SIZE) {
+        const uint8_t* frame = connection.rx + offset;
+        uint16_t protocol = frame[2] << 8 | frame[3];
+        uint16_t length = frame[4] << 8 | frame[5]; // Unit ID + PDU
+        if (protocol != 0 || length < 2 || length > MB_SOCKET_MAX_ADU - 6) {
+            return false;
+        }
+        if (connection.rxLength - offset < 6 + length) {
+            break;
+        }
+        if (!hasRoom(connection)) {
+            break;
+        }
+        // Every request may be deferred, so it needs an answer slot before it is handed over
+        int ticket = -1;
+        for (int i = 0; i < MB_SOCKET_MAX_DEFERRED; i++) {
+            if (deferredAnswers[i].state.load() == DEFERRED_FREE) {
+                ticket = i;
+                break;
+            }
+        }
+        if (ticket < 0) {
+            break;
+        }
+        Deferred& answer = deferredAnswers[ticket];
+        answer.connection = &connection - connections;
+        answer.generation = connection.generation;
+        memcpy(answer.header, frame, sizeof(answer.header));
+        answer.state = DEFERRED_WAITING;
+
+        // Same transaction and protocol ID, the handler fills in unit ID and PDU
+        uint8_t* out = connection.tx + connection.txLength;
+        uint16_t responseLength = handler(frame + 6, length, out + 6, MB_SOCKET_MAX_ADU - 6, ticket);
+        if (responseLength == MB_SOCKET_DEFERRED) {
+            connection.deferredCount++;
+            deferred++;
+        } else {
+            answer.state = DEFERRED_FREE;
+        }
+        if (responseLength > 0 && responseLength != MB_SOCKET_DEFERRED) {
+            memcpy(out, frame, 4);
+            out[4] = responseLength >> 8;
+            out[5] = responseLength & 0xFF;
+            connection.txLength += 6 + responseLength;
+        }
+        offset += 6 + length;
+        answered++;
+    }
+
+    if (offset > 0) {
+        connection.rxLength -= offset;
+        memmove(connection.rx, connection.rx + offset, connection.rxLength);
+        requests += answered;
+        if (answered > 1) {
+            pipelined += answered - 1;
+        }
+        uint32_t depth = maxPipelineDepth.load();
+        while (answered > depth && !maxPipelineDepth.compare_exchange_weak(depth, answered)) {}
+    }
+    return true;
+}
+
+void ModbusSocketServer::complete(uint32_t ticket, const uint8_t* response, uint16_t length) {
+    if (deferredAnswers == nullptr || ticket >= MB_SOCKET_MAX_DEFERRED) {
+        return;
+    }
+    Deferred& answer = deferredAnswers[ticket];
+    if (answer.state.load() != DEFERRED_WAITING) {
+        return;
+    }
+    answer.length = length < sizeof(answer.data) ? length : sizeof(answer.data);
+    memcpy(answer.data, response, answer.length);
+    answer.state.store(DEFERRED_READY, std::memory_order_release);
+}
+
+uint32_t ModbusSocketServer::getDeferredPending() const {
+    if (deferredAnswers == nullptr) {
+        return 0;
+    }
+    uint32_t pending = 0;
+    for (int i = 0; i < MB_SOCKET_MAX_DEFERRED; i++) {
+        if (deferredAnswers[i].state.load() != DEFERRED_FREE) {
+            pending++;
+        }
+    }
+    return pending;
+}
+
+void ModbusSocketServer::sendDeferred() {
+    bool freed = false;
+    for (int i = 0; i < MB_SOCKET_MAX_DEFERRED; i++) {
+        Deferred& answer = deferredAnswers[i];
+        if (answer.state.load(std::memory_order_acquire) != DEFERRED_READY) {
+            continue;
+        }
+        freed = true;
+        Connection& connection = connections[answer.connection];
+        // The client may have gone, and its slot been taken by another one, while the answer was owed
+        if (connection.fd >= 0 && connection.generation == answer.generation) {
+            connection.deferredCount--;
+            if (answer.length > 0) {
+                uint8_t* out = connection.tx + connection.txLength;
+                memcpy(out, answer.header, sizeof(answer.header));
+                out[4] = answer.length >> 8;
+                out[5] = answer.length & 0xFF;
+                memcpy(out + 6, answer.data, answer.length);
+                connection.txLength += 6 + answer.length;
+            }
+            answer.state = DEFERRED_FREE;
+            serviceClient(connection);
+        } else {
+            answer.state = DEFERRED_FREE;
+        }
+    }
+
+    // Requests held back for lack of an answer slot can go now, starting with a
+    // different connection each time so none of them is starved
+    if (freed) {
+        for (int i = 0; i < MB_SOCKET_MAX_CLIENTS; i++) {
+            Connection& connection = connections[(heldBackStart + i) % MB_SOCKET_MAX_CLIENTS];
+            if (connection.fd >= 0 && connection.rxLength >= MB_SOCKET_MBAP_SIZE) {
+                serviceClient(connection);
+            }
+        }
+        heldBackStart = (heldBackStart + 1) % MB_SOCKET_MAX_CLIENTS;
+    }
+}
+
+bool ModbusSocketServer::hasRoom(const Connection& connection) const {
+    return sizeof(connection.tx) - connection.txLength >= MB_SOCKET_MAX_ADU * (1u + connection.deferredCount);
+}
+
+void ModbusSocketServer::closeClient(Connection& connection) {
+    close(connection.fd);
+    connection.fd = -1;
+    connection.generation++;
+    connection.rxLength = 0;
+    connection.txLength = 0;
+    connection.deferredCount = 0;
+    clients--;
+}
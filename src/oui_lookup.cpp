@@ -0,0 +1,277 @@
+#include "oui_lookup.h"
+#include "config.h"
+#include "time_service.h"
+#include <ArduinoJson.h>
+#include <HTTPClient.h>
+#include <WiFi.h>
+
+// Global instance
+OuiLookup ouiLookup;
+
+static uint32_t readLE32(const uint8_t* p) {
+    return p[0] | p[1] << 8 | p[2] << 16 | static_cast<uint32_t>(p[3]) << 24;
+}
+
+static uint32_t readBE24(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) << 16 | p[1] << 8 | p[2];
+}
+
+OuiLookup::OuiLookup()
+    : mutex(nullptr)
+    , onlineQueue(nullptr)
+    , taskHandle(nullptr)
+    , count(0)
+    , pageSize(0)
+    , pageCount(0)
+    , recordsOffset(0)
+    , namesOffset(0)
+    , generated(0)
+    , pageIndex(nullptr)
+    , online(false)
+    , lookups(0)
+    , tableHits(0)
+    , onlineHits(0)
+    , misses(0)
+    , onlineRequests(0)
+    , onlineFailures(0)
+    , lastLookupUs(0)
+    , maxLookupUs(0)
+{}
+
+void OuiLookup::begin(bool onlineRefresh) {
+    mutex = xSemaphoreCreateMutex();
+    onlineQueue = xQueueCreate(OUI_ONLINE_QUEUE, sizeof(uint32_t));
+    if (mutex == nullptr || onlineQueue == nullptr) {
+        logErrln("[OUI] Failed to allocate lookup mutex or queue");
+        return;
+    }
+    online = onlineRefresh;
+    xTaskCreatePinnedToCore(onlineTask, "oui", 6144, this, 1, &taskHandle, 0);
+
+    if (!LittleFS.exists(OUI_TABLE_PATH)) {
+        dbgln("[OUI] No vendor table at " OUI_TABLE_PATH ", online lookups only");
+        return;
+    }
+    table = LittleFS.open(OUI_TABLE_PATH, "r");
+    uint8_t header[OUI_HEADER_SIZE];
+    if (!table || table.read(header, sizeof(header)) != sizeof(header)) {
+        logErrln("[OUI] Failed to read " OUI_TABLE_PATH);
+        return;
+    }
+
+    uint32_t entries = readLE32(header + 8);
+    pageSize = header[6] | header[7] << 8;
+    recordsOffset = readLE32(header + 12);
+    namesOffset = readLE32(header + 16);
+    generated = readLE32(header + 20);
+    pageCount = pageSize > 0 ? (entries + pageSize - 1) / pageSize : 0;
+    if (readLE32(header) != OUI_TABLE_MAGIC || header[4] != OUI_TABLE_VERSION ||
+        pageSize == 0 || pageSize > OUI_MAX_PAGE_SIZE || entries == 0 || pageCount > OUI_MAX_PAGES ||
+        recordsOffset != OUI_HEADER_SIZE + pageCount * 3 ||
+        namesOffset != recordsOffset + entries * OUI_RECORD_SIZE || table.size() <= namesOffset) {
+        logErrln("[OUI] " OUI_TABLE_PATH " is not a valid version " + String(OUI_TABLE_VERSION) + " table");
+        table.close();
+        return;
+    }
+
+    pageIndex = static_cast<uint8_t*>(malloc(pageCount * 3));
+    if (pageIndex == nullptr || table.read(pageIndex, pageCount * 3) != pageCount * 3) {
+        logErrln("[OUI] Failed to load the page index");
+        free(pageIndex);
+        pageIndex = nullptr;
+        table.close();
+        return;
+    }
+    count = entries;
+    dbgln("[OUI] Vendor table with " + String(count) + " entries, " + String(pageCount) + " pages");
+}
+
+void OuiLookup::setOnlineRefresh(bool enabled) {
+    online = enabled;
+}
+
+bool OuiLookup::parseOui(const String& mac, uint32_t& oui) {
+    // First six hex digits, separators ignored
+    oui = 0;
+    uint8_t digits = 0;
+    for (size_t i = 0; i < mac.length() && digits < 6; i++) {
+        char c = mac[i];
+        if (isxdigit(c)) {
+            oui = oui << 4 | (isdigit(c) ? c - '0' : (tolower(c) - 'a' + 10));
+            digits++;
+        }
+    }
+    return digits == 6;
+}
+
+OuiSource OuiLookup::lookup(const String& mac, uint32_t& oui, String& vendor) {
+    uint64_t startUs = TimeService::micros64();
+    lookups++;
+
+    OuiSource source = OuiSource::NOT_FOUND;
+    if (!parseOui(mac, oui)) {
+        source = OuiSource::NOT_FOUND;
+    } else if (oui & 0x020000) {
+        // Randomised and other locally administered addresses carry no vendor
+        source = OuiSource::PRIVATE;
+    } else if (findInTable(oui, vendor)) {
+        source = OuiSource::TABLE;
+        tableHits++;
+    } else if (mutex != nullptr && xSemaphoreTake(mutex, pdMS_TO_TICKS(10))) {
+        unsigned long now = millis();
+        auto cached = onlineCache.find(oui);
+        if (cached != onlineCache.end() && cached->second.first.length() > 0) {
+            vendor = cached->second.first;
+            source = OuiSource::ONLINE;
+            onlineHits++;
+        } else if (pending.count(oui) > 0) {
+            source = OuiSource::PENDING;
+        } else if (online && (cached == onlineCache.end() || now - cached->second.second > OUI_ONLINE_RETRY_MS)) {
+            // Never wait on the queue: a full queue just reports a miss this time
+            if (xQueueSend(onlineQueue, &oui, 0) == pdTRUE) {
+                pending[oui] = now;
+                source = OuiSource::PENDING;
+            }
+        }
+        xSemaphoreGive(mutex);
+    }
+    if (source == OuiSource::NOT_FOUND) {
+        misses++;
+    }
+
+    uint32_t elapsedUs = TimeService::micros64() - startUs;
+    lastLookupUs = elapsedUs;
+    if (elapsedUs > maxLookupUs) maxLookupUs = elapsedUs;
+    return source;
+}
+
+bool OuiLookup::findInTable(uint32_t oui, String& vendor) {
+    if (count == 0) {
+        return false;
+    }
+
+    // Last page whose first OUI is not above the key
+    uint32_t low = 0;
+    uint32_t high = pageCount;
+    while (low < high) {
+        uint32_t mid = (low + high) / 2;
+        if (readBE24(pageIndex + mid * 3) <= oui) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    if (low == 0) {
+        return false;
+    }
+    uint32_t page = low - 1;
+    uint32_t records = min<uint32_t>(pageSize, count - page * pageSize);
+
+    uint8_t buffer[OUI_MAX_PAGE_SIZE * OUI_RECORD_SIZE];
+    char name[OUI_MAX_NAME + 1];
+    bool found = false;
+    if (!xSemaphoreTake(mutex, pdMS_TO_TICKS(10))) {
+        return false;
+    }
+    if (table.seek(recordsOffset + page * pageSize * OUI_RECORD_SIZE) &&
+        table.read(buffer, records * OUI_RECORD_SIZE) == records * OUI_RECORD_SIZE) {
+        uint32_t first = 0;
+        uint32_t last = records;
+        while (first < last) {
+            uint32_t mid = (first + last) / 2;
+            uint32_t key = readBE24(buffer + mid * OUI_RECORD_SIZE);
+            if (key == oui) {
+                const uint8_t* offset = buffer + mid * OUI_RECORD_SIZE + 3;
+                uint32_t nameOffset = offset[0] | offset[1] << 8 | offset[2] << 16;
+                size_t length = table.seek(namesOffset + nameOffset)
+                              ? table.read(reinterpret_cast<uint8_t*>(name), OUI_MAX_NAME) : 0;
+                name[length] = '\0';
+                found = length > 0;
+                break;
+            }
+            if (key < oui) {
+                first = mid + 1;
+            } else {
+                last = mid;
+            }
+        }
+    }
+    xSemaphoreGive(mutex);
+
+    if (found) {
+        vendor = name;  // Stops at the name's terminator
+    }
+    return found;
+}
+
+bool OuiLookup::fetchOnline(uint32_t oui, String& vendor) {
+    char prefix[7];
+    snprintf(prefix, sizeof(prefix), "%06X", static_cast<unsigned>(oui));
+
+    WiFiClient client;
+    HTTPClient http;
+    bool found = false;
+    if (http.begin(client, String(OUI_ONLINE_URL) + prefix)) {
+        http.setTimeout(5000);
+        int httpCode = http.GET();
+        if (httpCode == HTTP_CODE_OK) {
+            DynamicJsonDocument doc(1024);
+            if (!deserializeJson(doc, http.getString()) && doc["found"].as<bool>()) {
+                vendor = doc["company"].as<String>();
+                found = vendor.length() > 0;
+            }
+        } else {
+            dbgln("[OUI] Online lookup of " + String(prefix) + " failed with " + String(httpCode));
+        }
+        http.end();
+    }
+    return found;
+}
+
+void OuiLookup::onlineTask(void* param) {
+    OuiLookup* self = static_cast<OuiLookup*>(param);
+    uint32_t oui;
+    for (;;) {
+        if (xQueueReceive(self->onlineQueue, &oui, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+
+        String vendor;
+        bool found = false;
+        if (self->online && WiFi.status() == WL_CONNECTED) {
+            self->onlineRequests++;
+            found = self->fetchOnline(oui, vendor);
+        }
+        if (!found) {
+            self->onlineFailures++;
+        }
+
+        xSemaphoreTake(self->mutex, portMAX_DELAY);
+        if (self->onlineCache.size() >= OUI_ONLINE_CACHE && self->onlineCache.count(oui) == 0) {
+            // Drop the oldest result
+            auto oldest = self->onlineCache.begin();
+            for (auto it = self->onlineCache.begin(); it != self->onlineCache.end(); ++it) {
+                if (it->second.second < oldest->second.second) {
+                    oldest = it;
+                }
+            }
+            self->onlineCache.erase(oldest);
+        }
+        self->onlineCache[oui] = std::make_pair(vendor, millis());
+        self->pending.erase(oui);
+        xSemaphoreGive(self->mutex);
+
+        // The free API tier allows a couple of requests per second
+        vTaskDelay(pdMS_TO_TICKS(500));
+    }
+}
+
+const char* OuiLookup::sourceName(OuiSource source) {
+    switch (source) {
+        case OuiSource::TABLE: return "table";
+        case OuiSource::ONLINE: return "online";
+        case OuiSource::PENDING: return "pending";
+        case OuiSource::PRIVATE: return "private";
+        default: return "none";
+    }
+}
@@ -1,8 +1,18 @@
 #include "pages.h"
+#include "bus_stats.h"
+#include "event_engine.h"
+#include "gzip_stream.h"
+#include "log_shipper.h"
+#include "oui_lookup.h"
+#include "rtu_gateway.h"
+#include "task_monitor.h"
+#include "time_service.h"
+#include "turnaround_stats.h"
+#include "wifi_utils.h"
 #include <ArduinoJson.h>
-#include <HTTPClient.h>
 #include <atomic>
 #include <map>
+#include <memory>
 #include <LittleFS.h>
 #include <esp_partition.h>
 #include <esp_ota_ops.h>
@@ -41,14 +51,29 @@ extern unsigned long lastWiFiConnectionTime;
 static std::atomic<int> activeConnections{0};
 static const int MAX_CONNECTIONS = 15; // Maximum concurrent connections (increased for browser parallelism)
 
+// Log endpoint statistics, exported in /metrics
+static std::atomic<uint32_t> logQueries{0};
+static std::atomic<uint32_t> logQueryBytes{0};       // Bytes sent by /logdata
+static std::atomic<uint32_t> logQueryScanned{0};     // Ring bytes examined by filtered queries
+static std::atomic<uint32_t> logQueryLastUs{0};
+static std::atomic<uint32_t> logQueryMaxUs{0};
+static std::atomic<uint32_t> logDownloads{0};
+static std::atomic<uint32_t> logDownloadRawBytes{0};
+static std::atomic<uint32_t> logDownloadBytes{0};
+static std::atomic<uint32_t> logDownloadLastMs{0};
+static std::atomic<bool> logDownloadActive{false};
+
+// /api/batch statistics, exported in /metrics
+static const char* const batchPartNames[] = {"status", "version", "config"};
+static std::atomic<uint32_t> batchRequests{0};
+static std::atomic<uint32_t> batchParts{0};
+static std::atomic<uint32_t> batchBytes{0};
+static std::atomic<uint32_t> batchLastMs{0};
+static std::atomic<uint32_t> batchMinFreeHeap{UINT32_MAX};  // Lowest free heap seen while building a part
+
 // LittleFS mutex for concurrent file access protection
 static SemaphoreHandle_t fileMutex = nullptr;
 
-// BSSID cache with expiry and size limits
-static std::map<String, std::pair<String, unsigned long>> bssidCache;
-static const unsigned long BSSID_CACHE_EXPIRY = 24 * 60 * 60 * 1000; // 24 hours
-static const size_t MAX_BSSID_CACHE_SIZE = 50;
-
 // Adaptive OTA constants and structures
 enum class FirmwareType {
     UNKNOWN,
@@ -101,19 +126,6 @@ void releaseConnection() {
   }
 }
 
-// Helper function to clean up expired BSSID cache entries
-void cleanupBssidCache() {
-  unsigned long currentTime = millis();
-  auto it = bssidCache.begin();
-  while (it != bssidCache.end()) {
-    if (currentTime - it->second.second > BSSID_CACHE_EXPIRY) {
-      it = bssidCache.erase(it);
-    } else {
-      ++it;
-    }
-  }
-}
-
 // Firmware detection functions
 FirmwareType detectFirmwareType(const uint8_t* data, size_t len, const String& filename) {
     dbgln("[OTA] Detecting firmware type from " + filename + ", data length: " + String(len));
@@ -549,178 +561,16 @@ void resetOTAContextForNewUpload() {
           ", finalization_successful: " + String(ota_context.finalization_successful));
 }
 
-void setupPages(AsyncWebServer *server, ModbusCache *modbusCache, Config *config, AsyncWiFiManager *wm){
-    // Initialize LittleFS mutex for concurrent file access protection
-    if (fileMutex == nullptr) {
-        fileMutex = xSemaphoreCreateMutex();
-        if (fileMutex == nullptr) {
-            logErrln("Failed to create LittleFS mutex!");
-        }
-    }
-
-    server->on("/metrics", HTTP_GET, [modbusCache](AsyncWebServerRequest *request) {
-    logHeapMemory("/metrics");
-
-    String response;
-
-    // ESP specific metrics
-    unsigned long uptime = millis() / 1000;
-    response += String("esp_uptime_seconds ") + String(uptime) + "\n";
-    response += String("esp_rssi ") + String(WiFi.RSSI()) + "\n";
-    response += String("esp_heap_free_bytes ") + String(ESP.getFreeHeap()) + "\n";
-
-
-    // Modbus metrics
-    ModbusClientRTU* rtu = modbusCache->getModbusRTUClient();
-    response += String("modbus_primary_rtu_messages ") + String(rtu->getMessageCount()) + "\n";
-    response += String("modbus_primary_rtu_pending_messages ") + String(rtu->pendingRequests()) + "\n";
-    response += String("modbus_primary_rtu_errors ") + String(rtu->getErrorCount()) + "\n";
-
-    ModbusClientTCPasync* modbusTCPClient = modbusCache->getModbusTCPClient();
-    response += String("modbus_secondary_tcp_messages ") + String(modbusTCPClient->getMessageCount()) + "\n";
-    response += String("modbus_secondary_tcp_errors ") + String(modbusTCPClient->getErrorCount()) + "\n";
-
-    ModbusServerRTU& modbusRTUServer = modbusCache->getModbusRTUServer();
-    response += String("modbus_server_messages ") + String(modbusRTUServer.getMessageCount()) + "\n";
-    response += String("modbus_server_errors ") + String(modbusRTUServer.getErrorCount()) + "\n";
-    response += String("modbus_static_registers_fetched ") + String(modbusCache->getStaticRegistersFetched() ? 1 : 0) + "\n";
-    response += String("modbus_dynamic_registers_fetched ") + String(modbusCache->getDynamicRegistersFetched() ? 1 : 0) + "\n";
-    response += String("modbus_operational ") + String(modbusCache->getIsOperational() ? 1 : 0) + "\n";
-    response += String("modbus_bogus_register_count ") + String(modbusCache->getInsaneCounter()) + "\n";
-    response += String("min_latency_ms ") + String(modbusCache->getMinLatency()) + "\n";
-    response += String("max_latency_ms ") + String(modbusCache->getMaxLatency()) + "\n";
-    response += String("average_latency_ms ") + String(modbusCache->getAverageLatency()) + "\n";
-    response += String("std_deviation_latency_ms ") + String(modbusCache->getStdDeviation()) + "\n";
-
-    // Add dynamic registers
-    for (auto& address : modbusCache->getDynamicRegisterAddresses()) {
-        String formattedValue = modbusCache->getFormattedRegisterValue(address);
-        auto regDef = modbusCache->getRegisterDefinition(address);
-        if (regDef.has_value()) {
-            String metricName = regDef->description;
-            metricName.replace("(", ""); // Remove parentheses
-            metricName.replace(")", ""); // Remove parentheses
-            metricName.replace("-", ""); // Remove hyphens
-            metricName.replace("+", ""); // Remove plus signs
-            metricName.trim();
-            metricName.replace(" ", "_"); // Replace spaces with underscores for Prometheus compliance
-            metricName.toLowerCase();
-
-            // Remove units from values
-            formattedValue.replace(" V", "");
-            formattedValue.replace(" A", "");
-
-            formattedValue.replace(" W", "");
-            formattedValue.replace(" VA", "");
-            formattedValue.replace(" var", "");
-            formattedValue.replace(" kWh", "");
-            formattedValue.replace(" kVARh", "");
-            formattedValue.replace(" Hz", "");
-            formattedValue.replace("A", "");
-
-            response += metricName + " " + formattedValue + "\n";
-        }
-    }
-
-    // Send the response to Prometheus
-    request->send(200, "text/plain", response);
-  });
-
-
-  server->on("/lookup", HTTP_GET, [](AsyncWebServerRequest *request) {
-    logHeapMemory("/lookup");
-      if (!request->hasParam("bssid")) {
-          request->send(400, "application/json", "{\"error\":\"Missing BSSID parameter\"}");
-          return;
-      }
-
-      String bssid = request->getParam("bssid")->value();
-      unsigned long currentTime = millis();
-      
-      // Clean up expired cache entries periodically
-      static unsigned long lastCleanup = 0;
-      if (currentTime - lastCleanup > 300000) { // Every 5 minutes
-          cleanupBssidCache();
-          lastCleanup = currentTime;
-      }
-      
-      // Check if we have a valid cached result for this BSSID
-      auto it = bssidCache.find(bssid);
-      if (it != bssidCache.end() && 
-          currentTime - it->second.second < BSSID_CACHE_EXPIRY) {
-          dbgln("[BSSID] Cache hit for " + bssid);
-          request->send(200, "application/json", it->second.first);
-          return;
-      }
-
-      dbgln("[BSSID] Cache miss for " + bssid + ", fetching from API");
-      WiFiClient client;
-      HTTPClient http;
-      String url = "http://api.maclookup.app/v2/macs/" + bssid;
-
-      if (http.begin(client, url)) {
-          http.setTimeout(5000); // 5 second timeout
-          int httpCode = http.GET();
-          if (httpCode == HTTP_CODE_OK) {
-              String payload = http.getString();
-              
-              // Manage cache size - remove oldest entries if needed
-              if (bssidCache.size() >= MAX_BSSID_CACHE_SIZE) {
-                  // Find and remove the oldest entry
-                  auto oldestIt = bssidCache.begin();
-                  unsigned long oldestTime = oldestIt->second.second;
-                  for (auto cacheIt = bssidCache.begin(); cacheIt != bssidCache.end(); ++cacheIt) {
-                      if (cacheIt->second.second < oldestTime) {
-                          oldestTime = cacheIt->second.second;
-                          oldestIt = cacheIt;
-                      }
-                  }
-                  bssidCache.erase(oldestIt);
-                  dbgln("[BSSID] Cache full, removed oldest entry");
-              }
-              
-              // Update cache with new data
-              bssidCache[bssid] = std::make_pair(payload, currentTime);
-              request->send(200, "application/json", payload);
-          } else {
-              // On error, try to use any cached data if available (even expired)
-              auto fallbackIt = bssidCache.find(bssid);
-              if (fallbackIt != bssidCache.end()) {
-                  dbgln("[BSSID] API request failed, using cached data (possibly expired)");
-                  request->send(200, "application/json", fallbackIt->second.first);
-              } else {
-                  request->send(500, "application/json", "{\"error\":\"API request failed\"}");
-              }
-          }
-          http.end();
-      } else {
-          // On connection failure, try to use any cached data if available
-          auto fallbackIt = bssidCache.find(bssid);
-          if (fallbackIt != bssidCache.end()) {
-              dbgln("[BSSID] HTTP connection failed, using cached data");
-              request->send(200, "application/json", fallbackIt->second.first);
-          } else {
-              request->send(500, "application/json", "{\"error\":\"HTTP connection failed\"}");
-          }
-      }
-  });
-
-  // Legacy home route removed - now handled by Preact SPA
-
-  // Endpoint to serve JSON data
-  server->on("/status.json", HTTP_GET, [modbusCache](AsyncWebServerRequest *request) {
-    logHeapMemory("/status.json");
-    
-    // Yield to prevent watchdog timeout
-    yield();
-    
-    // Check if we can accept more connections
-    if (!canAcceptConnection()) {
-      request->send(503, "application/json", "{\"error\":\"Server busy\"}");
-      return;
-    }
+// Cache state for /status.json, taken once so a batch can share it across its parts
+ModbusCache::SystemSnapshot fetchStatusSnapshot(ModbusCache *modbusCache) {
+    // Get dynamic register addresses
+    std::set<uint16_t> dynamicAddresses = modbusCache->getDynamicRegisterAddresses();
     
-    DynamicJsonDocument doc(4096);
+    // Fetch all system data in a single atomic operation including registers, unexpected registers, and insane counter
+    return modbusCache->fetchSystemSnapshot(dynamicAddresses);
+}
+
+void buildStatusJson(ModbusCache *modbusCache, const ModbusCache::SystemSnapshot& systemSnapshot, JsonDocument& doc) {
     JsonArray data = doc.createNestedArray("data");
 
     // Yield periodically during JSON generation
@@ -737,7 +587,8 @@ void setupPages(AsyncWebServer *server, ModbusCache *modbusCache, Config *config
     addSystemInfo("Firmware Version", GIT_VERSION);
     addSystemInfo("Firmware Build Time", BUILD_TIME_STR);
 
-    unsigned long uptime = millis() / 1000;
+    // 64-bit clock, millis() / 1000 would restart from zero after 49.7 days
+    unsigned long uptime = TimeService::millis64() / 1000;
     unsigned long days = uptime / 86400;
     uptime %= 86400;
     unsigned long hours = uptime / 3600;
@@ -748,6 +599,17 @@ void setupPages(AsyncWebServer *server, ModbusCache *modbusCache, Config *config
     sprintf(uptimeStr, "%lu days, %02lu:%02lu:%02lu", days, hours, minutes, seconds);
 
     addSystemInfo("ESP Uptime", uptimeStr);
+
+    if (timeService.isSynced()) {
+        time_t wallClock = timeService.unixMs() / 1000;
+        struct tm utc;
+        gmtime_r(&wallClock, &utc);
+        char timeStr[32];
+        strftime(timeStr, sizeof(timeStr), "%Y-%m-%d %H:%M:%S UTC", &utc);
+        addSystemInfo("Wall Clock", timeStr);
+    } else {
+        addSystemInfo("Wall Clock", "Not synced");
+    }
     
     // Calculate WiFi uptime (time since last connection)
     if (lastWiFiConnectionTime > 0 && WiFi.status() == WL_CONNECTED) {
@@ -792,12 +654,6 @@ void setupPages(AsyncWebServer *server, ModbusCache *modbusCache, Config *config
     addSystemInfo("Server - Dynamic Registers Fetched", modbusCache->getDynamicRegistersFetched() ? "Yes" : "No");
     addSystemInfo("Server - Operational", modbusCache->getIsOperational() ? "Yes" : "No");
     
-    // Get dynamic register addresses
-    std::set<uint16_t> dynamicAddresses = modbusCache->getDynamicRegisterAddresses();
-    
-    // Fetch all system data in a single atomic operation including registers, unexpected registers, and insane counter
-    auto systemSnapshot = modbusCache->fetchSystemSnapshot(dynamicAddresses);
-    
     // Use the baud rate from the system snapshot
     addSystemInfo("ET112 BAUD Rate", systemSnapshot.cgBaudRate);
 
@@ -837,6 +693,527 @@ void setupPages(AsyncWebServer *server, ModbusCache *modbusCache, Config *config
     addSystemInfo("Mutex Avg Wait Time", String(modbusCache->getAverageMutexWaitTime(), 2) + " ms");
     addSystemInfo("Mutex Avg Hold Time", String(modbusCache->getAverageMutexHoldTime(), 2) + " ms");
     addSystemInfo("Mutex Max Hold Time", String(modbusCache->getMaxMutexHoldTime()) + " ms");
+}
+
+void buildConfigJson(Config *config, JsonDocument& doc) {
+    doc["hostname"] = config->getHostname();
+    doc["pi"] = config->getPollingInterval();
+    doc["clientIsRTU"] = config->getClientIsRTU();
+    
+    // RTU Settings
+    doc["mb"] = config->getModbusBaudRate();
+    doc["md"] = config->getModbusDataBits();
+    doc["mp"] = config->getModbusParity();
+    doc["ms"] = config->getModbusStopBits();
+    doc["mr"] = config->getModbusRtsPin();
+    doc["snf"] = config->getSnifferMode();
+    
+    // TCP Settings
+    doc["sip"] = config->getTargetIP();
+    doc["tp2"] = config->getTcpPort2();
+    
+    // Secondary RTU Settings
+    doc["mb2"] = config->getModbusBaudRate2();
+    doc["md2"] = config->getModbusDataBits2();
+    doc["mp2"] = config->getModbusParity2();
+    doc["ms2"] = config->getModbusStopBits2();
+    doc["rtb"] = config->getResponseBudget();
+    doc["mr2"] = config->getModbusRtsPin2();
+    
+    // TCP Server Settings
+    doc["tp3"] = config->getTcpPort3();
+    doc["tse"] = config->getTcpSocketServer();
+    doc["tp4"] = config->getTcpPort4();
+    
+    // Serial Debug Settings
+    doc["sb"] = config->getSerialBaudRate();
+    doc["sd"] = config->getSerialDataBits();
+    doc["sp"] = config->getSerialParity();
+    doc["ss"] = config->getSerialStopBits();
+    
+    // Network Settings
+    doc["useStaticIP"] = config->getUseStaticIP();
+    doc["staticIP"] = config->getStaticIP();
+    doc["staticGateway"] = config->getStaticGateway();
+    doc["staticSubnet"] = config->getStaticSubnet();
+    doc["ntp"] = config->getNtpServer();
+    doc["oo"] = config->getOuiOnline();
+    doc["sl"] = config->getSyslogTarget();
+    doc["slp"] = config->getSyslogTransport();
+    doc["slr"] = config->getSyslogRate();
+    
+    // Event Settings
+    doc["er"] = config->getEventRules();
+    doc["es"] = config->getEventSinkType();
+    doc["et"] = config->getEventSinkTarget();
+    
+    // Pass-through Settings
+    doc["gu"] = config->getGatewayUnits();
+    doc["gs"] = config->getGatewayShare();
+    doc["bs"] = config->getBulkSync();
+    doc["dp"] = config->getDemandPolling();
+    doc["pf"] = config->getPrefetch();
+}
+
+// Contents of the web UI's version.json, false if it is missing or the filesystem is busy
+bool readVersionJson(String& json) {
+    if (xSemaphoreTake(fileMutex, pdMS_TO_TICKS(10)) != pdTRUE) {
+        return false;
+    }
+    File file = LittleFS.open("/web/version.json", "r");
+    if (file) {
+        json = file.readString();
+        file.close();
+    }
+    xSemaphoreGive(fileMutex);
+    return json.length() > 0;
+}
+
+void setupPages(AsyncWebServer *server, ModbusCache *modbusCache, Config *config, AsyncWiFiManager *wm){
+    // Initialize LittleFS mutex for concurrent file access protection
+    if (fileMutex == nullptr) {
+        fileMutex = xSemaphoreCreateMutex();
+        if (fileMutex == nullptr) {
+            logErrln("Failed to create LittleFS mutex!");
+        }
+    }
+
+    server->on("/metrics", HTTP_GET, [modbusCache](AsyncWebServerRequest *request) {
+    logHeapMemory("/metrics");
+
+    String response;
+
+    // ESP specific metrics
+    uint64_t uptime = TimeService::millis64() / 1000;
+    response += String("esp_uptime_seconds ") + String(uptime) + "\n";
+    response += String("time_synced ") + String(timeService.isSynced() ? 1 : 0) + "\n";
+    response += String("time_sync_count ") + String(timeService.getSyncCount()) + "\n";
+    response += String("time_last_step_us ") + String(timeService.getLastStepUs()) + "\n";
+    if (timeService.isSynced()) {
+        response += String("time_unix_ms ") + String(timeService.unixMs()) + "\n";
+    }
+
+    // Log endpoint metrics
+    response += String("log_queries ") + String(logQueries.load()) + "\n";
+    response += String("log_query_bytes ") + String(logQueryBytes.load()) + "\n";
+    response += String("log_query_scanned_bytes ") + String(logQueryScanned.load()) + "\n";
+    response += String("log_query_last_us ") + String(logQueryLastUs.load()) + "\n";
+    response += String("log_query_max_us ") + String(logQueryMaxUs.load()) + "\n";
+    response += String("log_downloads ") + String(logDownloads.load()) + "\n";
+    response += String("log_download_raw_bytes ") + String(logDownloadRawBytes.load()) + "\n";
+    response += String("log_download_bytes ") + String(logDownloadBytes.load()) + "\n";
+    response += String("log_download_last_ms ") + String(logDownloadLastMs.load()) + "\n";
+    uint64_t logRetained = debugBuffer.getRetainedBytes();
+    response += String("log_ring_retained_bytes ") + String(logRetained) + "\n";
+    response += String("log_ring_stored_bytes ") + String(debugBuffer.getStoredBytes()) + "\n";
+    response += String("log_ring_history_multiplier ") + String(static_cast<float>(logRetained) / DEBUG_BUFFER_SIZE, 2) + "\n";
+    response += String("log_ring_blocks_sealed ") + String(debugBuffer.getSealedBlocks()) + "\n";
+    response += String("log_ring_compress_us_total ") + String(debugBuffer.getCompressUs()) + "\n";
+    response += String("log_ring_compress_max_us ") + String(debugBuffer.getCompressMaxUs()) + "\n";
+    response += String("oui_table_entries ") + String(ouiLookup.getTableEntries()) + "\n";
+    response += String("oui_lookups ") + String(ouiLookup.getLookups()) + "\n";
+    response += String("oui_table_hits ") + String(ouiLookup.getTableHits()) + "\n";
+    response += String("oui_online_hits ") + String(ouiLookup.getOnlineHits()) + "\n";
+    response += String("oui_misses ") + String(ouiLookup.getMisses()) + "\n";
+    response += String("oui_online_requests ") + String(ouiLookup.getOnlineRequests()) + "\n";
+    response += String("oui_online_failures ") + String(ouiLookup.getOnlineFailures()) + "\n";
+    response += String("oui_lookup_last_us ") + String(ouiLookup.getLastLookupUs()) + "\n";
+    response += String("oui_lookup_max_us ") + String(ouiLookup.getMaxLookupUs()) + "\n";
+    response += String("syslog_enabled ") + String(logShipper.isEnabled() ? 1 : 0) + "\n";
+    response += String("syslog_records_sent ") + String(logShipper.getRecordsSent()) + "\n";
+    response += String("syslog_batches_sent ") + String(logShipper.getBatchesSent()) + "\n";
+    response += String("syslog_bytes_sent ") + String(logShipper.getBytesSent()) + "\n";
+    response += String("syslog_records_dropped ") + String(logShipper.getRecordsDropped()) + "\n";
+    response += String("syslog_bytes_overwritten ") + String(logShipper.getBytesOverwritten()) + "\n";
+    response += String("syslog_send_failures ") + String(logShipper.getSendFailures()) + "\n";
+    response += String("syslog_throttled ") + String(logShipper.getThrottled()) + "\n";
+    response += String("syslog_backlog_bytes ") + String(logShipper.getBacklogBytes()) + "\n";
+    response += String("esp_rssi ") + String(WiFi.RSSI()) + "\n";
+    response += String("wifi_boot_time_to_ip_ms ") + String(wifiGetBootTimeToIP()) + "\n";
+    response += String("wifi_last_time_to_ip_ms ") + String(wifiGetLastTimeToIP()) + "\n";
+    response += String("wifi_fast_connect_attempts ") + String(wifiGetFastConnectAttempts()) + "\n";
+    response += String("wifi_fast_connect_successes ") + String(wifiGetFastConnectSuccesses()) + "\n";
+    response += String("wifi_roam_scans ") + String(wifiGetRoamScans()) + "\n";
+    response += String("wifi_roams ") + String(wifiGetRoamCount()) + "\n";
+    response += String("wifi_last_roam_interruption_ms ") + String(wifiGetLastRoamInterruption()) + "\n";
+    response += String("wifi_max_roam_interruption_ms ") + String(wifiGetMaxRoamInterruption()) + "\n";
+    response += String("esp_heap_free_bytes ") + String(ESP.getFreeHeap()) + "\n";
+    response += String("batch_requests ") + String(batchRequests.load()) + "\n";
+    response += String("batch_parts ") + String(batchParts.load()) + "\n";
+    response += String("batch_bytes ") + String(batchBytes.load()) + "\n";
+    response += String("batch_last_duration_ms ") + String(batchLastMs.load()) + "\n";
+    if (batchMinFreeHeap.load() != UINT32_MAX) {
+      response += String("batch_min_free_heap_bytes ") + String(batchMinFreeHeap.load()) + "\n";
+    }
+
+
+    // Modbus metrics
+    ModbusClientRTU* rtu = modbusCache->getModbusRTUClient();
+    response += String("modbus_primary_rtu_messages ") + String(rtu->getMessageCount()) + "\n";
+    response += String("modbus_primary_rtu_pending_messages ") + String(rtu->pendingRequests()) + "\n";
+    response += String("modbus_primary_rtu_errors ") + String(rtu->getErrorCount()) + "\n";
+
+    ModbusClientTCPasync* modbusTCPClient = modbusCache->getModbusTCPClient();
+    response += String("modbus_secondary_tcp_messages ") + String(modbusTCPClient->getMessageCount()) + "\n";
+    response += String("modbus_secondary_tcp_errors ") + String(modbusTCPClient->getErrorCount()) + "\n";
+
+    ModbusServerRTU& modbusRTUServer = modbusCache->getModbusRTUServer();
+    response += String("modbus_server_messages ") + String(modbusRTUServer.getMessageCount()) + "\n";
+    response += String("modbus_server_errors ") + String(modbusRTUServer.getErrorCount()) + "\n";
+
+    RtuOverTcpServer& rtuTcpServer = modbusCache->getRtuOverTcpServer();
+    response += String("modbus_rtu_tcp_clients ") + String(rtuTcpServer.getClients()) + "\n";
+    response += String("modbus_rtu_tcp_frames ") + String(rtuTcpServer.getFrames()) + "\n";
+    response += String("modbus_rtu_tcp_crc_errors ") + String(rtuTcpServer.getCrcErrors()) + "\n";
+    response += String("modbus_rtu_tcp_discarded_bytes ") + String(rtuTcpServer.getDiscardedBytes()) + "\n";
+
+    ModbusSocketServer& socketServer = modbusCache->getSocketServer();
+    response += String("modbus_socket_listening ") + String(socketServer.isListening() ? 1 : 0) + "\n";
+    response += String("modbus_socket_clients ") + String(socketServer.getClients()) + "\n";
+    response += String("modbus_socket_accepted ") + String(socketServer.getAccepted()) + "\n";
+    response += String("modbus_socket_rejected ") + String(socketServer.getRejected()) + "\n";
+    response += String("modbus_socket_requests ") + String(socketServer.getRequests()) + "\n";
+    response += String("modbus_socket_pipelined ") + String(socketServer.getPipelined()) + "\n";
+    response += String("modbus_socket_max_pipeline_depth ") + String(socketServer.getMaxPipelineDepth()) + "\n";
+    response += String("modbus_socket_protocol_errors ") + String(socketServer.getProtocolErrors()) + "\n";
+    response += String("modbus_socket_idle_closed ") + String(socketServer.getIdleClosed()) + "\n";
+    response += String("modbus_socket_deferred ") + String(socketServer.getDeferred()) + "\n";
+    response += String("modbus_static_registers_fetched ") + String(modbusCache->getStaticRegistersFetched() ? 1 : 0) + "\n";
+    response += String("modbus_dynamic_registers_fetched ") + String(modbusCache->getDynamicRegistersFetched() ? 1 : 0) + "\n";
+    response += String("modbus_operational ") + String(modbusCache->getIsOperational() ? 1 : 0) + "\n";
+    response += String("modbus_bogus_register_count ") + String(modbusCache->getInsaneCounter()) + "\n";
+    response += String("min_latency_ms ") + String(modbusCache->getMinLatency()) + "\n";
+    response += String("max_latency_ms ") + String(modbusCache->getMaxLatency()) + "\n";
+    response += String("average_latency_ms ") + String(modbusCache->getAverageLatency()) + "\n";
+    response += String("std_deviation_latency_ms ") + String(modbusCache->getStdDeviation()) + "\n";
+    response += String("modbus_initial_sync_ms ") + String(modbusCache->getInitialSyncTime()) + "\n";
+
+    // Cache image metrics
+    response += String("cache_generation ") + String(modbusCache->getCacheGeneration()) + "\n";
+    response += String("cache_bulk_sync_active ") + String(modbusCache->isBulkSyncActive() ? 1 : 0) + "\n";
+    response += String("cache_bulk_sync_requests ") + String(modbusCache->getBulkSyncRequests()) + "\n";
+    response += String("cache_bulk_sync_not_modified ") + String(modbusCache->getBulkSyncNotModified()) + "\n";
+    response += String("cache_bulk_sync_errors ") + String(modbusCache->getBulkSyncErrors()) + "\n";
+
+    // RTU client baud rate and switch metrics
+    response += String("rtu_client_baud ") + String(modbusCache->getClientBaudRate()) + "\n";
+    response += String("baud_switch_state ") + String(static_cast<int>(modbusCache->getBaudSwitchState())) + "\n";
+    response += String("baud_switch_attempts ") + String(modbusCache->getBaudSwitchAttempts()) + "\n";
+    response += String("baud_switch_successes ") + String(modbusCache->getBaudSwitchSuccesses()) + "\n";
+    response += String("baud_switch_rollbacks ") + String(modbusCache->getBaudSwitchRollbacks()) + "\n";
+    response += String("baud_switch_last_gap_ms ") + String(modbusCache->getLastBaudSwitchGapMs()) + "\n";
+    response += String("baud_probe_corrections ") + String(modbusCache->getBaudProbeCorrections()) + "\n";
+
+    // Listen-only RTU client metrics
+    const RtuSniffer& sniffer = modbusCache->getSniffer();
+    response += String("sniffer_active ") + String(modbusCache->isSnifferActive() ? 1 : 0) + "\n";
+    response += String("sniffer_frames ") + String(sniffer.getFrames()) + "\n";
+    response += String("sniffer_transactions ") + String(sniffer.getTransactions()) + "\n";
+    response += String("sniffer_commits ") + String(modbusCache->getSnifferCommits()) + "\n";
+    response += String("sniffer_exceptions ") + String(sniffer.getExceptions()) + "\n";
+    response += String("sniffer_unanswered ") + String(sniffer.getUnanswered()) + "\n";
+    response += String("sniffer_orphan_responses ") + String(sniffer.getOrphanResponses()) + "\n";
+    response += String("sniffer_crc_errors ") + String(sniffer.getCrcErrors()) + "\n";
+    response += String("sniffer_discarded_bytes ") + String(sniffer.getDiscardedBytes()) + "\n";
+
+    // Frame buffer pool metrics
+    response += String("pdu_pool_buffers ") + String(PDU_POOL_BUFFERS) + "\n";
+    response += String("pdu_pool_in_use ") + String(pduPool.getInUse()) + "\n";
+    response += String("pdu_pool_max_in_use ") + String(pduPool.getMaxInUse()) + "\n";
+    response += String("pdu_pool_acquired ") + String(pduPool.getAcquired()) + "\n";
+    response += String("pdu_pool_exhausted ") + String(pduPool.getExhausted()) + "\n";
+
+    // Demand-driven polling metrics
+    response += String("demand_polling_enabled ") + String(modbusCache->getDemandPolling() ? 1 : 0) + "\n";
+    response += String("demand_registers ") + String(modbusCache->getDemandRegisterCount()) + "\n";
+    response += String("demand_ranges_added ") + String(modbusCache->getDemandRangesAdded()) + "\n";
+    response += String("demand_uncovered_reads ") + String(modbusCache->getDemandUncoveredReads()) + "\n";
+    response += String("demand_rejected ") + String(modbusCache->getDemandRejected()) + "\n";
+    for (const auto& range : modbusCache->getRangeDemand()) {
+        String label = String("{range=\"") + String(range.startAddress) + "+" + String(range.regCount) + "\"} ";
+        response += String("cache_range_poll_interval_ms") + label + String(range.pollIntervalMs) + "\n";
+        response += String("cache_range_read_interval_ms") + label + String(range.readIntervalMs) + "\n";
+        response += String("cache_range_reads") + label + String(range.reads) + "\n";
+        response += String("cache_range_cold") + label + String(range.cold ? 1 : 0) + "\n";
+        response += String("cache_range_retired") + label + String(range.retired ? 1 : 0) + "\n";
+        response += String("cache_range_phase_locked") + label + String(range.phaseLocked ? 1 : 0) + "\n";
+        response += String("cache_range_client_period_ms") + label + String(range.clientPeriodMs) + "\n";
+        response += String("cache_range_phase_jitter_ms") + label + String(range.phaseJitterMs) + "\n";
+        response += String("cache_range_round_trip_ms") + label + String(range.roundTripMs) + "\n";
+    }
+
+    // Phase-aligned prefetch and served-data age
+    response += String("prefetch_enabled ") + String(modbusCache->getPrefetch() ? 1 : 0) + "\n";
+    response += String("prefetch_polls ") + String(modbusCache->getPrefetchPolls()) + "\n";
+    ServedAgeSnapshot servedAge = modbusCache->getServedAge();
+    uint32_t servedAgeCumulative = 0;
+    for (uint8_t i = 0; i < SERVED_AGE_BUCKETS; i++) {
+        servedAgeCumulative += servedAge.buckets[i];
+        response += String("served_data_age_ms_bucket{le=\"") + String(ModbusCache::SERVED_AGE_BUCKET_MS[i]) + "\"} " +
+                    String(servedAgeCumulative) + "\n";
+    }
+    response += String("served_data_age_ms_bucket{le=\"+Inf\"} ") + String(servedAge.count) + "\n";
+    response += String("served_data_age_ms_sum ") + String(servedAge.sumMs) + "\n";
+    response += String("served_data_age_ms_count ") + String(servedAge.count) + "\n";
+    response += String("served_data_age_max_ms ") + String(servedAge.maxMs) + "\n";
+
+    // Threshold event metrics
+    response += String("event_rules ") + String(eventEngine.getRuleCount()) + "\n";
+    response += String("event_raised ") + String(eventEngine.getEventsRaised()) + "\n";
+    response += String("event_cleared ") + String(eventEngine.getEventsCleared()) + "\n";
+    response += String("event_delivered ") + String(eventEngine.getEventsDelivered()) + "\n";
+    response += String("event_dropped ") + String(eventEngine.getEventsDropped()) + "\n";
+    response += String("event_delivery_errors ") + String(eventEngine.getDeliveryFailures()) + "\n";
+    response += String("event_queue_depth ") + String(eventEngine.getQueueDepth()) + "\n";
+    response += String("event_last_notify_latency_ms ") + String(eventEngine.getLastNotifyLatency()) + "\n";
+    response += String("event_max_notify_latency_ms ") + String(eventEngine.getMaxNotifyLatency()) + "\n";
+    response += String("event_average_notify_latency_ms ") + String(eventEngine.getAverageNotifyLatency()) + "\n";
+
+    // RTU pass-through metrics
+    response += String("gateway_requests ") + String(rtuGateway.getRequests()) + "\n";
+    response += String("gateway_errors ") + String(rtuGateway.getErrors()) + "\n";
+    response += String("gateway_rejected ") + String(rtuGateway.getRejected()) + "\n";
+    response += String("gateway_timeouts ") + String(rtuGateway.getTimeouts()) + "\n";
+    response += String("gateway_queue_depth ") + String(rtuGateway.getQueueDepth()) + "\n";
+    response += String("gateway_average_queue_ms ") + String(rtuGateway.getAverageQueueTime()) + "\n";
+    response += String("gateway_max_queue_ms ") + String(rtuGateway.getMaxQueueTime()) + "\n";
+    response += String("gateway_average_latency_ms ") + String(rtuGateway.getAverageLatency()) + "\n";
+    response += String("gateway_max_latency_ms ") + String(rtuGateway.getMaxLatency()) + "\n";
+    response += String("gateway_bus_time_ms ") + String(rtuGateway.getBusTime()) + "\n";
+    response += String("gateway_bus_share_limit_percent ") + String(rtuGateway.getSharePercent()) + "\n";
+
+    // Request-to-response turnaround of each downstream server
+    response += "# HELP server_turnaround_us Worker run time plus the nominal T3.5 silence on RTU servers; "
+                "an estimate, frame end and transmit start are not timestamped\n";
+    for (uint8_t kind = 0; kind < static_cast<uint8_t>(ServerKind::COUNT); kind++) {
+      TurnaroundSnapshot turnaround = turnaroundStats.getSnapshot(static_cast<ServerKind>(kind));
+      String server = TurnaroundStats::kindName(static_cast<ServerKind>(kind));
+      String label = String("{server=\"") + server + "\"} ";
+      response += String("server_requests_answered") + label + String(turnaround.answered) + "\n";
+      response += String("server_requests_late") + label + String(turnaround.late) + "\n";
+      response += String("server_requests_dropped") + label + String(turnaround.dropped) + "\n";
+      response += String("server_turnaround_max_us") + label + String(turnaround.maxUs) + "\n";
+      uint32_t cumulative = 0;
+      for (uint8_t i = 0; i < TURNAROUND_BUCKETS; i++) {
+        cumulative += turnaround.buckets[i];
+        response += String("server_turnaround_us_bucket{server=\"") + server + "\",le=\"" +
+                    String(TurnaroundStats::BUCKET_US[i]) + "\"} " + String(cumulative) + "\n";
+      }
+      response += String("server_turnaround_us_bucket{server=\"") + server + "\",le=\"+Inf\"} " + String(turnaround.answered) + "\n";
+      response += String("server_turnaround_us_sum") + label + String(turnaround.sumUs) + "\n";
+      response += String("server_turnaround_us_count") + label + String(turnaround.answered) + "\n";
+    }
+    response += String("server_response_budget_us ") + String(turnaroundStats.getBudgetUs()) + "\n";
+    // RS485 bus utilisation of the upstream RTU client
+    BusStatsSnapshot bus = busStats.getSnapshot();
+    if (bus.enabled) {
+      response += String("bus_char_time_us ") + String(bus.charTimeUs) + "\n";
+      response += String("bus_transactions ") + String(bus.transactions) + "\n";
+      response += String("bus_timeouts ") + String(bus.timeouts) + "\n";
+      response += String("bus_airtime_us_total ") + String(bus.airtimeUs) + "\n";
+      response += String("bus_busy_us_total ") + String(bus.busyUs) + "\n";
+      response += String("bus_turnaround_us_total ") + String(bus.turnaroundUs) + "\n";
+      response += String("bus_turnaround_max_us ") + String(bus.maxTurnaroundUs) + "\n";
+      response += String("bus_busy_percent ") + String(bus.busyPercent) + "\n";
+      response += String("bus_airtime_percent ") + String(bus.airtimePercent) + "\n";
+      response += String("bus_headroom_percent ") + String(bus.headroomPercent) + "\n";
+      response += String("bus_headroom_registers_per_second ") + String(bus.headroomRegistersPerSecond) + "\n";
+      response += String("bus_headroom_slaves ") + String(bus.headroomSlaves) + "\n";
+      uint32_t cumulative = 0;
+      for (uint8_t i = 0; i < BUS_STATS_GAP_BUCKETS; i++) {
+        cumulative += bus.gapBuckets[i];
+        response += String("bus_idle_gap_ms_bucket{le=\"") + String(BusStats::GAP_BUCKET_MS[i]) + "\"} " + String(cumulative) + "\n";
+      }
+      response += String("bus_idle_gap_ms_bucket{le=\"+Inf\"} ") + String(bus.gapCount) + "\n";
+      response += String("bus_idle_gap_ms_sum ") + String(bus.gapSumUs / 1000.0, 3) + "\n";
+      response += String("bus_idle_gap_ms_count ") + String(bus.gapCount) + "\n";
+      for (const auto& range : bus.ranges) {
+        String label = range.startAddress == BUS_STATS_GATEWAY_RANGE
+            ? String("{range=\"gateway\"} ")
+            : String("{range=\"") + String(range.startAddress) + "+" + String(range.regCount) + "\"} ";
+        response += String("bus_range_transactions") + label + String(range.transactions) + "\n";
+        response += String("bus_range_airtime_us_total") + label + String(range.airtimeUs) + "\n";
+        response += String("bus_range_busy_us_total") + label + String(range.busyUs) + "\n";
+      }
+    }
+
+    // Task and queue metrics, refreshed by the task monitor every few seconds
+    for (uint8_t core = 0; core < TASK_MONITOR_CORES; core++) {
+      float idle = taskMonitor.getIdlePercent(core);
+      if (idle >= 0.0f) {
+        response += String("esp_core_idle_percent{core=\"") + String(core) + "\"} " + String(idle) + "\n";
+      }
+    }
+    for (const auto& task : taskMonitor.getTasks()) {
+      String label = String("{task=\"") + task.name + "\"} ";
+      if (task.cpuPercent >= 0.0f) {
+        response += String("esp_task_cpu_percent") + label + String(task.cpuPercent) + "\n";
+        response += String("esp_task_cpu_peak_percent") + label + String(task.peakCpuPercent) + "\n";
+      }
+      response += String("esp_task_stack_free_min_bytes") + label + String(task.stackHighWater) + "\n";
+    }
+    for (const auto& queue : taskMonitor.getQueues()) {
+      String label = String("{queue=\"") + queue.name + "\"} ";
+      response += String("queue_depth") + label + String(queue.depth) + "\n";
+      response += String("queue_depth_peak") + label + String(queue.peak) + "\n";
+    }
+
+    // Add dynamic registers
+    for (auto& address : modbusCache->getDynamicRegisterAddresses()) {
+        String formattedValue = modbusCache->getFormattedRegisterValue(address);
+        auto regDef = modbusCache->getRegisterDefinition(address);
+        if (regDef.has_value()) {
+            String metricName = regDef->description;
+            metricName.replace("(", ""); // Remove parentheses
+            metricName.replace(")", ""); // Remove parentheses
+            metricName.replace("-", ""); // Remove hyphens
+            metricName.replace("+", ""); // Remove plus signs
+            metricName.trim();
+            metricName.replace(" ", "_"); // Replace spaces with underscores for Prometheus compliance
+            metricName.toLowerCase();
+
+            // Remove units from values
+            formattedValue.replace(" V", "");
+            formattedValue.replace(" A", "");
+
+            formattedValue.replace(" W", "");
+            formattedValue.replace(" VA", "");
+            formattedValue.replace(" var", "");
+            formattedValue.replace(" kWh", "");
+            formattedValue.replace(" kVARh", "");
+            formattedValue.replace(" Hz", "");
+            formattedValue.replace("A", "");
+
+            response += metricName + " " + formattedValue + "\n";
+        }
+    }
+
+    // Send the response to Prometheus
+    request->send(200, "text/plain", response);
+  });
+
+  // Whole-cache snapshot for secondary proxies, see CACHE_IMAGE_* in ModbusCache.h
+  server->on("/cache.bin", HTTP_GET, [modbusCache](AsyncWebServerRequest *request) {
+    auto image = std::make_shared<std::vector<uint8_t>>();
+    uint32_t generation;
+    bool operational;
+    if (!modbusCache->buildCacheImage(*image, generation, operational)) {
+      request->send(503, "text/plain", "Cache busy");
+      return;
+    }
+
+    String etag = "\"" + String(generation) + (operational ? "" : "-stale") + "\"";
+    if (request->hasHeader("If-None-Match") && request->getHeader("If-None-Match")->value() == etag) {
+      auto *response = request->beginResponse(304);
+      response->addHeader("ETag", etag);
+      request->send(response);
+      return;
+    }
+
+    auto *response = request->beginResponse("application/octet-stream", image->size(),
+      [image](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+        size_t len = min(maxLen, image->size() - index);
+        memcpy(buffer, image->data() + index, len);
+        return len;
+      });
+    response->addHeader("ETag", etag);
+    response->addHeader("Cache-Control", "no-cache");
+    request->send(response);
+  });
+
+
+  server->on("/debug/tasks", HTTP_GET, [](AsyncWebServerRequest *request) {
+    logHeapMemory("/debug/tasks");
+    DynamicJsonDocument doc(8192);
+    doc["runtimeStats"] = taskMonitor.hasRuntimeStats();
+    doc["intervalMs"] = TASK_MONITOR_INTERVAL_MS;
+    doc["samples"] = taskMonitor.getSamples();
+
+    JsonArray cores = doc.createNestedArray("cores");
+    for (uint8_t core = 0; core < TASK_MONITOR_CORES; core++) {
+      JsonObject entry = cores.createNestedObject();
+      entry["core"] = core;
+      entry["idle"] = taskMonitor.getIdlePercent(core);
+      JsonArray history = entry.createNestedArray("idleHistory");
+      for (float idle : taskMonitor.getIdleHistory(core)) {
+        history.add(idle);
+      }
+    }
+
+    JsonArray tasks = doc.createNestedArray("tasks");
+    for (const auto& task : taskMonitor.getTasks()) {
+      JsonObject entry = tasks.createNestedObject();
+      entry["name"] = task.name;
+      entry["core"] = task.core;
+      entry["priority"] = task.priority;
+      entry["stackFree"] = task.stackHighWater;
+      entry["cpu"] = task.cpuPercent;
+      entry["cpuPeak"] = task.peakCpuPercent;
+    }
+
+    JsonArray queues = doc.createNestedArray("queues");
+    for (const auto& queue : taskMonitor.getQueues()) {
+      JsonObject entry = queues.createNestedObject();
+      entry["name"] = queue.name;
+      entry["depth"] = queue.depth;
+      entry["peak"] = queue.peak;
+    }
+
+    String json;
+    serializeJson(doc, json);
+    request->send(200, "application/json", json);
+  });
+
+  // BSSID vendor from the on-flash OUI table. Misses may be queued for an
+  // online lookup on the OUI worker task, the request itself never waits on it.
+  server->on("/lookup", HTTP_GET, [](AsyncWebServerRequest *request) {
+    logHeapMemory("/lookup");
+      if (!request->hasParam("bssid")) {
+          request->send(400, "application/json", "{\"error\":\"Missing BSSID parameter\"}");
+          return;
+      }
+
+      String bssid = request->getParam("bssid")->value();
+      uint32_t oui;
+      if (!OuiLookup::parseOui(bssid, oui)) {
+          request->send(400, "application/json", "{\"error\":\"Invalid BSSID\"}");
+          return;
+      }
+
+      String vendor;
+      OuiSource source = ouiLookup.lookup(bssid, oui, vendor);
+      char prefix[7];
+      snprintf(prefix, sizeof(prefix), "%06X", static_cast<unsigned>(oui));
+
+      // Same fields as the maclookup.app response this endpoint used to relay
+      DynamicJsonDocument doc(256);
+      doc["success"] = true;
+      doc["found"] = source == OuiSource::TABLE || source == OuiSource::ONLINE;
+      doc["macPrefix"] = prefix;
+      doc["company"] = vendor;
+      doc["source"] = OuiLookup::sourceName(source);
+      String json;
+      serializeJson(doc, json);
+      request->send(200, "application/json", json);
+  });
+
+  // Legacy home route removed - now handled by Preact SPA
+
+  // Endpoint to serve JSON data
+  server->on("/status.json", HTTP_GET, [modbusCache](AsyncWebServerRequest *request) {
+    logHeapMemory("/status.json");
+    
+    // Yield to prevent watchdog timeout
+    yield();
+    
+    // Check if we can accept more connections
+    if (!canAcceptConnection()) {
+      request->send(503, "application/json", "{\"error\":\"Server busy\"}");
+      return;
+    }
+    
+    DynamicJsonDocument doc(4096);
+    buildStatusJson(modbusCache, fetchStatusSnapshot(modbusCache), doc);
 
     // Yield again before serializing JSON
     yield();
@@ -858,11 +1235,20 @@ void setupPages(AsyncWebServer *server, ModbusCache *modbusCache, Config *config
     response->print("<p class=\"w\" style=\"color: red; font-weight: bold;\">"
                     "WARNING: Changing the baud rate from 9.6 kbps can make it impossible to directly address the ET112 from a CerboGX. "
                     "The CerboGX requires 9.6 kbps for direct Modbus RTU communication.<br>However, if you are using the ESP32 caching proxy, 38.4 kbps is recommended. "
-                    "<br />Please proceed at your own risk.<br /> You will need to manually change the RTU Client bps rate in the \"Config\" section "
-                    "after making this change.</p>");
+                    "<br />Please proceed at your own risk.<br /> The RTU Client bps rate follows the meter automatically; if the meter "
+                    "does not answer at the new rate within a few seconds both sides return to the old rate.</p>");
 
     sendResponseHeader(response, "Set Baud Rate", true, hostname);
 
+    response->print("<p class=\"e\">RTU Client rate: " + String(modbusCache->getClientBaudRate()) + " bps");
+    if (modbusCache->getBaudSwitchState() != BaudSwitchState::IDLE) {
+      response->print(" (switch in progress, reload to check)");
+    } else if (modbusCache->getBaudSwitchAttempts() > 0) {
+      response->print(" (" + String(modbusCache->getBaudSwitchSuccesses()) + " switched, " +
+                      String(modbusCache->getBaudSwitchRollbacks()) + " rolled back, last pause " +
+                      String(modbusCache->getLastBaudSwitchGapMs()) + " ms)");
+    }
+    response->print("</p>");
     response->print("<p class=\"e\">Select a new baud rate:</p>");
     response->print("<form method=\"post\">"
                     "<label><input type=\"radio\" name=\"baudrate\" value=\"1\"> 9.6 kbps</label><br>"
@@ -897,9 +1283,12 @@ void setupPages(AsyncWebServer *server, ModbusCache *modbusCache, Config *config
         return;
     }
 
-    // Set the baud rate using the ModbusCache function
-    modbusCache->setCGBaudRate(baudRateValue);
-    dbgln("[webserver] Baud rate set to " + String(baudRateValue));
+    // The switch runs on the cache's baud task, the GET page shows how it went
+    if (!modbusCache->setCGBaudRate(baudRateValue)) {
+        request->send(409, "text/plain", "Baud rate switch not possible now, see the log");
+        return;
+    }
+    dbgln("[webserver] Baud rate switch to " + String(baudRateValue) + " requested");
 
     // Redirect back to the GET page
     request->redirect("/baudrate");
@@ -923,43 +1312,7 @@ void setupPages(AsyncWebServer *server, ModbusCache *modbusCache, Config *config
     }
     
     DynamicJsonDocument doc(2048);
-    
-    doc["hostname"] = config->getHostname();
-    doc["pi"] = config->getPollingInterval();
-    doc["clientIsRTU"] = config->getClientIsRTU();
-    
-    // RTU Settings
-    doc["mb"] = config->getModbusBaudRate();
-    doc["md"] = config->getModbusDataBits();
-    doc["mp"] = config->getModbusParity();
-    doc["ms"] = config->getModbusStopBits();
-    doc["mr"] = config->getModbusRtsPin();
-    
-    // TCP Settings
-    doc["sip"] = config->getTargetIP();
-    doc["tp2"] = config->getTcpPort2();
-    
-    // Secondary RTU Settings
-    doc["mb2"] = config->getModbusBaudRate2();
-    doc["md2"] = config->getModbusDataBits2();
-    doc["mp2"] = config->getModbusParity2();
-    doc["ms2"] = config->getModbusStopBits2();
-    doc["mr2"] = config->getModbusRtsPin2();
-    
-    // TCP Server Settings
-    doc["tp3"] = config->getTcpPort3();
-    
-    // Serial Debug Settings
-    doc["sb"] = config->getSerialBaudRate();
-    doc["sd"] = config->getSerialDataBits();
-    doc["sp"] = config->getSerialParity();
-    doc["ss"] = config->getSerialStopBits();
-    
-    // Network Settings
-    doc["useStaticIP"] = config->getUseStaticIP();
-    doc["staticIP"] = config->getStaticIP();
-    doc["staticGateway"] = config->getStaticGateway();
-    doc["staticSubnet"] = config->getStaticSubnet();
+    buildConfigJson(config, doc);
     
     String jsonResponse;
     serializeJson(doc, jsonResponse);
@@ -968,8 +1321,115 @@ void setupPages(AsyncWebServer *server, ModbusCache *modbusCache, Config *config
     // Release the connection count
     releaseConnection();
   });
+  // Several JSON resources in one response, e.g. /api/batch?parts=status,version,config
+  // returns {"status":{...},"version":{...},"config":{...}}. Parts are built one
+  // at a time as the previous one drains, so only one is held in memory, and
+  // they share one snapshot of the cache taken when the request arrives.
+  server->on("/api/batch", HTTP_GET, [modbusCache, config](AsyncWebServerRequest *request) {
+    logHeapMemory("/api/batch");
+
+    std::vector<String> parts;
+    String list = request->hasParam("parts") ? request->getParam("parts")->value() : "";
+    int start = 0;
+    while (start < (int)list.length()) {
+      int end = list.indexOf(',', start);
+      if (end < 0) end = list.length();
+      String part = list.substring(start, end);
+      part.trim();
+      start = end + 1;
+      bool known = false;
+      for (const char* name : batchPartNames) {
+        known = known || part == name;
+      }
+      if (!known) {
+        request->send(400, "application/json", "{\"error\":\"Unknown part\"}");
+        return;
+      }
+      if (std::find(parts.begin(), parts.end(), part) == parts.end()) {
+        parts.push_back(part);
+      }
+    }
+    if (parts.empty()) {
+      request->send(400, "application/json", "{\"error\":\"No parts requested\"}");
+      return;
+    }
+
+    if (!canAcceptConnection()) {
+      request->send(503, "application/json", "{\"error\":\"Server busy\"}");
+      return;
+    }
+
+    struct BatchResponse {
+      std::vector<String> parts;
+      size_t next = 0;                  // Next part to build
+      String pending;                   // Serialized text not yet handed to the connection
+      size_t sent = 0;                  // Bytes of pending already handed over
+      bool closed = false;              // Closing brace is in pending
+      size_t bytes = 0;
+      std::optional<ModbusCache::SystemSnapshot> snapshot;
+      uint64_t startUs = 0;
+      ~BatchResponse() {
+        batchBytes += bytes;
+        batchLastMs = (TimeService::micros64() - startUs) / 1000;
+        releaseConnection();
+      }
+    };
+    auto batch = std::make_shared<BatchResponse>();
+    batch->startUs = TimeService::micros64();
+    batch->parts = std::move(parts);
+    if (std::find(batch->parts.begin(), batch->parts.end(), "status") != batch->parts.end()) {
+      batch->snapshot = fetchStatusSnapshot(modbusCache);
+    }
+    batchRequests++;
+    batchParts += batch->parts.size();
+
+    AsyncWebServerResponse *response = request->beginChunkedResponse("application/json",
+      [batch, modbusCache, config](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+        size_t written = 0;
+        while (written < maxLen) {
+          if (batch->sent == batch->pending.length()) {
+            if (batch->closed) {
+              break;
+            }
+            batch->pending = batch->next == 0 ? "{" : ",";
+            batch->sent = 0;
+            if (batch->next == batch->parts.size()) {
+              batch->pending = batch->next == 0 ? "{}" : "}";
+              batch->closed = true;
+            } else {
+              const String& name = batch->parts[batch->next++];
+              batch->pending += "\"" + name + "\":";
+              String json;
+              if (name == "status") {
+                DynamicJsonDocument doc(4096);
+                buildStatusJson(modbusCache, *batch->snapshot, doc);
+                serializeJson(doc, json);
+              } else if (name == "config") {
+                DynamicJsonDocument doc(2048);
+                buildConfigJson(config, doc);
+                serializeJson(doc, json);
+              } else if (!readVersionJson(json)) {
+                json = "null";
+              }
+              json.trim();
+              batch->pending += json;
+              uint32_t freeHeap = ESP.getFreeHeap();
+              if (freeHeap < batchMinFreeHeap) batchMinFreeHeap = freeHeap;
+            }
+          }
+          size_t length = min(maxLen - written, batch->pending.length() - batch->sent);
+          memcpy(buffer + written, batch->pending.c_str() + batch->sent, length);
+          written += length;
+          batch->sent += length;
+        }
+        batch->bytes += written;
+        return written;
+      });
+    response->addHeader("Cache-Control", "no-store");
+    request->send(response);
+  });
   // Legacy GET /config handler removed - now handled by Preact SPA
-  server->on("/config", HTTP_POST, [config](AsyncWebServerRequest *request){
+  server->on("/config", HTTP_POST, [config, modbusCache](AsyncWebServerRequest *request){
     dbgln("[webserver] POST /config");
     bool validIP = true;
     if (request->hasParam("hostname", true)) {
@@ -1007,6 +1467,11 @@ void setupPages(AsyncWebServer *server, ModbusCache *modbusCache, Config *config
       config->setTcpPort3(port);
       dbgln("[webserver] saved port3");
     }
+    if (request->hasParam("tp4", true)){
+      auto port = request->getParam("tp4", true)->value().toInt();
+      config->setTcpPort4(port);
+      dbgln("[webserver] saved port4");
+    }
     if (request->hasParam("sip", true)){
       String targetIP = request->getParam("sip", true)->value();
         IPAddress ip;
@@ -1070,6 +1535,12 @@ void setupPages(AsyncWebServer *server, ModbusCache *modbusCache, Config *config
       config->setModbusStopBits2(stop);
       dbgln("[webserver] saved modbus stop bits 2");
     }
+    if (request->hasParam("rtb", true)){
+      auto budget = request->getParam("rtb", true)->value().toInt();
+      config->setResponseBudget(budget);
+      turnaroundStats.setBudgetMs(config->getResponseBudget());
+      dbgln("[webserver] saved response budget");
+    }
     if (request->hasParam("mr2", true)){
       auto rts = request->getParam("mr2", true)->value().toInt();
       config->setModbusRtsPin2(rts);
@@ -1151,6 +1622,64 @@ void setupPages(AsyncWebServer *server, ModbusCache *modbusCache, Config *config
             validIP = false;
         }
     }
+    if (request->hasParam("ntp", true)) {
+        String ntpServer = request->getParam("ntp", true)->value();
+        ntpServer.trim();
+        config->setNtpServer(ntpServer);
+        dbgln("[webserver] saved NTP server");
+    }
+    config->setOuiOnline(request->hasParam("oo", true));
+    ouiLookup.setOnlineRefresh(config->getOuiOnline());
+    if (request->hasParam("sl", true) || request->hasParam("slp", true) || request->hasParam("slr", true)) {
+        if (request->hasParam("sl", true)) {
+            String target = request->getParam("sl", true)->value();
+            target.trim();
+            config->setSyslogTarget(target);
+        }
+        if (request->hasParam("slp", true)) {
+            config->setSyslogTransport(request->getParam("slp", true)->value().toInt());
+        }
+        if (request->hasParam("slr", true)) {
+            config->setSyslogRate(request->getParam("slr", true)->value().toInt());
+        }
+        logShipper.configure(config->getSyslogTarget(), config->getSyslogTransport(), config->getSyslogRate());
+        dbgln("[webserver] saved syslog settings");
+    }
+    if (request->hasParam("er", true)) {
+        String rules = request->getParam("er", true)->value();
+        config->setEventRules(rules);
+        if (!eventEngine.compileRules(rules)) {
+            logErrln("[webserver] some event rules were rejected");
+        }
+        dbgln("[webserver] saved event rules");
+    }
+    if (request->hasParam("es", true) || request->hasParam("et", true)) {
+        if (request->hasParam("es", true)) {
+            config->setEventSinkType(request->getParam("es", true)->value().toInt());
+        }
+        if (request->hasParam("et", true)) {
+            config->setEventSinkTarget(request->getParam("et", true)->value());
+        }
+        eventEngine.setSink(config->getEventSinkType(), config->getEventSinkTarget());
+        dbgln("[webserver] saved event sink");
+    }
+    if (request->hasParam("gu", true)) {
+        config->setGatewayUnits(request->getParam("gu", true)->value());
+        dbgln("[webserver] saved gateway units");
+    }
+    if (request->hasParam("gs", true)) {
+        auto share = request->getParam("gs", true)->value().toInt();
+        config->setGatewayShare(constrain(share, 0, 100));
+        dbgln("[webserver] saved gateway share");
+    }
+    // Checkbox: only posted when enabled
+    config->setBulkSync(request->hasParam("bs", true));
+    config->setDemandPolling(request->hasParam("dp", true));
+    modbusCache->setDemandPolling(config->getDemandPolling());
+    config->setPrefetch(request->hasParam("pf", true));
+    modbusCache->setPrefetch(config->getPrefetch());
+    config->setTcpSocketServer(request->hasParam("tse", true)); // Takes effect after a reboot
+    config->setSnifferMode(request->hasParam("snf", true)); // Takes effect after a reboot
     
     // Return JSON response instead of redirect for Preact SPA compatibility
     if (validIP) {
@@ -1242,7 +1771,7 @@ void setupPages(AsyncWebServer *server, ModbusCache *modbusCache, Config *config
     jsonResponse += "\"function\":" + func + ",";
     jsonResponse += "\"register\":" + reg + ",";
     jsonResponse += "\"count\":" + count + ",";
-    jsonResponse += "\"timestamp\":" + String(millis()) + ",";
+    jsonResponse += "\"timestamp\":" + String(TimeService::millis64()) + ",";
     jsonResponse += "\"success\":true,";
     jsonResponse += "\"error_code\":0,";
     jsonResponse += "\"error_message\":\"\",";
@@ -1314,7 +1843,7 @@ void setupPages(AsyncWebServer *server, ModbusCache *modbusCache, Config *config
         jsonResponse += "\"function\":" + String(function) + ",";
         jsonResponse += "\"register\":" + String(regAddr) + ",";
         jsonResponse += "\"count\":" + String(regCount) + ",";
-        jsonResponse += "\"timestamp\":" + String(millis()) + ",";
+        jsonResponse += "\"timestamp\":" + String(TimeService::millis64()) + ",";
         jsonResponse += "\"client_type\":\"none\",";
         jsonResponse += "\"success\":false,";
         jsonResponse += "\"error_code\":1,";
@@ -1386,7 +1915,7 @@ void setupPages(AsyncWebServer *server, ModbusCache *modbusCache, Config *config
       jsonResponse += "\"function\":" + String(function) + ",";
       jsonResponse += "\"register\":" + String(regAddr) + ",";
       jsonResponse += "\"count\":" + String(regCount) + ",";
-      jsonResponse += "\"timestamp\":" + String(millis()) + ",";
+      jsonResponse += "\"timestamp\":" + String(TimeService::millis64()) + ",";
       jsonResponse += "\"client_type\":\"" + clientType + "\",";
       jsonResponse += "\"success\":" + String(responseReceived ? "true" : "false") + ",";
       jsonResponse += "\"error_code\":" + String(errorCode) + ",";
@@ -1404,7 +1933,7 @@ void setupPages(AsyncWebServer *server, ModbusCache *modbusCache, Config *config
       jsonResponse += "\"function\":" + String(function) + ",";
       jsonResponse += "\"register\":" + String(regAddr) + ",";
       jsonResponse += "\"count\":" + String(regCount) + ",";
-      jsonResponse += "\"timestamp\":" + String(millis()) + ",";
+      jsonResponse += "\"timestamp\":" + String(TimeService::millis64()) + ",";
       jsonResponse += "\"client_type\":\"" + clientType + "\",";
       jsonResponse += "\"success\":false,";
       jsonResponse += "\"error_code\":255,";
@@ -1421,7 +1950,7 @@ void setupPages(AsyncWebServer *server, ModbusCache *modbusCache, Config *config
       jsonResponse += "\"function\":" + String(function) + ",";
       jsonResponse += "\"register\":" + String(regAddr) + ",";
       jsonResponse += "\"count\":" + String(regCount) + ",";
-      jsonResponse += "\"timestamp\":" + String(millis()) + ",";
+      jsonResponse += "\"timestamp\":" + String(TimeService::millis64()) + ",";
       jsonResponse += "\"client_type\":\"" + clientType + "\",";
       jsonResponse += "\"success\":false,";
       jsonResponse += "\"error_code\":254,";
@@ -1792,20 +2321,37 @@ void setupPages(AsyncWebServer *server, ModbusCache *modbusCache, Config *config
   });
   // Legacy /log GET handler removed - now handled by Preact SPA
   
-  // Add log data endpoint for AJAX fallback - ultra lightweight version
+  // Add log data endpoint for AJAX fallback - ultra lightweight version.
+  // Optional filters: level=<D|I|W|E> (minimum), category=<tag>, q=<text>
   server->on("/logdata", HTTP_GET, [](AsyncWebServerRequest *request) {
     logHeapMemory("/logdata");
     // Don't even log this request to avoid recursive logging
     // dbgln("[webserver] GET /logdata");
+    uint64_t handlerStart = TimeService::micros64();
+    
+    LogFilter filter;
+    if (request->hasParam("level")) {
+        String level = request->getParam("level")->value();
+        level.toUpperCase();
+        if (level.length() > 0 && strchr(LOG_LEVEL_MARKERS, level[0]) != nullptr) {
+            filter.minLevel = level[0];
+        }
+    }
+    if (request->hasParam("category")) {
+        filter.category = request->getParam("category")->value();
+    }
+    if (request->hasParam("q")) {
+        filter.text = request->getParam("q")->value();
+    }
     
     // Send a simple response immediately
     AsyncResponseStream *response = request->beginResponseStream("text/plain");
     response->addHeader("Cache-Control", "no-store, no-cache, must-revalidate, max-age=0");
     
-    // Get position parameter if it exists
-    size_t position = 0;
+    // Get position parameter if it exists; positions are 64-bit log stream offsets
+    uint64_t position = 0;
     if (request->hasParam("position")) {
-        position = request->getParam("position")->value().toInt();
+        position = strtoull(request->getParam("position")->value().c_str(), nullptr, 10);
     }
     
     // Get chunk_size parameter if it exists
@@ -1814,7 +2360,7 @@ void setupPages(AsyncWebServer *server, ModbusCache *modbusCache, Config *config
         maxChars = request->getParam("chunk_size")->value().toInt();
         // Limit to reasonable size to prevent memory issues
         if (maxChars > 32768) {
-            maxChars = 32768; // Cap at 32KB (buffer size)
+            maxChars = 32768; // Cap at 32KB
         }
     }
     
@@ -1828,13 +2374,19 @@ void setupPages(AsyncWebServer *server, ModbusCache *modbusCache, Config *config
     // Use a critical section to minimize mutex lock time
     {
         // Manually get data from buffer with minimal processing
-        size_t newPosition = position;
+        uint64_t newPosition = position;
         
         // Get overflow flag
         hasOverflow = debugBuffer.hasOverflowed();
         
         // Get a chunk of messages with the requested size
-        messages = debugBuffer.getSafeChunk(position, maxChars, newPosition);
+        if (filter.isEmpty()) {
+            messages = debugBuffer.getSafeChunk(position, maxChars, newPosition);
+        } else {
+            size_t scanned = 0;
+            messages = debugBuffer.getFilteredChunk(position, maxChars, filter, newPosition, scanned);
+            logQueryScanned += scanned;
+        }
         
         // Update position
         position = newPosition;
@@ -1852,6 +2404,50 @@ void setupPages(AsyncWebServer *server, ModbusCache *modbusCache, Config *config
     response->print(messages);
     
     // Send response
+    logQueries++;
+    logQueryBytes += String(position).length() + 3 + messages.length();
+    uint32_t handlerUs = TimeService::micros64() - handlerStart;
+    logQueryLastUs = handlerUs;
+    if (handlerUs > logQueryMaxUs) logQueryMaxUs = handlerUs;
+    request->send(response);
+  });
+
+  // Whole ring as a gzip file, compressed while it is sent so nothing beyond
+  // the encoder state is buffered. One download at a time bounds the heap cost.
+  server->on("/log.txt.gz", HTTP_GET, [](AsyncWebServerRequest *request) {
+    if (logDownloadActive.exchange(true)) {
+      request->send(503, "text/plain", "Log download already in progress");
+      return;
+    }
+
+    struct LogDownload {
+      uint64_t cursor;
+      uint64_t end;
+      uint64_t startUs;
+      std::unique_ptr<GzipStream> gzip;
+      ~LogDownload() {
+        logDownloads++;
+        logDownloadRawBytes += gzip->getInputBytes();
+        logDownloadBytes += gzip->getOutputBytes();
+        logDownloadLastMs = (TimeService::micros64() - startUs) / 1000;
+        logDownloadActive = false;
+      }
+    };
+    auto download = std::make_shared<LogDownload>();
+    download->cursor = debugBuffer.getOldestOffset();
+    download->end = debugBuffer.getWrittenBytes();
+    download->startUs = TimeService::micros64();
+    LogDownload* state = download.get();
+    download->gzip.reset(new GzipStream([state](uint8_t* dest, size_t maxLen) {
+      return debugBuffer.readFrom(state->cursor, state->end, dest, maxLen);
+    }));
+
+    AsyncWebServerResponse *response = request->beginChunkedResponse("application/gzip",
+      [download](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+        return download->gzip->read(buffer, maxLen);
+      });
+    response->addHeader("Content-Disposition", "attachment; filename=\"log.txt.gz\"");
+    response->addHeader("Cache-Control", "no-store");
     request->send(response);
   });
   
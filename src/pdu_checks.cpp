@@ -0,0 +1,31 @@
+#include "pdu_checks.h"
+
+uint8_t checkCacheRequest(const uint8_t* request, size_t length) {
+    if (length < 2) {
+        return CACHE_REQUEST_DROP;
+    }
+    const uint8_t functionCode = request[1];
+    if (functionCode != 3 && functionCode != 4 && functionCode != 6) {
+        return 0x01; // Illegal function
+    }
+    if (length != 6) {
+        return 0x03; // Illegal data value
+    }
+    if (functionCode == 6) {
+        return CACHE_REQUEST_VALID;
+    }
+
+    const uint16_t address = (request[2] << 8) | request[3];
+    const uint16_t words = (request[4] << 8) | request[5];
+    if (words == 0 || words > MODBUS_MAX_READ_REGISTERS) {
+        return 0x03; // Illegal data value
+    }
+    if (static_cast<uint32_t>(address) + words > 0x10000) {
+        return 0x02; // Illegal data address
+    }
+    return CACHE_REQUEST_VALID;
+}
+
+bool registerPayloadComplete(const uint8_t* response, size_t length, uint16_t regCount) {
+    return length >= 3 && response[2] == regCount * 2 && length >= 3u + response[2];
+}
@@ -0,0 +1,100 @@
+#include "pdu_pool.h"
+
+// Global instance
+PduPool pduPool;
+
+PduBuffer::PduBuffer()
+    : buffer(nullptr)
+    , length(0)
+    , slot(-1)
+{}
+
+PduBuffer::PduBuffer(PduBuffer&& other) noexcept
+    : buffer(other.buffer)
+    , length(other.length)
+    , slot(other.slot)
+{
+    other.buffer = nullptr;
+    other.length = 0;
+}
+
+PduBuffer& PduBuffer::operator=(PduBuffer&& other) noexcept {
+    if (this != &other) {
+        release();
+        buffer = other.buffer;
+        length = other.length;
+        slot = other.slot;
+        other.buffer = nullptr;
+        other.length = 0;
+    }
+    return *this;
+}
+
+bool PduBuffer::add(uint8_t value) {
+    if (buffer == nullptr || length >= PDU_BUFFER_SIZE) {
+        return false;
+    }
+    buffer[length++] = value;
+    return true;
+}
+
+bool PduBuffer::add(uint16_t value) {
+    if (buffer == nullptr || length + 2 > PDU_BUFFER_SIZE) {
+        return false;
+    }
+    buffer[length++] = value >> 8;
+    buffer[length++] = value & 0xFF;
+    return true;
+}
+
+void PduBuffer::release() {
+    if (buffer == nullptr) {
+        return;
+    }
+    if (slot < 0) {
+        delete[] buffer;
+    } else {
+        pduPool.release(slot);
+    }
+    buffer = nullptr;
+    length = 0;
+}
+
+PduPool::PduPool()
+    : freeMask((1UL << PDU_POOL_BUFFERS) - 1)
+    , acquired(0)
+    , exhausted(0)
+    , maxInUse(0)
+{}
+
+PduBuffer PduPool::acquire() {
+    PduBuffer pdu;
+    acquired++;
+
+    uint32_t mask = freeMask.load();
+    while (mask != 0) {
+        int8_t slot = __builtin_ctz(mask);
+        if (freeMask.compare_exchange_weak(mask, mask & ~(1UL << slot))) {
+            pdu.buffer = storage[slot];
+            pdu.slot = slot;
+            uint8_t inUse = getInUse();
+            uint8_t peak = maxInUse.load();
+            while (inUse > peak && !maxInUse.compare_exchange_weak(peak, inUse)) {}
+            return pdu;
+        }
+        // mask was reloaded by the failed exchange, try the next free slot
+    }
+
+    exhausted++;
+    pdu.buffer = new uint8_t[PDU_BUFFER_SIZE];
+    pdu.slot = -1;
+    return pdu;
+}
+
+void PduPool::release(int8_t slot) {
+    freeMask.fetch_or(1UL << slot);
+}
+
+uint8_t PduPool::getInUse() const {
+    return PDU_POOL_BUFFERS - __builtin_popcount(freeMask.load());
+}
@@ -0,0 +1,112 @@
+#include "phase_tracker.h"
+
+#include <math.h>
+#include <algorithm>
+
+PhaseTracker::PhaseTracker()
+    : outliers(0)
+{
+    reset();
+}
+
+void PhaseTracker::reset() {
+    arrivals = 0;
+    onTime = 0;
+    wild = 0;
+    locked = false;
+    lastArrival = 0;
+    predicted = 0;
+    periodMs = 0.0f;
+    jitterMs = 0.0f;
+}
+
+// Start over from a single arrival
+void PhaseTracker::acquire(unsigned long nowMs) {
+    reset();
+    arrivals = 1;
+    lastArrival = nowMs;
+}
+
+void PhaseTracker::observe(unsigned long nowMs) {
+    if (arrivals == 0) {
+        acquire(nowMs);
+        return;
+    }
+
+    unsigned long sinceLast = nowMs - lastArrival;
+    if (sinceLast < PHASE_MIN_PERIOD_MS) {
+        return;
+    }
+
+    if (arrivals == 1) {
+        if (sinceLast > PHASE_MAX_PERIOD_MS) {
+            acquire(nowMs);
+            return;
+        }
+        periodMs = sinceLast;
+        predicted = nowMs + sinceLast;
+        lastArrival = nowMs;
+        arrivals = 2;
+        return;
+    }
+
+    float error = static_cast<long>(nowMs - predicted);
+    // Same cycle as the last arrival, e.g. a client reading the range twice
+    if (error < -periodMs / 2 && sinceLast < periodMs / 4) {
+        return;
+    }
+
+    // Skip the cycles the client did not read
+    long missed = error > 0 ? static_cast<long>((error + periodMs / 2) / periodMs) : 0;
+    if (missed > PHASE_MAX_MISSED) {
+        acquire(nowMs);
+        return;
+    }
+    error -= missed * periodMs;
+
+    // Outside the capture window: a second client, a retry, or a changed period
+    if (fabsf(error) > periodMs / 4) {
+        outliers++;
+        jitterMs += (periodMs / 4 - jitterMs) / 4;
+        onTime = 0;
+        locked = false;
+        // Regular off-phase arrivals (a second client, a halved period) outweigh
+        // the on-time ones and restart the estimate; an odd retry decays away
+        wild += 2;
+        if (wild >= 2 * PHASE_LOCK_COUNT) {
+            acquire(nowMs);
+        }
+        return;
+    }
+
+    periodMs = std::min(std::max(periodMs + error / 8, static_cast<float>(PHASE_MIN_PERIOD_MS)),
+                        static_cast<float>(PHASE_MAX_PERIOD_MS));
+    predicted += static_cast<long>(missed * periodMs + error / 2 + periodMs);
+    jitterMs += (fabsf(error) - jitterMs) / 4;
+    lastArrival = nowMs;
+    // Only a run of on-time arrivals wears the off-phase ones down, so a new
+    // period that alternates in and out of the window still restarts the estimate
+    if (wild > 0 && onTime > 0) {
+        wild--;
+    }
+    if (onTime < PHASE_LOCK_COUNT) {
+        onTime++;
+    }
+
+    float lockJitter = std::max(static_cast<float>(PHASE_LOCK_JITTER_MS), periodMs * PHASE_LOCK_JITTER_PERCENT / 100);
+    locked = onTime >= PHASE_LOCK_COUNT && jitterMs <= lockJitter;
+}
+
+bool PhaseTracker::isLocked(unsigned long nowMs) const {
+    return locked && nowMs - lastArrival < static_cast<unsigned long>(periodMs * (PHASE_MAX_MISSED + 1));
+}
+
+unsigned long PhaseTracker::nextExpected(unsigned long nowMs) const {
+    unsigned long next = predicted;
+    unsigned long period = static_cast<unsigned long>(periodMs);
+    // The client is late or skipped a cycle, the read after that keeps the phase
+    while (period > 0 && static_cast<long>(nowMs - next) > static_cast<long>(period / 2)) {
+        next += period;
+    }
+    return next;
+}
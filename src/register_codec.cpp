@@ -0,0 +1,18 @@
+#include "register_codec.h"
+
+// Indexed by RegisterType
+static const RegisterCodecOps codecTable[] = {
+    makeCodecOps<RegisterCodec<uint16_t>>(),
+    makeCodecOps<RegisterCodec<int16_t>>(),
+    makeCodecOps<RegisterCodec<uint32_t>>(),
+    makeCodecOps<RegisterCodec<int32_t>>(),
+    makeCodecOps<RegisterCodec<float>>(),
+    makeCodecOps<RegisterCodec<uint32_t, WordOrder::HIGH_FIRST>>(),
+    makeCodecOps<RegisterCodec<int32_t, WordOrder::HIGH_FIRST>>(),
+    makeCodecOps<RegisterCodec<float, WordOrder::HIGH_FIRST>>(),
+};
+
+const RegisterCodecOps& registerCodec(RegisterType type) {
+    size_t index = static_cast<size_t>(type);
+    return codecTable[index < sizeof(codecTable) / sizeof(codecTable[0]) ? index : 0];
+}
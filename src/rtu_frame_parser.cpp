@@ -0,0 +1,44 @@
+#include "rtu_frame_parser.h"
+
+int RtuFrameParser::expectedRequestLength(const uint8_t* frame, size_t len) {
+    if (len < 2) return -1;
+    switch (frame[1]) {
+        case 0x01: // Read coils
+        case 0x02: // Read discrete inputs
+        case 0x03: // Read holding registers
+        case 0x04: // Read input registers
+        case 0x05: // Write single coil
+        case 0x06: // Write single register
+        case 0x08: // Diagnostics
+            return 8;
+        case 0x07: // Read exception status
+        case 0x0B: // Get comm event counter
+        case 0x0C: // Get comm event log
+        case 0x11: // Report server ID
+            return 4;
+        case 0x0F: // Write multiple coils
+        case 0x10: // Write multiple registers
+            if (len < 7) return -1;
+            return 9 + frame[6];
+        case 0x16: // Mask write register
+            return 10;
+        case 0x17: // Read/write multiple registers
+            if (len < 11) return -1;
+            return 13 + frame[10];
+        default:
+            return 0;
+    }
+}
+
+// CRC-16/MODBUS over the frame, the last two bytes hold it low byte first.
+// Same check as RTUutils::validCRC, kept here so the parser builds without eModbus.
+bool RtuFrameParser::validCrc(const uint8_t* frame, size_t len) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i + 2 < len; i++) {
+        crc ^= frame[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 1) ? (crc >> 1) ^ 0xA001 : crc >> 1;
+        }
+    }
+    return len >= 2 && frame[len - 2] == (crc & 0xFF) && frame[len - 1] == (crc >> 8);
+}
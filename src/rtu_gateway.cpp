@@ -0,0 +1,322 @@
+#include "rtu_gateway.h"
+#include "config.h"
+#include "bus_stats.h"
+#include "time_service.h"
+#include <algorithm>
+
+// Global instance
+RtuGateway rtuGateway;
+
+RtuGateway::RtuGateway()
+    : client(nullptr)
+    , enabled(false)
+    , slotMutex(nullptr)
+    , nextSequence(0)
+    , nextToken(0)
+    , inFlightToken(0)
+    , sharePercent(0)
+    , budgetMs(0.0f)
+    , lastRefill(0)
+    , charTimeUs(0)
+    , requests(0)
+    , errors(0)
+    , rejected(0)
+    , timeouts(0)
+    , busTime(0)
+    , totalQueueTime(0)
+    , maxQueueTime(0)
+    , totalLatency(0)
+    , maxLatency(0)
+{
+    for (auto& slot : slots) {
+        slot.state = SlotState::FREE;
+        slot.token = 0;
+        slot.sequence = 0;
+        slot.enqueuedAt = 0;
+        slot.dispatchedAt = 0;
+    }
+}
+
+void RtuGateway::setBaudRate(unsigned long baudRate, uint8_t bitsPerChar) {
+    charTimeUs = baudRate > 0 ? (1000000UL * bitsPerChar) / baudRate : 0;
+}
+
+void RtuGateway::begin(ModbusClientRTU* rtuClient, const String& unitList, uint8_t share,
+                       unsigned long baudRate, uint8_t bitsPerChar) {
+    client = rtuClient;
+    sharePercent = min<uint8_t>(share, 100);
+    setBaudRate(baudRate, bitsPerChar);
+
+    // Unit list is a comma or space separated list of slave IDs; 1 is the cached ET112
+    units.clear();
+    String list = unitList;
+    list.replace(' ', ',');
+    int start = 0;
+    while (start < (int)list.length()) {
+        int sep = list.indexOf(',', start);
+        String entry = sep < 0 ? list.substring(start) : list.substring(start, sep);
+        entry.trim();
+        if (entry.length() > 0) {
+            long unit = entry.toInt();
+            if (unit < 2 || unit > 247) {
+                logErrln("[RtuGateway] Ignoring invalid unit ID: " + entry);
+            } else if (std::find(units.begin(), units.end(), unit) == units.end()) {
+                units.push_back(static_cast<uint8_t>(unit));
+            }
+        }
+        if (sep < 0) break;
+        start = sep + 1;
+    }
+
+    if (units.empty() || client == nullptr) {
+        return;
+    }
+
+    slotMutex = xSemaphoreCreateMutex();
+    if (slotMutex == nullptr) {
+        logErrln("[RtuGateway] Failed to allocate mutex, pass-through disabled");
+        return;
+    }
+
+    lastRefill = millis();
+    budgetMs = 0.0f;
+    enabled = true;
+    dbgln("[RtuGateway] Pass-through enabled for " + String(units.size()) + " unit(s), bus share " + String(sharePercent) + "%");
+}
+
+unsigned long RtuGateway::estimateTransactionMs(const ModbusMessage& request) const {
+    // Request frame is the PDU plus CRC; response size depends on the function code
+    size_t requestChars = request.size() + 2;
+    size_t responseChars = 256;
+    uint8_t functionCode = request.getFunctionCode();
+    if (request.size() >= 6) {
+        uint16_t quantity = (request[4] << 8) | request[5];
+        switch (functionCode) {
+            case 1:
+            case 2:
+                responseChars = 5 + (quantity + 7) / 8;
+                break;
+            case 3:
+            case 4:
+                responseChars = 5 + 2 * quantity;
+                break;
+            case 5:
+            case 6:
+            case 15:
+            case 16:
+                responseChars = 8;
+                break;
+            default:
+                break;
+        }
+    }
+    // Add the 3.5 character inter-frame silence after each frame
+    unsigned long airtimeUs = (requestChars + responseChars + 7) * charTimeUs;
+    return airtimeUs / 1000 + GATEWAY_TURNAROUND_MS;
+}
+
+void RtuGateway::submit(const ModbusMessage& request, DoneFn done) {
+    uint8_t serverID = request.getServerID();
+    uint8_t functionCode = request.getFunctionCode();
+    ModbusMessage response;
+
+    if (!enabled) {
+        response.setError(serverID, functionCode, GATEWAY_PATH_UNAVAIL);
+        done(response);
+        return;
+    }
+
+    // Claim a free slot
+    Slot* slot = nullptr;
+    xSemaphoreTake(slotMutex, portMAX_DELAY);
+    for (auto& candidate : slots) {
+        if (candidate.state == SlotState::FREE) {
+            slot = &candidate;
+            break;
+        }
+    }
+    if (slot != nullptr) {
+        slot->state = SlotState::QUEUED;
+        slot->request = request;
+        slot->done = std::move(done);
+        slot->sequence = nextSequence++;
+        slot->enqueuedAt = TimeService::micros64();
+    }
+    xSemaphoreGive(slotMutex);
+
+    if (slot == nullptr) {
+        rejected++;
+        response.setError(serverID, functionCode, SERVER_DEVICE_BUSY);
+        done(response);
+    }
+}
+
+void RtuGateway::schedule(bool busIdle, unsigned long slackMs) {
+    if (!enabled) return;
+
+    uint64_t nowUs = TimeService::micros64();
+    unsigned long now = millis();
+    DoneFn expired[GATEWAY_MAX_PENDING];
+    ModbusMessage expiredResponses[GATEWAY_MAX_PENDING];
+    size_t expiredCount = 0;
+    uint32_t stuckToken = 0;
+    Slot* next = nullptr;
+
+    xSemaphoreTake(slotMutex, portMAX_DELAY);
+
+    // Refill the bus-time budget at the configured share of wall time
+    float maxBudget = GATEWAY_BUDGET_WINDOW_MS * sharePercent / 100.0f;
+    budgetMs = min(maxBudget, budgetMs + (now - lastRefill) * sharePercent / 100.0f);
+    lastRefill = now;
+
+    // Requests that never got the bus in time are answered as a silent slave would be
+    for (auto& slot : slots) {
+        if (slot.state == SlotState::QUEUED && nowUs - slot.enqueuedAt > GATEWAY_WAIT_MS * 1000ULL) {
+            expiredResponses[expiredCount].setError(slot.request.getServerID(), slot.request.getFunctionCode(),
+                                                    GATEWAY_TARGET_NO_RESP);
+            expired[expiredCount++] = std::move(slot.done);
+            slot.done = nullptr;
+            slot.state = SlotState::FREE;
+            timeouts++;
+        }
+    }
+
+    uint32_t current = inFlightToken.load();
+    if (current != 0) {
+        // The RTU client always reports back, but never let a lost callback wedge the gateway
+        for (auto& slot : slots) {
+            if (slot.token == current && nowUs - slot.dispatchedAt > GATEWAY_STUCK_MS * 1000ULL) {
+                stuckToken = current;
+            }
+        }
+    } else if (busIdle && budgetMs > 0.0f) {
+        // Oldest queued request first
+        for (auto& slot : slots) {
+            if (slot.state == SlotState::QUEUED &&
+                (next == nullptr || (int32_t)(slot.sequence - next->sequence) < 0)) {
+                next = &slot;
+            }
+        }
+        // Only dispatch when the transaction fits before the next cache poll is due
+        if (next != nullptr && estimateTransactionMs(next->request) > slackMs) {
+            next = nullptr;
+        }
+    }
+
+    ModbusMessage request;
+    uint32_t token = 0;
+    if (next != nullptr) {
+        next->token = GATEWAY_TOKEN_FLAG | (++nextToken & ~GATEWAY_TOKEN_FLAG);
+        next->state = SlotState::IN_FLIGHT;
+        next->dispatchedAt = nowUs;
+        request = next->request;
+        token = next->token;
+        inFlightToken = token;
+    }
+    xSemaphoreGive(slotMutex);
+
+    for (size_t i = 0; i < expiredCount; i++) {
+        expired[i](expiredResponses[i]);
+    }
+    if (stuckToken != 0) {
+        logErrln("[RtuGateway] Pass-through request stuck, releasing bus");
+        onError(TIMEOUT, stuckToken);
+    }
+    if (token != 0) {
+        Error err = client->addRequest(request, token);
+        if (err != SUCCESS) {
+            fail(SERVER_DEVICE_BUSY, token, false);
+        }
+    }
+}
+
+void RtuGateway::onData(ModbusMessage response, uint32_t token) {
+    complete(token, response, true, true, response.size() + 2);
+}
+
+void RtuGateway::onError(Error error, uint32_t token) {
+    fail(error, token, true);
+}
+
+void RtuGateway::fail(Error error, uint32_t token, bool sent) {
+    uint8_t serverID = 0;
+    uint8_t functionCode = 0;
+    xSemaphoreTake(slotMutex, portMAX_DELAY);
+    for (auto& slot : slots) {
+        if (slot.token == token) {
+            serverID = slot.request.getServerID();
+            functionCode = slot.request.getFunctionCode();
+            break;
+        }
+    }
+    xSemaphoreGive(slotMutex);
+
+    // Pass slave exceptions through, map local failures onto gateway exceptions
+    Error code = error;
+    if (error == TIMEOUT) {
+        code = GATEWAY_TARGET_NO_RESP;
+    } else if (error > GATEWAY_TARGET_NO_RESP) {
+        code = GATEWAY_PATH_UNAVAIL;
+    }
+    ModbusMessage response;
+    response.setError(serverID, functionCode, code);
+    // A slave exception is a 5 byte frame on the wire; anything else is treated as silence
+    complete(token, response, false, sent, sent && error <= GATEWAY_TARGET_NO_RESP ? 5 : 0);
+}
+
+void RtuGateway::complete(uint32_t token, const ModbusMessage& response, bool success, bool sent,
+                          size_t wireBytes) {
+    uint64_t nowUs = TimeService::micros64();
+    DoneFn done;
+
+    xSemaphoreTake(slotMutex, portMAX_DELAY);
+    for (auto& slot : slots) {
+        if (slot.token != token) continue;
+        if (slot.state != SlotState::IN_FLIGHT) break;
+
+        unsigned long queued = (slot.dispatchedAt - slot.enqueuedAt) / 1000;
+        unsigned long latency = (nowUs - slot.enqueuedAt) / 1000;
+        totalQueueTime += queued;
+        maxQueueTime = max(maxQueueTime, queued);
+        totalLatency += latency;
+        maxLatency = max(maxLatency, latency);
+        if (success) {
+            requests++;
+        } else {
+            errors++;
+        }
+        if (sent) {
+            unsigned long onBus = (nowUs - slot.dispatchedAt) / 1000;
+            busTime += onBus;
+            budgetMs -= onBus;
+            busStats.recordTransaction(BUS_STATS_GATEWAY_RANGE, 0, slot.request.size() + 2, wireBytes,
+                                       slot.dispatchedAt, nowUs);
+        }
+
+        slot.token = 0;
+        done = std::move(slot.done);
+        slot.done = nullptr;
+        slot.state = SlotState::FREE;
+        break;
+    }
+    if (inFlightToken.load() == token) {
+        inFlightToken = 0;
+    }
+    xSemaphoreGive(slotMutex);
+
+    // Outside the lock, the callback may queue the next request
+    if (done) {
+        done(response);
+    }
+}
+
+uint32_t RtuGateway::getQueueDepth() {
+    if (!enabled) return 0;
+    uint32_t depth = 0;
+    xSemaphoreTake(slotMutex, portMAX_DELAY);
+    for (auto& slot : slots) {
+        if (slot.state == SlotState::QUEUED) depth++;
+    }
+    xSemaphoreGive(slotMutex);
+    return depth;
+}
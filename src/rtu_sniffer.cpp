@@ -0,0 +1,236 @@
+#include "rtu_sniffer.h"
+
+#include <string.h>
+#include <algorithm>
+
+RtuSniffer::RtuSniffer()
+    : length(0)
+    , resyncing(false)
+    , lastArrivalUs(0)
+    , charUs(0)
+    , t35Us(0)
+    , pending{false, 0, 0, 0, 0, 0, 0}
+    , handler(nullptr)
+    , frames(0)
+    , transactions(0)
+    , exceptions(0)
+    , unanswered(0)
+    , orphanResponses(0)
+    , crcErrors(0)
+    , discardedBytes(0)
+{}
+
+uint16_t RtuSniffer::crc16(const uint8_t* data, size_t len) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 1) ? (crc >> 1) ^ 0xA001 : crc >> 1;
+        }
+    }
+    return crc;
+}
+
+void RtuSniffer::begin(unsigned long baudRate, uint8_t bitsPerChar, TransactionFn transactionHandler) {
+    charUs = baudRate > 0 ? (1000000UL * bitsPerChar) / baudRate : 0;
+    t35Us = baudRate > 19200 ? RTU_SNIFFER_FAST_T35_US : charUs * 7 / 2;
+    handler = transactionHandler;
+    length = 0;
+    resyncing = false;
+    pending.active = false;
+}
+
+void RtuSniffer::feed(const uint8_t* data, size_t len, uint64_t arrivalUs) {
+    // The time the new bytes took on the wire is not silence
+    if (arrivalUs != 0 && lastArrivalUs != 0 && length > 0 &&
+        arrivalUs - lastArrivalUs >= static_cast<uint64_t>(len) * charUs + t35Us) {
+        decode(true);
+    }
+    lastArrivalUs = arrivalUs;
+
+    while (len > 0) {
+        size_t chunk = std::min(len, RTU_SNIFFER_BUFFER - length);
+        memcpy(buffer + length, data, chunk);
+        length += chunk;
+        data += chunk;
+        len -= chunk;
+        decode(false);
+        if (length == RTU_SNIFFER_BUFFER) {
+            discard(1, true);
+        }
+    }
+}
+
+void RtuSniffer::idle(uint64_t nowUs) {
+    if (length > 0 && lastArrivalUs != 0 && nowUs - lastArrivalUs >= t35Us) {
+        decode(true);
+    }
+}
+
+void RtuSniffer::decode(bool frameEnded) {
+    // The shortest frames are an FC7 request (4 bytes) and an exception response (5)
+    while (length >= 4) {
+        bool waiting = false;
+
+        int expected = responseLength();
+        if (expected > 0 && static_cast<size_t>(expected) > length) {
+            waiting = true;
+        } else if (expected > 0 && validFrame(expected)) {
+            acceptResponse(expected);
+            continue;
+        }
+
+        expected = requestLength(length);
+        if (expected > 0 && static_cast<size_t>(expected) > length) {
+            waiting = true;
+        } else if (expected > 0 && validFrame(expected)) {
+            acceptRequest(expected);
+            continue;
+        }
+
+        // A response whose request we missed, e.g. just after starting up
+        expected = orphanResponseLength();
+        if (expected > 0 && static_cast<size_t>(expected) > length) {
+            waiting = true;
+        } else if (expected > 0 && validFrame(expected)) {
+            frames++;
+            orphanResponses++;
+            resyncing = false;
+            discard(expected, false);
+            continue;
+        }
+
+        if (waiting && !frameEnded) {
+            return;
+        }
+        // Nothing valid starts here: noise or a CRC error, slide forward one byte
+        if (!resyncing) {
+            crcErrors++;
+        }
+        discard(1, true);
+    }
+
+    // T3.5 of silence ends any frame, whatever is left can't complete any more
+    if (frameEnded && length > 0) {
+        discard(length, true);
+    }
+}
+
+int RtuSniffer::requestLength(size_t available) const {
+    if (buffer[0] > 247) {
+        return -1;
+    }
+    switch (buffer[1]) {
+        case 0x01: // Read coils
+        case 0x02: // Read discrete inputs
+        case 0x03: // Read holding registers
+        case 0x04: // Read input registers
+        case 0x05: // Write single coil
+        case 0x06: // Write single register
+            return 8;
+        case 0x0F: // Write multiple coils
+        case 0x10: // Write multiple registers
+            return available < 7 ? 7 : 9 + buffer[6];
+        default:
+            return -1;
+    }
+}
+
+int RtuSniffer::responseLength() const {
+    if (!pending.active || buffer[0] != pending.unit) {
+        return -1;
+    }
+    if (buffer[1] == (pending.functionCode | 0x80)) {
+        return 5;
+    }
+    if (buffer[1] != pending.functionCode) {
+        return -1;
+    }
+    switch (pending.functionCode) {
+        // Out-of-range quantities are answered with an exception, handled above
+        case 0x01:
+        case 0x02:
+            return pending.quantity <= 2000 ? 5 + (pending.quantity + 7) / 8 : -1;
+        case 0x03:
+        case 0x04:
+            return pending.quantity <= 125 ? 5 + 2 * pending.quantity : -1;
+        default:
+            return 8;
+    }
+}
+
+int RtuSniffer::orphanResponseLength() const {
+    if (buffer[1] & 0x80) {
+        return buffer[2] >= 0x01 && buffer[2] <= 0x0B ? 5 : -1;
+    }
+    switch (buffer[1]) {
+        case 0x01:
+        case 0x02:
+        case 0x03:
+        case 0x04:
+            return 5 + buffer[2];
+        default:
+            // FC5/6/15/16 responses look like requests and were tried as one
+            return -1;
+    }
+}
+
+bool RtuSniffer::validFrame(int frameLength) const {
+    uint16_t crc = crc16(buffer, frameLength - 2);
+    return buffer[frameLength - 2] == (crc & 0xFF) && buffer[frameLength - 1] == (crc >> 8);
+}
+
+void RtuSniffer::acceptRequest(uint16_t frameLength) {
+    // A request while another is outstanding means the slave never answered
+    if (pending.active) {
+        unanswered++;
+    }
+    frames++;
+    resyncing = false;
+
+    uint8_t functionCode = buffer[1];
+    pending.unit = buffer[0];
+    pending.functionCode = functionCode;
+    pending.startAddress = buffer[2] << 8 | buffer[3];
+    pending.quantity = functionCode == 0x05 || functionCode == 0x06 ? 1 : buffer[4] << 8 | buffer[5];
+    pending.length = frameLength;
+    pending.arrivalUs = lastArrivalUs;
+    // Broadcasts get no response
+    pending.active = pending.unit != 0;
+    discard(frameLength, false);
+}
+
+void RtuSniffer::acceptResponse(uint16_t frameLength) {
+    frames++;
+    transactions++;
+    resyncing = false;
+    pending.active = false;
+
+    SniffedTransaction transaction;
+    transaction.unit = pending.unit;
+    transaction.functionCode = pending.functionCode;
+    transaction.startAddress = pending.startAddress;
+    transaction.quantity = pending.quantity;
+    transaction.exception = (buffer[1] & 0x80) != 0;
+    transaction.response = buffer;
+    transaction.responseLength = frameLength - 2;
+    transaction.requestLength = pending.length;
+    transaction.requestUs = pending.arrivalUs;
+    transaction.responseUs = lastArrivalUs;
+    if (transaction.exception) {
+        exceptions++;
+    }
+    if (handler) {
+        handler(transaction);
+    }
+    discard(frameLength, false);
+}
+
+void RtuSniffer::discard(size_t count, bool garbage) {
+    if (garbage) {
+        discardedBytes += count;
+        resyncing = true;
+    }
+    length -= count;
+    memmove(buffer, buffer + count, length);
+}
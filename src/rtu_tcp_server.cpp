@@ -0,0 +1,119 @@
+#include "rtu_tcp_server.h"
+#include "config.h"
+
+RtuOverTcpServer::RtuOverTcpServer()
+    : server(nullptr)
+    , serverID(1)
+    , idleTimeoutMs(0)
+    , worker(nullptr)
+    , clients(0)
+    , frames(0)
+    , crcErrors(0)
+    , discardedBytes(0)
+{}
+
+bool RtuOverTcpServer::begin(uint16_t port, uint8_t id, uint32_t timeoutMs, MBSworker handler) {
+    if (port == 0 || handler == nullptr) {
+        return false;
+    }
+    serverID = id;
+    idleTimeoutMs = timeoutMs;
+    worker = handler;
+
+    server = new AsyncServer(port);
+    server->onClient(&RtuOverTcpServer::onClient, this);
+    server->setNoDelay(true);
+    server->begin();
+    dbgln("[RtuOverTcpServer] Listening on port " + String(port));
+    return true;
+}
+
+void RtuOverTcpServer::onClient(void* arg, AsyncClient* client) {
+    RtuOverTcpServer* self = static_cast<RtuOverTcpServer*>(arg);
+    if (self->clients.load() >= RTU_TCP_MAX_CLIENTS) {
+        logErrln("[RtuOverTcpServer] Too many clients, rejecting connection");
+        client->close(true);
+        delete client;
+        return;
+    }
+
+    Connection* connection = new Connection();
+    connection->server = self;
+    connection->client = client;
+    self->clients++;
+
+    client->setNoDelay(true);
+    if (self->idleTimeoutMs > 0) {
+        client->setRxTimeout(max<uint32_t>(1, self->idleTimeoutMs / 1000));
+    }
+    client->onData(&RtuOverTcpServer::onData, connection);
+    client->onDisconnect(&RtuOverTcpServer::onDisconnect, connection);
+    client->onTimeout([](void* arg, AsyncClient* client, uint32_t time) {
+        client->close(true);
+    }, connection);
+    dbgln("[RtuOverTcpServer] Client connected from " + client->remoteIP().toString());
+}
+
+void RtuOverTcpServer::onData(void* arg, AsyncClient* client, void* data, size_t len) {
+    Connection* connection = static_cast<Connection*>(arg);
+    RtuOverTcpServer* self = connection->server;
+    RtuFrameParser& parser = connection->parser;
+
+    uint32_t framesBefore = parser.getFrames();
+    uint32_t crcBefore = parser.getCrcErrors();
+    uint32_t discardedBefore = parser.getDiscardedBytes();
+
+    // One TCP segment may carry part of a frame or several back-to-back frames
+    parser.feed(static_cast<const uint8_t*>(data), len, [connection](const uint8_t* frame, size_t frameLen) {
+        connection->server->handleFrame(connection, frame, frameLen);
+    });
+
+    self->frames += parser.getFrames() - framesBefore;
+    self->crcErrors += parser.getCrcErrors() - crcBefore;
+    self->discardedBytes += parser.getDiscardedBytes() - discardedBefore;
+}
+
+void RtuOverTcpServer::onDisconnect(void* arg, AsyncClient* client) {
+    Connection* connection = static_cast<Connection*>(arg);
+    connection->server->clients--;
+    delete connection;
+    delete client;
+}
+
+void RtuOverTcpServer::handleFrame(Connection* connection, const uint8_t* frame, size_t len) {
+    // Like a slave on a real bus, stay silent for other addresses and broadcasts
+    if (frame[0] != serverID) {
+        return;
+    }
+
+    ModbusMessage request;
+    request.add(frame, static_cast<uint16_t>(len));
+    uint8_t functionCode = frame[1];
+
+    ModbusMessage response;
+    if (functionCode != 0x03 && functionCode != 0x04 && functionCode != 0x06) {
+        response.setError(serverID, functionCode, ILLEGAL_FUNCTION);
+    } else {
+        response = worker(request);
+        if (response.size() == 0) {
+            // Cache not ready or busy
+            response.setError(serverID, functionCode, SERVER_DEVICE_BUSY);
+        }
+    }
+
+    // Append the CRC, low byte first
+    uint8_t out[RTU_MAX_FRAME];
+    size_t outLen = min<size_t>(response.size(), RTU_MAX_FRAME - 2);
+    memcpy(out, response.data(), outLen);
+    uint16_t crc = RTUutils::calcCRC(out, outLen);
+    out[outLen++] = crc & 0xFF;
+    out[outLen++] = crc >> 8;
+
+    AsyncClient* client = connection->client;
+    if (client->space() < outLen) {
+        logErrln("[RtuOverTcpServer] Send buffer full, dropping response");
+        return;
+    }
+    client->add(reinterpret_cast<const char*>(out), outLen);
+    client->send();
+}
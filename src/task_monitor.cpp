@@ -0,0 +1,164 @@
+#include "task_monitor.h"
+#include "config.h"
+#include <algorithm>
+
+// Global instance
+TaskMonitor taskMonitor;
+
+TaskMonitor::TaskMonitor()
+    : mutex(nullptr)
+    , lastTotalRunTime(0)
+    , historyHead(0)
+    , historyCount(0)
+    , samples(0)
+{
+    for (uint8_t core = 0; core < TASK_MONITOR_CORES; core++) {
+        idlePercent[core] = -1.0f;
+    }
+}
+
+void TaskMonitor::begin() {
+    mutex = xSemaphoreCreateMutex();
+    if (mutex == nullptr) {
+        logErrln("[TaskMonitor] Failed to allocate mutex");
+        return;
+    }
+#if !TASK_MONITOR_HAS_RUNTIME
+    dbgln("[TaskMonitor] FreeRTOS run-time stats disabled, CPU percentages unavailable");
+#endif
+    // Sampling only reads scheduler state, lowest priority above idle is enough
+    xTaskCreatePinnedToCore(samplerTask, "taskMonitor", 3072, this, 1, nullptr, 0);
+}
+
+void TaskMonitor::addQueue(const String& name, std::function<uint32_t()> depthFn) {
+    queues.push_back({name, 0, 0});
+    queueDepthFns.push_back(depthFn);
+}
+
+void TaskMonitor::samplerTask(void* param) {
+    TaskMonitor* monitor = static_cast<TaskMonitor*>(param);
+    for (;;) {
+        monitor->sample();
+        vTaskDelay(pdMS_TO_TICKS(TASK_MONITOR_INTERVAL_MS));
+    }
+}
+
+void TaskMonitor::sample() {
+#if defined(configUSE_TRACE_FACILITY) && configUSE_TRACE_FACILITY
+    static TaskStatus_t status[TASK_MONITOR_MAX_TASKS];
+    uint32_t totalRunTime = 0;
+    UBaseType_t count = uxTaskGetSystemState(status, TASK_MONITOR_MAX_TASKS, &totalRunTime);
+    if (count == 0) {
+        // More tasks than slots; the table would be incomplete, so skip this round
+        logErrln("[TaskMonitor] More than " + String(TASK_MONITOR_MAX_TASKS) + " tasks, sample skipped");
+        return;
+    }
+    uint32_t elapsed = totalRunTime - lastTotalRunTime;
+#endif
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+
+#if defined(configUSE_TRACE_FACILITY) && configUSE_TRACE_FACILITY
+    std::vector<TaskSample> current;
+    current.reserve(count);
+    float idle[TASK_MONITOR_CORES] = {-1.0f, -1.0f};
+    uint8_t idleSeen = 0;
+
+    for (UBaseType_t i = 0; i < count; i++) {
+        const TaskStatus_t& task = status[i];
+        TaskSample entry;
+        entry.name = task.pcTaskName;
+        entry.priority = task.uxCurrentPriority;
+#ifdef CONFIG_FREERTOS_VTASKLIST_INCLUDE_COREID
+        entry.core = task.xCoreID == tskNO_AFFINITY ? -1 : task.xCoreID;
+#else
+        entry.core = -1;
+#endif
+        entry.stackHighWater = task.usStackHighWaterMark;
+        entry.runTime = 0;
+        entry.cpuPercent = -1.0f;
+        entry.peakCpuPercent = -1.0f;
+
+#if TASK_MONITOR_HAS_RUNTIME
+        entry.runTime = task.ulRunTimeCounter;
+        for (const auto& previous : tasks) {
+            if (previous.name == entry.name && previous.core == entry.core) {
+                if (samples > 0 && elapsed > 0) {
+                    entry.cpuPercent = 100.0f * (entry.runTime - previous.runTime) / elapsed;
+                }
+                entry.peakCpuPercent = max(previous.peakCpuPercent, entry.cpuPercent);
+                break;
+            }
+        }
+
+        // One idle task per core; their share is the core's idle time
+        if (entry.name.startsWith("IDLE") && entry.cpuPercent >= 0.0f) {
+            uint8_t core = entry.core >= 0 ? entry.core : idleSeen;
+            if (entry.name.length() > 4 && isDigit(entry.name[4])) {
+                core = entry.name[4] - '0';
+            }
+            if (core < TASK_MONITOR_CORES) {
+                idle[core] = min(100.0f, entry.cpuPercent);
+            }
+            idleSeen++;
+        }
+#endif
+        current.push_back(entry);
+    }
+
+    std::sort(current.begin(), current.end(),
+        [](const TaskSample& a, const TaskSample& b) { return a.name < b.name; });
+    tasks.swap(current);
+    lastTotalRunTime = totalRunTime;
+
+    for (uint8_t core = 0; core < TASK_MONITOR_CORES; core++) {
+        idlePercent[core] = idle[core];
+        idleHistory[core][historyHead] = idle[core];
+    }
+    historyHead = (historyHead + 1) % TASK_MONITOR_HISTORY;
+    if (historyCount < TASK_MONITOR_HISTORY) historyCount++;
+#endif
+
+    for (size_t i = 0; i < queues.size(); i++) {
+        queues[i].depth = queueDepthFns[i]();
+        queues[i].peak = max(queues[i].peak, queues[i].depth);
+    }
+    samples++;
+
+    xSemaphoreGive(mutex);
+}
+
+std::vector<TaskSample> TaskMonitor::getTasks() {
+    std::vector<TaskSample> copy;
+    if (mutex == nullptr) return copy;
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    copy = tasks;
+    xSemaphoreGive(mutex);
+    return copy;
+}
+
+std::vector<QueueSample> TaskMonitor::getQueues() {
+    std::vector<QueueSample> copy;
+    if (mutex == nullptr) return copy;
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    copy = queues;
+    xSemaphoreGive(mutex);
+    return copy;
+}
+
+float TaskMonitor::getIdlePercent(uint8_t core) {
+    return core < TASK_MONITOR_CORES ? idlePercent[core] : -1.0f;
+}
+
+std::vector<float> TaskMonitor::getIdleHistory(uint8_t core) {
+    std::vector<float> history;
+    if (mutex == nullptr || core >= TASK_MONITOR_CORES) return history;
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    // Oldest first
+    for (uint16_t i = 0; i < historyCount; i++) {
+        uint16_t index = (historyHead + TASK_MONITOR_HISTORY - historyCount + i) % TASK_MONITOR_HISTORY;
+        history.push_back(idleHistory[core][index]);
+    }
+    xSemaphoreGive(mutex);
+    return history;
+}
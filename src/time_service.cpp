@@ -0,0 +1,76 @@
+#include "time_service.h"
+#include <sys/time.h>
+
+#ifdef ARDUINO
+#include <esp_sntp.h>
+#include "config.h"
+#define TIME_LOCK(mux) portENTER_CRITICAL(&mux)
+#define TIME_UNLOCK(mux) portEXIT_CRITICAL(&mux)
+#else
+#define TIME_LOCK(mux) (mux).lock()
+#define TIME_UNLOCK(mux) (mux).unlock()
+#endif
+
+// Global instance
+TimeService timeService;
+
+TimeService::TimeService()
+    : offsetUs(0)
+    , lastSyncUs(0)
+    , lastStepUs(0)
+    , syncCount(0)
+{}
+
+#ifdef ARDUINO
+void TimeService::begin(const String& ntpServer) {
+    if (ntpServer.length() == 0) {
+        dbgln("[TimeService] No NTP server configured, wall-clock time unavailable");
+        return;
+    }
+    sntp_set_time_sync_notification_cb(&TimeService::onSync);
+    // UTC throughout; the web UI localises timestamps itself
+    configTime(0, 0, ntpServer.c_str());
+    dbgln("[TimeService] SNTP started with " + ntpServer);
+}
+#endif
+
+void TimeService::onSync(struct timeval* tv) {
+    uint64_t now = micros64();
+    int64_t unixUs = static_cast<int64_t>(tv->tv_sec) * 1000000LL + tv->tv_usec;
+    int64_t offset = unixUs - static_cast<int64_t>(now);
+
+    TIME_LOCK(timeService.lock);
+    timeService.lastStepUs = timeService.syncCount > 0 ? offset - timeService.offsetUs : 0;
+    timeService.offsetUs = offset;
+    timeService.lastSyncUs = now;
+    timeService.syncCount++;
+    TIME_UNLOCK(timeService.lock);
+}
+
+bool TimeService::isSynced() const {
+    return syncCount > 0;
+}
+
+uint64_t TimeService::toUnixMs(uint64_t monotonicUs) const {
+    if (!isSynced()) {
+        return 0;
+    }
+    TIME_LOCK(lock);
+    int64_t offset = offsetUs;
+    TIME_UNLOCK(lock);
+    return static_cast<uint64_t>(static_cast<int64_t>(monotonicUs) + offset) / 1000;
+}
+
+uint64_t TimeService::getLastSyncUs() const {
+    TIME_LOCK(lock);
+    uint64_t value = lastSyncUs;
+    TIME_UNLOCK(lock);
+    return value;
+}
+
+int64_t TimeService::getLastStepUs() const {
+    TIME_LOCK(lock);
+    int64_t value = lastStepUs;
+    TIME_UNLOCK(lock);
+    return value;
+}
@@ -0,0 +1,76 @@
+#include "turnaround_stats.h"
+#include "time_service.h"
+
+// Global instance
+TurnaroundStats turnaroundStats;
+
+constexpr uint32_t TurnaroundStats::BUCKET_US[TURNAROUND_BUCKETS];
+
+TurnaroundStats::TurnaroundStats()
+    : lock(portMUX_INITIALIZER_UNLOCKED)
+    , budgetUs(TURNAROUND_DEFAULT_BUDGET_MS * 1000UL)
+{
+    memset(counters, 0, sizeof(counters));
+}
+
+void TurnaroundStats::setSerialFormat(ServerKind kind, unsigned long baudRate, uint8_t bitsPerChar) {
+    // 3.5 character times, fixed at 1.75 ms above 19200 baud as the spec recommends
+    uint32_t frameGapUs = baudRate > 0 ? (3500000UL * bitsPerChar) / baudRate : 0;
+    counters[static_cast<uint8_t>(kind)].frameGapUs = baudRate > 19200 ? 1750 : frameGapUs;
+}
+
+MBSworker TurnaroundStats::wrap(ServerKind kind, MBSworker worker) {
+    return [this, kind, worker](ModbusMessage request) {
+        uint64_t start = TimeService::micros64();
+        ModbusMessage response = worker(request);
+        record(kind, TimeService::micros64() - start, response.size() > 0);
+        return response;
+    };
+}
+
+void TurnaroundStats::record(ServerKind kind, uint32_t workerUs, bool answered) {
+    Counters& c = counters[static_cast<uint8_t>(kind)];
+    portENTER_CRITICAL(&lock);
+    if (!answered) {
+        c.dropped++;
+        portEXIT_CRITICAL(&lock);
+        return;
+    }
+    uint32_t turnaround = workerUs + c.frameGapUs;
+    uint8_t bucket = 0;
+    while (bucket < TURNAROUND_BUCKETS && turnaround > BUCKET_US[bucket]) {
+        bucket++;
+    }
+    c.buckets[bucket]++;
+    c.answered++;
+    c.sumUs += turnaround;
+    c.maxUs = max(c.maxUs, turnaround);
+    if (turnaround > budgetUs) {
+        c.late++;
+    }
+    portEXIT_CRITICAL(&lock);
+}
+
+TurnaroundSnapshot TurnaroundStats::getSnapshot(ServerKind kind) {
+    const Counters& c = counters[static_cast<uint8_t>(kind)];
+    TurnaroundSnapshot snapshot;
+    portENTER_CRITICAL(&lock);
+    snapshot.answered = c.answered;
+    snapshot.late = c.late;
+    snapshot.dropped = c.dropped;
+    snapshot.maxUs = c.maxUs;
+    snapshot.sumUs = c.sumUs;
+    memcpy(snapshot.buckets, c.buckets, sizeof(snapshot.buckets));
+    portEXIT_CRITICAL(&lock);
+    return snapshot;
+}
+
+const char* TurnaroundStats::kindName(ServerKind kind) {
+    switch (kind) {
+        case ServerKind::RTU: return "rtu";
+        case ServerKind::TCP: return "tcp";
+        case ServerKind::RTU_TCP: return "rtu_tcp";
+        case ServerKind::EMULATOR: return "emulator";
+        default: return "unknown";
+    }
+}
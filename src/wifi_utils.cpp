@@ -0,0 +1,333 @@
+#include "wifi_utils.h"
+#include "config.h"
+#include <WiFi.h>
+#include <esp_wifi.h>
+
+extern Config config;
+
+#define WIFI_FAST_CACHE_MAGIC 0x57464331 // "WFC1"
+
+// Last-good association, kept in RTC memory across soft resets and in NVS
+// across power cycles. NVS is only rewritten when the AP or channel changes.
+struct WiFiFastConnectCache {
+    uint32_t magic;
+    uint32_t ssidHash;
+    uint8_t bssid[6];
+    uint8_t channel;
+    uint8_t reserved;
+    uint32_t checksum;
+};
+
+RTC_NOINIT_ATTR static WiFiFastConnectCache rtcCache;
+static WiFiFastConnectCache cache;
+static bool cacheValid = false;
+static Preferences* cachePrefs = nullptr;
+
+static unsigned long connectStartTime = 0;
+static unsigned long bootTimeToIP = 0;
+static unsigned long lastTimeToIP = 0;
+static uint32_t fastConnectAttempts = 0;
+static uint32_t fastConnectSuccesses = 0;
+static bool fastConnectPending = false;
+
+// Roaming agent state
+enum class RoamState : uint8_t { IDLE, SCANNING, SWITCHING };
+static RoamState roamState = RoamState::IDLE;
+static unsigned long lastRssiCheck = 0;
+static unsigned long lastRoamScan = 0;
+static unsigned long roamStartTime = 0;
+static uint8_t scanChannel = 0;
+static int8_t bestCandidateRssi = 0;
+static uint8_t bestCandidateBssid[6];
+static uint8_t bestCandidateChannel = 0;
+static uint32_t roamScans = 0;
+static uint32_t roamCount = 0;
+static unsigned long lastRoamInterruption = 0;
+static unsigned long maxRoamInterruption = 0;
+
+static uint32_t fnv1a(const uint8_t* data, size_t len) {
+    uint32_t hash = 2166136261UL;
+    for (size_t i = 0; i < len; i++) {
+        hash = (hash ^ data[i]) * 16777619UL;
+    }
+    return hash;
+}
+
+static uint32_t cacheChecksum(const WiFiFastConnectCache& entry) {
+    return fnv1a(reinterpret_cast<const uint8_t*>(&entry), offsetof(WiFiFastConnectCache, checksum));
+}
+
+static bool isCacheValid(const WiFiFastConnectCache& entry) {
+    return entry.magic == WIFI_FAST_CACHE_MAGIC && entry.channel >= 1 && entry.channel <= 14 &&
+           entry.checksum == cacheChecksum(entry);
+}
+
+// Credentials saved by WiFiManager in the WiFi driver's NVS config
+static bool storedCredentials(String& ssid, String& password) {
+    wifi_config_t conf;
+    if (esp_wifi_get_config(WIFI_IF_STA, &conf) != ESP_OK || conf.sta.ssid[0] == 0) {
+        return false;
+    }
+    char ssidBuffer[33] = {0};
+    char passwordBuffer[65] = {0};
+    memcpy(ssidBuffer, conf.sta.ssid, sizeof(conf.sta.ssid));
+    memcpy(passwordBuffer, conf.sta.password, sizeof(conf.sta.password));
+    ssid = ssidBuffer;
+    password = passwordBuffer;
+    return true;
+}
+
+void wifiFastConnectBegin(Preferences* prefs) {
+    cachePrefs = prefs;
+    if (isCacheValid(rtcCache)) {
+        cache = rtcCache;
+        cacheValid = true;
+        dbgln("[WiFi] Fast connect cache restored from RTC memory");
+    } else if (prefs != nullptr &&
+               prefs->getBytes("wifiFast", &cache, sizeof(cache)) == sizeof(cache) && isCacheValid(cache)) {
+        rtcCache = cache;
+        cacheValid = true;
+        dbgln("[WiFi] Fast connect cache restored from NVS");
+    }
+}
+
+bool wifiGetStaticIPConfig(IPAddress& ip, IPAddress& gateway, IPAddress& subnet) {
+    if (!config.getUseStaticIP()) {
+        return false;
+    }
+    if (!ip.fromString(config.getStaticIP()) || !gateway.fromString(config.getStaticGateway()) ||
+        !subnet.fromString(config.getStaticSubnet())) {
+        logErrln("[WiFi] Static IP enabled but settings are invalid, using DHCP");
+        return false;
+    }
+    return true;
+}
+
+bool wifiBeginFastConnect() {
+    String ssid;
+    String password;
+    if (!cacheValid || !storedCredentials(ssid, password)) {
+        return false;
+    }
+    if (cache.ssidHash != fnv1a(reinterpret_cast<const uint8_t*>(ssid.c_str()), ssid.length())) {
+        dbgln("[WiFi] Fast connect cache belongs to another SSID, ignoring");
+        return false;
+    }
+
+    // A static address also saves the DHCP exchange
+    IPAddress ip, gateway, subnet;
+    if (wifiGetStaticIPConfig(ip, gateway, subnet)) {
+        WiFi.config(ip, gateway, subnet, gateway);
+    }
+
+    fastConnectAttempts++;
+    wifiConnectStarted();
+    fastConnectPending = true;
+    static char bssidBuffer[64];
+    snprintf(bssidBuffer, sizeof(bssidBuffer), "[WiFi] Fast connect to %02X:%02X:%02X:%02X:%02X:%02X on channel %u",
+             cache.bssid[0], cache.bssid[1], cache.bssid[2], cache.bssid[3], cache.bssid[4], cache.bssid[5], cache.channel);
+    dbgln(bssidBuffer);
+    WiFi.begin(ssid.c_str(), password.c_str(), cache.channel, cache.bssid);
+    return true;
+}
+
+bool wifiFastConnect(unsigned long timeoutMs) {
+    if (!wifiBeginFastConnect()) {
+        return false;
+    }
+
+    unsigned long start = millis();
+    while (WiFi.status() != WL_CONNECTED && millis() - start < timeoutMs) {
+        delay(50);
+    }
+    if (WiFi.status() == WL_CONNECTED) {
+        dbgln("[WiFi] Fast connect succeeded after " + String(millis() - start) + " ms");
+        return true;
+    }
+
+    // The AP may have moved channel or gone away; let the caller scan
+    dbgln("[WiFi] Fast connect failed, falling back to scan");
+    fastConnectPending = false;
+    WiFi.disconnect();
+    return false;
+}
+
+void wifiConnectStarted() {
+    connectStartTime = millis();
+    fastConnectPending = false;
+}
+
+void wifiGotIP() {
+    unsigned long now = millis();
+    if (bootTimeToIP == 0) {
+        bootTimeToIP = now;
+    }
+    lastTimeToIP = now - connectStartTime;
+    if (fastConnectPending) {
+        fastConnectSuccesses++;
+        fastConnectPending = false;
+    }
+    if (roamState == RoamState::SWITCHING) {
+        lastRoamInterruption = now - roamStartTime;
+        maxRoamInterruption = max(maxRoamInterruption, lastRoamInterruption);
+        roamCount++;
+        roamState = RoamState::IDLE;
+        dbgln("[WiFi] Roam completed, service interrupted for " + String(lastRoamInterruption) + " ms");
+    }
+
+    String ssid = WiFi.SSID();
+    uint8_t* bssid = WiFi.BSSID();
+    int32_t channel = WiFi.channel();
+    if (bssid == nullptr || channel < 1 || channel > 14) {
+        return;
+    }
+
+    WiFiFastConnectCache entry = {};
+    entry.magic = WIFI_FAST_CACHE_MAGIC;
+    entry.ssidHash = fnv1a(reinterpret_cast<const uint8_t*>(ssid.c_str()), ssid.length());
+    memcpy(entry.bssid, bssid, sizeof(entry.bssid));
+    entry.channel = static_cast<uint8_t>(channel);
+    entry.checksum = cacheChecksum(entry);
+
+    bool changed = !cacheValid || memcmp(&entry, &cache, sizeof(entry)) != 0;
+    cache = entry;
+    rtcCache = entry;
+    cacheValid = true;
+    if (changed && cachePrefs != nullptr) {
+        cachePrefs->putBytes("wifiFast", &entry, sizeof(entry));
+    }
+}
+
+static void startChannelScan(const String& ssid) {
+    // Active scan of a single channel filtered by SSID; the radio returns to
+    // the home channel in between, so the association is kept
+    WiFi.scanNetworks(true, false, false, WIFI_ROAM_CHANNEL_DWELL_MS, scanChannel, ssid.c_str());
+}
+
+void wifiRoamingLoop() {
+    unsigned long now = millis();
+
+    switch (roamState) {
+        case RoamState::IDLE: {
+            if (WiFi.status() != WL_CONNECTED || now - lastRssiCheck < WIFI_ROAM_RSSI_CHECK_MS) {
+                return;
+            }
+            lastRssiCheck = now;
+            int rssi = WiFi.RSSI();
+            if (rssi >= WIFI_RSSI_THRESHOLD || (lastRoamScan != 0 && now - lastRoamScan < WIFI_CHECK_INTERVAL)) {
+                return;
+            }
+            String ssid = WiFi.SSID();
+            if (ssid.length() == 0) {
+                return;
+            }
+            dbgln("[WiFi] RSSI " + String(rssi) + "dBm below threshold, scanning for a better AP");
+            lastRoamScan = now;
+            roamScans++;
+            scanChannel = 1;
+            bestCandidateRssi = rssi + WIFI_ROAM_HYSTERESIS_DB;
+            bestCandidateChannel = 0;
+            roamState = RoamState::SCANNING;
+            startChannelScan(ssid);
+            return;
+        }
+
+        case RoamState::SCANNING: {
+            int16_t result = WiFi.scanComplete();
+            if (result == WIFI_SCAN_RUNNING) {
+                return;
+            }
+            if (WiFi.status() != WL_CONNECTED) {
+                // Lost the link mid-scan, leave it to the recovery logic
+                WiFi.scanDelete();
+                roamState = RoamState::IDLE;
+                return;
+            }
+
+            uint8_t* currentBssid = WiFi.BSSID();
+            for (int16_t i = 0; i < result; i++) {
+                uint8_t* bssid = WiFi.BSSID(i);
+                if (bssid == nullptr || (currentBssid != nullptr && memcmp(bssid, currentBssid, 6) == 0)) {
+                    continue;
+                }
+                if (WiFi.RSSI(i) > bestCandidateRssi) {
+                    bestCandidateRssi = WiFi.RSSI(i);
+                    memcpy(bestCandidateBssid, bssid, sizeof(bestCandidateBssid));
+                    bestCandidateChannel = WiFi.channel(i);
+                }
+            }
+            WiFi.scanDelete();
+
+            if (++scanChannel <= WIFI_ROAM_MAX_CHANNEL) {
+                startChannelScan(WiFi.SSID());
+                return;
+            }
+
+            if (bestCandidateChannel == 0) {
+                dbgln("[WiFi] No AP at least " + String(WIFI_ROAM_HYSTERESIS_DB) + "dB stronger, staying");
+                roamState = RoamState::IDLE;
+                return;
+            }
+
+            String ssid;
+            String password;
+            if (!storedCredentials(ssid, password)) {
+                roamState = RoamState::IDLE;
+                return;
+            }
+            static char roamBuffer[96];
+            snprintf(roamBuffer, sizeof(roamBuffer), "[WiFi] Roaming to %02X:%02X:%02X:%02X:%02X:%02X on channel %u (%ddBm)",
+                     bestCandidateBssid[0], bestCandidateBssid[1], bestCandidateBssid[2], bestCandidateBssid[3],
+                     bestCandidateBssid[4], bestCandidateBssid[5], bestCandidateChannel, bestCandidateRssi);
+            dbgln(roamBuffer);
+            roamStartTime = now;
+            roamState = RoamState::SWITCHING;
+            wifiConnectStarted();
+            WiFi.begin(ssid.c_str(), password.c_str(), bestCandidateChannel, bestCandidateBssid);
+            return;
+        }
+
+        case RoamState::SWITCHING:
+            if (now - roamStartTime > WIFI_ROAM_TIMEOUT_MS) {
+                logErrln("[WiFi] Roam did not complete, handing over to recovery");
+                roamState = RoamState::IDLE;
+            }
+            return;
+    }
+}
+
+bool wifiIsRoaming() {
+    return roamState == RoamState::SWITCHING;
+}
+
+uint32_t wifiGetRoamScans() {
+    return roamScans;
+}
+
+uint32_t wifiGetRoamCount() {
+    return roamCount;
+}
+
+unsigned long wifiGetLastRoamInterruption() {
+    return lastRoamInterruption;
+}
+
+unsigned long wifiGetMaxRoamInterruption() {
+    return maxRoamInterruption;
+}
+
+unsigned long wifiGetBootTimeToIP() {
+    return bootTimeToIP;
+}
+
+unsigned long wifiGetLastTimeToIP() {
+    return lastTimeToIP;
+}
+
+uint32_t wifiGetFastConnectAttempts() {
+    return fastConnectAttempts;
+}
+
+uint32_t wifiGetFastConnectSuccesses() {
+    return fastConnectSuccesses;
+}
@@ -27,5 +27,6 @@ export {
   Pause,
   RefreshCw,
   Lightbulb,
-  Save
+  Save,
+  Download
 } from 'lucide-preact';
\ No newline at end of file
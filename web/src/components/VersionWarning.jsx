@@ -21,12 +21,9 @@ export function VersionWarning() {
 
   const checkVersionSync = async () => {
     try {
-      // Get firmware version from status
-      const status = await api.getStatus();
+      // Firmware version from status, filesystem version from version.json, in one batch
+      const [status, versionData] = await Promise.all([api.getStatus(), api.getVersion()]);
       const firmwareVersionFromStatus = status.data?.find(item => item.name === 'Firmware Version')?.value || 'Unknown';
-      
-      // Get filesystem version
-      const versionData = await api.getVersion();
       const fsVersion = versionData.filesystem_version || 'Unknown';
       
       setFirmwareVersion(firmwareVersionFromStatus);
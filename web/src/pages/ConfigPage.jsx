@@ -6,6 +6,8 @@ export function ConfigPage() {
   const [config, setConfig] = useState({
     hostname: '',
     pi: 1000, // Polling interval
+    dp: false, // demand-driven polling
+    pf: false, // phase-aligned prefetch
     clientIsRTU: true,
     // RTU Settings
     mb: 9600,  // baud rate
@@ -13,6 +15,7 @@ export function ConfigPage() {
     mp: 0,     // parity (0=None, 2=Even, 3=Odd)
     ms: 1,     // stop bits
     mr: -1,    // RTS pin
+    snf: false, // listen-only sniffer mode
     // TCP Settings  
     sip: '',   // server IP
     tp2: 502,  // server port
@@ -22,8 +25,11 @@ export function ConfigPage() {
     mp2: 0,
     ms2: 1,
     mr2: -1,
+    rtb: 20,   // response budget (ms) for the late-response counters
     // TCP Server Settings
     tp3: 502,
+    tse: false, // socket-based TCP server engine
+    tp4: 8899, // RTU over TCP port (0 = disabled)
     // Serial Debug Settings
     sb: 115200,
     sd: 8,
@@ -33,7 +39,19 @@ export function ConfigPage() {
     useStaticIP: false,
     staticIP: '',
     staticGateway: '',
-    staticSubnet: ''
+    staticSubnet: '',
+    ntp: 'pool.ntp.org',
+    oo: true,  // online lookup of vendors missing from the OUI table
+    sl: '',    // syslog target host[:port]
+    slp: 0,    // syslog transport (0=UDP, 1=TCP)
+    slr: 2048, // syslog bandwidth cap (bytes/s, 0=unlimited)
+    // Event Settings
+    er: '',    // threshold rules
+    es: 0,     // sink type (0=None, 1=Webhook, 2=MQTT, 3=UDP)
+    et: '',    // sink target
+    // RTU Pass-through Settings
+    gu: '',    // forwarded unit IDs
+    gs: 20     // bus-time share cap (%)
   });
   
   const [loading, setLoading] = useState(false);
@@ -177,6 +195,38 @@ export function ConfigPage() {
             />
             {renderFieldError('pi')}
           </div>
+
+          <div class="form-group">
+            <div class="form-check">
+              <input
+                type="checkbox"
+                id="dp"
+                class="form-check-input"
+                checked={config.dp}
+                onChange={(e) => handleInputChange('dp', e.target.checked)}
+              />
+              <label class="form-label" for="dp">Demand-driven polling</label>
+            </div>
+            <div class="text-sm text-muted" style="margin-top: 0.25rem;">
+              Poll registers at twice the rate clients read them; unread ranges drop to every 10 s, and reads of unlisted registers are added to the poll set
+            </div>
+          </div>
+
+          <div class="form-group">
+            <div class="form-check">
+              <input
+                type="checkbox"
+                id="pf"
+                class="form-check-input"
+                checked={config.pf}
+                onChange={(e) => handleInputChange('pf', e.target.checked)}
+              />
+              <label class="form-label" for="pf">Phase-aligned prefetch</label>
+            </div>
+            <div class="text-sm text-muted" style="margin-top: 0.25rem;">
+              Learn the period of regular client reads and poll each range just before the next one is due, so clients get fresher data
+            </div>
+          </div>
           
           <div class="form-group">
             <div class="form-check">
@@ -277,6 +327,22 @@ export function ConfigPage() {
                 <option value={33}>D33</option>
               </select>
             </div>
+
+            <div class="form-group">
+              <div class="form-check">
+                <input
+                  type="checkbox"
+                  id="snf"
+                  class="form-check-input"
+                  checked={config.snf}
+                  onChange={(e) => handleInputChange('snf', e.target.checked)}
+                />
+                <label class="form-label" for="snf">Listen only (sniffer)</label>
+              </div>
+              <div class="text-sm text-muted" style="margin-top: 0.25rem;">
+                Never transmit: fill the cache from another master's polls of the meter on the same bus (takes effect after a reboot)
+              </div>
+            </div>
           </div>
         )}
 
@@ -312,6 +378,22 @@ export function ConfigPage() {
                 />
               </div>
             </div>
+
+            <div class="form-group">
+              <div class="form-check">
+                <input
+                  type="checkbox"
+                  id="bs"
+                  class="form-check-input"
+                  checked={config.bs}
+                  onChange={(e) => handleInputChange('bs', e.target.checked)}
+                />
+                <label class="form-label" for="bs">Bulk sync from primary proxy</label>
+              </div>
+              <div class="text-sm text-muted" style="margin-top: 0.25rem;">
+                Server is another proxy: fetch its whole cache from /cache.bin instead of polling registers
+              </div>
+            </div>
           </div>
         )}
 
@@ -399,6 +481,19 @@ export function ConfigPage() {
               <option value={33}>D33</option>
             </select>
           </div>
+
+          <div class="form-group">
+            <label class="form-label" for="rtb">Response Budget (ms)</label>
+            <input
+              type="number"
+              id="rtb"
+              class="form-control"
+              min="1"
+              value={config.rtb}
+              onInput={(e) => handleInputChange('rtb', parseInt(e.target.value))}
+            />
+            <div class="text-sm text-muted" style="margin-top: 0.25rem;">Responses slower than this are counted as late in the turnaround metrics of every server (worker time plus the nominal T3.5 silence on RTU servers)</div>
+          </div>
         </div>
 
         {/* TCP Server Settings */}
@@ -416,8 +511,70 @@ export function ConfigPage() {
               onInput={(e) => handleInputChange('tp3', parseInt(e.target.value))}
             />
           </div>
+          <div class="form-group">
+            <div class="form-check">
+              <input
+                type="checkbox"
+                id="tse"
+                class="form-check-input"
+                checked={config.tse}
+                onChange={(e) => handleInputChange('tse', e.target.checked)}
+              />
+              <label class="form-label" for="tse">Dedicated socket task</label>
+            </div>
+            <div class="text-sm text-muted" style="margin-top: 0.25rem;">
+              Serve this port from its own task instead of the web server's, so slow pages don't delay Modbus replies (takes effect after a reboot)
+            </div>
+          </div>
+          <div class="form-group">
+            <label class="form-label" for="tp4">RTU over TCP Port</label>
+            <input
+              type="number"
+              id="tp4"
+              class="form-control"
+              min="0"
+              max="65535"
+              value={config.tp4}
+              onInput={(e) => handleInputChange('tp4', parseInt(e.target.value))}
+            />
+            <div class="text-sm text-muted" style="margin-top: 0.25rem;">Raw RTU frames with CRC, no MBAP header (0 disables)</div>
+          </div>
         </div>
 
+        {/* RTU Pass-through Settings */}
+        {config.clientIsRTU && (
+          <div class="card">
+            <h3 class="card-title">RTU Pass-through</h3>
+            <div style="display: grid; grid-template-columns: 2fr 1fr; gap: 1rem;">
+              <div class="form-group">
+                <label class="form-label" for="gu">Forwarded Unit IDs</label>
+                <input
+                  type="text"
+                  id="gu"
+                  class="form-control"
+                  value={config.gu}
+                  onInput={(e) => handleInputChange('gu', e.target.value)}
+                  placeholder="2, 3"
+                />
+                <div class="text-sm text-muted" style="margin-top: 0.25rem;">TCP requests for these slaves are forwarded onto the RS485 bus; Modbus TCP is then always served from the dedicated socket task (reboot required)</div>
+              </div>
+
+              <div class="form-group">
+                <label class="form-label" for="gs">Bus Share Cap (%)</label>
+                <input
+                  type="number"
+                  id="gs"
+                  class="form-control"
+                  min="0"
+                  max="100"
+                  value={config.gs}
+                  onInput={(e) => handleInputChange('gs', parseInt(e.target.value))}
+                />
+              </div>
+            </div>
+          </div>
+        )}
+
         {/* Serial Debug Settings */}
         <div class="card">
           <h3 class="card-title">Serial (Debug)</h3>
@@ -479,10 +636,133 @@ export function ConfigPage() {
           </div>
         </div>
 
+        {/* Threshold Event Settings */}
+        <div class="card">
+          <h3 class="card-title">Threshold Events</h3>
+          <div class="form-group">
+            <label class="form-label" for="er">Rules</label>
+            <textarea
+              id="er"
+              class="form-control"
+              rows="4"
+              value={config.er}
+              onInput={(e) => handleInputChange('er', e.target.value)}
+              placeholder="4<-4000:200:5000"
+            />
+            <div class="text-sm text-muted" style="margin-top: 0.25rem;">One rule per line: register, &gt; or &lt;, threshold, then optional :hysteresis:min-duration-ms</div>
+          </div>
+
+          <div style="display: grid; grid-template-columns: 1fr 2fr; gap: 1rem;">
+            <div class="form-group">
+              <label class="form-label" for="es">Sink</label>
+              <select
+                id="es"
+                class="form-control"
+                value={config.es}
+                onChange={(e) => handleInputChange('es', parseInt(e.target.value))}
+              >
+                <option value={0}>None</option>
+                <option value={1}>Webhook</option>
+                <option value={2}>MQTT</option>
+                <option value={3}>UDP</option>
+              </select>
+            </div>
+
+            <div class="form-group">
+              <label class="form-label" for="et">Target</label>
+              <input
+                type="text"
+                id="et"
+                class="form-control"
+                value={config.et}
+                onInput={(e) => handleInputChange('et', e.target.value)}
+                placeholder={config.es === 1 ? 'http://host/path' : config.es === 2 ? 'broker:1883/topic' : 'host:port'}
+              />
+            </div>
+          </div>
+        </div>
+
+        {/* Remote Syslog Settings */}
+        <div class="card">
+          <h3 class="card-title">Remote Syslog</h3>
+          <div style="display: grid; grid-template-columns: 2fr 1fr 1fr; gap: 1rem;">
+            <div class="form-group">
+              <label class="form-label" for="sl">Collector</label>
+              <input
+                type="text"
+                id="sl"
+                class="form-control"
+                value={config.sl}
+                onInput={(e) => handleInputChange('sl', e.target.value)}
+                placeholder="host:514"
+              />
+            </div>
+
+            <div class="form-group">
+              <label class="form-label" for="slp">Transport</label>
+              <select
+                id="slp"
+                class="form-control"
+                value={config.slp}
+                onChange={(e) => handleInputChange('slp', parseInt(e.target.value))}
+              >
+                <option value={0}>UDP</option>
+                <option value={1}>TCP</option>
+              </select>
+            </div>
+
+            <div class="form-group">
+              <label class="form-label" for="slr">Rate Limit (B/s)</label>
+              <input
+                type="number"
+                id="slr"
+                class="form-control"
+                min="0"
+                value={config.slr}
+                onInput={(e) => handleInputChange('slr', parseInt(e.target.value) || 0)}
+              />
+            </div>
+          </div>
+          <div class="text-sm text-muted" style="margin-top: 0.25rem;">
+            RFC 5424 records from the debug log; leave the collector empty to disable. UDP packs several records per datagram, one per line
+          </div>
+        </div>
+
         {/* Network Settings */}
         <div class="card">
           <h3 class="card-title">Network Settings</h3>
           
+          <div class="form-group">
+            <label class="form-label" for="ntp">NTP Server</label>
+            <input
+              type="text"
+              id="ntp"
+              class="form-control"
+              value={config.ntp}
+              onInput={(e) => handleInputChange('ntp', e.target.value)}
+              placeholder="pool.ntp.org"
+            />
+            <div class="text-sm text-muted" style="margin-top: 0.25rem;">
+              Used for wall-clock timestamps in exports; leave empty to disable. Takes effect after reboot
+            </div>
+          </div>
+
+          <div class="form-group">
+            <div class="form-check">
+              <input
+                type="checkbox"
+                id="oo"
+                class="form-check-input"
+                checked={config.oo}
+                onChange={(e) => handleInputChange('oo', e.target.checked)}
+              />
+              <label class="form-label" for="oo">Online vendor lookup</label>
+            </div>
+            <div class="text-sm text-muted" style="margin-top: 0.25rem;">
+              Look up access point vendors missing from the on-flash OUI table at api.maclookup.app, in the background
+            </div>
+          </div>
+          
           <div class="form-group">
             <div class="form-check">
               <input
@@ -1,6 +1,6 @@
 import { useState, useEffect, useRef } from 'preact/hooks';
 import { api } from '../utils/api';
-import { Play, Pause, Trash2, RotateCcw, AlertTriangle, XCircle, RefreshCw, Lightbulb, FileText } from '../components/Icons';
+import { Play, Pause, Trash2, RotateCcw, AlertTriangle, XCircle, RefreshCw, Lightbulb, FileText, Download } from '../components/Icons';
 
 export function LogPage() {
   const [logs, setLogs] = useState('');
@@ -10,13 +10,14 @@ export function LogPage() {
   const [position, setPosition] = useState(0);
   const [isOverflow, setIsOverflow] = useState(false);
   const [isPaused, setIsPaused] = useState(false);
+  const [filters, setFilters] = useState({ level: '', category: '', q: '' });
   
   const logContainerRef = useRef();
   const intervalRef = useRef();
 
   const fetchLogs = async (isInitial = false) => {
     try {
-      const response = await api.getLogs(isInitial ? 0 : position);
+      const response = await api.getLogs(isInitial ? null : position, 8192, filters);
       
       // Parse response format: position\noverflowFlag\nmessages
       const lines = response.split('\n');
@@ -55,6 +56,10 @@ export function LogPage() {
     }
   };
 
+  const updateFilter = (field, value) => {
+    setFilters(prev => ({ ...prev, [field]: value.trim() }));
+  };
+
   const togglePause = () => {
     setIsPaused(prev => !prev);
   };
@@ -82,7 +87,7 @@ export function LogPage() {
         clearInterval(intervalRef.current);
       }
     };
-  }, [isPaused, position]);
+  }, [isPaused, position, filters]);
 
   // Handle manual scroll to disable auto-scroll
   const handleScroll = (e) => {
@@ -130,9 +135,46 @@ export function LogPage() {
           >
             <RefreshCw size={16} style="margin-right: 0.25rem;" />Refresh
           </button>
+          
+          <a
+            class="btn btn-primary"
+            href="/log.txt.gz"
+            download="log.txt.gz"
+            style="padding: 0.5rem 1rem; font-size: 0.875rem;"
+          >
+            <Download size={16} style="margin-right: 0.25rem;" />Download
+          </a>
         </div>
       </div>
 
+      {/* Filters are evaluated on the device, only matching lines are transferred */}
+      <div style="display: flex; gap: 0.5rem; margin-bottom: 1rem;">
+        <select
+          class="form-control"
+          value={filters.level}
+          onChange={(e) => updateFilter('level', e.target.value)}
+          style="max-width: 10rem;"
+        >
+          <option value="">All levels</option>
+          <option value="E">Errors only</option>
+        </select>
+        <input
+          type="text"
+          class="form-control"
+          placeholder="Category, e.g. WiFi"
+          value={filters.category}
+          onChange={(e) => updateFilter('category', e.target.value)}
+          style="max-width: 14rem;"
+        />
+        <input
+          type="text"
+          class="form-control"
+          placeholder="Search text"
+          value={filters.q}
+          onChange={(e) => updateFilter('q', e.target.value)}
+        />
+      </div>
+
       {/* Status indicators */}
       <div style="display: flex; gap: 1rem; margin-bottom: 1rem; font-size: 0.875rem;">
         <div style={`color: ${isPaused ? 'var(--warning-color)' : 'var(--success-color)'};`}>
@@ -190,6 +232,8 @@ export function LogPage() {
           <li><strong>Pause:</strong> Use pause to stop fetching new logs while investigating</li>
           <li><strong>Clear:</strong> Clear logs to reduce memory usage and start fresh</li>
           <li><strong>Live updates:</strong> Logs refresh automatically every 2 seconds when not paused</li>
+          <li><strong>Filters:</strong> Level, category (the <code>[Tag]</code> at the start of a message) and text are matched on the device</li>
+          <li><strong>Download:</strong> Saves the whole log buffer as a compressed <code>log.txt.gz</code></li>
         </ul>
       </div>
     </div>
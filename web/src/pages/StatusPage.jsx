@@ -1,4 +1,5 @@
 import { useState, useEffect } from 'preact/hooks';
+import { api } from '../utils/api';
 
 export function StatusPage() {
   const [statusData, setStatusData] = useState(null);
@@ -7,28 +8,16 @@ export function StatusPage() {
 
   const fetchStatusData = async () => {
     try {
-      // Fetch both status data and filesystem version
-      const [statusResponse, versionResponse] = await Promise.all([
-        fetch('/status.json'),
-        fetch('/version.json')
+      // Fetch both status data and filesystem version, in one batch request
+      // Don't fail if the filesystem version is not available
+      const [statusData, versionData] = await Promise.all([
+        api.getStatus(),
+        api.getVersion().catch(versionErr => {
+          console.warn('Failed to fetch filesystem version:', versionErr);
+          return null;
+        })
       ]);
-
-      if (!statusResponse.ok) {
-        throw new Error(`HTTP error! status: ${statusResponse.status}`);
-      }
-
-      const statusData = await statusResponse.json();
-      
-      // Try to fetch filesystem version, but don't fail if it's not available
-      let filesystemVersion = 'Unknown';
-      try {
-        if (versionResponse.ok) {
-          const versionData = await versionResponse.json();
-          filesystemVersion = versionData.filesystem_version || 'Unknown';
-        }
-      } catch (versionErr) {
-        console.warn('Failed to fetch filesystem version:', versionErr);
-      }
+      const filesystemVersion = versionData?.filesystem_version || 'Unknown';
 
       // Insert filesystem version right after firmware version in the data array
       const modifiedData = [...statusData.data];
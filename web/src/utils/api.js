@@ -61,19 +61,91 @@ export async function apiPost(endpoint, data = null) {
   return apiCall(endpoint, options);
 }
 
+/**
+ * Batched GET of JSON resources.
+ *
+ * Parts requested within BATCH_WINDOW_MS of each other (e.g. by components
+ * mounting together) are fetched in one /api/batch request instead of one
+ * connection each. A part already in flight is shared, not fetched twice.
+ * Firmware without /api/batch falls back to the individual endpoints.
+ */
+const BATCH_WINDOW_MS = 5;
+const BATCH_ENDPOINTS = {
+  status: '/status.json',
+  version: '/version.json',
+  config: '/config.json',
+};
+let batchQueue = null;
+let batchSupported = true;
+
+async function flushBatch() {
+  const queue = batchQueue;
+  batchQueue = null;
+  const parts = Object.keys(queue);
+
+  try {
+    let results;
+    if (batchSupported) {
+      const response = await fetch(`${API_BASE}/api/batch?parts=${parts.join(',')}`);
+      if (response.status === 404) {
+        batchSupported = false;
+      } else if (!response.ok) {
+        throw new Error(`HTTP ${response.status}: ${response.statusText}`);
+      } else {
+        results = await response.json();
+      }
+    }
+
+    for (const part of parts) {
+      if (results) {
+        if (results[part] === null || results[part] === undefined) {
+          queue[part].reject(new Error('HTTP 404: Not Found'));
+        } else {
+          queue[part].resolve(results[part]);
+        }
+      } else {
+        apiGet(BATCH_ENDPOINTS[part]).then(queue[part].resolve, queue[part].reject);
+      }
+    }
+  } catch (error) {
+    console.error(`API Error for batch ${parts.join(',')}:`, error);
+    parts.forEach(part => queue[part].reject(error));
+  }
+}
+
+export function batchGet(part) {
+  if (!batchQueue) {
+    batchQueue = {};
+    setTimeout(flushBatch, BATCH_WINDOW_MS);
+  }
+  if (!batchQueue[part]) {
+    let resolve, reject;
+    const promise = new Promise((res, rej) => { resolve = res; reject = rej; });
+    batchQueue[part] = { promise, resolve, reject };
+  }
+  return batchQueue[part].promise;
+}
+
 /**
  * Specific API endpoints
  */
 export const api = {
   // Status and monitoring
-  getStatus: () => apiGet('/status.json'),
-  getVersion: () => apiGet('/version.json'),
-  getLogs: (position = 0, chunkSize = 8192) => 
-    apiGet(`/logdata?position=${position}&chunk_size=${chunkSize}`),
+  getStatus: () => batchGet('status'),
+  getVersion: () => batchGet('version'),
+  // position null starts from the oldest line; filters are applied on the device
+  getLogs: (position = 0, chunkSize = 8192, filters = {}) => {
+    const params = new URLSearchParams({ chunk_size: chunkSize });
+    if (position !== null) params.set('position', position);
+    if (filters.level) params.set('level', filters.level);
+    if (filters.category) params.set('category', filters.category);
+    if (filters.q) params.set('q', filters.q);
+    return apiGet(`/logdata?${params.toString()}`);
+  },
   clearLogs: () => apiPost('/logclear'),
 
   // Configuration
-  getConfig: () => apiGet('/config.json'),
+  getConfig: () => batchGet('config'),
   updateConfig: (config) => {
     const formData = new FormData();
     Object.entries(config).forEach(([key, value]) => {